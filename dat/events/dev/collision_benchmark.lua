@@ -0,0 +1,60 @@
+--[[
+<?xml version='1.0' encoding='utf8'?>
+<event name="Collision Benchmark">
+ <location>none</location>
+ <chance>0</chance>
+</event>
+--]]
+--[[
+   Times the polygon collision tests between pairs of ships.
+   Trigger it with naev.eventStart("Collision Benchmark")
+   Run it once with low memory mode off and once with it on to compare the
+   precomputed views with the views rotated on the fly.
+--]]
+local TRIES = 2000
+
+local pairs_ships = {
+   { "Llama", "Hyena" },
+   { "Vendetta", "Ancestor" },
+   { "Pacifier", "Lancelot" },
+   { "Kestrel", "Hawking" },
+   { "Goddard", "Empire Peacemaker" },
+}
+
+function create ()
+   local pos = vec2.new( 50e6, 0 )
+   player.pilot():setPos( pos )
+   player.pilot():setInvincible(true)
+   player.pilot():setHide(true)
+
+   local low_memory = naev.conf().low_memory
+   print(string.format("Collision benchmark (low memory: %s)",
+      tostring(low_memory)))
+   print("ship a, ship b, hits, tests, time (ms), per test (us)")
+   for k,s in ipairs(pairs_ships) do
+      local a = pilot.add( s[1], "Independent", pos + vec2.new( 0, 300*k ) )
+      local b = pilot.add( s[2], "Independent", pos + vec2.new( 0, 300*k ) )
+      a:control()
+      b:control()
+
+      local hits = 0
+      local t = naev.clock()
+      for i = 1,TRIES do
+         -- Sweep b around a at all the angles so every view gets used, at
+         -- distances that give both hits and misses
+         local ang = 2*math.pi*i/TRIES
+         b:setPos( a:pos() + vec2.newP( 10*(i%10), ang ) )
+         b:setDir( -ang )
+         if a:collisionTest( b ) then
+            hits = hits+1
+         end
+      end
+      local elapsed = (naev.clock()-t)*1000
+      print(string.format("%s, %s, %d, %d, %.2f, %.2f", s[1], s[2], hits,
+         TRIES, elapsed, 1000*elapsed/TRIES ))
+
+      a:rm()
+      b:rm()
+   end
+   evt.finish()
+end
@@ -109,6 +109,10 @@ function scom.choose ()
       m = m + v.w
       if r < m then
          scom._spawn_data = v.func()
+         -- Get the graphics ready before they spawn
+         for _i,p in ipairs( scom._spawn_data ) do
+            p.ship:gfxPrefetch()
+         end
          return true
       end
    end
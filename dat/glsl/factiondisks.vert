@@ -0,0 +1,23 @@
+uniform mat4 projection;
+uniform vec2 offset;
+uniform float zoom;
+uniform float radius;
+uniform float alpha;
+
+in vec2 centre;
+in vec2 vertex;
+in float size;
+in vec4 disk_colour;
+out vec2 pos;
+out vec4 colour;
+out float paramf;
+
+void main(void) {
+   /* Disks are stored in map coordinates. */
+   float sr    = size * zoom;
+   pos         = vertex;
+   colour      = disk_colour;
+   colour.a   *= alpha;
+   paramf      = radius / sr;
+   gl_Position = projection * vec4(offset + centre * zoom + vertex * sr, 0.0, 1.0);
+}
@@ -1,11 +1,11 @@
 #include "lib/math.glsl"
 
-uniform float m;
-uniform vec4 colour;
 uniform vec4 outline_colour;
 uniform sampler2D sampler;
 
 in vec2 tex_coord_out;
+in float m;
+in vec4 colour;
 out vec4 colour_out;
 
 void main(void)
@@ -2,9 +2,15 @@ uniform mat4 projection;
 
 in vec4 vertex;
 in vec2 tex_coord;
+in float glyph_m;
+in vec4 glyph_colour;
 out vec2 tex_coord_out;
+out float m;
+out vec4 colour;
 
 void main(void) {
    tex_coord_out = tex_coord;
+   m = glyph_m;
+   colour = glyph_colour;
    gl_Position = projection * vertex;
 }
@@ -0,0 +1,30 @@
+uniform mat4 projection;
+uniform vec2 offset;
+uniform float zoom;
+
+in vec4 lane;
+in vec2 vertex;
+in float height;
+in vec4 lane_colour;
+in vec4 lane_colour_end;
+out vec2 pos;
+out vec2 dimensions;
+out vec4 colour;
+out vec4 colour_end;
+
+void main(void) {
+   /* Lanes are stored in map coordinates, but their width is in pixels. */
+   vec2 p1  = offset + lane.xy * zoom;
+   vec2 p2  = offset + lane.zw * zoom;
+   vec2 d   = p2 - p1;
+   float l  = length(d);
+   vec2 dir = (l > 0.0) ? d / l : vec2(1.0, 0.0);
+   vec2 nrm = vec2(-dir.y, dir.x);
+
+   pos         = vertex;
+   dimensions  = vec2(0.5 * l, height);
+   colour      = lane_colour;
+   colour_end  = lane_colour_end;
+   vec2 p      = 0.5 * (p1 + p2) + dir * vertex.x * dimensions.x + nrm * vertex.y * dimensions.y;
+   gl_Position = projection * vec4(p, 0.0, 1.0);
+}
@@ -9,6 +9,21 @@ local bioship = require 'bioship'
 local ai_setup = require "ai.core.setup"
 local function choose_one( t ) return t[ rnd.rnd(1,#t) ] end
 
+-- Solved loadouts, indexed by loadout_key(). Each entry has a pool of up to
+-- LOADOUT_VARIANTS different solutions to keep some diversity, which gets
+-- filled by solving in the background as the entry gets used. At most
+-- LOADOUT_CACHE_SIZE entries are kept, dropping the least recently used, and
+-- the cache is emptied when the system changes.
+local loadout_cache = {}
+local loadout_cache_n = 0
+local loadout_cache_sys
+local loadout_cache_tick = 0
+local LOADOUT_VARIANTS = 4
+local LOADOUT_CACHE_SIZE = 64
+-- The mass limit is randomised per pilot, so it gets rounded to this step to
+-- let pilots share loadouts
+local LOADOUT_MASS_STEP = 0.05
+
 -- Create caches and stuff
 -- Get all the fighter bays and calculate rough dps
 local outfit_stats = {}
@@ -134,6 +149,158 @@ special_ships["Heavy Drone"] = function( p )
 end
 
 
+-- Appends a deterministic representation of a value to out
+local function loadout_serialize( v, out )
+   local t = type(v)
+   if t=="table" then
+      local keys = {}
+      for k in pairs(v) do
+         if k ~= "id" then -- Set by optimize.optimize
+            table.insert( keys, k )
+         end
+      end
+      table.sort( keys, function ( a, b ) return tostring(a) < tostring(b) end )
+      table.insert( out, "{" )
+      for i,k in ipairs(keys) do
+         table.insert( out, tostring(k) )
+         table.insert( out, "=" )
+         if not loadout_serialize( v[k], out ) then
+            return false
+         end
+         table.insert( out, "," )
+      end
+      table.insert( out, "}" )
+   elseif t=="function" then
+      -- Custom functions can be closures that change every call
+      if v ~= optimize.goodness_default then
+         return false
+      end
+      table.insert( out, "goodness_default" )
+   elseif t=="userdata" then
+      table.insert( out, v:nameRaw() )
+   else
+      table.insert( out, tostring(v) )
+   end
+   return true
+end
+
+-- Drops an entry of the cache, collecting its background solve if any
+local function loadout_drop( key )
+   local entry = loadout_cache[key]
+   if entry.pending then
+      entry.lp:solve_wait()
+   end
+   entry.lp = nil
+   entry.cols = nil
+   loadout_cache[key] = nil
+   loadout_cache_n = loadout_cache_n - 1
+end
+
+-- Gets an entry of the cache, emptying the cache if the system changed
+local function loadout_get( key )
+   local sys = system.cur()
+   if sys ~= loadout_cache_sys then
+      for k in pairs(loadout_cache) do
+         loadout_drop( k )
+      end
+      loadout_cache_sys = sys
+   end
+   local entry = loadout_cache[key]
+   if entry then
+      loadout_cache_tick = loadout_cache_tick+1
+      entry.tick = loadout_cache_tick
+   end
+   return entry
+end
+
+-- Adds an entry to the cache, dropping the least recently used if full
+local function loadout_set( key, entry )
+   if loadout_cache[key] then
+      loadout_drop( key )
+   end
+   if loadout_cache_n >= LOADOUT_CACHE_SIZE then
+      local oldest
+      for k,e in pairs(loadout_cache) do
+         if not oldest or e.tick < loadout_cache[oldest].tick then
+            oldest = k
+         end
+      end
+      loadout_drop( oldest )
+   end
+   loadout_cache_tick = loadout_cache_tick+1
+   entry.tick = loadout_cache_tick
+   loadout_cache[key] = entry
+   loadout_cache_n = loadout_cache_n + 1
+end
+
+-- Gets the key of a loadout in the cache, or nil if it can't be cached
+local function loadout_key( p, cores, outfit_list, params )
+   local _nebu_dens, nebu_vol = system.cur():nebula()
+   local out = { p:ship():nameRaw(), p:faction():nameRaw(), tostring(nebu_vol) }
+   if not loadout_serialize( cores or {}, out ) or
+         not loadout_serialize( outfit_list, out ) or
+         not loadout_serialize( params, out ) then
+      return nil
+   end
+   return table.concat( out, "|" )
+end
+
+-- Tries to equip a cached loadout, returns true on success
+local function loadout_apply( p, entry )
+   -- Collect the solution that was being solved in the background
+   if entry.pending then
+      entry.pending = false
+      local z, x = entry.lp:solve_wait()
+      if z then
+         local variant = {}
+         for c,col in ipairs(entry.cols) do
+            if x[c] == 1 then
+               table.insert( variant, col.outfit )
+            end
+         end
+         table.insert( entry.variants, { outfits=variant } )
+      end
+   end
+
+   -- Solve another variant in the background if there is room
+   if not entry.lp then
+      -- Nothing to do
+   elseif #entry.variants < LOADOUT_VARIANTS then
+      for c,col in ipairs(entry.cols) do
+         local objf = (1+entry.rnd*rnd.sigma()) * col.objf
+         entry.lp:set_col( c, col.name, objf, "binary" )
+      end
+      entry.lp:solve_start( optimize.sparams )
+      entry.pending = true
+   else
+      entry.lp = nil
+      entry.cols = nil
+   end
+
+   while #entry.variants > 0 do
+      local i = rnd.rnd( 1, #entry.variants )
+      local v = entry.variants[i]
+      local ok = true
+      for k,o in ipairs(v.outfits) do
+         if p:outfitAdd( o, 1, true ) < 1 then
+            ok = false
+            break
+         end
+      end
+      -- Background solutions didn't get their energy checked yet
+      if ok and not v.verified then
+         ok = (p:stats().energy_regen >= entry.energygoal)
+         v.verified = ok
+      end
+      if ok then
+         return true
+      end
+      p:outfitRm( "all" )
+      table.remove( entry.variants, i )
+   end
+   return false
+end
+
 --[[
       Goodness functions to rank how good each outfits are
 --]]
@@ -276,6 +443,16 @@ function optimize.optimize( p, cores, outfit_list, params )
       bioship.simulate( p, rnd.rnd(1,stage) )
    end
 
+   -- Bioships and pilots that keep their outfits depend on more than the
+   -- parameters, so they always get solved
+   local cachekey
+   if not pt.bioship and not params.noremove then
+      if params.max_mass then
+         params.max_mass = math.floor( params.max_mass / LOADOUT_MASS_STEP + 0.5 ) * LOADOUT_MASS_STEP
+      end
+      cachekey = loadout_key( p, cores, outfit_list, params )
+   end
+
    -- Handle cores
    if cores and not pt.nocores then
       -- Don't actually have to remove cores as it should overwrite default
@@ -290,6 +467,21 @@ function optimize.optimize( p, cores, outfit_list, params )
       end
    end
 
+   -- Use a previous solution if possible
+   local cached = cachekey and loadout_get( cachekey )
+   if cached and loadout_apply( p, cached ) then
+      p:fillAmmo()
+      ai_setup.setup(p)
+      if __debugging then
+         local b, s = p:spaceworthy()
+         if not b then
+            warn(string.format(_("Pilot '%s' is not space worthy after equip script is run! Reason: %s"),p:name(),s))
+            return false
+         end
+      end
+      return true
+   end
+
    -- Global ship stuff
    local ss = p:shipstat( nil, true ) -- Should include cores!!
    local st = p:stats() -- also include cores
@@ -590,6 +782,7 @@ function optimize.optimize( p, cores, outfit_list, params )
    end
    -- Add outfit checks
    local c = 1
+   local cols = {}
    for i,s in ipairs(slots) do
       for j,o in ipairs(s.outfits) do
          local stats = outfit_cache[o]
@@ -597,6 +790,7 @@ function optimize.optimize( p, cores, outfit_list, params )
          local slotmod = ((slots.size==stats.size) and 1) or params.mismatch
          local objf = (1+params.rnd*rnd.sigma()) * stats.goodness * slotmod -- contribution to objective function
          lp:set_col( c, name, objf, "binary" ) -- constraints set automatically
+         cols[c] = { name=name, outfit=o, objf=stats.goodness * slotmod }
          -- CPU constraint
          table.insert( ia, 1 )
          table.insert( ja, c )
@@ -744,9 +938,11 @@ function optimize.optimize( p, cores, outfit_list, params )
 
       -- Interpret results
       c = 1
+      local variant = {}
       for i,s in ipairs(slots) do
          for j,o in ipairs(s.outfits) do
             if x[c] == 1 then
+               table.insert( variant, o )
                local q = p:outfitAdd( o, 1, true )
                if q < 1 then
                   warn(string.format(_("Unable to equip outfit '%s' on '%s'!"), o,  p:name()))
@@ -765,6 +961,19 @@ function optimize.optimize( p, cores, outfit_list, params )
          --print(string.format("Pilot %s: optimization attempt %d of %d: emod=%.3f", p:name(), try, 3, emod ))
          lp:set_row( 2, "energy_regen", nil, st.energy_regen - emod*energygoal )
          done = false
+      elseif cachekey then
+         -- Remember the solution, the linear program is kept around to solve
+         -- more variants unless there is no randomness
+         local entry = {
+            variants = { { outfits=variant, verified=true } },
+            energygoal = energygoal,
+            rnd = params.rnd or 0,
+         }
+         if params.rnd and params.rnd > 0 then
+            entry.lp = lp
+            entry.cols = cols
+         end
+         loadout_set( cachekey, entry )
       end
    until done or try >= 5 -- attempts should be fairly fast since we just do optimization step
    if not done then
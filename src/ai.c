@@ -1526,56 +1526,77 @@ static int aiL_getnearestpilot( lua_State *L )
 }
 
 /**
- * @brief Gets the distance from the pointer.
+ * @brief Gets a position parameter without creating a new vector.
  *
- *    @luatparam Vec2|Pilot pointer
- *    @luatreturn number The distance from the pointer.
- *    @luafunc dist
+ * The position can be either a vector, a pilot or a pair of numbers, the
+ * latter allowing scripts to avoid creating vectors altogether.
+ *
+ *    @param L Lua state.
+ *    @param ind Index of the parameter.
+ *    @param[out] v Position.
  */
-static int aiL_getdistance( lua_State *L )
+static void ai_checkpos( lua_State *L, int ind, vec2 *v )
 {
-   const vec2 *v;
-
    /* vector as a parameter */
-   if ( lua_isvector( L, 1 ) )
-      v = lua_tovector( L, 1 );
+   if ( lua_isvector( L, ind ) )
+      *v = *lua_tovector( L, ind );
    /* pilot as parameter */
-   else if ( lua_ispilot( L, 1 ) ) {
-      const Pilot *p = luaL_validpilot( L, 1 );
-      v              = &p->solid.pos;
+   else if ( lua_ispilot( L, ind ) ) {
+      const Pilot *p = luaL_validpilot( L, ind );
+      *v             = p->solid.pos;
    }
+   /* coordinates as parameters */
+   else if ( lua_isnumber( L, ind ) )
+      vec2_cset( v, lua_tonumber( L, ind ), luaL_checknumber( L, ind + 1 ) );
    /* wrong parameter */
    else
-      NLUA_INVALID_PARAMETER( L, 1 );
+      NLUA_INVALID_PARAMETER_NORET( L, ind );
+}
 
-   lua_pushnumber( L, vec2_dist( v, &cur_pilot->solid.pos ) );
-   return 1;
+/**
+ * @brief Gets the distance from the pointer.
+ *
+ * Also returns the offset to the pointer so scripts don't have to create
+ * vectors to compute it.
+ *
+ * @usage d = ai.dist( target )
+ * @usage d, dx, dy = ai.dist( x, y )
+ *
+ *    @luatparam Vec2|Pilot|number pointer Pointer or x coordinate.
+ *    @luatparam[opt] number y Y coordinate if pointer is a number.
+ *    @luatreturn number The distance from the pointer.
+ *    @luatreturn number X offset from the pilot to the pointer.
+ *    @luatreturn number Y offset from the pilot to the pointer.
+ *    @luafunc dist
+ */
+static int aiL_getdistance( lua_State *L )
+{
+   vec2   v;
+   double dx, dy;
+
+   ai_checkpos( L, 1, &v );
+   dx = v.x - cur_pilot->solid.pos.x;
+   dy = v.y - cur_pilot->solid.pos.y;
+
+   lua_pushnumber( L, hypot( dx, dy ) );
+   lua_pushnumber( L, dx );
+   lua_pushnumber( L, dy );
+   return 3;
 }
 
 /**
  * @brief Gets the squared distance from the pointer.
  *
- *    @luatparam Vec2|Pilot pointer
+ *    @luatparam Vec2|Pilot|number pointer Pointer or x coordinate.
+ *    @luatparam[opt] number y Y coordinate if pointer is a number.
  *    @luatreturn number The squared distance from the pointer.
  *    @luafunc dist2
  */
 static int aiL_getdistance2( lua_State *L )
 {
-   const vec2 *v;
-
-   /* vector as a parameter */
-   if ( lua_isvector( L, 1 ) )
-      v = lua_tovector( L, 1 );
-   /* pilot as parameter */
-   else if ( lua_ispilot( L, 1 ) ) {
-      const Pilot *p = luaL_validpilot( L, 1 );
-      v              = &p->solid.pos;
-   }
-   /* wrong parameter */
-   else
-      NLUA_INVALID_PARAMETER( L, 1 );
-
-   lua_pushnumber( L, vec2_dist2( v, &cur_pilot->solid.pos ) );
+   vec2 v;
+   ai_checkpos( L, 1, &v );
+   lua_pushnumber( L, vec2_dist2( &v, &cur_pilot->solid.pos ) );
    return 1;
 }
 
@@ -1583,31 +1604,20 @@ static int aiL_getdistance2( lua_State *L )
  * @brief Gets the distance from the pointer perpendicular to the current
  * pilot's flight vector.
  *
- *    @luatparam Vec2|Pilot pointer
+ *    @luatparam Vec2|Pilot|number pointer Pointer or x coordinate.
+ *    @luatparam[opt] number y Y coordinate if pointer is a number.
  *    @luatreturn number offset_distance
  *    @luafunc flyby_dist
  */
 static int aiL_getflybydistance( lua_State *L )
 {
-   const vec2 *v;
-   vec2        perp_motion_unit, offset_vect;
-   int         offset_distance;
+   vec2 v, perp_motion_unit, offset_vect;
+   int  offset_distance;
 
-   /* vector as a parameter */
-   if ( lua_isvector( L, 1 ) )
-      v = lua_tovector( L, 1 );
-   /* pilot id as parameter */
-   else if ( lua_ispilot( L, 1 ) ) {
-      const Pilot *p = luaL_validpilot( L, 1 );
-      v              = &p->solid.pos;
+   ai_checkpos( L, 1, &v );
 
-      /*vec2_cset(&v, VX(pilot->solid.pos) - VX(cur_pilot->solid.pos),
-       * VY(pilot->solid.pos) - VY(cur_pilot->solid.pos) );*/
-   } else
-      NLUA_INVALID_PARAMETER( L, 1 );
-
-   vec2_cset( &offset_vect, VX( *v ) - VX( cur_pilot->solid.pos ),
-              VY( *v ) - VY( cur_pilot->solid.pos ) );
+   vec2_cset( &offset_vect, VX( v ) - VX( cur_pilot->solid.pos ),
+              VY( v ) - VY( cur_pilot->solid.pos ) );
    vec2_pset( &perp_motion_unit, 1, VANGLE( cur_pilot->solid.vel ) + M_PI_2 );
    offset_distance = vec2_dot( &perp_motion_unit, &offset_vect );
 
@@ -2783,7 +2793,18 @@ static int aiL_hyperspaceAbort( lua_State *L )
 /**
  * @brief Gets the relative velocity of a pilot.
  *
- *    @luatreturn number Relative velocity.
+ * Besides the projection on the line of sight, it returns the components of
+ * the relative velocity so that scripts don't have to create vectors.
+ *
+ * @usage v = ai.relvel( target )
+ * @usage v, vx, vy = ai.relvel( target, true )
+ *
+ *    @luatparam Pilot p Pilot to get relative velocity of.
+ *    @luatparam[opt=false] boolean absolute Whether to use the absolute
+ * velocity of the pilot instead of the relative one.
+ *    @luatreturn number Relative velocity along the line of sight.
+ *    @luatreturn number X component of the (relative) velocity.
+ *    @luatreturn number Y component of the (relative) velocity.
  * @luafunc relvel
  */
 static int aiL_relvel( lua_State *L )
@@ -2811,7 +2832,9 @@ static int aiL_relvel( lua_State *L )
    mod = MAX( VMOD( pv ), 1. ); /* Avoid /0. */
 
    lua_pushnumber( L, dot / mod );
-   return 1;
+   lua_pushnumber( L, vv.x );
+   lua_pushnumber( L, vv.y );
+   return 3;
 }
 
 /**
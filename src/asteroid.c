@@ -49,6 +49,9 @@ const double DEBRIS_BUFFER =
 static const double SCAN_FADE =
    10.; /**< 1/time it takes to fade in/out scanning text. */
 
+static const double ASTEROID_QT_LOOSE =
+   1.; /**< Seconds of drift covered by the loose quadtree bounds. */
+
 static Debris *debris_stack =
    NULL; /**< All the debris in the current system (array.h). */
 static glTexture **debris_gfx = NULL; /**< Graphics to use for debris. */
@@ -74,6 +77,7 @@ static int astgroup_cmp( const void *p1, const void *p2 );
 static int astgroup_parse( AsteroidTypeGroup *ag, const char *file );
 static int asttype_load( void );
 
+static void asteroids_qtPlot( void );
 static int  asteroid_updateSingle( Asteroid *a );
 static void asteroid_renderSingle( const Asteroid *a );
 static void debris_renderSingle( const Debris *d, double cx, double cy );
@@ -195,6 +199,34 @@ static int asteroid_updateSingle( Asteroid *a )
    return 0;
 }
 
+/**
+ * @brief Plots the statistics of the asteroid quadtrees for the profiler.
+ */
+static void asteroids_qtPlot( void )
+{
+#if HAVE_TRACY
+   QtStats total;
+   memset( &total, 0, sizeof( QtStats ) );
+   for ( int i = 0; i < array_size( cur_system->asteroids ); i++ ) {
+      QtStats st;
+      qt_stats( &cur_system->asteroids[i].qt, &st );
+      total.nodes      += st.nodes;
+      total.queries    += st.queries;
+      total.candidates += st.candidates;
+      total.reinserts  += st.reinserts;
+
+      total.max_depth = MAX( total.max_depth, st.max_depth );
+   }
+   NTracingPlotI( "asteroid qt nodes", total.nodes );
+   NTracingPlotI( "asteroid qt depth", total.max_depth );
+   NTracingPlotI( "asteroid qt reinserts", total.reinserts );
+   NTracingPlotF( "asteroid qt candidates",
+                  ( total.queries > 0 )
+                     ? (double)total.candidates / total.queries
+                     : 0. );
+#endif /* HAVE_TRACY */
+}
+
 /**
  * @brief Controls fleet spawning.
  *
@@ -235,24 +267,29 @@ void asteroids_update( double dt )
          asteroid_updateSingle( a );
       }
 
-      /* Do quadtree stuff. Can't be threaded. */
-      qt_clear( &ast->qt );
+      /* Do quadtree stuff. Can't be threaded. Asteroids keep their elements
+       * and the ones that left the foreground get swept. */
       for ( int j = 0; j < array_size( ast->asteroids ); j++ ) {
-         const Asteroid *a = &ast->asteroids[j];
+         Asteroid *a = &ast->asteroids[j];
          /* Add to quadtree if in foreground. */
          if ( a->state == ASTEROID_FG ) {
-            int x, y, w2, h2, px, py;
+            int x, y, w2, h2, px, py, m;
             x  = round( a->sol.pos.x );
             y  = round( a->sol.pos.y );
             px = round( a->sol.pre.x );
             py = round( a->sol.pre.y );
             w2 = ceil( a->gfx->sw * 0.5 );
             h2 = ceil( a->gfx->sh * 0.5 );
-            qt_insert( &ast->qt, j, MIN( x, px ) - w2, MIN( y, py ) - h2,
-                       MAX( x, px ) + w2, MAX( y, py ) + h2 );
+            m  = MAX( w2, h2 ) + ceil( VMOD( a->sol.vel ) * ASTEROID_QT_LOOSE );
+            a->qt_elem =
+               qt_update( &ast->qt, a->qt_elem, j, j, MIN( x, px ) - w2,
+                          MIN( y, py ) - h2, MAX( x, px ) + w2,
+                          MAX( y, py ) + h2, m );
          }
       }
+      qt_sweep( &ast->qt );
    }
+   asteroids_qtPlot();
 
    /* Only have to update stuff if not simulating. */
    if ( !space_isSimulation() ) {
@@ -342,7 +379,8 @@ void asteroids_init( void )
          if ( asteroid_init( &a, ast ) ) {
             continue;
          }
-         a.id = array_size( ast->asteroids );
+         a.id      = array_size( ast->asteroids );
+         a.qt_elem = -1;
          if ( r > 0.6 )
             a.state = ASTEROID_FG;
          else if ( r > 0.8 )
@@ -864,7 +902,7 @@ static int astgroup_parse( AsteroidTypeGroup *ag, const char *file )
 void asteroids_renderOverlay( void )
 {
    double cx, cy;
-   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &cx, &cy );
    cx -= SCREEN_W / 2.;
    cy -= SCREEN_H / 2.;
 
@@ -886,7 +924,7 @@ void asteroids_renderOverlay( void )
 void asteroids_render( void )
 {
    double cx, cy, z;
-   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &cx, &cy );
    z = cam_getZoom();
    cx -= SCREEN_W / 2.;
    cy -= SCREEN_H / 2.;
@@ -929,6 +967,7 @@ void asteroids_render( void )
 static void asteroid_renderSingle( const Asteroid *a )
 {
    double              nx, ny;
+   vec2                pos;
    const AsteroidType *at;
    glColour            col;
    double              progress;
@@ -967,15 +1006,15 @@ static void asteroid_renderSingle( const Asteroid *a )
    }
 
    at = a->type;
-   gl_renderSpriteRotate( a->gfx, a->sol.pos.x, a->sol.pos.y, a->ang, 0, 0,
-                          &col );
+   solid_renderPos( &pos, &a->sol, &a->sol.vel );
+   gl_renderSpriteRotate( a->gfx, pos.x, pos.y, a->ang, 0, 0, &col );
 
    /* Add the commodities if scanned. */
    if ( !a->scanned )
       return;
    col   = cFontWhite;
    col.a = a->scan_alpha;
-   gl_gameToScreenCoords( &nx, &ny, a->sol.pos.x, a->sol.pos.y );
+   gl_gameToScreenCoords( &nx, &ny, pos.x, pos.y );
    gl_printRaw( &gl_smallFont, nx + a->gfx->sw / 2, ny - gl_smallFont.h / 2,
                 &col, -1., _( at->scanned_msg ) );
    /*
@@ -1174,14 +1213,11 @@ void asteroid_explode( Asteroid *a, int max_rarity, double mining_bonus )
 {
    Damage                dmg;
    char                  buf[16];
-   double                rad2;
-   LuaAsteroid_t         la;
-   const AsteroidType   *at          = a->type;
-   const AsteroidAnchor *field       = &cur_system->asteroids[a->parent];
-   Pilot *const         *pilot_stack = pilot_getAll();
+   const AsteroidType   *at    = a->type;
+   const AsteroidAnchor *field = &cur_system->asteroids[a->parent];
 
    /* Manage the explosion */
-   dmg.type        = dtype_get( "explosion_splash" );
+   dmg.type        = expl_dtype();
    dmg.damage      = at->damage;
    dmg.penetration = at->penetration; /* Full penetration. */
    dmg.disable     = 0.;
@@ -1194,19 +1230,7 @@ void asteroid_explode( Asteroid *a, int max_rarity, double mining_bonus )
                   a->sol.vel.y );
 
    /* Alert nearby pilots. */
-   rad2      = pow2( at->alert_range );
-   la.parent = a->parent;
-   la.id     = a->id;
-   lua_pushasteroid( naevL, la );
-   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      Pilot *p = pilot_stack[i];
-
-      if ( vec2_dist2( &p->solid.pos, &a->sol.pos ) > rad2 )
-         continue;
-
-      pilot_msg( NULL, p, "asteroid", -1 );
-   }
-   lua_pop( naevL, 1 );
+   expl_alertAsteroid( &a->sol.pos, at->alert_range, a->parent, a->id );
 
    /* Release commodity rewards. */
    if ( max_rarity >= 0 ) {
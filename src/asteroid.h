@@ -101,6 +101,8 @@ typedef struct Asteroid_ {
    double timer_max;  /**< Internal timer initial value. */
    double scan_alpha; /**< Alpha value for scanning stuff. */
    int    scanned;    /**< Wether the player already scanned this asteroid. */
+   /* Collisions. */
+   int qt_elem; /**< Element of the asteroid in the anchor quadtree. */
 } Asteroid;
 
 /**
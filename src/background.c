@@ -157,7 +157,7 @@ void background_renderDust( const double dt )
 {
    (void)dt;
    GLfloat h, w, m;
-   double  z, angle;
+   double  z, angle, cx, cy, rx, ry;
    mat4    projection;
    int     points = 1;
 
@@ -201,10 +201,14 @@ void background_renderDust( const double dt )
    h = ( SCREEN_H + 2. * STAR_BUF );
    h += ( h / conf.zoom_far - 1. );
 
+   /* The dust moves against the camera, so follow where it is rendered. */
+   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &rx, &ry );
+
    /* Common shader stuff. */
    glUseProgram( shaders.dust.program );
    gl_uniformMat4( shaders.dust.projection, &projection );
-   glUniform2f( shaders.dust.offset_xy, dust_x, dust_y );
+   glUniform2f( shaders.dust.offset_xy, dust_x + cx - rx, dust_y + cy - ry );
    if ( points )
       glUniform3f( shaders.dust.dims, 2. / gl_screen.scale, 0., 0. );
    else
@@ -399,7 +403,7 @@ static void background_renderImages( background_image_t *bkg_arr )
       glColour            col;
       background_image_t *bkg = &bkg_arr[i];
 
-      cam_getPos( &cx, &cy );
+      cam_getRenderPos( &cx, &cy );
       gui_getOffset( &gx, &gy );
       m = bkg->move;
       z = bkg->scale;
@@ -125,6 +125,23 @@ void cam_getPos( double *x, double *y )
    *y = camera_Y;
 }
 
+/**
+ * @brief Gets the camera position things are rendered from.
+ *
+ * Rendering lags behind the simulation, so the camera is moved back along its
+ * velocity like the solids it follows.
+ *
+ *    @param[out] x X position to get.
+ *    @param[out] y Y position to get.
+ * @sa solid_renderPos
+ */
+void cam_getRenderPos( double *x, double *y )
+{
+   double lag = solid_getRenderLag();
+   *x         = camera_X - camera_VX * lag;
+   *y         = camera_Y - camera_VY * lag;
+}
+
 /**
  * @brief Gets the camera position differential (change in last frame).
  */
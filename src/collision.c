@@ -11,17 +11,46 @@
 #include "naev.h"
 
 #include "SDL.h"
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif /* defined( __SSE2__ ) */
 /** @endcond */
 
 #include "collision.h"
 
 #include "array.h"
+#include "conf.h"
 #include "log.h"
 #include "physics.h"
 
+#define COLL_EDGE_TOL                                                          \
+   1e-3 /**< Slack of the edge candidate tests, hits are confirmed after. */
+
+/**
+ * @brief A segment or circle tested against the edges of a polygon, in the
+ * unrotated frame of the polygon.
+ */
+typedef struct CollEdgeQuery_ {
+   float sx; /**< X of the start of the segment or center of the circle. */
+   float sy; /**< Y of the start of the segment or center of the circle. */
+   float dx; /**< X length of the segment. */
+   float dy; /**< Y length of the segment. */
+   float r;  /**< Radius of the circle, negative for segments. */
+} CollEdgeQuery;
+
 /*
  * Prototypes
  */
+static uint64_t CollMask( int n );
+static int      CollCtz( uint64_t bits );
+static void PolyToLocal( const CollPolyView *at, const vec2 *ap, double x,
+                         double y, float *lx, float *ly );
+static void PolyVertex( const CollPolyView *at, const vec2 *ap, int i,
+                        double *x, double *y );
+static void PolyEdge( const CollPolyView *at, const vec2 *ap, int i, vec2 *p1,
+                      vec2 *p2 );
+static unsigned int PolyEdgeCandidates( const CollPolyView *at, int i,
+                                        const CollEdgeQuery *q );
 static int PointInPolygon( const CollPolyView *at, const vec2 *ap, float x,
                            float y );
 static int LineOnPolygon( const CollPolyView *at, const vec2 *ap, float x1,
@@ -30,14 +59,23 @@ static int LineOnPolygon( const CollPolyView *at, const vec2 *ap, float x1,
 /**
  * @brief Loads a polygon from an xml node.
  *
+ * The points of all the views are packed into a single block. In low memory
+ * mode only the first view is kept and the others are rotations of it.
+ *
  *    @param[out] polygon Polygon.
  *    @param[in] base XML node to parse.
  */
 void poly_load( CollPoly *polygon, xmlNodePtr base )
 {
-   int n;
+   int     n, total, nviews;
+   float  *data;
+   float **px, **py;
+
    xmlr_attr_int_def( base, "num", n, 32 );
    polygon->views = array_create_size( CollPolyView, n );
+   polygon->data  = NULL;
+   px             = array_create_size( float *, n );
+   py             = array_create_size( float *, n );
 
    xmlNodePtr node = base->children;
    do {
@@ -45,10 +83,14 @@ void poly_load( CollPoly *polygon, xmlNodePtr base )
          continue;
 
       CollPolyView *view = &array_grow( &polygon->views );
-      view->x            = array_create_size( float, 32 );
+      float       **vx   = &array_grow( &px );
+      float       **vy   = &array_grow( &py );
+      *vx                = array_create_size( float, 32 );
+      *vy                = array_create_size( float, 32 );
+      view->ct           = 1.;
+      view->st           = 0.;
       view->xmin         = 0;
       view->xmax         = 0;
-      view->y            = array_create_size( float, 32 );
       view->ymin         = 0;
       view->ymax         = 0;
 
@@ -61,7 +103,7 @@ void poly_load( CollPoly *polygon, xmlNodePtr base )
             char *ch = SDL_strtokr( list, ",", &saveptr );
             while ( ch != NULL ) {
                float d = atof( ch );
-               array_push_back( &view->x, d );
+               array_push_back( vx, d );
                view->xmin = MIN( view->xmin, d );
                view->xmax = MAX( view->xmax, d );
                ch         = SDL_strtokr( NULL, ",", &saveptr );
@@ -74,7 +116,7 @@ void poly_load( CollPoly *polygon, xmlNodePtr base )
             char *ch = SDL_strtokr( list, ",", &saveptr );
             while ( ch != NULL ) {
                float d = atof( ch );
-               array_push_back( &view->y, d );
+               array_push_back( vy, d );
                view->ymin = MIN( view->ymin, d );
                view->ymax = MAX( view->ymax, d );
                ch         = SDL_strtokr( NULL, ",", &saveptr );
@@ -83,33 +125,100 @@ void poly_load( CollPoly *polygon, xmlNodePtr base )
          }
       } while ( xml_nextNode( cur ) );
 
-      view->npt = array_size( view->x );
-      if ( array_size( view->y ) != view->npt )
+      view->npt = array_size( *vx );
+      if ( array_size( *vy ) != view->npt ) {
          WARN( _( "Polygon with mismatch of number of |x|=%d and |y|=%d "
                   "coordinates detected!" ),
-               view->npt, array_size( view->y ) );
+               view->npt, array_size( *vy ) );
+         view->npt = MIN( view->npt, array_size( *vy ) );
+      }
    } while ( xml_nextNode( node ) );
 
    /* Compute useful offsets. */
    polygon->dir_inc = 2. * M_PI / array_size( polygon->views );
    polygon->dir_off = polygon->dir_inc * 0.5;
+
+   /* Pack the points, x of a view followed by its y. */
+   nviews = conf.low_memory ? MIN( 1, array_size( polygon->views ) )
+                            : array_size( polygon->views );
+   total  = 0;
+   for ( int i = 0; i < nviews; i++ )
+      total += 2 * polygon->views[i].npt;
+   data          = malloc( MAX( total, 1 ) * sizeof( float ) );
+   polygon->data = data;
+   for ( int i = 0; i < nviews; i++ ) {
+      CollPolyView *view = &polygon->views[i];
+      view->x            = data;
+      view->y            = data + view->npt;
+      memcpy( view->x, px[i], view->npt * sizeof( float ) );
+      memcpy( view->y, py[i], view->npt * sizeof( float ) );
+      data += 2 * view->npt;
+   }
+   for ( int i = 0; i < array_size( px ); i++ ) {
+      array_free( px[i] );
+      array_free( py[i] );
+   }
+   array_free( px );
+   array_free( py );
+
+   /* The other views are computed on the fly from the first. */
+   for ( int i = nviews; i < array_size( polygon->views ); i++ )
+      poly_rotate( &polygon->views[i], &polygon->views[0],
+                   i * polygon->dir_inc );
 }
 
+/**
+ * @brief Frees a polygon.
+ *
+ *    @param poly Polygon to free.
+ */
 void poly_free( CollPoly *poly )
 {
-   for ( int i = 0; i < array_size( poly->views ); i++ ) {
-      CollPolyView *view = &poly->views[i];
-      array_free( view->x );
-      array_free( view->y );
-   }
+   free( poly->data );
+   poly->data = NULL;
    array_free( poly->views );
+   poly->views = NULL;
+}
+
+/**
+ * @brief Gets a mask of the first n bits of a transparency row word.
+ *
+ *    @param n Number of pixels left in the row.
+ *    @return Mask with the lower MIN(n,64) bits set.
+ */
+static uint64_t CollMask( int n )
+{
+   if ( n >= 64 )
+      return UINT64_MAX;
+   return ( UINT64_C( 1 ) << n ) - 1;
+}
+
+/**
+ * @brief Gets the offset of the first non-transparent pixel in a row word.
+ *
+ *    @param bits Row word, must not be 0.
+ *    @return Index of the lowest set bit.
+ */
+static int CollCtz( uint64_t bits )
+{
+#if defined( __GNUC__ ) || defined( __clang__ )
+   return __builtin_ctzll( bits );
+#else  /* defined( __GNUC__ ) || defined( __clang__ ) */
+   int n = 0;
+   while ( !( bits & 1 ) ) {
+      bits >>= 1;
+      n++;
+   }
+   return n;
+#endif /* defined( __GNUC__ ) || defined( __clang__ ) */
 }
 
 /**
  * @brief Checks whether or not two sprites collide.
  *
- * This function does pixel perfect checks.  If the collision actually occurs,
- *  crash is set to store the real position of the collision.
+ * This function does pixel perfect checks 64 pixels at a time by ANDing the
+ *  rows of both transparency maps.  If the collision actually occurs, crash is
+ *  set to store the real position of the collision.
  *
  *    @param[in] at Texture a.
  *    @param[in] asx Position of x of sprite a.
@@ -180,17 +289,20 @@ int CollideSprite( const glTexture *at, const int asx, const int asy,
    bbx = bsx * (int)( bt->sw ) - bx1;
    bby = rbsy * (int)( bt->sh ) - by1;
 
-   for ( y = inter_y0; y <= inter_y1; y++ )
-      for ( x = inter_x0; x <= inter_x1; x++ )
-         /* compute offsets for surface before pass to TransparentPixel test */
-         if ( ( !gl_isTrans( at, abx + x, aby + y ) ) &&
-              ( !gl_isTrans( bt, bbx + x, bby + y ) ) ) {
-
+   for ( y = inter_y0; y <= inter_y1; y++ ) {
+      for ( x = inter_x0; x <= inter_x1; x += 64 ) {
+         /* Pixels that aren't transparent in either sprite. */
+         uint64_t bits = gl_transBits( at, abx + x, aby + y ) &
+                         gl_transBits( bt, bbx + x, bby + y ) &
+                         CollMask( inter_x1 - x + 1 );
+         if ( bits != 0 ) {
             /* Set the crash position. */
-            crash->x = x;
+            crash->x = x + CollCtz( bits );
             crash->y = y;
             return 1;
          }
+      }
+   }
 
    return 0;
 }
@@ -258,14 +370,18 @@ int CollideSpritePolygon( const CollPolyView *at, const vec2 *ap,
    bbx = bsx * (int)( bt->sw ) - bx1;
    bby = rbsy * (int)( bt->sh ) - by1;
    for ( y = inter_y0; y <= inter_y1; y++ ) {
-      for ( x = inter_x0; x <= inter_x1; x++ ) {
-         /* compute offsets for surface before pass to TransparentPixel test */
-         if ( ( !gl_isTrans( bt, bbx + x, bby + y ) ) ) {
-            if ( PointInPolygon( at, ap, (float)x, (float)y ) ) {
-               crash->x = x;
+      for ( x = inter_x0; x <= inter_x1; x += 64 ) {
+         uint64_t bits =
+            gl_transBits( bt, bbx + x, bby + y ) & CollMask( inter_x1 - x + 1 );
+         /* Only pixels that aren't transparent are tested on the polygon. */
+         while ( bits != 0 ) {
+            int px = x + CollCtz( bits );
+            if ( PointInPolygon( at, ap, (float)px, (float)y ) ) {
+               crash->x = px;
                crash->y = y;
                return 1;
             }
+            bits &= bits - 1;
          }
       }
    }
@@ -321,8 +437,9 @@ int CollidePolygon( const CollPolyView *at, const vec2 *ap,
    /* loop on the points of bt to see if one of them is in polygon at. */
    for ( int i = 0; i <= bt->npt - 1; i++ ) {
       float xabs, yabs;
-      xabs = bt->x[i] + VX( *bp );
-      yabs = bt->y[i] + VY( *bp );
+      poly_point( bt, i, &xabs, &yabs );
+      xabs += VX( *bp );
+      yabs += VY( *bp );
 
       if ( ( xabs < inter_x0 ) || ( xabs > inter_x1 ) || ( yabs < inter_y0 ) ||
            ( yabs > inter_y1 ) ) {
@@ -335,18 +452,16 @@ int CollidePolygon( const CollPolyView *at, const vec2 *ap,
    }
 
    /* loop on the lines of bt to see if one of them intersects a line of at. */
-   x1 = bt->x[0] + VX( *bp );
-   y1 = bt->y[0] + VY( *bp );
-   x2 = bt->x[bt->npt - 1] + VX( *bp );
-   y2 = bt->y[bt->npt - 1] + VY( *bp );
-   if ( LineOnPolygon( at, ap, x1, y1, x2, y2, crash ) )
+   poly_point( bt, 0, &x1, &y1 );
+   poly_point( bt, bt->npt - 1, &x2, &y2 );
+   if ( LineOnPolygon( at, ap, x1 + VX( *bp ), y1 + VY( *bp ), x2 + VX( *bp ),
+                       y2 + VY( *bp ), crash ) )
       return 1;
    for ( int i = 0; i <= bt->npt - 2; i++ ) {
-      x1 = bt->x[i] + VX( *bp );
-      y1 = bt->y[i] + VY( *bp );
-      x2 = bt->x[i + 1] + VX( *bp );
-      y2 = bt->y[i + 1] + VY( *bp );
-      if ( LineOnPolygon( at, ap, x1, y1, x2, y2, crash ) )
+      poly_point( bt, i, &x1, &y1 );
+      poly_point( bt, i + 1, &x2, &y2 );
+      if ( LineOnPolygon( at, ap, x1 + VX( *bp ), y1 + VY( *bp ),
+                          x2 + VX( *bp ), y2 + VY( *bp ), crash ) )
          return 1;
    }
 
@@ -356,6 +471,9 @@ int CollidePolygon( const CollPolyView *at, const vec2 *ap,
 /**
  * @brief Rotates a polygon.
  *
+ * The rotated polygon shares the points of the input polygon and only stores
+ * the rotation, so it must not outlive it and does not have to be freed.
+ *
  *    @param[out] rpolygon Rotated polygon.
  *    @param[in] ipolygon Imput polygon.
  *    @param[in] theta Rotation angle (radian).
@@ -365,27 +483,26 @@ void poly_rotate( CollPolyView *rpolygon, const CollPolyView *ipolygon,
 {
    float ct, st;
 
+   ct = cos( theta );
+   st = sin( theta );
+
    rpolygon->npt  = ipolygon->npt;
-   rpolygon->x    = malloc( ipolygon->npt * sizeof( float ) );
-   rpolygon->y    = malloc( ipolygon->npt * sizeof( float ) );
+   rpolygon->x    = ipolygon->x;
+   rpolygon->y    = ipolygon->y;
+   rpolygon->ct   = ipolygon->ct * ct - ipolygon->st * st;
+   rpolygon->st   = ipolygon->ct * st + ipolygon->st * ct;
    rpolygon->xmin = 0;
    rpolygon->xmax = 0;
    rpolygon->ymin = 0;
    rpolygon->ymax = 0;
 
-   ct = cos( theta );
-   st = sin( theta );
-
    for ( int i = 0; i <= rpolygon->npt - 1; i++ ) {
-      float d        = ipolygon->x[i] * ct - ipolygon->y[i] * st;
-      rpolygon->x[i] = d;
-      rpolygon->xmin = MIN( rpolygon->xmin, d );
-      rpolygon->xmax = MAX( rpolygon->xmax, d );
-
-      d              = ipolygon->x[i] * st + ipolygon->y[i] * ct;
-      rpolygon->y[i] = d;
-      rpolygon->ymin = MIN( rpolygon->ymin, d );
-      rpolygon->ymax = MAX( rpolygon->ymax, d );
+      float x, y;
+      poly_point( rpolygon, i, &x, &y );
+      rpolygon->xmin = MIN( rpolygon->xmin, x );
+      rpolygon->xmax = MAX( rpolygon->xmax, x );
+      rpolygon->ymin = MIN( rpolygon->ymin, y );
+      rpolygon->ymax = MAX( rpolygon->ymax, y );
    }
 }
 
@@ -406,9 +523,138 @@ const CollPolyView *poly_view( const CollPoly *poly, double dir )
    return &poly->views[s];
 }
 
+/**
+ * @brief Transforms a point in space to the unrotated frame of a polygon.
+ *
+ *    @param[in] at Polygon.
+ *    @param[in] ap Position in space of the polygon.
+ *    @param[in] x X coordinate of the point.
+ *    @param[in] y Y coordinate of the point.
+ *    @param[out] lx X coordinate in the frame of the polygon.
+ *    @param[out] ly Y coordinate in the frame of the polygon.
+ */
+static void PolyToLocal( const CollPolyView *at, const vec2 *ap, double x,
+                         double y, float *lx, float *ly )
+{
+   float dx = x - ap->x;
+   float dy = y - ap->y;
+   *lx      = dx * at->ct + dy * at->st;
+   *ly      = dy * at->ct - dx * at->st;
+}
+
+/**
+ * @brief Gets a point of a polygon in space.
+ *
+ *    @param[in] at Polygon.
+ *    @param[in] ap Position in space of the polygon.
+ *    @param[in] i Index of the point.
+ *    @param[out] x X coordinate of the point.
+ *    @param[out] y Y coordinate of the point.
+ */
+static void PolyVertex( const CollPolyView *at, const vec2 *ap, int i,
+                        double *x, double *y )
+{
+   float px, py;
+   poly_point( at, i, &px, &py );
+   *x = (double)px + ap->x;
+   *y = (double)py + ap->y;
+}
+
+/**
+ * @brief Gets an edge of a polygon in space.
+ *
+ * Edge i goes from point i to point i+1, the last edge closes the polygon.
+ *
+ *    @param[in] at Polygon.
+ *    @param[in] ap Position in space of the polygon.
+ *    @param[in] i Index of the edge.
+ *    @param[out] p1 Start of the edge.
+ *    @param[out] p2 End of the edge.
+ */
+static void PolyEdge( const CollPolyView *at, const vec2 *ap, int i, vec2 *p1,
+                      vec2 *p2 )
+{
+   PolyVertex( at, ap, i, &p1->x, &p1->y );
+   PolyVertex( at, ap, ( i + 1 ) % at->npt, &p2->x, &p2->y );
+}
+
+/**
+ * @brief Gets the edges of a polygon that may touch a segment or circle.
+ *
+ * Looks at edges i to i+3 that don't close the polygon and returns a bit for
+ * each one that may touch. The test is conservative and hits have to be
+ * confirmed, parallel edges are always returned.
+ *
+ *    @param[in] at Polygon.
+ *    @param[in] i First edge to test.
+ *    @param[in] q Segment or circle to test.
+ *    @return Bit mask of the edges starting at i that may touch.
+ */
+static unsigned int PolyEdgeCandidates( const CollPolyView *at, int i,
+                                        const CollEdgeQuery *q )
+{
+   int n = MIN( 4, at->npt - 1 - i );
+   if ( n < 4 )
+      return ( 1U << n ) - 1;
+#if defined( __SSE2__ )
+   const __m128 sign = _mm_set1_ps( -0.f );
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 tol  = _mm_set1_ps( COLL_EDGE_TOL );
+   __m128       x1   = _mm_loadu_ps( &at->x[i] );
+   __m128       y1   = _mm_loadu_ps( &at->y[i] );
+   __m128       ex   = _mm_sub_ps( _mm_loadu_ps( &at->x[i + 1] ), x1 );
+   __m128       ey   = _mm_sub_ps( _mm_loadu_ps( &at->y[i + 1] ), y1 );
+   __m128       wx   = _mm_sub_ps( _mm_set1_ps( q->sx ), x1 );
+   __m128       wy   = _mm_sub_ps( _mm_set1_ps( q->sy ), y1 );
+   __m128       hit;
+
+   if ( q->r < 0. ) {
+      /* Segment, same terms as CollideLineLine() without the division. */
+      __m128 dx   = _mm_set1_ps( q->dx );
+      __m128 dy   = _mm_set1_ps( q->dy );
+      __m128 ua_t = _mm_sub_ps( _mm_mul_ps( ex, wy ), _mm_mul_ps( ey, wx ) );
+      __m128 ub_t = _mm_sub_ps( _mm_mul_ps( dx, wy ), _mm_mul_ps( dy, wx ) );
+      __m128 u_b  = _mm_sub_ps( _mm_mul_ps( ey, dx ), _mm_mul_ps( ex, dy ) );
+      __m128 neg  = _mm_and_ps( u_b, sign );
+      __m128 den  = _mm_andnot_ps( sign, u_b );
+      __m128 lo   = _mm_sub_ps( zero, _mm_mul_ps( tol, den ) );
+      __m128 hi   = _mm_add_ps( den, _mm_mul_ps( tol, den ) );
+      __m128 len =
+         _mm_mul_ps( _mm_add_ps( _mm_andnot_ps( sign, ex ),
+                                 _mm_andnot_ps( sign, ey ) ),
+                     _mm_set1_ps( FABS( q->dx ) + FABS( q->dy ) ) );
+      ua_t = _mm_xor_ps( ua_t, neg );
+      ub_t = _mm_xor_ps( ub_t, neg );
+      hit  = _mm_and_ps(
+         _mm_and_ps( _mm_cmpge_ps( ua_t, lo ), _mm_cmple_ps( ua_t, hi ) ),
+         _mm_and_ps( _mm_cmpge_ps( ub_t, lo ), _mm_cmple_ps( ub_t, hi ) ) );
+      hit = _mm_or_ps( hit, _mm_cmple_ps( den, _mm_mul_ps( tol, len ) ) );
+   } else {
+      /* Circle, distance from the center to the edge. */
+      __m128 r    = _mm_set1_ps( q->r * ( 1. + COLL_EDGE_TOL ) + 1. );
+      __m128 len2 = _mm_add_ps( _mm_mul_ps( ex, ex ), _mm_mul_ps( ey, ey ) );
+      __m128 t    = _mm_div_ps(
+         _mm_add_ps( _mm_mul_ps( wx, ex ), _mm_mul_ps( wy, ey ) ),
+         _mm_max_ps( len2, _mm_set1_ps( 1e-12 ) ) );
+      t         = _mm_min_ps( _mm_max_ps( t, zero ), _mm_set1_ps( 1. ) );
+      __m128 cx = _mm_sub_ps( wx, _mm_mul_ps( t, ex ) );
+      __m128 cy = _mm_sub_ps( wy, _mm_mul_ps( t, ey ) );
+      __m128 d2 = _mm_add_ps( _mm_mul_ps( cx, cx ), _mm_mul_ps( cy, cy ) );
+      hit       = _mm_cmple_ps( d2, _mm_mul_ps( r, r ) );
+   }
+   return _mm_movemask_ps( hit );
+#else  /* defined( __SSE2__ ) */
+   (void)q;
+   return ( 1U << n ) - 1;
+#endif /* defined( __SSE2__ ) */
+}
+
 /**
  * @brief Checks whether or not a point is inside a polygon.
  *
+ * Counts the edges crossed by a ray going from the point towards +x in the
+ * unrotated frame of the polygon, four edges at a time when possible.
+ *
  *    @param[in] at Polygon a.
  *    @param[in] ap Position in space of polygon a.
  *    @param[in] x Coordiante of point.
@@ -418,35 +664,57 @@ const CollPolyView *poly_view( const CollPoly *poly, double dir )
 static int PointInPolygon( const CollPolyView *at, const vec2 *ap, float x,
                            float y )
 {
-   float vprod, sprod, angle;
-   float dxi, dxip, dyi, dyip;
-
-   /* See if the pixel is inside the polygon:
-      We increment the angle when doing a loop along all the points
-      If the final angle is 0, we are outside the polygon
-      Otherwise, the angle should be +/- 2pi*/
-   angle = 0.0;
-   for ( int i = 0; i <= at->npt - 2; i++ ) {
-      dxi   = at->x[i] + VX( *ap ) - x;
-      dxip  = at->x[i + 1] + VX( *ap ) - x;
-      dyi   = at->y[i] + VY( *ap ) - y;
-      dyip  = at->y[i + 1] + VY( *ap ) - y;
-      sprod = dxi * dxip + dyi * dyip;
-      vprod = dxi * dyip - dyi * dxip;
-      angle += atan2( vprod, sprod );
-   }
-   dxi   = at->x[at->npt - 1] + VX( *ap ) - x;
-   dxip  = at->x[0] + VX( *ap ) - x;
-   dyi   = at->y[at->npt - 1] + VY( *ap ) - y;
-   dyip  = at->y[0] + VY( *ap ) - y;
-   sprod = dxi * dxip + dyi * dyip;
-   vprod = dxi * dyip - dyi * dxip;
-   angle += atan2( vprod, sprod );
-
-   if ( FABS( angle ) < DOUBLE_TOL )
+   float        px, py;
+   unsigned int inside = 0;
+   int          i      = 0;
+   int          n      = at->npt;
+
+   if ( n < 3 )
       return 0;
+   PolyToLocal( at, ap, x, y, &px, &py );
+
+#if defined( __SSE2__ )
+   const __m128 vx = _mm_set1_ps( px );
+   const __m128 vy = _mm_set1_ps( py );
+   for ( ; i + 4 < n; i += 4 ) {
+      __m128 x1 = _mm_loadu_ps( &at->x[i] );
+      __m128 y1 = _mm_loadu_ps( &at->y[i] );
+      __m128 x2 = _mm_loadu_ps( &at->x[i + 1] );
+      __m128 y2 = _mm_loadu_ps( &at->y[i + 1] );
+      __m128 ey = _mm_sub_ps( y2, y1 );
+      /* Edges going across the ray. */
+      __m128 across =
+         _mm_xor_ps( _mm_cmpgt_ps( y1, vy ), _mm_cmpgt_ps( y2, vy ) );
+      /* Crossing is on the right of the point, without dividing by ey. */
+      __m128 lhs   = _mm_mul_ps( _mm_sub_ps( vx, x1 ), ey );
+      __m128 rhs   = _mm_mul_ps( _mm_sub_ps( vy, y1 ), _mm_sub_ps( x2, x1 ) );
+      __m128 up    = _mm_cmpgt_ps( ey, _mm_setzero_ps() );
+      __m128 right = _mm_or_ps( _mm_and_ps( up, _mm_cmplt_ps( lhs, rhs ) ),
+                                _mm_andnot_ps( up, _mm_cmpgt_ps( lhs, rhs ) ) );
+      unsigned int m = _mm_movemask_ps( _mm_and_ps( across, right ) );
+      m ^= m >> 2;
+      m ^= m >> 1;
+      inside ^= m & 1;
+   }
+#endif /* defined( __SSE2__ ) */
+
+   for ( ; i < n; i++ ) {
+      int   j  = ( i + 1 ) % n;
+      float x1 = at->x[i];
+      float y1 = at->y[i];
+      float x2 = at->x[j];
+      float y2 = at->y[j];
+      float ey = y2 - y1;
+      if ( ( y1 > py ) == ( y2 > py ) )
+         continue;
+      if ( ey > 0. ) {
+         if ( ( px - x1 ) * ey < ( py - y1 ) * ( x2 - x1 ) )
+            inside ^= 1;
+      } else if ( ( px - x1 ) * ey > ( py - y1 ) * ( x2 - x1 ) )
+         inside ^= 1;
+   }
 
-   return 1;
+   return inside;
 }
 
 /**
@@ -464,23 +732,29 @@ static int PointInPolygon( const CollPolyView *at, const vec2 *ap, float x,
 static int LineOnPolygon( const CollPolyView *at, const vec2 *ap, float x1,
                           float y1, float x2, float y2, vec2 *crash )
 {
-   float xi, xip, yi, yip;
+   CollEdgeQuery q;
+   float         lx, ly;
+   vec2          p1, p2;
 
    /* In this function, we are only looking for one collision point. */
-
-   xi  = at->x[at->npt - 1] + ap->x;
-   xip = at->x[0] + ap->x;
-   yi  = at->y[at->npt - 1] + ap->y;
-   yip = at->y[0] + ap->y;
-   if ( CollideLineLine( x1, y1, x2, y2, xi, yi, xip, yip, crash ) == 1 )
+   PolyEdge( at, ap, at->npt - 1, &p1, &p2 );
+   if ( CollideLineLine( x1, y1, x2, y2, p1.x, p1.y, p2.x, p2.y, crash ) == 1 )
       return 1;
-   for ( int i = 0; i <= at->npt - 2; i++ ) {
-      xi  = at->x[i] + ap->x;
-      xip = at->x[i + 1] + ap->x;
-      yi  = at->y[i] + ap->y;
-      yip = at->y[i + 1] + ap->y;
-      if ( CollideLineLine( x1, y1, x2, y2, xi, yi, xip, yip, crash ) == 1 )
-         return 1;
+
+   PolyToLocal( at, ap, x1, y1, &q.sx, &q.sy );
+   PolyToLocal( at, ap, x2, y2, &lx, &ly );
+   q.dx = lx - q.sx;
+   q.dy = ly - q.sy;
+   q.r  = -1.;
+   for ( int i = 0; i <= at->npt - 2; i += 4 ) {
+      unsigned int mask = PolyEdgeCandidates( at, i, &q );
+      while ( mask != 0 ) {
+         PolyEdge( at, ap, i + CollCtz( mask ), &p1, &p2 );
+         if ( CollideLineLine( x1, y1, x2, y2, p1.x, p1.y, p2.x, p2.y,
+                               crash ) == 1 )
+            return 1;
+         mask &= mask - 1;
+      }
    }
 
    return 0;
@@ -707,10 +981,12 @@ int CollideLineSprite( const vec2 *ap, double ad, double al,
 int CollideLinePolygon( const vec2 *ap, double ad, double al,
                         const CollPolyView *bt, const vec2 *bp, vec2 crash[2] )
 {
-   double ep[2];
-   double xi, yi, xip, yip;
-   int    real_hits;
-   vec2   tmp_crash;
+   double        ep[2];
+   vec2          p1, p2;
+   int           real_hits;
+   vec2          tmp_crash;
+   CollEdgeQuery q;
+   float         lx, ly;
 
    /* Set up end point of line. */
    ep[0] = ap->x + al * cos( ad );
@@ -780,11 +1056,8 @@ int CollideLinePolygon( const vec2 *ap, double ad, double al,
    /*
     * Now we check any line of the polygon
     */
-   xi  = (double)bt->x[bt->npt - 1] + bp->x;
-   xip = (double)bt->x[0] + bp->x;
-   yi  = (double)bt->y[bt->npt - 1] + bp->y;
-   yip = (double)bt->y[0] + bp->y;
-   if ( CollideLineLine( ap->x, ap->y, ep[0], ep[1], xi, yi, xip, yip,
+   PolyEdge( bt, bp, bt->npt - 1, &p1, &p2 );
+   if ( CollideLineLine( ap->x, ap->y, ep[0], ep[1], p1.x, p1.y, p2.x, p2.y,
                          &tmp_crash ) ) {
       crash[real_hits].x = tmp_crash.x;
       crash[real_hits].y = tmp_crash.y;
@@ -792,13 +1065,19 @@ int CollideLinePolygon( const vec2 *ap, double ad, double al,
       if ( real_hits == 2 )
          return 1;
    }
-   for ( int i = 0; i <= bt->npt - 2; i++ ) {
-      xi  = (double)bt->x[i] + bp->x;
-      xip = (double)bt->x[i + 1] + bp->x;
-      yi  = (double)bt->y[i] + bp->y;
-      yip = (double)bt->y[i + 1] + bp->y;
-      if ( CollideLineLine( ap->x, ap->y, ep[0], ep[1], xi, yi, xip, yip,
-                            &tmp_crash ) ) {
+   PolyToLocal( bt, bp, ap->x, ap->y, &q.sx, &q.sy );
+   PolyToLocal( bt, bp, ep[0], ep[1], &lx, &ly );
+   q.dx = lx - q.sx;
+   q.dy = ly - q.sy;
+   q.r  = -1.;
+   for ( int i = 0; i <= bt->npt - 2; i += 4 ) {
+      unsigned int mask = PolyEdgeCandidates( bt, i, &q );
+      while ( mask != 0 ) {
+         PolyEdge( bt, bp, i + CollCtz( mask ), &p1, &p2 );
+         mask &= mask - 1;
+         if ( !CollideLineLine( ap->x, ap->y, ep[0], ep[1], p1.x, p1.y, p2.x,
+                                p2.y, &tmp_crash ) )
+            continue;
          crash[real_hits].x = tmp_crash.x;
          crash[real_hits].y = tmp_crash.y;
          real_hits++;
@@ -840,9 +1119,10 @@ int CollideLinePolygon( const vec2 *ap, double ad, double al,
 int CollideCirclePolygon( const vec2 *ap, double ar, const CollPolyView *bt,
                           const vec2 *bp, vec2 crash[2] )
 {
-   vec2 p1, p2;
-   int  real_hits;
-   vec2 tmp_crash[2];
+   vec2          p1, p2;
+   int           real_hits;
+   vec2          tmp_crash[2];
+   CollEdgeQuery q;
 
    real_hits = 0;
    vectnull( &tmp_crash[0] );
@@ -863,10 +1143,7 @@ int CollideCirclePolygon( const vec2 *ap, double ar, const CollPolyView *bt,
    /*
     * Now we check any line of the polygon
     */
-   p1.x = (double)bt->x[bt->npt - 1] + bp->x;
-   p2.x = (double)bt->x[0] + bp->x;
-   p1.y = (double)bt->y[bt->npt - 1] + bp->y;
-   p2.y = (double)bt->y[0] + bp->y;
+   PolyEdge( bt, bp, bt->npt - 1, &p1, &p2 );
    if ( CollideLineCircle( &p1, &p2, ap, ar, tmp_crash ) ) {
       crash[real_hits].x = tmp_crash[0].x;
       crash[real_hits].y = tmp_crash[0].y;
@@ -874,12 +1151,17 @@ int CollideCirclePolygon( const vec2 *ap, double ar, const CollPolyView *bt,
       if ( real_hits == 2 )
          return 1;
    }
-   for ( int i = 0; i <= bt->npt - 2; i++ ) {
-      p1.x = (double)bt->x[i] + bp->x;
-      p2.x = (double)bt->x[i + 1] + bp->x;
-      p1.y = (double)bt->y[i] + bp->y;
-      p2.y = (double)bt->y[i + 1] + bp->y;
-      if ( CollideLineCircle( &p1, &p2, ap, ar, tmp_crash ) ) {
+   PolyToLocal( bt, bp, ap->x, ap->y, &q.sx, &q.sy );
+   q.dx = 0.;
+   q.dy = 0.;
+   q.r  = ar;
+   for ( int i = 0; i <= bt->npt - 2; i += 4 ) {
+      unsigned int mask = PolyEdgeCandidates( bt, i, &q );
+      while ( mask != 0 ) {
+         PolyEdge( bt, bp, i + CollCtz( mask ), &p1, &p2 );
+         mask &= mask - 1;
+         if ( !CollideLineCircle( &p1, &p2, ap, ar, tmp_crash ) )
+            continue;
          crash[real_hits].x = tmp_crash[0].x;
          crash[real_hits].y = tmp_crash[0].y;
          real_hits++;
@@ -968,14 +1250,27 @@ int CollideCircleSprite( const vec2 *ap, double ar, const glTexture *bt,
    bbx = bsx * (int)( bt->sw ) - bx1;
    bby = rbsy * (int)( bt->sh ) - by1;
    for ( int y = inter_y0; y <= inter_y1; y++ ) {
-      for ( int x = inter_x0; x <= inter_x1; x++ ) {
-         /* compute offsets for surface before pass to TransparentPixel test */
-         if ( ( !gl_isTrans( bt, bbx + x, bby + y ) ) ) {
-            if ( pow2( x - acx ) + pow2( y - acy ) <= r * r ) {
-               crash->x = x;
-               crash->y = y;
-               return 1;
-            }
+      int dx, x0, x1;
+      int dy2 = r * r - pow2( y - acy );
+      if ( dy2 < 0 )
+         continue;
+
+      /* Span of the circle on this row, so it can be tested as a mask. */
+      dx = (int)sqrt( dy2 );
+      while ( pow2( dx + 1 ) <= dy2 )
+         dx++;
+      while ( pow2( dx ) > dy2 )
+         dx--;
+      x0 = MAX( inter_x0, acx - dx );
+      x1 = MIN( inter_x1, acx + dx );
+
+      for ( int x = x0; x <= x1; x += 64 ) {
+         uint64_t bits =
+            gl_transBits( bt, bbx + x, bby + y ) & CollMask( x1 - x + 1 );
+         if ( bits != 0 ) {
+            crash->x = x + CollCtz( bits );
+            crash->y = y;
+            return 1;
          }
       }
    }
@@ -9,10 +9,15 @@
 
 /**
  * @brief Represents a polygon used for collision detection.
+ *
+ * The points are stored unrotated and the view rotation has to be applied to
+ * them, see poly_point(). Views loaded from data have no rotation.
  */
 typedef struct CollPolyView_ {
    float *x;    /**< List of X coordinates of the points. */
    float *y;    /**< List of Y coordinates of the points. */
+   float  ct;   /**< Cosine of the rotation of the points. */
+   float  st;   /**< Sine of the rotation of the points. */
    float  xmin; /**< Min of x. */
    float  xmax; /**< Max of x. */
    float  ymin; /**< Min of y. */
@@ -20,12 +25,35 @@ typedef struct CollPolyView_ {
    int    npt;  /**< Nb of points in the polygon. */
 } CollPolyView;
 
+/**
+ * @brief A collision polygon with a view for each direction.
+ *
+ * The points of all the views are in a single block, with the x coordinates
+ * of a view followed by its y coordinates. In low memory mode only the first
+ * view has points, and the others are rotations of it.
+ */
 typedef struct CollPoly_ {
-   CollPolyView *views;
-   double        dir_inc;
-   double        dir_off;
+   CollPolyView *views;   /**< Views for each direction (array.h). */
+   float        *data;    /**< Points of all the views. */
+   double        dir_inc; /**< Angle between views. */
+   double        dir_off; /**< Angle offset of the views. */
 } CollPoly;
 
+/**
+ * @brief Gets a point of a polygon view with the rotation applied.
+ *
+ *    @param v View to get point of.
+ *    @param i Index of the point.
+ *    @param[out] x X coordinate of the point.
+ *    @param[out] y Y coordinate of the point.
+ */
+static inline void poly_point( const CollPolyView *v, int i, float *x,
+                               float *y )
+{
+   *x = v->x[i] * v->ct - v->y[i] * v->st;
+   *y = v->x[i] * v->st + v->y[i] * v->ct;
+}
+
 /* Loads a polygon data from xml. */
 void poly_load( CollPoly *polygon, xmlNodePtr node );
 void poly_free( CollPoly *polygon );
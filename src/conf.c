@@ -21,6 +21,7 @@
 #include "nfile.h"
 #include "nlua.h"
 #include "nstring.h"
+#include "rng.h"
 #include "sound.h"
 #include "space.h"
 #include "utf8.h"
@@ -108,6 +109,7 @@ static void print_usage( void )
    LOG( _( "   -d, --datapath        adds a new datapath to be mounted (i.e., "
            "appends it to the search path for game assets)" ) );
    LOG( _( "   -X, --scale           defines the scale factor" ) );
+   LOG( _( "   -R n, --seed n        sets the random seed to n" ) );
    LOG(
       _( "   --devmode             enables dev mode perks like the editors" ) );
    LOG( _( "   -h, --help            display this message and exit" ) );
@@ -181,14 +183,16 @@ void conf_setDefaults( void )
  */
 void conf_setGameplayDefaults( void )
 {
-   conf.difficulty        = DIFFICULTY_DEFAULT;
-   conf.doubletap_sens    = DOUBLETAP_SENSITIVITY_DEFAULT;
-   conf.save_compress     = SAVE_COMPRESSION_DEFAULT;
-   conf.mouse_hide        = MOUSE_HIDE_DEFAULT;
-   conf.mouse_accel       = MOUSE_ACCEL_DEFAULT;
-   conf.mouse_doubleclick = MOUSE_DOUBLECLICK_TIME;
-   conf.mouse_fly         = MOUSE_FLY_DEFAULT;
-   conf.zoom_manual       = MANUAL_ZOOM_DEFAULT;
+   conf.difficulty         = DIFFICULTY_DEFAULT;
+   conf.doubletap_sens     = DOUBLETAP_SENSITIVITY_DEFAULT;
+   conf.save_compress      = SAVE_COMPRESSION_DEFAULT;
+   conf.mouse_hide         = MOUSE_HIDE_DEFAULT;
+   conf.mouse_accel        = MOUSE_ACCEL_DEFAULT;
+   conf.mouse_doubleclick  = MOUSE_DOUBLECLICK_TIME;
+   conf.mouse_fly          = MOUSE_FLY_DEFAULT;
+   conf.zoom_manual        = MANUAL_ZOOM_DEFAULT;
+   conf.collision_ccd      = COLLISION_CCD_DEFAULT;
+   conf.collision_ccd_step = COLLISION_CCD_STEP_DEFAULT;
 }
 
 /**
@@ -421,6 +425,8 @@ int conf_loadConfig( const char *file )
       conf_loadFloat( lEnv, "compression_mult", conf.compression_mult );
       conf_loadBool( lEnv, "redirect_file", conf.redirect_file );
       conf_loadBool( lEnv, "save_compress", conf.save_compress );
+      conf_loadBool( lEnv, "collision_ccd", conf.collision_ccd );
+      conf_loadFloat( lEnv, "collision_ccd_step", conf.collision_ccd_step );
       conf_loadInt( lEnv, "doubletap_sensitivity", conf.doubletap_sens );
       conf_loadFloat( lEnv, "mouse_hide", conf.mouse_hide );
       conf_loadBool( lEnv, "mouse_fly", conf.mouse_fly );
@@ -592,6 +598,7 @@ void conf_parseCLI( int argc, char **argv )
       { "svol", required_argument, 0, 's' },
       { "scale", required_argument, 0, 'X' },
       { "devmode", no_argument, 0, 'D' },
+      { "seed", required_argument, 0, 'R' },
       { "help", no_argument, 0, 'h' },
       { "version", no_argument, 0, 'v' },
       { NULL, 0, 0, 0 } };
@@ -603,7 +610,7 @@ void conf_parseCLI( int argc, char **argv )
     * option.
     */
    optind = 0;
-   while ( ( c = getopt_long( argc, argv, "fF:Vd:j:J:W:H:MSm:s:X:Nhv",
+   while ( ( c = getopt_long( argc, argv, "fF:Vd:j:J:W:H:MSm:s:X:R:Nhv",
                               long_options, &option_index ) ) != -1 ) {
       switch ( c ) {
       case 'd':
@@ -655,6 +662,9 @@ void conf_parseCLI( int argc, char **argv )
          conf.devmode = 1;
          LOG( _( "Enabling developer mode." ) );
          break;
+      case 'R':
+         rng_setSeed( strtoull( optarg, NULL, 0 ) );
+         break;
 
       case 'v':
          /* by now it has already displayed the version */
@@ -1122,6 +1132,15 @@ int conf_saveConfig( const char *file )
    conf_saveBool( "save_compress", conf.save_compress );
    conf_saveEmptyLine();
 
+   conf_saveComment( _( "Tests projectiles along the path they travelled "
+                        "since the last update, so they can't go through "
+                        "ships between updates" ) );
+   conf_saveBool( "collision_ccd", conf.collision_ccd );
+   conf_saveComment( _( "Longest physics step (in seconds) when collision_ccd "
+                        "is on, larger steps make time compression cheaper" ) );
+   conf_saveFloat( "collision_ccd_step", conf.collision_ccd_step );
+   conf_saveEmptyLine();
+
    conf_saveComment( _( "Doubletap sensitivity (used for double tap accel for "
                         "afterburner or double tap reverse for cooldown)" ) );
    conf_saveInt( "doubletap_sensitivity", conf.doubletap_sens );
@@ -27,6 +27,10 @@
    0.5 /**< How long to consider double-clicks for. */
 #define MANUAL_ZOOM_DEFAULT                                                    \
    0 /**< Whether or not to enable manual zoom controls. */
+#define COLLISION_CCD_DEFAULT                                                  \
+   1 /**< Whether or not to sweep projectiles along their path. */
+#define COLLISION_CCD_STEP_DEFAULT                                             \
+   0.2 /**< Longest physics step (in seconds) when sweeping projectiles. */
 #define ZOOM_FAR_DEFAULT 0.5  /**< Far zoom distance (smaller is further) */
 #define ZOOM_NEAR_DEFAULT 1.0 /**< Close zoom distance (bigger is larger) */
 #define ZOOM_SPEED_DEFAULT                                                     \
@@ -181,6 +185,9 @@ typedef struct PlayerConf_s {
    double       compression_mult;     /**< Maximum time multiplier. */
    int          redirect_file;        /**< Redirect output to files. */
    int          save_compress;        /**< Compress saved game. */
+   int          collision_ccd;        /**< Sweep projectiles along path. */
+   double       collision_ccd_step;   /**< Longest physics step with
+                                         collision_ccd. */
    unsigned int doubletap_sens;       /**< Double tap key sensibility (used for
                                          afterburn and cooldown). */
    double mouse_hide;                 /**< Time to hide mouse. */
@@ -224,6 +224,7 @@ static void debug_sigHandler( int sig )
 
    debug_logBacktrace();
    LOGERR( _( "Report this to project maintainer with the backtrace." ) );
+   log_flush();
 
    /* Always exit. */
    exit( 1 );
@@ -13,11 +13,11 @@
 /** @cond */
 #include <stdio.h>
 
-#if HAVE_SUITESPARSE_CS_H
-#include <suitesparse/cs.h>
-#else /* HAVE_SUITESPARSE_CS_H */
-#include <cs.h>
-#endif /* HAVE_SUITESPARSE_CS_H */
+#if HAVE_SUITESPARSE_CHOLMOD_H
+#include <suitesparse/cholmod.h>
+#else /* HAVE_SUITESPARSE_CHOLMOD_H */
+#include <cholmod.h>
+#endif /* HAVE_SUITESPARSE_CHOLMOD_H */
 
 #include "naev.h"
 /** @endcond */
@@ -25,10 +25,12 @@
 #include "economy.h"
 
 #include "array.h"
+#include "faction.h"
 #include "log.h"
 #include "ndata.h"
 #include "ntime.h"
 #include "nxml.h"
+#include "rng.h"
 #include "space.h"
 
 /*
@@ -40,6 +42,10 @@
 #define ECON_PROD_MODIFIER                                                     \
    500000. /**< Production modifier, divide production by this amount. */
 #define ECON_PROD_VAR 0.01 /**< Defines the variability of production. */
+#define ECON_PRICE_MIN                                                         \
+   0.5 /**< Lowest modifier the solution can apply to a price. */
+#define ECON_PRICE_MAX                                                         \
+   1.5 /**< Highest modifier the solution can apply to a price. */
 
 /* systems stack. */
 extern StarSystem *systems_stack; /**< Star system stack. */
@@ -52,16 +58,50 @@ extern Commodity *commodity_stack;
  */
 static int econ_initialized = 0; /**< Is economy system initialized? */
 static int econ_queued      = 0; /**< Whether there are any queued updates. */
-static cs *econ_G           = NULL; /**< Admittance matrix. */
-int       *econ_comm        = NULL; /**< Commodities to calculate. */
+static int econ_Gdirty      = 1; /**< Whether the admittance matrix is stale. */
+static cholmod_common  econ_C; /**< CHOLMOD settings and workspace. */
+static cholmod_factor *econ_L =
+   NULL; /**< Cholesky factorisation of the admittance matrix. */
+static cholmod_dense *econ_B =
+   NULL; /**< Intensities, one column per commodity. */
+static cholmod_dense *econ_X = NULL; /**< Solution, one column per commodity. */
+static cholmod_dense *econ_Y = NULL; /**< Solver workspace. */
+static cholmod_dense *econ_E = NULL; /**< Solver workspace. */
+static double        *econ_prod  = NULL; /**< Production factor by spob id. */
+static int            econ_nprod = 0;    /**< Number of production factors. */
+static int           *econ_spobSys =
+   NULL; /**< System stack index by spob id, or -1. */
+static int       econ_nspobSys = 0; /**< Number of spobs in econ_spobSys. */
+static RngStream econ_rng; /**< Stream of the production changes, so they do
+                              not shift the gameplay random numbers. */
+int                  *econ_comm  = NULL; /**< Commodities to calculate. */
+
+/*
+ * Averages of seen prices over all spobs, by commodity stack index.
+ */
+static double *econ_avgSum =
+   NULL; /**< Sum of the mean seen price at each spob. */
+static double *econ_avgSum2 =
+   NULL; /**< Sum of the squared mean seen price at each spob. */
+static int *econ_avgCnt   = NULL; /**< Number of spobs with seen prices. */
+static int  econ_avgDirty = 1;    /**< Averages need to be recomputed. */
 
 /*
  * Prototypes.
  */
 /* Economy. */
-// static double econ_calcJumpR( StarSystem *A, StarSystem *B );
-// static double econ_calcSysI( unsigned int dt, StarSystem *sys, int price );
-// static int econ_createGMatrix (void);
+static double econ_calcJumpR( const StarSystem *A, const StarSystem *B );
+static void   econ_updateProduction( double dt );
+static double econ_calcSysI( const StarSystem *sys, const Commodity *com );
+static int    econ_createGMatrix( void );
+static void   econ_updateSpobSys( void );
+static double econ_priceMod( const Commodity *com, const StarSystem *sys,
+                             const Spob *p );
+static inline void econ_tripletEntry( cholmod_triplet *m, int i, int j,
+                                      double x );
+static int  economy_hasCommodity( const Commodity *com );
+static void economy_avgRecompute( void );
+static void economy_avgAdd( const Spob *p, int i, int sign );
 
 /*
  * Externed prototypes.
@@ -69,6 +109,65 @@ int       *econ_comm        = NULL; /**< Commodities to calculate. */
 int economy_sysSave( xmlTextWriterPtr writer );
 int economy_sysLoad( xmlNodePtr parent );
 
+/**
+ * @brief Checks to see if the economy calculates the price of a commodity.
+ */
+static int economy_hasCommodity( const Commodity *com )
+{
+   /* Same criteria as for being in econ_comm. */
+   return !com->istemp && ( com->price > 0. );
+}
+
+/**
+ * @brief Recomputes the averages of seen prices from scratch.
+ */
+static void economy_avgRecompute( void )
+{
+   int n = MAX( array_size( commodity_stack ), 1 );
+
+   free( econ_avgSum );
+   free( econ_avgSum2 );
+   free( econ_avgCnt );
+   econ_avgSum   = calloc( n, sizeof( double ) );
+   econ_avgSum2  = calloc( n, sizeof( double ) );
+   econ_avgCnt   = calloc( n, sizeof( int ) );
+   econ_avgDirty = 0;
+
+   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
+      const StarSystem *sys = &systems_stack[i];
+      for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
+         const Spob *p = sys->spobs[j];
+         for ( int k = 0; k < array_size( p->commodityPrice ); k++ )
+            economy_avgAdd( p, k, 1 );
+      }
+   }
+}
+
+/**
+ * @brief Adds or removes the contribution of a spob commodity to the averages.
+ *
+ *    @param p Spob to update.
+ *    @param i Index of the commodity on the spob.
+ *    @param sign 1 to add, -1 to remove.
+ */
+static void economy_avgAdd( const Spob *p, int i, int sign )
+{
+   const CommodityPrice *cp = &p->commodityPrice[i];
+   const Commodity      *c  = p->commodities[i];
+   double                mean;
+   int                   k;
+
+   /* Will get picked up when recomputing. */
+   if ( econ_avgDirty || ( cp->cnt <= 0 ) || c->istemp )
+      return;
+
+   k    = c - commodity_stack;
+   mean = cp->sum / cp->cnt;
+   econ_avgSum[k] += sign * mean;
+   econ_avgSum2[k] += sign * mean * mean;
+   econ_avgCnt[k] += sign;
+}
+
 /**
  * @brief Gets the price of a good on a spob in a system.
  *
@@ -96,8 +195,7 @@ credits_t economy_getPrice( const Commodity *com, const StarSystem *sys,
 credits_t economy_getPriceAtTime( const Commodity *com, const StarSystem *sys,
                                   const Spob *p, ntime_t tme )
 {
-   (void)sys;
-   int             i, k;
+   int             i;
    double          price;
    double          t;
    CommodityPrice *commPrice;
@@ -121,42 +219,59 @@ credits_t economy_getPriceAtTime( const Commodity *com, const StarSystem *sys,
     * Journey with a single jump takes approx 3e7, so about 3 periods. */
    t = ntime_convertSeconds( tme ) / NT_PERIOD_SECONDS;
 
-   /* Get position in stack. */
-   k = com - commodity_stack;
-
-   /* Find what commodity that is. */
-   for ( i = 0; i < array_size( econ_comm ); i++ )
-      if ( econ_comm[i] == k )
-         break;
-
-   /* Check if found. */
-   if ( i >= array_size( econ_comm ) ) {
+   /* Check if the economy handles the commodity. */
+   if ( !economy_hasCommodity( com ) ) {
       WARN( _( "Price for commodity '%s' not known." ), com->name );
       return 0;
    }
 
    /* and get the index on this spob */
-   for ( i = 0; i < array_size( p->commodities ); i++ ) {
-      if ( ( strcmp( p->commodities[i]->name, com->name ) == 0 ) )
-         break;
-   }
-   if ( i >= array_size( p->commodities ) ) {
+   i = spob_getCommodityIndex( p, com );
+   if ( i < 0 ) {
       WARN( _( "Price for commodity '%s' not known on this spob." ),
             com->name );
       return 0;
    }
    commPrice = &p->commodityPrice[i];
    /* Calculate price. */
-   /* price  = (double) com->price; */
-   /* price *= sys->prices[i]; */
    price =
       ( commPrice->price +
         commPrice->sysVariation * sin( 2. * M_PI * t / commPrice->sysPeriod ) +
         commPrice->spobVariation *
            sin( 2. * M_PI * t / commPrice->spobPeriod ) );
+   /* Supply and demand of the system. */
+   price *= econ_priceMod( com, sys, p );
    return (credits_t)( price + 0.5 ); /* +0.5 to round */
 }
 
+/**
+ * @brief Gets the modifier the economy solution applies to a price.
+ *
+ *    @param com Commodity to get the modifier of.
+ *    @param sys System of the spob or NULL to look it up.
+ *    @param p Spob to get the modifier at.
+ *    @return The modifier, 1 if the economy has no solution for it.
+ */
+static double econ_priceMod( const Commodity *com, const StarSystem *sys,
+                             const Spob *p )
+{
+   int c = com - commodity_stack;
+
+   if ( sys == NULL ) {
+      if ( ( p->id < 0 ) || ( p->id >= econ_nspobSys ) ||
+           ( econ_spobSys[p->id] < 0 ) )
+         return 1.;
+      sys = &systems_stack[econ_spobSys[p->id]];
+   }
+   if ( sys->prices == NULL )
+      return 1.;
+
+   for ( int j = 0; j < array_size( econ_comm ); j++ )
+      if ( econ_comm[j] == c )
+         return sys->prices[j];
+   return 1.;
+}
+
 /**
  * @brief Gets the average price of a good on a spob in a system, using a
  * rolling average over the times the player has landed here.
@@ -171,7 +286,7 @@ credits_t economy_getPriceAtTime( const Commodity *com, const StarSystem *sys,
 int economy_getAverageSpobPrice( const Commodity *com, const Spob *p,
                                  credits_t *mean, double *std )
 {
-   int             i, k;
+   int             i;
    CommodityPrice *commPrice;
 
    if ( com->price_ref != NULL ) {
@@ -191,16 +306,8 @@ int economy_getAverageSpobPrice( const Commodity *com, const Spob *p,
       return com->price;
    }
 
-   /* Get position in stack */
-   k = com - commodity_stack;
-
-   /* Find what commodity this is */
-   for ( i = 0; i < array_size( econ_comm ); i++ )
-      if ( econ_comm[i] == k )
-         break;
-
-   /* Check if found */
-   if ( i >= array_size( econ_comm ) ) {
+   /* Check if the economy handles the commodity. */
+   if ( !economy_hasCommodity( com ) ) {
       WARN( _( "Average price for commodity '%s' not known." ), com->name );
       *mean = 0;
       *std  = 0;
@@ -208,11 +315,8 @@ int economy_getAverageSpobPrice( const Commodity *com, const Spob *p,
    }
 
    /* and get the index on this spob */
-   for ( i = 0; i < array_size( p->commodities ); i++ ) {
-      if ( ( strcmp( p->commodities[i]->name, com->name ) == 0 ) )
-         break;
-   }
-   if ( i >= array_size( p->commodities ) ) {
+   i = spob_getCommodityIndex( p, com );
+   if ( i < 0 ) {
       WARN( _( "Price for commodity '%s' not known on this spob." ),
             com->name );
       *mean = 0;
@@ -245,11 +349,10 @@ int economy_getAverageSpobPrice( const Commodity *com, const Spob *p,
 int economy_getAveragePrice( const Commodity *com, credits_t *mean,
                              double *std )
 {
-   int             i, k;
-   CommodityPrice *commPrice;
-   double          av  = 0;
-   double          av2 = 0;
-   int             cnt = 0;
+   int    k;
+   double av  = 0;
+   double av2 = 0;
+   int    cnt;
 
    if ( com->price_ref != NULL ) {
       const Commodity *ref = commodity_get( com->price_ref );
@@ -268,43 +371,22 @@ int economy_getAveragePrice( const Commodity *com, credits_t *mean,
       return com->price;
    }
 
-   /* Get position in stack */
-   k = com - commodity_stack;
-
-   /* Find what commodity this is */
-   for ( i = 0; i < array_size( econ_comm ); i++ )
-      if ( econ_comm[i] == k )
-         break;
-
-   /* Check if found */
-   if ( i >= array_size( econ_comm ) ) {
+   /* Check if the economy handles the commodity. */
+   if ( !economy_hasCommodity( com ) ) {
       WARN( _( "Average price for commodity '%s' not known." ), com->name );
       *mean = 0;
       *std  = 0;
       return 1;
    }
-   for ( i = 0; i < array_size( systems_stack ); i++ ) {
-      StarSystem *sys = &systems_stack[i];
-      for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-         Spob *p = sys->spobs[j];
 
-         /* and get the index on this spob */
-         for ( k = 0; k < array_size( p->commodities ); k++ ) {
-            if ( ( strcmp( p->commodities[k]->name, com->name ) == 0 ) )
-               break;
-         }
-         if ( k < array_size( p->commodityPrice ) ) {
-            commPrice = &p->commodityPrice[k];
-            if ( commPrice->cnt > 0 ) {
-               av += commPrice->sum / commPrice->cnt;
-               av2 += commPrice->sum * commPrice->sum /
-                      ( commPrice->cnt * commPrice->cnt );
-               cnt++;
-            }
-         }
-      }
-   }
+   /* Averages are kept up to date as prices are seen. */
+   if ( econ_avgDirty )
+      economy_avgRecompute();
+   k   = com - commodity_stack;
+   cnt = econ_avgCnt[k];
    if ( cnt > 0 ) {
+      av  = econ_avgSum[k];
+      av2 = econ_avgSum2[k];
       av /= cnt;
       av2 = sqrt( av2 / cnt - av * av );
    }
@@ -313,7 +395,6 @@ int economy_getAveragePrice( const Commodity *com, credits_t *mean,
    return 0;
 }
 
-#if 0
 /**
  * @brief Calculates the resistance between two star systems.
  *
@@ -321,7 +402,7 @@ int economy_getAveragePrice( const Commodity *com, credits_t *mean,
  *    @param B Star system to calculate the resistance between.
  *    @return Resistance between A and B.
  */
-static double econ_calcJumpR( StarSystem *A, StarSystem *B )
+static double econ_calcJumpR( const StarSystem *A, const StarSystem *B )
 {
    double R;
 
@@ -329,14 +410,16 @@ static double econ_calcJumpR( StarSystem *A, StarSystem *B )
    R = ECON_BASE_RES;
 
    /* Modify based on system conditions. */
-   R += (A->nebu_density + B->nebu_density) / 1000.; /* Density shouldn't affect much. */
-   R += (A->nebu_volatility + B->nebu_volatility) / 100.; /* Volatility should. */
+   R += ( A->nebu_density + B->nebu_density ) /
+        1000.; /* Density shouldn't affect much. */
+   R += ( A->nebu_volatility + B->nebu_volatility ) /
+        100.; /* Volatility should. */
 
    /* Modify based on global faction. */
-   if ((A->faction != -1) && (B->faction != -1)) {
-      if (areEnemies(A->faction, B->faction))
+   if ( ( A->faction != -1 ) && ( B->faction != -1 ) ) {
+      if ( areEnemies( A->faction, B->faction ) )
          R += ECON_FACTION_MOD * ECON_BASE_RES;
-      else if (areAllies(A->faction, B->faction))
+      else if ( areAllies( A->faction, B->faction ) )
          R -= ECON_FACTION_MOD * ECON_BASE_RES;
    }
 
@@ -345,104 +428,120 @@ static double econ_calcJumpR( StarSystem *A, StarSystem *B )
    return R;
 }
 
+/**
+ * @brief Updates the production level of all the spobs.
+ *
+ *    @param dt Time step in periods.
+ */
+static void econ_updateProduction( double dt )
+{
+   int n = array_size( spob_getAll() );
+
+   /* Spobs can get added by unidiffs. */
+   if ( n > econ_nprod ) {
+      econ_prod = realloc( econ_prod, n * sizeof( double ) );
+      for ( int i = econ_nprod; i < n; i++ )
+         econ_prod[i] = 1.;
+      econ_nprod = n;
+   }
+
+   if ( dt <= 0. )
+      return;
+
+   for ( int i = 0; i < n; i++ ) {
+      /* Add a variability factor based on the Gaussian distribution. */
+      econ_prod[i] += ECON_PROD_VAR * RNGS_2SIGMA( &econ_rng ) * sqrt( dt );
+      /* Add a tendency to return to the spob's base production. */
+      econ_prod[i] -= ECON_PROD_VAR * ( econ_prod[i] - 1. ) * dt;
+      econ_prod[i] = MAX( econ_prod[i], 0. );
+   }
+}
+
 /**
  * @brief Calculates the intensity in a system node.
  *
- * @todo Make it time/item dependent.
+ *    @param sys System to calculate intensity of.
+ *    @param com Commodity to calculate intensity for.
+ *    @return The intensity of the node.
  */
-static double econ_calcSysI( unsigned int dt, StarSystem *sys, int price )
+static double econ_calcSysI( const StarSystem *sys, const Commodity *com )
 {
-   int i;
-   double I;
-   double prodfactor, p;
-   double ddt;
-   Spob *spob;
-
-   ddt = (double)(dt / NTIME_UNIT_LENGTH);
-
-   /* Calculate production level. */
-   p = 0.;
-   for (i=0; i<sys->nspobs; i++) {
-      spob = sys->spobs[i];
-      if (spob_hasService(spob, SPOB_SERVICE_INHABITED)) {
-         /*
-          * Calculate production.
-          */
-         /* We base off the current production. */
-         prodfactor  = spob->cur_prodfactor;
-         /* Add a variability factor based on the Gaussian distribution. */
-         prodfactor += ECON_PROD_VAR * RNG_2SIGMA() * ddt;
-         /* Add a tendency to return to the spob's base production. */
-         prodfactor -= ECON_PROD_VAR *
-               (spob->cur_prodfactor - prodfactor)*ddt;
-         /* Save for next iteration. */
-         spob->cur_prodfactor = prodfactor;
-         /* We base off the sqrt of the population otherwise it changes too fast. */
-         p += prodfactor * sqrt(spob->population);
-      }
+   double p = 0.;
+
+   /* Calculate production level of the spobs trading the commodity. */
+   for ( int i = 0; i < array_size( sys->spobs ); i++ ) {
+      const Spob *spob = sys->spobs[i];
+      if ( !spob_hasService( spob, SPOB_SERVICE_INHABITED ) ||
+           ( spob_getCommodityIndex( spob, com ) < 0 ) )
+         continue;
+      /* We base off the sqrt of the population otherwise it changes too fast.
+       */
+      p += econ_prod[spob->id] * sqrt( spob->population );
    }
 
    /* The intensity is basically the modified production. */
-   I = p / ECON_PROD_MODIFIER;
-
-   return I;
+   return p / ECON_PROD_MODIFIER;
 }
 
 /**
- * @brief Creates the admittance matrix.
+ * @brief Creates and factorises the admittance matrix.
+ *
+ * Each jump is a conductance between two nodes and each node has an additional
+ * conductance to ground for dampening, so the matrix is symmetric positive
+ * definite and has a Cholesky factorisation.
  *
  *    @return 0 on success.
  */
-static int econ_createGMatrix (void)
+static int econ_createGMatrix( void )
 {
-   int ret;
-   double R, Rsum;
-   cs *M;
-
-   /* Create the matrix. */
-   M = cs_spalloc( array_size(systems_stack), array_size(systems_stack), 1, 1, 1 );
-   if (M == NULL)
-      WARN(_("Unable to create CSparse Matrix."));
-
-   /* Fill the matrix. */
-   for (int i=0; i < array_size(systems_stack); i++) {
-      StarSystem *sys   = &systems_stack[i];
-      Rsum = 0.;
-
-      /* Set some values. */
-      for (int j=0; j < array_size(sys->jumps); j++) {
-
-         /* Get the resistances. */
-         R     = econ_calcJumpR( sys, sys->jumps[j].target );
-         R     = 1./R; /* Must be inverted. */
-         Rsum += R;
-
-         /* Matrix is symmetrical and non-diagonal is negative. */
-         ret = cs_entry( M, i, sys->jumps[j].target->id, -R );
-         if (ret != 1)
-            WARN(_("Unable to enter CSparse Matrix Cell."));
-         ret = cs_entry( M, sys->jumps[j].target->id, i, -R );
-         if (ret != 1)
-            WARN(_("Unable to enter CSparse Matrix Cell."));
-      }
-
-      /* Set the diagonal. */
-      Rsum += 1./ECON_SELF_RES; /* We add a resistance for dampening. */
-      cs_entry( M, i, i, Rsum );
+   int              n   = array_size( systems_stack );
+   int              nnz = n;
+   cholmod_triplet *T;
+   cholmod_sparse  *G;
+
+   cholmod_free_factor( &econ_L, &econ_C );
+
+   /* Create the matrix, only the upper triangular part is stored. */
+   for ( int i = 0; i < n; i++ )
+      nnz += 3 * array_size( systems_stack[i].jumps );
+   T = cholmod_allocate_triplet( n, n, nnz, 1, CHOLMOD_REAL, &econ_C );
+   if ( T == NULL ) {
+      WARN( _( "Unable to create economy G Matrix." ) );
+      return -1;
    }
 
-   /* Compress M matrix and put into G. */
-   cs_spfree( econ_G );
-   econ_G = cs_compress( M );
-   if (econ_G == NULL)
-      WARN(_("Unable to create economy G Matrix."));
+   /* Fill the matrix, duplicate entries get summed. */
+   for ( int i = 0; i < n; i++ ) {
+      const StarSystem *sys = &systems_stack[i];
 
-   /* Clean up. */
-   cs_spfree(M);
+      /* We add a resistance for dampening. */
+      econ_tripletEntry( T, i, i, 1. / ECON_SELF_RES );
 
+      for ( int j = 0; j < array_size( sys->jumps ); j++ ) {
+         const StarSystem *target = sys->jumps[j].target;
+         int               k      = target->id;
+         double            R      = 1. / econ_calcJumpR( sys, target );
+         econ_tripletEntry( T, i, i, R );
+         econ_tripletEntry( T, k, k, R );
+         econ_tripletEntry( T, MIN( i, k ), MAX( i, k ), -R );
+      }
+   }
+
+   /* Factorise once, the factorisation gets reused for every solve. */
+   G = cholmod_triplet_to_sparse( T, 0, &econ_C );
+   cholmod_free_triplet( &T, &econ_C );
+   econ_L = cholmod_analyze( G, &econ_C );
+   cholmod_factorize( G, econ_L, &econ_C );
+   cholmod_free_sparse( &G, &econ_C );
+   if ( econ_C.status != CHOLMOD_OK ) {
+      WARN( _( "Unable to factorise economy G Matrix." ) );
+      cholmod_free_factor( &econ_L, &econ_C );
+      return -1;
+   }
+
+   econ_Gdirty = 0;
    return 0;
 }
-#endif
 
 /**
  * @brief Initializes the economy.
@@ -455,6 +554,9 @@ int economy_init( void )
    if ( econ_initialized )
       return 0;
 
+   cholmod_start( &econ_C );
+   rng_streamInit( &econ_rng, RNG_SUBSYS_ECONOMY, 0 );
+
    /* Allocate price space. */
    for ( int i = 0; i < array_size( systems_stack ); i++ ) {
       free( systems_stack[i].prices );
@@ -464,6 +566,7 @@ int economy_init( void )
 
    /* Mark economy as initialized. */
    econ_initialized = 1;
+   econ_Gdirty      = 1;
 
    /* Refresh economy. */
    economy_refresh();
@@ -492,6 +595,15 @@ int economy_execQueued( void )
    return 0;
 }
 
+/**
+ * @brief Marks the jump topology as changed, so the economy matrix gets
+ * recreated on the next update.
+ */
+void economy_jumpsChanged( void )
+{
+   econ_Gdirty = 1;
+}
+
 /**
  * @brief Regenerates the economy matrix.  Should be used if the universe
  *  changes in any permanent way.
@@ -502,11 +614,7 @@ int economy_refresh( void )
    if ( econ_initialized == 0 )
       return 0;
 
-   /* Create the resistance matrix. */
-   // if (econ_createGMatrix())
-   //    return -1;
-
-   /* Initialize the prices. */
+   /* Initialize the prices, the matrix is recreated if the jumps changed. */
    economy_update( 0 );
 
    return 0;
@@ -515,87 +623,112 @@ int economy_refresh( void )
 /**
  * @brief Updates the economy.
  *
+ * All the commodities are solved at once as a dense block of right-hand sides
+ * against the cached factorisation.
+ *
  *    @param dt Deltatick in NTIME.
  */
 int economy_update( unsigned int dt )
 {
-   (void)dt;
-#if 0
-   int i, j;
-   double *X;
-   double scale, offset;
-   /*double min, max;*/
+   int     n, ncomm;
+   double *B, *X;
 
    /* Economy must be initialized. */
-   if (econ_initialized == 0)
+   if ( econ_initialized == 0 )
       return 0;
 
-   /* Create the vector to solve the system. */
-   X = malloc(sizeof(double)*array_size(systems_stack));
-   if (X == NULL) {
-      WARN(_("Out of Memory"));
+   n           = array_size( systems_stack );
+   ncomm       = array_size( econ_comm );
+   econ_queued = 0;
+   if ( ( n == 0 ) || ( ncomm == 0 ) )
+      return 0;
+
+   /* Recreate the matrix if the topology changed. */
+   if ( econ_Gdirty || ( econ_L == NULL ) || ( (int)econ_L->n != n ) ) {
+      if ( econ_createGMatrix() )
+         return -1;
+   }
+
+   /* Load the block with intensities, one column per commodity. */
+   econ_updateProduction( ntime_convertSeconds( dt ) / NT_PERIOD_SECONDS );
+   if ( ( econ_B == NULL ) || ( (int)econ_B->nrow != n ) ||
+        ( (int)econ_B->ncol != ncomm ) ) {
+      cholmod_free_dense( &econ_B, &econ_C );
+      econ_B = cholmod_allocate_dense( n, ncomm, n, CHOLMOD_REAL, &econ_C );
+   }
+   B = econ_B->x;
+   for ( int j = 0; j < ncomm; j++ ) {
+      const Commodity *com = &commodity_stack[econ_comm[j]];
+      for ( int i = 0; i < n; i++ )
+         B[j * n + i] = econ_calcSysI( &systems_stack[i], com );
+   }
+
+   /* Solve the system, the workspaces are kept between updates. */
+   if ( !cholmod_solve2( CHOLMOD_A, econ_L, econ_B, NULL, &econ_X, NULL,
+                         &econ_Y, &econ_E, &econ_C ) ) {
+      WARN( _( "Failed to solve the Economy System." ) );
       return -1;
    }
 
-   /* Calculate the results for each price set. */
-   for (j=0; j<array_size(econ_comm); j++) {
-
-      /* First we must load the vector with intensities. */
-      for (i=0; i<array_size(systems_stack); i++)
-         X[i] = econ_calcSysI( dt, &systems_stack[i], j );
-
-      /* Solve the system. */
-      /** @TODO This should be improved to try to use better factorizations (LU/Cholesky)
-       * if possible or just outright try to use some other library that does fancy stuff
-       * like UMFPACK. Would be also interesting to see if it could be optimized so we
-       * store the factorization or update that instead of handling it individually. Another
-       * point of interest would be to split loops out to make the solving faster, however,
-       * this may be trickier to do (although it would surely let us use cholesky always if we
-       * enforce that condition). */
-      ret = cs_qrsol( 3, econ_G, X );
-      if (ret != 1)
-         WARN(_("Failed to solve the Economy System."));
-
-      /*
-       * Get the minimum and maximum to scale.
-       */
-      /*
-      min = +HUGE_VALF;
-      max = -HUGE_VALF;
-      for (i=0; i<array_size(systems_stack); i++) {
-         if (X[i] < min)
-            min = X[i];
-         if (X[i] > max)
-            max = X[i];
+   /*
+    * The solution is turned into price modifiers relative to the mean over
+    * all the systems, so the prices move around without drifting on average,
+    * and clamped to keep the balance in check.
+    */
+   X = econ_X->x;
+   for ( int j = 0; j < ncomm; j++ ) {
+      double mean = 0.;
+      for ( int i = 0; i < n; i++ )
+         mean += X[j * n + i] + 1.;
+      mean /= n;
+      for ( int i = 0; i < n; i++ ) {
+         StarSystem *sys = &systems_stack[i];
+         if ( sys->prices == NULL )
+            sys->prices = calloc( ncomm, sizeof( double ) );
+         sys->prices[j] = CLAMP( ECON_PRICE_MIN, ECON_PRICE_MAX,
+                                 ( X[j * n + i] + 1. ) / mean );
       }
-      scale = 1. / (max - min);
-      offset = 0.5 - min * scale;
-      */
-
-      /*
-       * I'm not sure I like the filtering of the results, but it would take
-       * much more work to get a good system working without the need of post
-       * filtering.
-       */
-      scale    = 1.;
-      offset   = 1.;
-      for (i=0; i<array_size(systems_stack); i++)
-         systems_stack[i].prices[j] = X[i] * scale + offset;
    }
 
-   /* Clean up. */
-   free(X);
+   /* Spobs look their system up for the prices. */
+   econ_updateSpobSys();
 
-#endif
-   econ_queued = 0;
    return 0;
 }
 
+/**
+ * @brief Maps the spobs to the systems they are in for price lookups.
+ */
+static void econ_updateSpobSys( void )
+{
+   int n = array_size( spob_getAll() );
+   if ( n > econ_nspobSys ) {
+      econ_spobSys  = realloc( econ_spobSys, n * sizeof( int ) );
+      econ_nspobSys = n;
+   }
+   for ( int i = 0; i < econ_nspobSys; i++ )
+      econ_spobSys[i] = -1;
+   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
+      const StarSystem *sys = &systems_stack[i];
+      for ( int j = 0; j < array_size( sys->spobs ); j++ )
+         econ_spobSys[sys->spobs[j]->id] = i;
+   }
+}
+
 /**
  * @brief Destroys the economy.
  */
 void economy_destroy( void )
 {
+   /* Clean up the seen price averages. */
+   free( econ_avgSum );
+   free( econ_avgSum2 );
+   free( econ_avgCnt );
+   econ_avgSum   = NULL;
+   econ_avgSum2  = NULL;
+   econ_avgCnt   = NULL;
+   econ_avgDirty = 1;
+
    /* Must be initialized. */
    if ( !econ_initialized )
       return;
@@ -606,14 +739,36 @@ void economy_destroy( void )
       systems_stack[i].prices = NULL;
    }
 
-   /* Destroy the economy matrix. */
-   cs_spfree( econ_G );
-   econ_G = NULL;
+   /* Destroy the economy matrix and solver state. */
+   cholmod_free_factor( &econ_L, &econ_C );
+   cholmod_free_dense( &econ_B, &econ_C );
+   cholmod_free_dense( &econ_X, &econ_C );
+   cholmod_free_dense( &econ_Y, &econ_C );
+   cholmod_free_dense( &econ_E, &econ_C );
+   cholmod_finish( &econ_C );
+   free( econ_prod );
+   econ_prod  = NULL;
+   econ_nprod = 0;
+   free( econ_spobSys );
+   econ_spobSys  = NULL;
+   econ_nspobSys = 0;
 
    /* Economy is now deinitialized. */
    econ_initialized = 0;
 }
 
+/**
+ * @brief Adds an entry to a triplet matrix.
+ */
+static inline void econ_tripletEntry( cholmod_triplet *m, int i, int j,
+                                      double x )
+{
+   ( (int *)m->i )[m->nnz]    = i;
+   ( (int *)m->j )[m->nnz]    = j;
+   ( (double *)m->x )[m->nnz] = x;
+   m->nnz++;
+}
+
 /**
  * @brief Used during startup to set price and variation of the economy,
  * depending on spob information.
@@ -959,12 +1114,14 @@ void economy_averageSeenPrices( const Spob *p )
       if ( cp->updateTime <
            t ) { /* has not yet been updated at present time. */
          credits_t price;
+         economy_avgAdd( p, i, -1 );
          cp->updateTime = t;
          /* Calculate values for mean and std */
          cp->cnt++;
          price = economy_getPrice( c, NULL, p );
          cp->sum += price;
          cp->sum2 += price * price;
+         economy_avgAdd( p, i, 1 );
       }
    }
 }
@@ -978,11 +1135,13 @@ void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate )
       if ( cp->updateTime <
            t ) { /* has not yet been updated at present time. */
          credits_t price;
+         economy_avgAdd( p, i, -1 );
          cp->updateTime = t;
          cp->cnt++;
          price = economy_getPriceAtTime( c, NULL, p, tupdate );
          cp->sum += price;
          cp->sum2 += price * price;
+         economy_avgAdd( p, i, 1 );
       }
    }
 }
@@ -1007,6 +1166,7 @@ void economy_clearKnown( void )
    }
    for ( int i = 0; i < array_size( commodity_stack ); i++ )
       commodity_stack[i].lastPurchasePrice = 0;
+   econ_avgDirty = 1;
 }
 
 /**
@@ -1015,6 +1175,8 @@ void economy_clearKnown( void )
  */
 void economy_clearSingleSpob( Spob *p )
 {
+   /* The spob may also have been added to a system. */
+   econ_avgDirty = 1;
    for ( int k = 0; k < array_size( p->commodityPrice ); k++ ) {
       CommodityPrice *cp = &p->commodityPrice[k];
       cp->cnt            = 0;
@@ -13,6 +13,7 @@ void economy_addQueuedUpdate( void );
 int  economy_execQueued( void );
 int  economy_update( unsigned int dt );
 int  economy_refresh( void );
+void economy_jumpsChanged( void );
 void economy_destroy( void );
 void economy_clearKnown( void );
 void economy_clearSingleSpob( Spob *p );
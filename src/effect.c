@@ -540,16 +540,16 @@ void effect_clear( Effect **efxlist )
 }
 
 /**
- * @brief Updates shipstats from effect list.
+ * @brief Accumulates the stats of an effect list into a delta.
  *
- *    @param s Stats to update.
+ *    @param delta Delta to update.
  *    @param efxlist List of effects.
  */
-void effect_compute( ShipStats *s, const Effect *efxlist )
+void effect_compute( ShipStatsDelta *delta, const Effect *efxlist )
 {
    for ( int i = 0; i < array_size( efxlist ); i++ ) {
       const Effect *e = &efxlist[i];
-      ss_statsMergeFromListScale( s, e->data->stats, e->strength );
+      ss_deltaMergeFromListScale( delta, e->data->stats, e->strength );
    }
 }
 
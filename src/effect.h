@@ -74,5 +74,5 @@ int  effect_rmType( Effect **efxlist, const EffectData *efx, int all );
 void effect_clearSpecific( Effect **efxlist, int debuffs, int buffs,
                            int others );
 void effect_clear( Effect **efxlist );
-void effect_compute( ShipStats *s, const Effect *efxlist );
+void effect_compute( ShipStatsDelta *delta, const Effect *efxlist );
 void effect_cleanup( Effect *efxlist );
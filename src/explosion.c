@@ -5,6 +5,12 @@
  * @file explosion.c
  *
  * @brief Handles gigantic explosions.
+ *
+ * The graphics of an explosion are shown right away, but the damage is queued
+ * and resolved once an update for all the explosions together. Explosions
+ * that are close to each other share a single query of the pilot and weapon
+ * quadtrees. Exploding weapons and the alerts of exploding asteroids go
+ * through the same queue.
  */
 /** @cond */
 #include "naev.h"
@@ -12,20 +18,141 @@
 
 #include "explosion.h"
 
+#include "array.h"
+#include "damagetype.h"
+#include "intlist.h"
 #include "log.h"
+#include "nlua_asteroid.h"
+#include "ntracing.h"
 #include "pilot.h"
 #include "rng.h"
 #include "spfx.h"
 #include "weapon.h"
 
-static int exp_s   = -1; /**< Small explosion spfx. */
-static int exp_m   = -1; /**< Medium explosion spfx. */
-static int exp_l   = -1; /**< Large explosion spfx. */
-static int exp_200 = -1; /**< 200 radius explsion spfx. */
-static int exp_300 = -1; /**< 300 radius explosion spfx. */
-static int exp_400 = -1; /**< 400 radius explosion spfx. */
-static int exp_500 = -1; /**< 500 radius explosion spfx. */
-static int exp_600 = -1; /**< 600 radius explosion spfx. */
+#define EXPL_BATCH_SLACK                                                       \
+   2. /**< How much larger the area of a batch may get than the area of the    \
+         explosions in it. */
+#define EXPL_MODE_ALERT                                                        \
+   ( 1 << 3 ) /**< Only alerts the pilots in range of an asteroid exploding. */
+
+/**
+ * @brief An explosion waiting for its damage to be resolved.
+ */
+typedef struct Explosion_ {
+   double          x;        /**< X position of the explosion center. */
+   double          y;        /**< Y position of the explosion center. */
+   double          radius;   /**< Radius of the explosion. */
+   Damage          dmg;      /**< Damage characteristics. */
+   unsigned int    parent;   /**< Id of the parent or 0 if none. */
+   int             mode;     /**< Defines the explosion behaviour. */
+   int             x1;       /**< Left of the bounding box. */
+   int             y1;       /**< Bottom of the bounding box. */
+   int             x2;       /**< Right of the bounding box. */
+   int             y2;       /**< Top of the bounding box. */
+   int             weapon;   /**< Whether it is the explosion of w. */
+   WeaponExplosion w;        /**< What is kept of the exploding weapon. */
+   LuaAsteroid_t   asteroid; /**< Asteroid alerting pilots (EXPL_MODE_ALERT). */
+} Explosion;
+
+static int exp_s     = -1; /**< Small explosion spfx. */
+static int exp_m     = -1; /**< Medium explosion spfx. */
+static int exp_l     = -1; /**< Large explosion spfx. */
+static int exp_200   = -1; /**< 200 radius explsion spfx. */
+static int exp_300   = -1; /**< 300 radius explosion spfx. */
+static int exp_400   = -1; /**< 400 radius explosion spfx. */
+static int exp_500   = -1; /**< 500 radius explosion spfx. */
+static int exp_600   = -1; /**< 600 radius explosion spfx. */
+static int exp_dtype = -1; /**< Damage type of the splash damage. */
+
+static Explosion *expl_queue = NULL; /**< Explosions to resolve (array.h). */
+static IntList    expl_qtquery;      /**< For querying the quadtrees. */
+
+/*
+ * Prototypes.
+ */
+static Explosion *expl_add( double x, double y, double radius, int mode );
+static void       expl_free( int start, int n );
+static void expl_resolve( int start, int n, int x1, int y1, int x2, int y2 );
+static void expl_resolvePilots( int start, int n, int x1, int y1, int x2,
+                                int y2 );
+static void expl_resolveWeapons( int start, int n, int x1, int y1, int x2,
+                                 int y2 );
+
+/**
+ * @brief Sets up the explosions, looking up the special effects they use.
+ */
+void expl_init( void )
+{
+   /* TODO This is all horrible and I wish we could either parametrize it or
+    * get rid of the hardcoding. */
+   exp_s     = spfx_get( "ExpS" );
+   exp_m     = spfx_get( "ExpM" );
+   exp_l     = spfx_get( "ExpL" );
+   exp_200   = spfx_get( "Exp200" );
+   exp_300   = spfx_get( "Exp300" );
+   exp_400   = spfx_get( "Exp400" );
+   exp_500   = spfx_get( "Exp500" );
+   exp_600   = spfx_get( "Exp600" );
+   exp_dtype = dtype_get( "explosion_splash" );
+
+   expl_queue = array_create( Explosion );
+   il_create( &expl_qtquery, 1 );
+}
+
+/**
+ * @brief Drops the explosions that were not resolved yet.
+ */
+void expl_clear( void )
+{
+   expl_free( 0, array_size( expl_queue ) );
+   array_erase( &expl_queue, array_begin( expl_queue ),
+                array_end( expl_queue ) );
+}
+
+/**
+ * @brief Cleans up the explosions.
+ */
+void expl_exit( void )
+{
+   expl_free( 0, array_size( expl_queue ) );
+   array_free( expl_queue );
+   expl_queue = NULL;
+   il_destroy( &expl_qtquery );
+}
+
+/**
+ * @brief Gets the special effect used by an explosion.
+ *
+ *    @param radius Radius of the explosion.
+ *    @return The special effect of the explosion.
+ */
+int expl_spfx( double radius )
+{
+   if ( radius < 40. / 2. )
+      return exp_s;
+   else if ( radius < 70. / 2. )
+      return exp_m;
+   else if ( radius < 100. / 2. )
+      return exp_l;
+   else if ( radius < 200. / 2. )
+      return exp_200;
+   else if ( radius < 300. / 2. )
+      return exp_300;
+   else if ( radius < 400. / 2. )
+      return exp_400;
+   else if ( radius < 500. / 2. )
+      return exp_500;
+   // else if (radius < 600./2.)
+   return exp_600;
+}
+
+/**
+ * @brief Gets the damage type of the splash damage of explosions.
+ */
+int expl_dtype( void )
+{
+   return exp_dtype;
+}
 
 /**
  * @brief Does explosion in a radius (damage and graphics).
@@ -42,44 +169,8 @@ static int exp_600 = -1; /**< 600 radius explosion spfx. */
 void expl_explode( double x, double y, double vx, double vy, double radius,
                    const Damage *dmg, const Pilot *parent, int mode )
 {
-   int layer;
-   int efx;
-
-   /* Standard stuff - lazy allocation. */
-   if ( exp_s == -1 ) {
-      /* TODO This is all horrible and I wish we could either parametrize it or
-       * get rid of the hardcoding. */
-      exp_s   = spfx_get( "ExpS" );
-      exp_m   = spfx_get( "ExpM" );
-      exp_l   = spfx_get( "ExpL" );
-      exp_200 = spfx_get( "Exp200" );
-      exp_300 = spfx_get( "Exp300" );
-      exp_400 = spfx_get( "Exp400" );
-      exp_500 = spfx_get( "Exp500" );
-      exp_600 = spfx_get( "Exp600" );
-   }
-   layer = SPFX_LAYER_FRONT;
-
-   if ( radius < 40. / 2. )
-      efx = exp_s;
-   else if ( radius < 70. / 2. )
-      efx = exp_m;
-   else if ( radius < 100. / 2. )
-      efx = exp_l;
-   else if ( radius < 200. / 2. )
-      efx = exp_200;
-   else if ( radius < 300. / 2. )
-      efx = exp_300;
-   else if ( radius < 400. / 2. )
-      efx = exp_400;
-   else if ( radius < 500. / 2. )
-      efx = exp_500;
-   // else if (radius < 600./2.)
-   else
-      efx = exp_600;
-
    /* Final explosion. */
-   spfx_add( efx, x, y, vx, vy, layer );
+   spfx_add( expl_spfx( radius ), x, y, vx, vy, SPFX_LAYER_FRONT );
 
    /* Run the damage. */
    if ( dmg != NULL )
@@ -89,6 +180,8 @@ void expl_explode( double x, double y, double vx, double vy, double radius,
 /**
  * @brief Does explosion damage in a radius.
  *
+ * The damage is only done once the explosions are resolved in expl_update().
+ *
  *    @param x X position of explosion center.
  *    @param y Y position of explosion center.
  *    @param radius Radius of the explosion.
@@ -99,13 +192,319 @@ void expl_explode( double x, double y, double vx, double vy, double radius,
 void expl_explodeDamage( double x, double y, double radius, const Damage *dmg,
                          const Pilot *parent, int mode )
 {
+   Explosion *e = expl_add( x, y, radius, mode );
+   if ( e == NULL )
+      return;
+   e->dmg    = *dmg;
+   e->parent = ( parent != NULL ) ? parent->id : 0;
+}
+
+/**
+ * @brief Does the damage of an exploding weapon.
+ *
+ * Unlike expl_explodeDamage(), whatever is caught by the explosion takes the
+ * full damage, the same way as if it had been hit by the weapon. The damage is
+ * only done once the explosions are resolved in expl_update().
+ *
+ *    @param w Weapon exploding.
+ *    @param radius Radius of the explosion.
+ *    @param dmg Damage characteristics.
+ *    @param mode Defines the explosion behaviour.
+ */
+void expl_explodeWeapon( const Weapon *w, double radius, const Damage *dmg,
+                         int mode )
+{
+   Explosion *e = expl_add( w->solid.pos.x, w->solid.pos.y, radius, mode );
+   if ( e == NULL )
+      return;
+   e->dmg    = *dmg;
+   e->parent = w->parent;
+   e->weapon = 1;
+   weapon_explosionInit( &e->w, w );
+}
+
+/**
+ * @brief Alerts the pilots in range of an asteroid exploding.
+ *
+ * The pilots get an "asteroid" message once the explosions are resolved in
+ * expl_update().
+ *
+ *    @param pos Position of the asteroid.
+ *    @param range Range to alert pilots in.
+ *    @param field Asteroid field of the asteroid.
+ *    @param id Id of the asteroid in its field.
+ */
+void expl_alertAsteroid( const vec2 *pos, double range, int field, int id )
+{
+   Explosion *e = expl_add( pos->x, pos->y, range, EXPL_MODE_ALERT );
+   if ( e == NULL )
+      return;
+   e->asteroid.parent = field;
+   e->asteroid.id     = id;
+}
+
+/**
+ * @brief Adds an explosion to the queue.
+ *
+ *    @return The explosion or NULL if explosions are not set up.
+ */
+static Explosion *expl_add( double x, double y, double radius, int mode )
+{
+   Explosion *e;
+   int        r;
+
+   if ( expl_queue == NULL )
+      return NULL;
+
+   e = &array_grow( &expl_queue );
+   memset( e, 0, sizeof( Explosion ) );
+   e->x      = x;
+   e->y      = y;
+   e->radius = radius;
+   e->mode   = mode;
+
+   /* Bounding box to query the quadtrees with. */
+   r     = ceil( radius );
+   e->x1 = round( x ) - r;
+   e->y1 = round( y ) - r;
+   e->x2 = round( x ) + r;
+   e->y2 = round( y ) + r;
+   return e;
+}
+
+/**
+ * @brief Frees the explosions in the queue before they are removed from it.
+ *
+ *    @param start First explosion to free.
+ *    @param n Number of explosions to free.
+ */
+static void expl_free( int start, int n )
+{
+   for ( int i = start; i < start + n; i++ )
+      if ( expl_queue[i].weapon )
+         weapon_explosionFree( &expl_queue[i].w );
+}
+
+/**
+ * @brief Resolves the damage of all the queued explosions.
+ *
+ * Consecutive explosions are batched together as long as the bounding box of
+ * the batch does not get much larger than the explosions themselves, so that
+ * flak and missile swarms only query the quadtrees once.
+ */
+void expl_update( void )
+{
+   int n, start;
+
+   n = array_size( expl_queue );
+   if ( n <= 0 )
+      return;
+
+   NTracingZone( _ctx, 1 );
+   NTracingPlotI( "explosions", n );
+
+   start = 0;
+   while ( start < n ) {
+      const Explosion *e = &expl_queue[start];
+      int              x1, y1, x2, y2, end;
+      double           area;
+
+      x1   = e->x1;
+      y1   = e->y1;
+      x2   = e->x2;
+      y2   = e->y2;
+      area = (double)( x2 - x1 ) * (double)( y2 - y1 );
+      for ( end = start + 1; end < n; end++ ) {
+         const Explosion *en = &expl_queue[end];
+         int              bx1, by1, bx2, by2;
+         double           ea;
+
+         bx1 = MIN( x1, en->x1 );
+         by1 = MIN( y1, en->y1 );
+         bx2 = MAX( x2, en->x2 );
+         by2 = MAX( y2, en->y2 );
+         ea  = (double)( en->x2 - en->x1 ) * (double)( en->y2 - en->y1 );
+         if ( (double)( bx2 - bx1 ) * (double)( by2 - by1 ) >
+              EXPL_BATCH_SLACK * ( area + ea ) )
+            break;
+
+         x1 = bx1;
+         y1 = by1;
+         x2 = bx2;
+         y2 = by2;
+         area += ea;
+      }
+
+      expl_resolve( start, end - start, x1, y1, x2, y2 );
+      start = end;
+   }
+
+   /* Explosions queued while resolving are left for the next update. */
+   expl_free( 0, n );
+   array_erase( &expl_queue, &expl_queue[0], &expl_queue[n] );
+
+   NTracingZoneEnd( _ctx );
+}
+
+/**
+ * @brief Resolves a batch of explosions.
+ *
+ *    @param start First explosion of the batch in the queue.
+ *    @param n Number of explosions in the batch.
+ *    @param x1 Left of the bounding box of the batch.
+ *    @param y1 Bottom of the bounding box of the batch.
+ *    @param x2 Right of the bounding box of the batch.
+ *    @param y2 Top of the bounding box of the batch.
+ */
+static void expl_resolve( int start, int n, int x1, int y1, int x2, int y2 )
+{
+   int mode = 0;
+   for ( int i = start; i < start + n; i++ )
+      mode |= expl_queue[i].mode;
+
    /* Explosion affects ships. */
-   if ( mode & EXPL_MODE_SHIP )
-      pilot_explode( x, y, radius, dmg, parent );
-
-#if 0
-   /* Explosion affects missiles and bolts. */
-   if ((mode & EXPL_MODE_MISSILE) || (mode & EXPL_MODE_BOLT))
-      weapon_explode( x, y, radius, dmg->type, dmg->damage, parent, mode );
-#endif
+   if ( mode & ( EXPL_MODE_SHIP | EXPL_MODE_ALERT ) )
+      expl_resolvePilots( start, n, x1, y1, x2, y2 );
+
+   /* Explosion affects missiles. Bolts can't be hit, so they are not in the
+    * weapon quadtree and EXPL_MODE_BOLT has nothing to act on. */
+   if ( mode & EXPL_MODE_MISSILE )
+      expl_resolveWeapons( start, n, x1, y1, x2, y2 );
+}
+
+/**
+ * @brief Damages the pilots caught in a batch of explosions.
+ *
+ *    @param start First explosion of the batch in the queue.
+ *    @param n Number of explosions in the batch.
+ *    @param x1 Left of the bounding box of the batch.
+ *    @param y1 Bottom of the bounding box of the batch.
+ *    @param x2 Right of the bounding box of the batch.
+ *    @param y2 Top of the bounding box of the batch.
+ */
+static void expl_resolvePilots( int start, int n, int x1, int y1, int x2,
+                                int y2 )
+{
+   pilot_collideQueryIL( &expl_qtquery, x1, y1, x2, y2 );
+   for ( int i = 0; i < il_size( &expl_qtquery ); i++ ) {
+      /* The stack may move if pilots get added by hooks. */
+      Pilot *p = pilot_getAll()[il_get( &expl_qtquery, i, 0 )];
+
+      for ( int j = start; j < start + n; j++ ) {
+         const Explosion *e = &expl_queue[j];
+         double           rx, ry, dist, rad2;
+         Solid            s; /* Only need to manipulate mass and vel. */
+         Damage           ddmg;
+
+         /* Asteroid blowing up nearby. */
+         if ( e->mode & EXPL_MODE_ALERT ) {
+            rx = p->solid.pos.x - e->x;
+            ry = p->solid.pos.y - e->y;
+            if ( pow2( rx ) + pow2( ry ) > pow2( e->radius ) )
+               continue;
+            lua_pushasteroid( naevL, e->asteroid );
+            pilot_msg( NULL, p, "asteroid", -1 );
+            lua_pop( naevL, 1 );
+            continue;
+         }
+
+         if ( !( e->mode & EXPL_MODE_SHIP ) )
+            continue;
+
+         /* Weapons hit what they touch, hooks may queue explosions so it has
+          * to be copied. */
+         if ( e->weapon ) {
+            WeaponExplosion we = e->w;
+            ddmg               = e->dmg;
+            weapon_explodePilot( &we, e->radius, &ddmg, p );
+            continue;
+         }
+
+         /* Calculate a bit. */
+         rx   = p->solid.pos.x - e->x;
+         ry   = p->solid.pos.y - e->y;
+         dist = pow2( rx ) + pow2( ry );
+         /* Take into account ship size. */
+         dist -= pow2( p->ship->size );
+         dist = MAX( 0, dist );
+
+         /* Pilot is not hit. */
+         rad2 = pow2( e->radius );
+         if ( dist > rad2 )
+            continue;
+
+         /* Adjust damage based on distance. */
+         ddmg        = e->dmg;
+         ddmg.damage = e->dmg.damage * ( 1. - sqrt( dist / rad2 ) );
+
+         /* Impact settings. */
+         s.mass  = pow2( e->dmg.damage ) / 30.;
+         s.vel.x = rx;
+         s.vel.y = ry;
+
+         /* Actual damage calculations. */
+         pilot_hit( p, &s, pilot_get( e->parent ), &ddmg, NULL, LUA_NOREF, 1 );
+
+         /* Shock wave from the explosion. */
+         if ( pilot_isPlayer( p ) )
+            spfx_shake( pow2( ddmg.damage ) / pow2( 100. ) );
+      }
+   }
+}
+
+/**
+ * @brief Damages the missiles caught in a batch of explosions.
+ *
+ *    @param start First explosion of the batch in the queue.
+ *    @param n Number of explosions in the batch.
+ *    @param x1 Left of the bounding box of the batch.
+ *    @param y1 Bottom of the bounding box of the batch.
+ *    @param x2 Right of the bounding box of the batch.
+ *    @param y2 Top of the bounding box of the batch.
+ */
+static void expl_resolveWeapons( int start, int n, int x1, int y1, int x2,
+                                 int y2 )
+{
+   weapon_collideQueryIL( &expl_qtquery, x1, y1, x2, y2 );
+   for ( int i = 0; i < il_size( &expl_qtquery ); i++ ) {
+      /* The stack may move if weapons get fired by hooks. */
+      Weapon          *w   = &weapon_getStack()[il_get( &expl_qtquery, i, 0 )];
+      const OutfitGFX *gfx = outfit_gfx( w->outfit );
+      double           size;
+
+      if ( !outfit_isLauncher( w->outfit ) )
+         continue;
+
+      size = ( gfx->tex != NULL ) ? gfx->size : gfx->col_size;
+      for ( int j = start; j < start + n; j++ ) {
+         const Explosion *e = &expl_queue[j];
+         double           dist, rad2;
+         Damage           ddmg;
+
+         if ( weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) )
+            break;
+
+         if ( !( e->mode & EXPL_MODE_MISSILE ) )
+            continue;
+
+         /* Point defense of exploding weapons, copied like with the ships. */
+         if ( e->weapon ) {
+            WeaponExplosion we = e->w;
+            ddmg               = e->dmg;
+            weapon_explodeWeapon( &we, e->radius, &ddmg, w );
+            continue;
+         }
+
+         /* Same falloff as with the ships. */
+         dist = pow2( w->solid.pos.x - e->x ) + pow2( w->solid.pos.y - e->y );
+         dist = MAX( 0, dist - pow2( size ) );
+         rad2 = pow2( e->radius );
+         if ( dist > rad2 )
+            continue;
+
+         ddmg        = e->dmg;
+         ddmg.damage = e->dmg.damage * ( 1. - sqrt( dist / rad2 ) );
+         weapon_damage( w, &ddmg );
+      }
+   }
 }
@@ -5,12 +5,27 @@
 
 #include "outfit.h"
 #include "pilot.h"
+#include "weapon.h"
 
 #define EXPL_MODE_SHIP ( 1 << 0 )    /**< Affects ships. */
 #define EXPL_MODE_MISSILE ( 1 << 1 ) /**< Affects missiles. */
 #define EXPL_MODE_BOLT ( 1 << 2 )    /**< Affects bolts. */
 
+/* Setup. */
+void expl_init( void );
+void expl_clear( void );
+void expl_exit( void );
+
+/* Lookups. */
+int expl_spfx( double radius );
+int expl_dtype( void );
+
+/* Explosions. */
 void expl_explode( double x, double y, double vx, double vy, double radius,
                    const Damage *dmg, const Pilot *parent, int mode );
 void expl_explodeDamage( double x, double y, double radius, const Damage *dmg,
                          const Pilot *parent, int mode );
+void expl_explodeWeapon( const Weapon *w, double radius, const Damage *dmg,
+                         int mode );
+void expl_alertAsteroid( const vec2 *pos, double range, int field, int id );
+void expl_update( void );
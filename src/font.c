@@ -42,6 +42,10 @@
 #define DEFAULT_TEXTURE_SIZE                                                   \
    1024             /**< Default size of texture caches for glyphs. */
 #define MAX_ROWS 64 /**< Max number of rows per texture cache. */
+#define RUN_CACHE_SETS 64 /**< Number of sets in the layout cache. */
+#define RUN_CACHE_WAYS 4  /**< Number of layouts per cache set. */
+#define RUN_CACHE_MAXLEN                                                       \
+   256 /**< Strings longer than this (in bytes) are not cached. */
 
 /**
  * OpenGL rendering stuff. Since we can't actually render with multiple threads
@@ -52,6 +56,7 @@ static FT_Library font_library = NULL; /**< Global FreeType library. */
 static FT_UInt
    prev_glyph_index; /**< Index of last character drawn (for kerning). */
 static int prev_glyph_ft_index; /**< HACK: Index into which stsh->ft[_].face? */
+static GLfloat font_pen_x; /**< Pen position along the line in font units. */
 
 /**
  * @brief Stores the row information for a font.
@@ -135,10 +140,8 @@ typedef struct glFontStash_s {
    int          tw;            /**< Width of textures. */
    int          th;            /**< Height of textures. */
    glFontTex   *tex;           /**< Textures. */
-   gl_vbo      *vbo_tex;       /**< VBO associated to texture coordinates. */
-   gl_vbo      *vbo_vert;      /**< VBO associated to vertex coordinates. */
-   GLfloat     *vbo_tex_data;  /**< Copy of texture coordinate data. */
-   GLshort     *vbo_vert_data; /**< Copy of vertex coordinate data. */
+   GLfloat     *vbo_tex_data;  /**< Texture coordinates of the glyph quads. */
+   GLshort     *vbo_vert_data; /**< Vertex coordinates of the glyph quads. */
    int          nvbo;          /**< Amount of vbo data. */
    int          mvbo;          /**< Amount of vbo memory. */
    glFontGlyph *glyphs;        /**< Unicode glyphs. */
@@ -150,6 +153,41 @@ typedef struct glFontStash_s {
    int refcount; /**< Reference counting. */
 } glFontStash;
 
+/**
+ * @brief Vertex of a glyph quad queued for rendering.
+ */
+typedef struct glFontVertex_s {
+   GLfloat x;      /**< X position in font units, with the pen applied. */
+   GLfloat y;      /**< Y position in font units. */
+   GLfloat s;      /**< Texture X coordinate. */
+   GLfloat t;      /**< Texture Y coordinate. */
+   GLfloat m;      /**< Distance units corresponding to 1 "pixel". */
+   GLfloat col[4]; /**< Fill colour. */
+} glFontVertex;
+
+/**
+ * @brief Element of a laid out string.
+ */
+typedef struct glFontRunGlyph_s {
+   GLfloat  x;     /**< Pen position in font units. */
+   int      glyph; /**< Index into the stash glyphs, -1 for a colour code. */
+   uint32_t code;  /**< Colour code operand if glyph is -1. */
+} glFontRunGlyph;
+
+/**
+ * @brief Cached layout of a string, reused when it gets drawn or measured
+ * again.
+ */
+typedef struct glFontRun_s {
+   char        *text;  /**< Text laid out, NULL if the entry is empty. */
+   uint32_t     hash;  /**< Hash of the text. */
+   int          stsh;  /**< Index of the font stash. */
+   unsigned int used;  /**< Last use tick, for eviction. */
+   int          width; /**< Width like gl_printWidthRaw, -1 if unknown. */
+   glFontRunGlyph *glyphs; /**< Array (array.h): Layout like gl_printRaw, NULL
+                              if unknown. */
+} glFontRun;
+
 /**
  * Available fonts stashes.
  */
@@ -166,6 +204,17 @@ static const glColour *font_lastCol =
    NULL; /**< Stores last colour used (activated by FONT_COLOUR_CODE). */
 static int font_restoreLast = 0; /**< Restore last colour. */
 
+/* Glyph batching. */
+static gl_vbo            *font_batch_vbo  = NULL; /**< Batch stream VBO. */
+static glFontVertex      *font_batch      = NULL; /**< Array (array.h). */
+static const glFontStash *font_batch_stsh = NULL; /**< Stash being drawn. */
+static int                font_batch_tex  = -1;   /**< Texture of the batch. */
+static GLfloat            font_batch_col[4];      /**< Current fill colour. */
+
+/* Layout cache. */
+static glFontRun font_runs[RUN_CACHE_SETS][RUN_CACHE_WAYS]; /**< LRU cache. */
+static unsigned int font_runs_tick = 0; /**< Cache use counter. */
+
 /*
  * prototypes
  */
@@ -178,11 +227,8 @@ static uint32_t        font_nextChar( const char *s, size_t *i );
 /* Get unicode glyphs from cache. */
 static glFontGlyph *gl_fontGetGlyph( glFontStash *stsh, uint32_t ch );
 /* Render.
- * TODO this should be changed to be more like font-stash
- * (https://github.com/akrinke/Font-Stash) In particular, instead of writing
- * char by char, they should be batched up by textures and rendered when
- * gl_fontRenderEnd() is called, saving lots of opengl calls.
- */
+ * Glyphs are batched up by texture and drawn when the texture changes or
+ * gl_fontRenderEnd() is called. */
 static void gl_fontRenderStart( const glFontStash *stsh, double x, double y,
                                 const glColour *c, double outlineR );
 static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
@@ -190,6 +236,16 @@ static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
 static int  gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
                                 const glColour *c, int state );
 static void gl_fontRenderEnd( void );
+static int  gl_fontLayoutGlyph( glFontStash *stsh, uint32_t ch, int state,
+                                glFontRunGlyph *out );
+static void gl_fontRenderRunGlyph( const glFontStash    *stsh,
+                                   const glFontRunGlyph *g, const glColour *c );
+static void gl_fontBatchColour( const glColour *col, double a );
+static void gl_fontBatchFlush( void );
+/* Layout cache. */
+static glFontRun *gl_fontGetRun( const glFontStash *stsh, const char *text );
+static void       gl_fontRunLayout( glFontStash *stsh, glFontRun *run );
+static void       gl_fontFlushRuns( const glFontStash *stsh );
 /* Fussy layout concerns. */
 static void gl_fontKernStart( void );
 static int  gl_fontKernGlyph( glFontStash *stsh, uint32_t ch,
@@ -374,9 +430,6 @@ static int gl_fontAddGlyphTex( glFontStash *stsh, font_char_t *ch,
    vbo_vert[5] = vy;
    vbo_vert[6] = vx + vw; /* Bottom right. */
    vbo_vert[7] = vy;
-   /* Update vbos. */
-   gl_vboData( stsh->vbo_tex, sizeof( GLfloat ) * n, stsh->vbo_tex_data );
-   gl_vboData( stsh->vbo_vert, sizeof( GLshort ) * n, stsh->vbo_vert_data );
 
    /* Add space for the new character. */
    gr->x += ch->w;
@@ -385,12 +438,6 @@ static int gl_fontAddGlyphTex( glFontStash *stsh, font_char_t *ch,
    glyph->vbo_id    = ( n - 8 ) / 2;
    glyph->tex_index = tex - stsh->tex;
 
-   /* Since the VBOs have possibly changed, we have to reset the data. */
-   gl_vboActivateAttribOffset( stsh->vbo_vert, shaders.font.vertex, 0, 2,
-                               GL_SHORT, 0 );
-   gl_vboActivateAttribOffset( stsh->vbo_tex, shaders.font.tex_coord, 0, 2,
-                               GL_FLOAT, 0 );
-
    return 0;
 }
 
@@ -648,9 +695,10 @@ static uint32_t font_nextChar( const char *s, size_t *i )
 void gl_printRaw( const glFont *ft_font, double x, double y, const glColour *c,
                   double outlineR, const char *text )
 {
-   int      s;
-   size_t   i;
-   uint32_t ch;
+   int        s;
+   size_t     i;
+   uint32_t   ch;
+   glFontRun *run;
    NTracingZone( _ctx, 1 );
 
    if ( ft_font == NULL )
@@ -658,11 +706,19 @@ void gl_printRaw( const glFont *ft_font, double x, double y, const glColour *c,
    glFontStash *stsh = gl_fontGetStash( ft_font );
 
    /* Render it. */
-   s = 0;
-   i = 0;
    gl_fontRenderStart( stsh, x, y, c, outlineR );
-   while ( ( ch = u8_nextchar( text, &i ) ) )
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   run = gl_fontGetRun( stsh, text );
+   if ( run != NULL ) {
+      if ( run->glyphs == NULL )
+         gl_fontRunLayout( stsh, run );
+      for ( int j = 0; j < array_size( run->glyphs ); j++ )
+         gl_fontRenderRunGlyph( stsh, &run->glyphs[j], c );
+   } else {
+      s = 0;
+      i = 0;
+      while ( ( ch = u8_nextchar( text, &i ) ) )
+         s = gl_fontRenderGlyph( stsh, ch, c, s );
+   }
    gl_fontRenderEnd();
 
    NTracingZoneEnd( _ctx );
@@ -682,9 +738,10 @@ void gl_printRaw( const glFont *ft_font, double x, double y, const glColour *c,
 void gl_printRawH( const glFont *ft_font, const mat4 *H, const glColour *c,
                    const double outlineR, const char *text )
 {
-   int      s;
-   size_t   i;
-   uint32_t ch;
+   int        s;
+   size_t     i;
+   uint32_t   ch;
+   glFontRun *run;
    NTracingZone( _ctx, 1 );
 
    if ( ft_font == NULL )
@@ -692,11 +749,19 @@ void gl_printRawH( const glFont *ft_font, const mat4 *H, const glColour *c,
    glFontStash *stsh = gl_fontGetStash( ft_font );
 
    /* Render it. */
-   s = 0;
-   i = 0;
    gl_fontRenderStartH( stsh, H, c, outlineR );
-   while ( ( ch = u8_nextchar( text, &i ) ) )
-      s = gl_fontRenderGlyph( stsh, ch, c, s );
+   run = gl_fontGetRun( stsh, text );
+   if ( run != NULL ) {
+      if ( run->glyphs == NULL )
+         gl_fontRunLayout( stsh, run );
+      for ( int j = 0; j < array_size( run->glyphs ); j++ )
+         gl_fontRenderRunGlyph( stsh, &run->glyphs[j], c );
+   } else {
+      s = 0;
+      i = 0;
+      while ( ( ch = u8_nextchar( text, &i ) ) )
+         s = gl_fontRenderGlyph( stsh, ch, c, s );
+   }
    gl_fontRenderEnd();
 
    NTracingZoneEnd( _ctx );
@@ -985,15 +1050,23 @@ int gl_printText( const glFont *ft_font, const int width, const int height,
  */
 int gl_printWidthRaw( const glFont *ft_font, const char *text )
 {
-   GLfloat  n, nmax;
-   size_t   i;
-   uint32_t ch;
+   GLfloat    n, nmax;
+   size_t     i;
+   uint32_t   ch;
+   glFontRun *run;
    NTracingZone( _ctx, 1 );
 
    if ( ft_font == NULL )
       ft_font = &gl_defFont;
    glFontStash *stsh = gl_fontGetStash( ft_font );
 
+   /* See if it was already measured. */
+   run = gl_fontGetRun( stsh, text );
+   if ( ( run != NULL ) && ( run->width >= 0 ) ) {
+      NTracingZoneEnd( _ctx );
+      return run->width;
+   }
+
    gl_fontKernStart();
    nmax = n = 0.;
    i        = 0;
@@ -1011,6 +1084,8 @@ int gl_printWidthRaw( const glFont *ft_font, const char *text )
       n += gl_fontKernGlyph( stsh, ch, glyph ) + glyph->adv_x;
    }
    nmax = MAX( nmax, n );
+   if ( run != NULL )
+      run->width = (int)round( nmax );
 
    NTracingZoneEnd( _ctx );
    return (int)round( nmax );
@@ -1268,7 +1343,7 @@ static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
       col = c;
 
    glUseProgram( shaders.font.program );
-   gl_uniformAColour( shaders.font.colour, col, a );
+   gl_fontBatchColour( col, a );
    if ( outlineR == 0. )
       gl_uniformAColour( shaders.font.outline_colour, col, 0. );
    else
@@ -1277,17 +1352,21 @@ static void gl_fontRenderStartH( const glFontStash *stsh, const mat4 *H,
    scale               = (double)stsh->h / FONT_DISTANCE_FIELD_SIZE;
    font_projection_mat = *H;
    mat4_scale( &font_projection_mat, scale, scale, 1 );
+   gl_uniformMat4( shaders.font.projection, &font_projection_mat );
 
    font_restoreLast = 0;
+   font_pen_x       = 0.;
    gl_fontKernStart();
 
-   /* Activate the appropriate VBOs. */
+   /* Set up the batch. */
+   font_batch_stsh = stsh;
+   font_batch_tex  = -1;
+   if ( font_batch == NULL )
+      font_batch = array_create( glFontVertex );
    glEnableVertexAttribArray( shaders.font.vertex );
-   gl_vboActivateAttribOffset( stsh->vbo_vert, shaders.font.vertex, 0, 2,
-                               GL_SHORT, 0 );
    glEnableVertexAttribArray( shaders.font.tex_coord );
-   gl_vboActivateAttribOffset( stsh->vbo_tex, shaders.font.tex_coord, 0, 2,
-                               GL_FLOAT, 0 );
+   glEnableVertexAttribArray( shaders.font.glyph_m );
+   glEnableVertexAttribArray( shaders.font.glyph_colour );
 
    /* Depth testing is used to draw the outline under the glyph. */
    if ( outlineR > 0. )
@@ -1471,29 +1550,31 @@ static int gl_fontKernGlyph( glFontStash *stsh, uint32_t ch,
 }
 
 /**
- * @brief Renders a character.
+ * @brief Lays out a character, handling escape sequences and kerning.
+ *
+ *    @param stsh Font stash to use.
+ *    @param ch Character to lay out.
+ *    @param state Escape sequence state.
+ *    @param[out] out Laid out element, its glyph is set to -2 if there is
+ *                nothing to render.
+ *    @return New escape sequence state.
  */
-static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
-                               const glColour *c, int state )
+static int gl_fontLayoutGlyph( glFontStash *stsh, uint32_t ch, int state,
+                               glFontRunGlyph *out )
 {
    double       scale;
    int          kern_adv_x;
    glFontGlyph *glyph;
 
+   out->glyph = -2;
+
    /* Handle escape sequences. */
    if ( ( ch == FONT_COLOUR_CODE ) && ( state == 0 ) ) { /* Start sequence. */
       return 1;
    }
    if ( ( state == 1 ) && ( ch != FONT_COLOUR_CODE ) ) {
-      const glColour *col = gl_fontGetColour( ch );
-      double          a   = ( c == NULL ) ? 1. : c->a;
-      if ( col != NULL )
-         gl_uniformAColour( shaders.font.colour, col, a );
-      else if ( c == NULL )
-         gl_uniformColour( shaders.font.colour, &cWhite );
-      else
-         gl_uniformColour( shaders.font.colour, c );
-      font_lastCol = col;
+      out->glyph = -1;
+      out->code  = ch;
       return 0;
    }
 
@@ -1508,22 +1589,128 @@ static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
    /* Kern if possible. */
    scale      = (double)stsh->h / FONT_DISTANCE_FIELD_SIZE;
    kern_adv_x = gl_fontKernGlyph( stsh, ch, glyph );
-   if ( kern_adv_x )
-      mat4_translate_x( &font_projection_mat, kern_adv_x / scale );
+   font_pen_x += kern_adv_x / scale;
 
-   /* Activate texture. */
-   glBindTexture( GL_TEXTURE_2D, stsh->tex[glyph->tex_index].id );
+   out->glyph = glyph - stsh->glyphs;
+   out->x     = font_pen_x;
 
-   glUniform1f( shaders.font.m, glyph->m );
-   gl_uniformMat4( shaders.font.projection, &font_projection_mat );
+   /* Advance the pen. */
+   font_pen_x += glyph->adv_x / scale;
+
+   return 0;
+}
 
-   /* Draw the element. */
-   glDrawArrays( GL_TRIANGLE_STRIP, glyph->vbo_id, 4 );
+/**
+ * @brief Queues a laid out element for rendering.
+ *
+ *    @param stsh Font stash being rendered.
+ *    @param g Element to render.
+ *    @param c Base colour of the text.
+ */
+static void gl_fontRenderRunGlyph( const glFontStash    *stsh,
+                                   const glFontRunGlyph *g, const glColour *c )
+{
+   /* Strip order is top left, top right, bottom left, bottom right. */
+   static const int strip[6] = { 0, 1, 2, 2, 1, 3 };
+   const glFontGlyph *glyph;
+   const GLshort     *vert;
+   const GLfloat     *tex;
+
+   /* Colour change. */
+   if ( g->glyph == -1 ) {
+      const glColour *col = gl_fontGetColour( g->code );
+      if ( col != NULL )
+         gl_fontBatchColour( col, ( c == NULL ) ? 1. : c->a );
+      else if ( c == NULL )
+         gl_fontBatchColour( &cWhite, cWhite.a );
+      else
+         gl_fontBatchColour( c, c->a );
+      font_lastCol = col;
+      return;
+   }
+   if ( g->glyph < 0 )
+      return;
 
-   /* Translate matrix. */
-   mat4_translate_x( &font_projection_mat, glyph->adv_x / scale );
+   /* Draw what we have so far if the texture changes. */
+   glyph = &stsh->glyphs[g->glyph];
+   if ( glyph->tex_index != font_batch_tex ) {
+      gl_fontBatchFlush();
+      font_batch_tex = glyph->tex_index;
+   }
 
-   return 0;
+   /* Add the quad as two triangles. */
+   vert = &stsh->vbo_vert_data[2 * glyph->vbo_id];
+   tex  = &stsh->vbo_tex_data[2 * glyph->vbo_id];
+   for ( int i = 0; i < 6; i++ ) {
+      glFontVertex *v = &array_grow( &font_batch );
+      v->x            = vert[2 * strip[i] + 0] + g->x;
+      v->y            = vert[2 * strip[i] + 1];
+      v->s            = tex[2 * strip[i] + 0];
+      v->t            = tex[2 * strip[i] + 1];
+      v->m            = glyph->m;
+      memcpy( v->col, font_batch_col, sizeof( font_batch_col ) );
+   }
+}
+
+/**
+ * @brief Sets the fill colour of the following glyphs.
+ */
+static void gl_fontBatchColour( const glColour *col, double a )
+{
+   font_batch_col[0] = col->r;
+   font_batch_col[1] = col->g;
+   font_batch_col[2] = col->b;
+   font_batch_col[3] = a;
+}
+
+/**
+ * @brief Renders a character.
+ */
+static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
+                               const glColour *c, int state )
+{
+   glFontRunGlyph g;
+   state = gl_fontLayoutGlyph( stsh, ch, state, &g );
+   gl_fontRenderRunGlyph( stsh, &g, c );
+   return state;
+}
+
+/**
+ * @brief Draws all the queued glyphs.
+ */
+static void gl_fontBatchFlush( void )
+{
+   GLsizei n = array_size( font_batch );
+   GLsizei size;
+
+   if ( n == 0 )
+      return;
+
+   /* Upload. */
+   size = sizeof( glFontVertex ) * n;
+   if ( font_batch_vbo == NULL )
+      font_batch_vbo = gl_vboCreateStream( size, font_batch );
+   else
+      gl_vboData( font_batch_vbo, size, font_batch );
+   gl_vboActivateAttribOffset( font_batch_vbo, shaders.font.vertex,
+                               offsetof( glFontVertex, x ), 2, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_batch_vbo, shaders.font.tex_coord,
+                               offsetof( glFontVertex, s ), 2, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_batch_vbo, shaders.font.glyph_m,
+                               offsetof( glFontVertex, m ), 1, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+   gl_vboActivateAttribOffset( font_batch_vbo, shaders.font.glyph_colour,
+                               offsetof( glFontVertex, col ), 4, GL_FLOAT,
+                               sizeof( glFontVertex ) );
+
+   /* Draw. */
+   glBindTexture( GL_TEXTURE_2D, font_batch_stsh->tex[font_batch_tex].id );
+   glDrawArrays( GL_TRIANGLES, 0, n );
+
+   array_erase( &font_batch, array_begin( font_batch ),
+                array_end( font_batch ) );
 }
 
 /**
@@ -1531,8 +1718,13 @@ static int gl_fontRenderGlyph( glFontStash *stsh, uint32_t ch,
  */
 static void gl_fontRenderEnd( void )
 {
+   gl_fontBatchFlush();
+   font_batch_stsh = NULL;
+
    glDisableVertexAttribArray( shaders.font.vertex );
    glDisableVertexAttribArray( shaders.font.tex_coord );
+   glDisableVertexAttribArray( shaders.font.glyph_m );
+   glDisableVertexAttribArray( shaders.font.glyph_colour );
    glUseProgram( 0 );
 
    glDisable( GL_DEPTH_TEST );
@@ -1541,6 +1733,108 @@ static void gl_fontRenderEnd( void )
    gl_checkErr();
 }
 
+/**
+ * @brief Hashes a string, FNV-1a.
+ */
+static uint32_t font_hashstr( const char *str )
+{
+   uint32_t h = 2166136261u;
+   for ( const unsigned char *c = (const unsigned char *)str; *c != '\0'; c++ )
+      h = ( h ^ *c ) * 16777619u;
+   return h;
+}
+
+/**
+ * @brief Gets the cached layout of a string, allocating an empty one if it
+ * isn't cached.
+ *
+ *    @param stsh Font stash being used.
+ *    @param text Text to look up.
+ *    @return The cache entry or NULL if the text can't be cached.
+ */
+static glFontRun *gl_fontGetRun( const glFontStash *stsh, const char *text )
+{
+   glFontRun *set, *run;
+   uint32_t   hash;
+   int        id = stsh - avail_fonts;
+
+   if ( ( text == NULL ) || ( strlen( text ) > RUN_CACHE_MAXLEN ) )
+      return NULL;
+
+   /* Look for a hit. */
+   hash = font_hashstr( text );
+   set  = font_runs[hashint( hash ^ id ) & ( RUN_CACHE_SETS - 1 )];
+   font_runs_tick++;
+   run = &set[0];
+   for ( int i = 0; i < RUN_CACHE_WAYS; i++ ) {
+      glFontRun *r = &set[i];
+      if ( ( r->text != NULL ) && ( r->hash == hash ) && ( r->stsh == id ) &&
+           ( strcmp( r->text, text ) == 0 ) ) {
+         r->used = font_runs_tick;
+         return r;
+      }
+      /* Keep track of the least recently used. */
+      if ( ( r->text == NULL ) ||
+           ( ( run->text != NULL ) && ( r->used < run->used ) ) )
+         run = r;
+   }
+
+   /* Evict and reuse. */
+   free( run->text );
+   array_free( run->glyphs );
+   run->text   = strdup( text );
+   run->hash   = hash;
+   run->stsh   = id;
+   run->used   = font_runs_tick;
+   run->width  = -1;
+   run->glyphs = NULL;
+   return run;
+}
+
+/**
+ * @brief Lays out a cache entry as it would be rendered by gl_printRaw.
+ *
+ *    @param stsh Font stash being used.
+ *    @param run Entry to lay out.
+ */
+static void gl_fontRunLayout( glFontStash *stsh, glFontRun *run )
+{
+   int      s = 0;
+   size_t   i = 0;
+   uint32_t ch;
+   GLfloat  pen = font_pen_x;
+
+   run->glyphs = array_create( glFontRunGlyph );
+   font_pen_x  = 0.;
+   gl_fontKernStart();
+   while ( ( ch = u8_nextchar( run->text, &i ) ) ) {
+      glFontRunGlyph g;
+      s = gl_fontLayoutGlyph( stsh, ch, s, &g );
+      if ( g.glyph != -2 )
+         array_push_back( &run->glyphs, g );
+   }
+   font_pen_x = pen;
+}
+
+/**
+ * @brief Drops cached layouts.
+ *
+ *    @param stsh Only drop layouts of this font stash, or all if NULL.
+ */
+static void gl_fontFlushRuns( const glFontStash *stsh )
+{
+   for ( int i = 0; i < RUN_CACHE_SETS; i++ ) {
+      for ( int j = 0; j < RUN_CACHE_WAYS; j++ ) {
+         glFontRun *run = &font_runs[i][j];
+         if ( ( stsh != NULL ) && ( run->stsh != stsh - avail_fonts ) )
+            continue;
+         free( run->text );
+         array_free( run->glyphs );
+         memset( run, 0, sizeof( glFontRun ) );
+      }
+   }
+}
+
 /**
  * @brief Sets the minification and magnification filters for a font.
  *
@@ -1659,14 +1953,10 @@ int gl_fontInit( glFont *font, const char *fname, const unsigned int h,
    stsh->glyphs = array_create( glFontGlyph );
    stsh->tex    = array_create( glFontTex );
 
-   /* Set up VBOs. */
+   /* Set up glyph quad data. */
    stsh->mvbo          = 256;
    stsh->vbo_tex_data  = calloc( 8 * stsh->mvbo, sizeof( GLfloat ) );
    stsh->vbo_vert_data = calloc( 8 * stsh->mvbo, sizeof( GLshort ) );
-   stsh->vbo_tex       = gl_vboCreateStatic( sizeof( GLfloat ) * 8 * stsh->mvbo,
-                                             stsh->vbo_tex_data );
-   stsh->vbo_vert      = gl_vboCreateStatic( sizeof( GLshort ) * 8 * stsh->mvbo,
-                                             stsh->vbo_vert_data );
 
    return 0;
 }
@@ -1702,6 +1992,9 @@ int gl_fontAddFallback( glFont *font, const char *fname, const char *prefix )
       }
    }
 
+   /* Missing glyphs may now be found. */
+   gl_fontFlushRuns( stsh );
+
    return ret;
 }
 
@@ -1806,8 +2099,7 @@ void gl_freeFont( glFont *font )
    array_free( stsh->tex );
 
    array_free( stsh->glyphs );
-   gl_vboDestroy( stsh->vbo_tex );
-   gl_vboDestroy( stsh->vbo_vert );
+   gl_fontFlushRuns( stsh );
    free( stsh->vbo_tex_data );
    free( stsh->vbo_vert_data );
 
@@ -1835,6 +2127,11 @@ static void gl_fontstashftDestroy( glFontStashFreetype *ft )
  */
 void gl_fontExit( void )
 {
+   gl_fontFlushRuns( NULL );
+   array_free( font_batch );
+   font_batch = NULL;
+   gl_vboDestroy( font_batch_vbo );
+   font_batch_vbo = NULL;
    FT_Done_FreeType( font_library );
    font_library = NULL;
    array_free( avail_fonts );
@@ -17,6 +17,7 @@
 
 #include "array.h"
 #include "hook.h"
+#include "physics.h"
 #include "player.h"
 #include "rng.h"
 
@@ -157,8 +158,10 @@ void gatherable_render( void )
 {
    for ( int i = 0; i < array_size( gatherable_stack ); i++ ) {
       const Gatherable *gat = &gatherable_stack[i];
-      gl_renderSprite( gat->type->gfx_space, gat->pos.x, gat->pos.y, gat->sx,
-                       gat->sy, NULL );
+      vec2              pos;
+      solid_renderPosVec( &pos, &gat->pos, &gat->vel );
+      gl_renderSprite( gat->type->gfx_space, pos.x, pos.y, gat->sx, gat->sy,
+                       NULL );
    }
 }
 
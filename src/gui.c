@@ -414,10 +414,13 @@ static void gui_renderSpobTarget( void )
       const AsteroidAnchor *field =
          &cur_system->asteroids[player.p->nav_anchor];
       const Asteroid *ast = &field->asteroids[player.p->nav_asteroid];
-      c                   = &cWhite;
+      vec2            pos;
+      c = &cWhite;
 
-      x = ast->sol.pos.x;
-      y = ast->sol.pos.y;
+      /* Around where the asteroid is drawn. */
+      solid_renderPos( &pos, &ast->sol, &ast->sol.vel );
+      x = pos.x;
+      y = pos.y;
       r = ast->gfx->sw * 0.5;
       gui_renderTargetReticles( &shaders.targetship, x, y, r, 0., c );
    }
@@ -458,6 +461,7 @@ static void gui_renderPilotTarget( void )
 {
    Pilot          *p;
    const glColour *c;
+   vec2            pos;
 
    /* Player is most likely dead. */
    if ( gui_target_pilot == NULL )
@@ -493,9 +497,10 @@ static void gui_renderPilotTarget( void )
    else
       c = &cNeutral;
 
-   gui_renderTargetReticles( &shaders.targetship, p->solid.pos.x,
-                             p->solid.pos.y, p->ship->size * 0.5, p->solid.dir,
-                             c );
+   /* Around where the pilot is drawn. */
+   solid_renderPos( &pos, &p->solid, &p->solid.vel );
+   gui_renderTargetReticles( &shaders.targetship, pos.x, pos.y,
+                             p->ship->size * 0.5, p->solid.dir, c );
 }
 
 /**
@@ -53,6 +53,8 @@ static iar_data_t iar_data[OUTFITS_NTABS]; /**< Stored image array positions. */
 static Outfit *
    *iar_outfits[OUTFITS_NTABS]; /**< C-array of Arrays: Outfits associated with
                                    the image array cells. */
+static char *outfits_lastFilter[OUTFITS_NTABS]; /**< Filter text iar_outfits
+                                                   was last narrowed with. */
 static int             outfit_Mode = 0; /**< Outfit mode for filtering. */
 static PlayerOutfit_t *outfits_sold =
    NULL; /**< List of the outfits the player sold so they can buy them back. */
@@ -74,7 +76,10 @@ static const char *outfit_getPrice( const Outfit *outfit, credits_t *price,
                                     int *canbuy, int *cansell,
                                     char **player_has );
 static void        outfit_Popdown( unsigned int wid, const char *str );
-static void        outfits_genList( unsigned int wid );
+static void        outfits_regen( unsigned int wid, int incremental );
+static void        outfits_regenFilter( unsigned int wid, const char *str );
+static void        outfits_genList( unsigned int wid, int incremental );
+static char *outfits_cellAlt( unsigned int wid, const char *name, int pos );
 static void outfits_changeTab( unsigned int wid, const char *wgt, int old,
                                int tab );
 static void outfits_onClose( unsigned int wid, const char *str );
@@ -188,8 +193,10 @@ void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket )
    for ( int i = 0; i < OUTFITS_NTABS; i++ ) {
       toolkit_initImageArrayData( &iar_data[i] );
       array_free( iar_outfits[i] );
+      free( outfits_lastFilter[i] );
    }
    memset( iar_outfits, 0, sizeof( Outfit ** ) * OUTFITS_NTABS );
+   memset( outfits_lastFilter, 0, sizeof( char * ) * OUTFITS_NTABS );
 
    /* will allow buying from keyboard */
    window_setAccept( wid, outfits_buy );
@@ -237,7 +244,7 @@ void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket )
                    0, "txtDescription", &gl_defFont, NULL, NULL );
 
    /* Create the image array. */
-   outfits_genList( wid );
+   outfits_genList( wid, 0 );
 
    /* Set default keyboard focus to the list */
    window_setFocus( wid, OUTFITS_IAR );
@@ -252,6 +259,30 @@ void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket )
 void outfits_regenList( unsigned int wid, const char *str )
 {
    (void)str;
+   outfits_regen( wid, 0 );
+}
+
+/**
+ * @brief Regenerates the outfit list when the filter text changes.
+ *
+ *   @param wid Window to generate the list on.
+ *   @param str Unused.
+ */
+static void outfits_regenFilter( unsigned int wid, const char *str )
+{
+   (void)str;
+   outfits_regen( wid, 1 );
+}
+
+/**
+ * @brief Regenerates the outfit list.
+ *
+ *   @param wid Window to generate the list on.
+ *   @param incremental Whether the previous results of the tab can be narrowed
+ * down instead of starting over.
+ */
+static void outfits_regen( unsigned int wid, int incremental )
+{
    int             tab;
    char           *focused;
    LandOutfitData *data;
@@ -272,7 +303,7 @@ void outfits_regenList( unsigned int wid, const char *str )
    toolkit_saveImageArrayData( wid, OUTFITS_IAR, &iar_data[tab] );
    window_destroyWidget( wid, OUTFITS_IAR );
 
-   outfits_genList( wid );
+   outfits_genList( wid, incremental );
 
    /* Restore positions. */
    toolkit_loadImageArrayData( wid, OUTFITS_IAR, &iar_data[tab] );
@@ -343,12 +374,27 @@ static int outfitLand_filterCore( const Outfit *o )
    return outfitLand_filter( o ) && outfit_filterCore( o );
 }
 
+/**
+ * @brief Generates the alt text of an outfit cell when it is first hovered.
+ */
+static char *outfits_cellAlt( unsigned int wid, const char *name, int pos )
+{
+   (void)name;
+   int active = window_tabWinGetActive( wid, OUTFITS_TAB );
+   if ( ( pos < 0 ) || ( pos >= array_size( iar_outfits[active] ) ) )
+      return NULL;
+   return strdup(
+      pilot_outfitSummary( player.p, iar_outfits[active][pos], 1 ) );
+}
+
 /**
  * @brief Generates the outfit list.
  *
  *    @param wid Window to generate the list on.
+ *    @param incremental Whether the previous results of the tab can be narrowed
+ * down instead of starting over.
  */
-static void outfits_genList( unsigned int wid )
+static void outfits_genList( unsigned int wid, int incremental )
 {
    int ( *tabfilters[] )( const Outfit *o ) = {
       outfitLand_filter,        outfitLand_filterWeapon,
@@ -404,7 +450,7 @@ static void outfits_genList( unsigned int wid )
          window_addInput( wid, fx, fy, fw, fh, OUTFITS_FILTER, 32, 1,
                           &gl_defFont );
          inp_setEmptyText( wid, OUTFITS_FILTER, _( "Filter…" ) );
-         window_setInputCallback( wid, OUTFITS_FILTER, outfits_regenList );
+         window_setInputCallback( wid, OUTFITS_FILTER, outfits_regenFilter );
       }
    }
 
@@ -424,9 +470,17 @@ static void outfits_genList( unsigned int wid )
 
    /* Set up the outfits to buy/sell */
    data = window_getData( wid );
-   array_free( iar_outfits[active] );
 
-   if ( active == 6 ) {
+   /* Text that contains the previous filter text can only match a subset of
+    * what it matched, so we can just filter the previous results again. */
+   if ( incremental && ( iar_outfits[active] != NULL ) &&
+        ( filtertext != NULL ) &&
+        ( SDL_strcasestr( filtertext, ( outfits_lastFilter[active] != NULL )
+                                         ? outfits_lastFilter[active]
+                                         : "" ) != NULL ) ) {
+      /* Already set up. */
+   } else if ( active == 6 ) {
+      array_free( iar_outfits[active] );
       /* Show player their owned outfits. */
       const PlayerOutfit_t *po = player_getOutfits();
       iar_outfits[active]      = array_create( Outfit      *);
@@ -449,6 +503,7 @@ static void outfits_genList( unsigned int wid )
              sizeof( Outfit * ), outfit_compareTech );
    } else {
       /* Use custom list; default to landed outfits. */
+      array_free( iar_outfits[active] );
       iar_outfits[active] = ( data->outfits != NULL )
                                ? array_copy( Outfit *, data->outfits )
                                : tech_getOutfit( land_spob->tech );
@@ -456,8 +511,12 @@ static void outfits_genList( unsigned int wid )
    noutfits = outfits_filter( (const Outfit **)iar_outfits[active],
                               array_size( iar_outfits[active] ),
                               tabfilters[active], filtertext );
+   array_resize( &iar_outfits[active], noutfits );
+   free( outfits_lastFilter[active] );
+   outfits_lastFilter[active] =
+      ( filtertext != NULL ) ? strdup( filtertext ) : NULL;
    coutfits = outfits_imageArrayCells( (const Outfit **)iar_outfits[active],
-                                       &noutfits, player.p, 1 );
+                                       &noutfits, player.p, 1, 1 );
 
    iconsize = 128;
    if ( !conf.big_icons ) {
@@ -471,6 +530,7 @@ static void outfits_genList( unsigned int wid )
    window_addImageArray( wid, 20, 20, iw, ih - 34, OUTFITS_IAR, iconsize,
                          iconsize, coutfits, noutfits, outfits_update,
                          outfits_rmouse, NULL );
+   toolkit_setImageArrayAltFunc( wid, OUTFITS_IAR, outfits_cellAlt );
 
    /* write the outfits stuff */
    outfits_update( wid, NULL );
@@ -804,9 +864,18 @@ int outfit_altText( char *buf, int n, const Outfit *o, const Pilot *plt )
 
 /**
  * @brief Generates image array cells corresponding to outfits.
+ *
+ *    @param outfits Outfits to generate cells for.
+ *    @param[in,out] noutfits Number of outfits, set to the number of cells.
+ *    @param p Pilot to generate the outfit summaries for.
+ *    @param store Whether or not the cells are for a store.
+ *    @param lazyalt Whether to leave the alt text to be generated on demand
+ * with toolkit_setImageArrayAltFunc().
+ *    @return Newly allocated cells.
  */
 ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
-                                         const Pilot *p, int store )
+                                         const Pilot *p, int store,
+                                         int lazyalt )
 {
    ImageArrayCell *coutfits =
       calloc( MAX( 1, *noutfits ), sizeof( ImageArrayCell ) );
@@ -851,7 +920,8 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
          col_blend( &coutfits[i].bg, c, &cGrey70, 1 );
 
          /* Short description. */
-         coutfits[i].alt = strdup( pilot_outfitSummary( p, o, 1 ) );
+         if ( !lazyalt )
+            coutfits[i].alt = strdup( pilot_outfitSummary( p, o, 1 ) );
 
          /* Slot type. */
          if ( ( strcmp( outfit_slotName( o ), "N/A" ) != 0 ) &&
@@ -1301,7 +1371,10 @@ static int outfits_getMod( void )
 void outfits_cleanup( void )
 {
    /* Free stored positions. */
-   for ( int i = 0; i < OUTFITS_NTABS; i++ )
+   for ( int i = 0; i < OUTFITS_NTABS; i++ ) {
       array_free( iar_outfits[i] );
+      free( outfits_lastFilter[i] );
+   }
    memset( iar_outfits, 0, sizeof( Outfit ** ) * OUTFITS_NTABS );
+   memset( outfits_lastFilter, 0, sizeof( char * ) * OUTFITS_NTABS );
 }
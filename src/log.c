@@ -7,6 +7,9 @@
  * @brief Home of logprintf.
  */
 /** @cond */
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
 #include "physfs.h"
 #include <stdarg.h>
 #include <stdio.h>
@@ -42,6 +45,59 @@ static int copying = 0;
 static PHYSFS_File *logout_file = NULL;
 static PHYSFS_File *logerr_file = NULL;
 
+/*
+ * Asynchronous logging. Once the writer is running, messages are formatted on
+ * the calling thread and copied into a ring of fixed-size slots, which the
+ * writer thread drains to the streams and log files. Producers never lock:
+ * they reserve slots by bumping log_tail and publish them through the slot
+ * sequence numbers.
+ */
+#define LOG_RING_SLOTS 2048 /**< Number of slots in the ring. */
+#define LOG_SLOT_LEN 240    /**< Bytes of text per slot. */
+#define LOG_RECORD_SLOTS 32 /**< Maximum slots per message, longer get cut. */
+#define LOG_WARN_FRAME_LIMIT 5 /**< Warnings per call site and frame. */
+#define LOG_WARN_SITES 64      /**< Call sites tracked for rate limiting. */
+#define LOG_DROPPED_INTERVAL 1000 /**< Milliseconds between drop reports. */
+
+/**
+ * @brief Slot of the log ring.
+ */
+typedef struct LogSlot_s {
+   SDL_atomic_t seq;    /**< Position + 1 once filled, position + LOG_RING_SLOTS
+                           once free again. */
+   uint8_t      err;    /**< Whether the message goes to stderr. */
+   uint8_t      newline; /**< Whether the message ends in a newline. */
+   uint16_t     nslots;  /**< Slots the message takes, set on the first one. */
+   uint16_t     len;     /**< Bytes of text in this slot. */
+   char         data[LOG_SLOT_LEN]; /**< Text. */
+} LogSlot;
+
+/**
+ * @brief Warning call site being rate limited for the current frame.
+ */
+typedef struct LogWarnSite_s {
+   const char *file;  /**< File of the call site. */
+   size_t      line;  /**< Line of the call site. */
+   int         count; /**< Warnings printed this frame. */
+} LogWarnSite;
+
+static LogSlot      log_ring[LOG_RING_SLOTS]; /**< Ring of pending messages. */
+static SDL_atomic_t log_tail; /**< Next position to reserve for producers. */
+static unsigned int log_head = 0; /**< Next position to drain. */
+static SDL_atomic_t log_dropped;  /**< Messages dropped since last report. */
+static int          log_droppedTotal = 0; /**< Messages dropped in total. */
+static Uint32       log_droppedTicks = 0; /**< Ticks of the last report. */
+static SDL_atomic_t log_running;  /**< Whether the writer thread is running. */
+static SDL_atomic_t log_limiting; /**< Whether warnings are being rate limited,
+                                     only once frames start. */
+static SDL_Thread  *log_writer = NULL; /**< Writer thread. */
+static SDL_mutex   *log_drainLock =
+   NULL; /**< Serializes draining between the writer and log_flush(). */
+static LogWarnSite  log_warnSites[LOG_WARN_SITES]; /**< Warning call sites. */
+static SDL_SpinLock log_warnLock = 0; /**< Protects log_warnSites. */
+static char log_drainBuf[LOG_RECORD_SLOTS * LOG_SLOT_LEN + 1]; /**< Reassembly
+                                                                  buffer. */
+
 /*
  * Prototypes
  */
@@ -52,6 +108,12 @@ static void log_append( const FILE *stream, const char *str );
 static void log_cleanStream( PHYSFS_File **file, const char *fname,
                              const char *filedouble );
 static void log_purge( void );
+static int  log_push( FILE *stream, int newline, const char *str, size_t n );
+static void log_drain( void );
+static int  log_writerThread( void *unused );
+static void log_startWriter( void );
+static void log_stopWriter( void );
+static int  log_warnAllowed( const char *file, size_t line );
 
 /**
  * @brief va_list version of logprintf and backend.
@@ -87,15 +149,20 @@ static int slogprintf( FILE *stream, int newline, const char *str, size_t n )
 static int vlogprintf( FILE *stream, int newline, const char *fmt, va_list ap )
 {
    va_list aq;
+   char    sbuf[LOG_SLOT_LEN];
    char   *buf;
    size_t  n;
 
-   /* Offset to add error colour header as necessary. */
+   /* Most messages fit on the stack, only allocate for long ones. */
    va_copy( aq, ap );
-   n = vsnprintf( NULL, 0, fmt, aq );
+   n = vsnprintf( sbuf, sizeof( sbuf ), fmt, aq );
    va_end( aq );
-   buf = malloc( n + 2 );
-   n   = vsnprintf( buf, n + 1, fmt, ap );
+   if ( n + 2 <= sizeof( sbuf ) )
+      buf = sbuf;
+   else {
+      buf = malloc( n + 2 );
+      n   = vsnprintf( buf, n + 1, fmt, ap );
+   }
 
    /* Finally add newline if necessary. */
    if ( newline ) {
@@ -104,11 +171,250 @@ static int vlogprintf( FILE *stream, int newline, const char *fmt, va_list ap )
    } else
       buf[n] = '\0';
 
-   slogprintf( stream, newline, buf, n );
-   free( buf );
+   if ( !log_push( stream, newline, buf, n ) )
+      slogprintf( stream, newline, buf, n );
+   if ( buf != sbuf )
+      free( buf );
    return n;
 }
 
+/**
+ * @brief Copies a message into the log ring for the writer thread.
+ *
+ *    @param stream Destination stream (stdout or stderr).
+ *    @param newline Whether or not \p str ends in a newline.
+ *    @param str Message to write.
+ *    @param n Length of the message not including the newline.
+ *    @return 1 if the message was handled, 0 if it should be written
+ * synchronously.
+ */
+static int log_push( FILE *stream, int newline, const char *str, size_t n )
+{
+   unsigned int pos;
+   size_t       len, k;
+   int          cut;
+
+   if ( !SDL_AtomicGet( &log_running ) )
+      return 0;
+
+   len = newline ? n + 1 : n;
+   k   = MAX( 1, ( len + LOG_SLOT_LEN - 1 ) / LOG_SLOT_LEN );
+   cut = ( k > LOG_RECORD_SLOTS );
+   if ( cut ) {
+      k   = LOG_RECORD_SLOTS;
+      len = k * LOG_SLOT_LEN;
+   }
+
+   /* Reserve the slots. */
+   while ( 1 ) {
+      int retry = 0;
+      pos       = (unsigned int)SDL_AtomicGet( &log_tail );
+      for ( size_t i = 0; i < k; i++ ) {
+         const LogSlot *s    = &log_ring[( pos + i ) % LOG_RING_SLOTS];
+         int            diff = (int)( (unsigned int)SDL_AtomicGet( &s->seq ) -
+                                      (unsigned int)( pos + i ) );
+         /* Ring is full, drop the message. */
+         if ( diff < 0 ) {
+            SDL_AtomicIncRef( &log_dropped );
+            return 1;
+         }
+         /* Someone else got there first. */
+         if ( diff > 0 ) {
+            retry = 1;
+            break;
+         }
+      }
+      if ( !retry && SDL_AtomicCAS( &log_tail, (int)pos, (int)( pos + k ) ) )
+         break;
+   }
+
+   /* Fill and publish them. */
+   for ( size_t i = 0; i < k; i++ ) {
+      LogSlot *s = &log_ring[( pos + i ) % LOG_RING_SLOTS];
+      size_t   o = i * LOG_SLOT_LEN;
+      s->err     = ( stream == stderr );
+      s->newline = newline;
+      s->nslots  = k;
+      s->len     = MIN( LOG_SLOT_LEN, len - o );
+      memcpy( s->data, &str[o], s->len );
+      /* Cut messages still have to end in their newline. */
+      if ( cut && newline && ( i == k - 1 ) )
+         s->data[s->len - 1] = '\n';
+      SDL_AtomicSet( &s->seq, (int)( pos + i + 1 ) );
+   }
+   return 1;
+}
+
+/**
+ * @brief Writes out all the complete messages in the log ring.
+ */
+static void log_drain( void )
+{
+   SDL_mutexP( log_drainLock );
+   while ( 1 ) {
+      const LogSlot *s = &log_ring[log_head % LOG_RING_SLOTS];
+      size_t         n, k;
+      int            err, newline;
+
+      if ( SDL_AtomicGet( &s->seq ) != (int)( log_head + 1 ) )
+         break;
+
+      /* Wait for the rest of the message to be published. */
+      k = s->nslots;
+      if ( SDL_AtomicGet( &log_ring[( log_head + k - 1 ) % LOG_RING_SLOTS]
+                              .seq ) != (int)( log_head + k ) )
+         break;
+
+      err     = s->err;
+      newline = s->newline;
+      n       = 0;
+      for ( size_t i = 0; i < k; i++ ) {
+         LogSlot *si = &log_ring[( log_head + i ) % LOG_RING_SLOTS];
+         memcpy( &log_drainBuf[n], si->data, si->len );
+         n += si->len;
+         SDL_AtomicSet( &si->seq, (int)( log_head + i + LOG_RING_SLOTS ) );
+      }
+      log_head += k;
+      log_drainBuf[n] = '\0';
+
+      slogprintf( err ? stderr : stdout, newline, log_drainBuf,
+                  newline ? n - 1 : n );
+   }
+   SDL_mutexV( log_drainLock );
+}
+
+/**
+ * @brief Background thread that drains the log ring.
+ */
+static int log_writerThread( void *unused )
+{
+   (void)unused;
+   while ( SDL_AtomicGet( &log_running ) ) {
+      log_drain();
+      SDL_Delay( 5 );
+   }
+   return 0;
+}
+
+/**
+ * @brief Starts writing the log asynchronously.
+ */
+static void log_startWriter( void )
+{
+   if ( log_writer != NULL )
+      return;
+
+   for ( int i = 0; i < LOG_RING_SLOTS; i++ )
+      SDL_AtomicSet( &log_ring[i].seq, i );
+   SDL_AtomicSet( &log_tail, 0 );
+   log_head = 0;
+
+   log_drainLock = SDL_CreateMutex();
+   SDL_AtomicSet( &log_running, 1 );
+   log_writer = SDL_CreateThread( log_writerThread, "log_writer", NULL );
+   if ( log_writer == NULL ) {
+      SDL_AtomicSet( &log_running, 0 );
+      SDL_DestroyMutex( log_drainLock );
+      log_drainLock = NULL;
+   }
+}
+
+/**
+ * @brief Stops the writer thread and writes out whatever it left behind.
+ */
+static void log_stopWriter( void )
+{
+   if ( log_writer == NULL )
+      return;
+
+   SDL_AtomicSet( &log_running, 0 );
+   SDL_WaitThread( log_writer, NULL );
+   log_writer = NULL;
+   log_drain();
+   SDL_DestroyMutex( log_drainLock );
+   log_drainLock = NULL;
+}
+
+/**
+ * @brief Writes out all pending log messages right away.
+ *
+ * Used before the program goes down, as the writer thread might not get the
+ * chance to do so.
+ */
+void log_flush( void )
+{
+   if ( !SDL_AtomicGet( &log_running ) )
+      return;
+   log_drain();
+   fflush( stdout );
+   fflush( stderr );
+}
+
+/**
+ * @brief Marks the start of a new frame.
+ *
+ * Resets the warning rate limits and reports how many messages got dropped,
+ * at most once per second. Warnings are only rate limited once this gets called, so all the warnings
+ * while loading data get printed.
+ */
+void log_frame( void )
+{
+   int    dropped;
+   Uint32 t;
+
+   SDL_AtomicSet( &log_limiting, 1 );
+   SDL_AtomicLock( &log_warnLock );
+   memset( log_warnSites, 0, sizeof( log_warnSites ) );
+   SDL_AtomicUnlock( &log_warnLock );
+
+   /* Don't flood the log with reports while it is overflowing. */
+   t = SDL_GetTicks();
+   if ( t - log_droppedTicks < LOG_DROPPED_INTERVAL )
+      return;
+   dropped = SDL_AtomicSet( &log_dropped, 0 );
+   if ( dropped <= 0 )
+      return;
+   log_droppedTicks = t;
+   log_droppedTotal += dropped;
+   logprintf( stderr, 1, _( "%d log messages were dropped (%d in total)." ),
+              dropped, log_droppedTotal );
+}
+
+/**
+ * @brief Checks to see if a warning call site still has budget this frame.
+ *
+ *    @return 1 if the warning can be printed, 0 if it was dropped.
+ */
+static int log_warnAllowed( const char *file, size_t line )
+{
+   unsigned int h = ( (uintptr_t)file ^ ( line * 2654435761u ) );
+   int          ret;
+
+   if ( !SDL_AtomicGet( &log_limiting ) )
+      return 1;
+
+   SDL_AtomicLock( &log_warnLock );
+   ret = 1;
+   for ( int i = 0; i < LOG_WARN_SITES; i++ ) {
+      LogWarnSite *ws = &log_warnSites[( h + i ) % LOG_WARN_SITES];
+      if ( ws->file == NULL ) {
+         ws->file  = file;
+         ws->line  = line;
+         ws->count = 1;
+         break;
+      }
+      if ( ( ws->file == file ) && ( ws->line == line ) ) {
+         ret = ( ++ws->count <= LOG_WARN_FRAME_LIMIT );
+         break;
+      }
+   }
+   SDL_AtomicUnlock( &log_warnLock );
+
+   if ( !ret )
+      SDL_AtomicIncRef( &log_dropped );
+   return ret;
+}
+
 /**
  * @brief Like fprintf, but automatically teed to log files (and line-terminated
  * if \p newline is true).
@@ -133,8 +439,10 @@ void log_redirect( void )
    struct tm *ts;
    char       timestr[20];
 
-   if ( !conf.redirect_file )
+   if ( !conf.redirect_file ) {
+      log_startWriter();
       return;
+   }
 
    time( &cur );
    ts = localtime( &cur );
@@ -153,6 +461,7 @@ void log_redirect( void )
    SDL_asprintf( &errfiledouble, "logs/%s_stderr.txt", timestr );
 
    log_copy( 0 );
+   log_startWriter();
 }
 
 /**
@@ -227,6 +536,7 @@ static void log_purge( void )
  */
 void log_clean( void )
 {
+   log_stopWriter();
    log_cleanStream( &logout_file, "logs/stdout.txt", outfiledouble );
    log_cleanStream( &logerr_file, "logs/stderr.txt", errfiledouble );
 }
@@ -302,9 +612,13 @@ int log_warn( const char *file, size_t line, const char *func, const char *fmt,
    static char *warn_last_msg = NULL;
    static int   warn_last_num;
    va_list      ap;
-   char        *buf;
+   char        *buf, *hdr;
    size_t       n;
 
+   /* Don't let a single call site flood the log in a frame. */
+   if ( !log_warnAllowed( file, line ) )
+      return 0;
+
    /* First do a backtrace, if possible. */
    debug_logBacktrace();
 
@@ -332,10 +646,12 @@ int log_warn( const char *file, size_t line, const char *func, const char *fmt,
       }
    }
 
-   /* Display messages. */
-   logprintf( stderr, 0, _( "WARNING %s:%lu [%s]: " ), file,
-              (unsigned long)line, func );
-   slogprintf( stderr, 1, buf, n );
+   /* Display the header and message as a single record, so messages from
+    * other threads can not end up in between. */
+   SDL_asprintf( &hdr, _( "WARNING %s:%lu [%s]: " ), file, (unsigned long)line,
+                 func );
+   logprintf( stderr, 1, "%s%.*s", hdr, (int)n, buf );
+   free( hdr );
 
    /* Reset last message. */
    free( warn_last_msg );
@@ -19,7 +19,7 @@
 #define ERR( str, ... )                                                        \
    ( logprintf( stderr, 0, _( "ERROR %s:%d [%s]: " ), __FILE__, __LINE__,      \
                 __func__ ),                                                    \
-     logprintf( stderr, 1, str, ##__VA_ARGS__ ), abort() )
+     logprintf( stderr, 1, str, ##__VA_ARGS__ ), log_flush(), abort() )
 #ifdef DEBUG
 #undef DEBUG
 #define DEBUG( str, ... ) LOG( str, ##__VA_ARGS__ )
@@ -38,5 +38,7 @@ NONNULL( 3 ) int logprintf( FILE *stream, int newline, const char *fmt, ... );
 void log_init( void );
 void log_redirect( void );
 void log_clean( void );
+void log_flush( void );
+void log_frame( void );
 int  log_warn( const char *file, size_t line, const char *func, const char *fmt,
                ... );
@@ -3,6 +3,7 @@
  */
 /** @cond */
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -86,6 +87,45 @@ typedef struct CstMapWidget_ {
    MapMode mode;             /**< Default map mode. */
 } CstMapWidget;
 
+/**
+ * @brief Vertex of a cached jump lane quad.
+ */
+typedef struct MapLaneVertex_ {
+   GLfloat lane[4];   /**< Lane end points in map coordinates. */
+   GLfloat vertex[2]; /**< Quad corner in [-1,1] coordinates. */
+   GLfloat height;    /**< Half width of the lane in pixels. */
+   GLfloat col[4];    /**< Colour at the start of the lane. */
+   GLfloat cole[4];   /**< Colour at the end of the lane. */
+} MapLaneVertex;
+
+/**
+ * @brief Vertex of a cached faction disk quad.
+ */
+typedef struct MapDiskVertex_ {
+   GLfloat centre[2]; /**< Disk centre in map coordinates. */
+   GLfloat vertex[2]; /**< Quad corner in [-1,1] coordinates. */
+   GLfloat size;      /**< Disk radius in map coordinates. */
+   GLfloat col[4];    /**< Disk colour, alpha is scaled at render time. */
+} MapDiskVertex;
+
+/**
+ * @brief Map geometry that only depends on what the player knows.
+ *
+ * Rebuilt whenever space_mapGeneration changes, so the per-frame cost of the
+ * map is a couple of draw calls instead of a pass over every system and jump.
+ */
+typedef struct MapGeometry_ {
+   int            valid;     /**< Whether or not the cache has been built. */
+   int            editor;    /**< Whether it was built for the editor. */
+   unsigned int   gen;       /**< space_mapGeneration it was built at. */
+   MapLaneVertex *lanes;     /**< Array (array.h) of jump lane vertices. */
+   MapDiskVertex *disks;     /**< Array (array.h) of faction disk vertices. */
+   int           *visible;   /**< Array (array.h) of visible system ids. */
+   gl_vbo        *lanes_vbo; /**< Jump lane vertex buffer. */
+   gl_vbo        *disks_vbo; /**< Faction disk vertex buffer. */
+} MapGeometry;
+static MapGeometry map_geom; /**< Cached galaxy map geometry. */
+
 /* map decorator stack */
 static MapDecorator *decorator_stack =
    NULL; /**< Contains all the map decorators. */
@@ -141,6 +181,9 @@ static void map_renderCommodIgnorance( double x, double y, double zoom,
                                        const Commodity *c, double a );
 static void map_drawMarker( double x, double y, double zoom, double r, double a,
                             int num, int cur, int type );
+static void map_geomUpdate( int editor );
+static void map_geomUpload( gl_vbo **vbo, const void *data, GLsizei size );
+static void map_geomFree( void );
 /* Mouse. */
 static void map_focusLose( unsigned int wid, const char *wgtname );
 static int  map_mouse( unsigned int wid, const SDL_Event *event, double mx,
@@ -187,6 +230,8 @@ void map_exit( void )
    }
 
    ovr_exit();
+   map_findExit();
+   map_geomFree();
 }
 
 /**
@@ -495,17 +540,13 @@ static void map_update_commod_av_price( void )
             double thisPrice;
             for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
                Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  if ( p->commodities[k] == c ) {
-                     if ( p->commodityPrice[k].cnt >
-                          0 ) { /*commodity is known about*/
-                        thisPrice =
-                           p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                        sumPrice += thisPrice;
-                        sumCnt += 1;
-                        break;
-                     }
-                  }
+               int   k = spob_getCommodityIndex( p, c );
+               if ( ( k >= 0 ) && ( p->commodityPrice[k].cnt >
+                                    0 ) ) { /*commodity is known about*/
+                  thisPrice =
+                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+                  sumPrice += thisPrice;
+                  sumCnt += 1;
                }
             }
             if ( sumCnt > 0 ) {
@@ -1193,46 +1234,212 @@ void map_renderDecorators( double x, double y, double zoom, int editor,
 }
 
 /**
- * @brief Renders the faction disks.
+ * @brief Quad corners as two triangles, in [-1,1] coordinates.
  */
-void map_renderFactionDisks( double x, double y, double zoom, double r,
-                             int editor, double alpha )
+static const GLfloat map_geomCorners[6][2] = {
+   { -1., -1. }, { 1., -1. }, { -1., 1. },
+   { -1., 1. },  { 1., -1. }, { 1., 1. } };
+
+/**
+ * @brief Copies a colour into a vertex colour.
+ */
+static void map_geomColour( GLfloat col[4], const glColour *c )
 {
+   col[0] = c->r;
+   col[1] = c->g;
+   col[2] = c->b;
+   col[3] = c->a;
+}
+
+/**
+ * @brief Uploads cached geometry to a vertex buffer, creating it if needed.
+ */
+static void map_geomUpload( gl_vbo **vbo, const void *data, GLsizei size )
+{
+   if ( size == 0 )
+      return;
+   if ( *vbo == NULL )
+      *vbo = gl_vboCreateStatic( size, data );
+   else
+      gl_vboData( *vbo, size, data );
+}
+
+/**
+ * @brief Rebuilds the cached map geometry if the known universe changed.
+ *
+ * The editor can move systems around without touching any flags, so it always
+ * rebuilds.
+ *
+ *    @param editor Whether or not we are rendering for the editor.
+ */
+static void map_geomUpdate( int editor )
+{
+   if ( map_geom.valid && !editor && !map_geom.editor &&
+        ( map_geom.gen == space_mapGeneration ) )
+      return;
+
+   if ( map_geom.lanes == NULL ) {
+      map_geom.lanes   = array_create( MapLaneVertex );
+      map_geom.disks   = array_create( MapDiskVertex );
+      map_geom.visible = array_create( int );
+   }
+   array_erase( &map_geom.lanes, array_begin( map_geom.lanes ),
+                array_end( map_geom.lanes ) );
+   array_erase( &map_geom.disks, array_begin( map_geom.disks ),
+                array_end( map_geom.disks ) );
+   array_erase( &map_geom.visible, array_begin( map_geom.visible ),
+                array_end( map_geom.visible ) );
+
    for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      glColour    c;
-      double      tx, ty;
-      StarSystem *sys = system_getIndex( i );
+      const StarSystem *sys = system_getIndex( i );
 
       if ( sys_isFlag( sys, SYSTEM_HIDDEN ) )
          continue;
 
-      if ( ( !sys_isFlag( sys, SYSTEM_HAS_KNOWN_LANDABLE ) ||
-             !sys_isKnown( sys ) ) &&
-           !editor )
-         continue;
-
-      tx = x + sys->pos.x * zoom;
-      ty = y + sys->pos.y * zoom;
+      /* Systems that can be drawn outside of the editor. */
+      if ( sys_isKnown( sys ) ||
+           sys_isFlag( sys, SYSTEM_MARKED | SYSTEM_CMARKED ) ||
+           space_sysReachable( sys ) )
+         array_push_back( &map_geom.visible, i );
+
+      /* Faction disk. */
+      if ( ( sys->faction != -1 ) &&
+           ( editor || ( sys_isFlag( sys, SYSTEM_HAS_KNOWN_LANDABLE ) &&
+                         sys_isKnown( sys ) ) ) ) {
+         glColour c = *faction_colour( sys->faction );
+         double   size = ( 40. + sqrt( sys->ownerpresence ) * 3. ) * 0.5;
+         c.a           = 0.6;
+         for ( int k = 0; k < 6; k++ ) {
+            MapDiskVertex *v = &array_grow( &map_geom.disks );
+            v->centre[0]     = sys->pos.x;
+            v->centre[1]     = sys->pos.y;
+            v->vertex[0]     = map_geomCorners[k][0];
+            v->vertex[1]     = map_geomCorners[k][1];
+            v->size          = size;
+            map_geomColour( v->col, &c );
+         }
+      }
 
-      /* System has faction and is known or we are in editor. */
-      if ( sys->faction != -1 ) {
-         const glColour *col;
-         double          presence = sqrt( sys->ownerpresence );
+      /* Jump lanes, we don't draw hyperspace lines of unknown systems. */
+      if ( !sys_isKnown( sys ) && !editor )
+         continue;
+      for ( int j = 0; j < array_size( sys->jumps ); j++ ) {
+         const glColour   *col, *cole;
+         double            rh;
+         const StarSystem *jsys = sys->jumps[j].target;
+         if ( sys_isFlag( jsys, SYSTEM_HIDDEN ) )
+            continue;
+         if ( !space_sysReachableFromSys( jsys, sys ) && !editor )
+            continue;
 
-         /* draws the disk representing the faction */
-         double sr = ( 40. + presence * 3. ) * zoom * 0.5;
+         /* Choose colours. */
+         cole = &cAquaBlue;
+         for ( int k = 0; k < array_size( jsys->jumps ); k++ ) {
+            if ( jsys->jumps[k].target == sys ) {
+               if ( jp_isFlag( &jsys->jumps[k], JP_EXITONLY ) )
+                  cole = &cGrey80;
+               else if ( jp_isFlag( &jsys->jumps[k], JP_HIDDEN ) )
+                  cole = &cRed;
+               break;
+            }
+         }
+         if ( jp_isFlag( &sys->jumps[j], JP_EXITONLY ) )
+            col = &cGrey80;
+         else if ( jp_isFlag( &sys->jumps[j], JP_HIDDEN ) )
+            col = &cRed;
+         else
+            col = &cAquaBlue;
 
-         col = faction_colour( sys->faction );
-         c.r = col->r;
-         c.g = col->g;
-         c.b = col->b;
-         c.a = 0.6 * alpha;
+         if ( sys->jumps[j].hide <= 0. ) {
+            col = &cGreen;
+            rh  = 2.5;
+         } else {
+            rh = 1.5;
+         }
 
-         glUseProgram( shaders.factiondisk.program );
-         glUniform1f( shaders.factiondisk.paramf, r / sr );
-         gl_renderShader( tx, ty, sr, sr, 0., &shaders.factiondisk, &c, 1 );
+         for ( int k = 0; k < 6; k++ ) {
+            MapLaneVertex *v = &array_grow( &map_geom.lanes );
+            v->lane[0]       = sys->pos.x;
+            v->lane[1]       = sys->pos.y;
+            v->lane[2]       = jsys->pos.x;
+            v->lane[3]       = jsys->pos.y;
+            v->vertex[0]     = map_geomCorners[k][0];
+            v->vertex[1]     = map_geomCorners[k][1];
+            v->height        = rh;
+            map_geomColour( v->col, col );
+            map_geomColour( v->cole, cole );
+         }
       }
    }
+
+   map_geomUpload( &map_geom.lanes_vbo, map_geom.lanes,
+                   sizeof( MapLaneVertex ) * array_size( map_geom.lanes ) );
+   map_geomUpload( &map_geom.disks_vbo, map_geom.disks,
+                   sizeof( MapDiskVertex ) * array_size( map_geom.disks ) );
+
+   map_geom.valid  = 1;
+   map_geom.editor = editor;
+   map_geom.gen    = space_mapGeneration;
+}
+
+/**
+ * @brief Frees the cached map geometry.
+ */
+static void map_geomFree( void )
+{
+   array_free( map_geom.lanes );
+   array_free( map_geom.disks );
+   array_free( map_geom.visible );
+   gl_vboDestroy( map_geom.lanes_vbo );
+   gl_vboDestroy( map_geom.disks_vbo );
+   memset( &map_geom, 0, sizeof( MapGeometry ) );
+}
+
+/**
+ * @brief Renders the faction disks.
+ */
+void map_renderFactionDisks( double x, double y, double zoom, double r,
+                             int editor, double alpha )
+{
+   GLsizei n;
+
+   map_geomUpdate( editor );
+   n = array_size( map_geom.disks );
+   if ( n == 0 )
+      return;
+
+   glUseProgram( shaders.factiondisks.program );
+   gl_uniformMat4( shaders.factiondisks.projection, &gl_view_matrix );
+   glUniform2f( shaders.factiondisks.offset, x, y );
+   glUniform1f( shaders.factiondisks.zoom, zoom );
+   glUniform1f( shaders.factiondisks.radius, r );
+   glUniform1f( shaders.factiondisks.alpha, alpha );
+
+   glEnableVertexAttribArray( shaders.factiondisks.centre );
+   glEnableVertexAttribArray( shaders.factiondisks.vertex );
+   glEnableVertexAttribArray( shaders.factiondisks.size );
+   glEnableVertexAttribArray( shaders.factiondisks.disk_colour );
+   gl_vboActivateAttribOffset(
+      map_geom.disks_vbo, shaders.factiondisks.centre,
+      offsetof( MapDiskVertex, centre ), 2, GL_FLOAT, sizeof( MapDiskVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.disks_vbo, shaders.factiondisks.vertex,
+      offsetof( MapDiskVertex, vertex ), 2, GL_FLOAT, sizeof( MapDiskVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.disks_vbo, shaders.factiondisks.size,
+      offsetof( MapDiskVertex, size ), 1, GL_FLOAT, sizeof( MapDiskVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.disks_vbo, shaders.factiondisks.disk_colour,
+      offsetof( MapDiskVertex, col ), 4, GL_FLOAT, sizeof( MapDiskVertex ) );
+
+   glDrawArrays( GL_TRIANGLES, 0, n );
+
+   glDisableVertexAttribArray( shaders.factiondisks.centre );
+   glDisableVertexAttribArray( shaders.factiondisks.vertex );
+   glDisableVertexAttribArray( shaders.factiondisks.size );
+   glDisableVertexAttribArray( shaders.factiondisks.disk_colour );
+   glUseProgram( 0 );
+   gl_checkErr();
 }
 
 /**
@@ -1329,67 +1536,49 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor,
 void map_renderJumps( double x, double y, double zoom, double radius,
                       int editor )
 {
-   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      double      x1, y1;
-      StarSystem *sys = system_getIndex( i );
-
-      if ( sys_isFlag( sys, SYSTEM_HIDDEN ) )
-         continue;
-
-      if ( !sys_isKnown( sys ) && !editor )
-         continue; /* we don't draw hyperspace lines */
-
-      x1 = x + sys->pos.x * zoom;
-      y1 = y + sys->pos.y * zoom;
-
-      for ( int j = 0; j < array_size( sys->jumps ); j++ ) {
-         double          x2, y2, rx, ry, r, rw, rh;
-         const glColour *col, *cole;
-         StarSystem     *jsys = sys->jumps[j].target;
-         if ( sys_isFlag( jsys, SYSTEM_HIDDEN ) )
-            continue;
-         if ( !space_sysReachableFromSys( jsys, sys ) && !editor )
-            continue;
+   GLsizei n;
 
-         /* Choose colours. */
-         cole = &cAquaBlue;
-         for ( int k = 0; k < array_size( jsys->jumps ); k++ ) {
-            if ( jsys->jumps[k].target == sys ) {
-               if ( jp_isFlag( &jsys->jumps[k], JP_EXITONLY ) )
-                  cole = &cGrey80;
-               else if ( jp_isFlag( &jsys->jumps[k], JP_HIDDEN ) )
-                  cole = &cRed;
-               break;
-            }
-         }
-         if ( jp_isFlag( &sys->jumps[j], JP_EXITONLY ) )
-            col = &cGrey80;
-         else if ( jp_isFlag( &sys->jumps[j], JP_HIDDEN ) )
-            col = &cRed;
-         else
-            col = &cAquaBlue;
-
-         x2 = x + jsys->pos.x * zoom;
-         y2 = y + jsys->pos.y * zoom;
-         rx = x2 - x1;
-         ry = y2 - y1;
-         r  = atan2( ry, rx );
-         rw = MOD( rx, ry ) / 2.;
-
-         if ( sys->jumps[j].hide <= 0. ) {
-            col = &cGreen;
-            rh  = 2.5;
-         } else {
-            rh = 1.5;
-         }
+   map_geomUpdate( editor );
+   n = array_size( map_geom.lanes );
+   if ( n == 0 )
+      return;
 
-         glUseProgram( shaders.jumplane.program );
-         gl_uniformColour( shaders.jumplane.paramv, cole );
-         glUniform1f( shaders.jumplane.paramf, radius );
-         gl_renderShader( ( x1 + x2 ) / 2., ( y1 + y2 ) / 2., rw, rh, r,
-                          &shaders.jumplane, col, 1 );
-      }
-   }
+   glUseProgram( shaders.jumplanes.program );
+   gl_uniformMat4( shaders.jumplanes.projection, &gl_view_matrix );
+   glUniform2f( shaders.jumplanes.offset, x, y );
+   glUniform1f( shaders.jumplanes.zoom, zoom );
+   glUniform1f( shaders.jumplanes.radius, radius );
+
+   glEnableVertexAttribArray( shaders.jumplanes.lane );
+   glEnableVertexAttribArray( shaders.jumplanes.vertex );
+   glEnableVertexAttribArray( shaders.jumplanes.height );
+   glEnableVertexAttribArray( shaders.jumplanes.lane_colour );
+   glEnableVertexAttribArray( shaders.jumplanes.lane_colour_end );
+   gl_vboActivateAttribOffset(
+      map_geom.lanes_vbo, shaders.jumplanes.lane,
+      offsetof( MapLaneVertex, lane ), 4, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.lanes_vbo, shaders.jumplanes.vertex,
+      offsetof( MapLaneVertex, vertex ), 2, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.lanes_vbo, shaders.jumplanes.height,
+      offsetof( MapLaneVertex, height ), 1, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.lanes_vbo, shaders.jumplanes.lane_colour,
+      offsetof( MapLaneVertex, col ), 4, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      map_geom.lanes_vbo, shaders.jumplanes.lane_colour_end,
+      offsetof( MapLaneVertex, cole ), 4, GL_FLOAT, sizeof( MapLaneVertex ) );
+
+   glDrawArrays( GL_TRIANGLES, 0, n );
+
+   glDisableVertexAttribArray( shaders.jumplanes.lane );
+   glDisableVertexAttribArray( shaders.jumplanes.vertex );
+   glDisableVertexAttribArray( shaders.jumplanes.height );
+   glDisableVertexAttribArray( shaders.jumplanes.lane_colour );
+   glDisableVertexAttribArray( shaders.jumplanes.lane_colour_end );
+   glUseProgram( 0 );
+   gl_checkErr();
 }
 
 /**
@@ -1398,20 +1587,27 @@ void map_renderJumps( double x, double y, double zoom, double radius,
 void map_renderSystems( double bx, double by, double x, double y, double zoom,
                         double w, double h, double r, MapMode mode )
 {
-   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      double      tx, ty;
-      StarSystem *sys = system_getIndex( i );
+   int n;
 
-      if ( sys_isFlag( sys, SYSTEM_HIDDEN ) )
-         continue;
+   /* Outside of the editor only systems that are known, reachable, or marked
+    * are drawn, which the geometry cache already has a list of. */
+   if ( mode != MAPMODE_EDITOR ) {
+      map_geomUpdate( 0 );
+      n = array_size( map_geom.visible );
+   } else
+      n = array_size( systems_stack );
 
-      /* if system is not known, reachable, or marked. and we are not in the
-       * editor */
-      if ( ( !sys_isKnown( sys ) &&
-             !sys_isFlag( sys, SYSTEM_MARKED | SYSTEM_CMARKED ) &&
-             !space_sysReachable( sys ) ) &&
-           mode != MAPMODE_EDITOR )
-         continue;
+   for ( int k = 0; k < n; k++ ) {
+      double      tx, ty;
+      StarSystem *sys;
+
+      if ( mode != MAPMODE_EDITOR )
+         sys = system_getIndex( map_geom.visible[k] );
+      else {
+         sys = system_getIndex( k );
+         if ( sys_isFlag( sys, SYSTEM_HIDDEN ) )
+            continue;
+      }
 
       tx = x + sys->pos.x * zoom;
       ty = y + sys->pos.y * zoom;
@@ -1768,19 +1964,13 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
       curMaxPrice = 0.;
       curMinPrice = 0.;
       if ( sys == cur_system && landed ) {
-         int k;
-         for ( k = 0; k < array_size( land_spob->commodities ); k++ ) {
-            if ( land_spob->commodities[k] == c ) {
-               /* current spob has the commodity of interest */
-               curMinPrice = land_spob->commodityPrice[k].sum /
-                             land_spob->commodityPrice[k].cnt;
-               curMaxPrice = curMinPrice;
-               break;
-            }
-         }
-         if ( k ==
-              array_size( land_spob->commodities ) ) { /* commodity of interest
-                                                          not found */
+         int k = spob_getCommodityIndex( land_spob, c );
+         if ( k >= 0 ) {
+            /* current spob has the commodity of interest */
+            curMinPrice = land_spob->commodityPrice[k].sum /
+                          land_spob->commodityPrice[k].cnt;
+            curMaxPrice = curMinPrice;
+         } else { /* commodity of interest not found */
             map_renderCommodIgnorance( x, y, zoom, sys, c, a );
             map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
             return;
@@ -1792,20 +1982,15 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
             double minPrice = HUGE_VAL;
             double maxPrice = 0;
             for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /* commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  maxPrice = MAX( thisPrice, maxPrice );
-                  minPrice = MIN( thisPrice, minPrice );
-                  break;
-               }
+               Spob  *p = sys->spobs[j];
+               int    k = spob_getCommodityIndex( p, c );
+               double thisPrice;
+               if ( ( k < 0 ) || ( p->commodityPrice[k].cnt <=
+                                   0 ) ) /* commodity is not known about */
+                  continue;
+               thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+               maxPrice  = MAX( thisPrice, maxPrice );
+               minPrice  = MIN( thisPrice, minPrice );
             }
             if ( maxPrice == 0 ) { /* no prices are known here */
                map_renderCommodIgnorance( x, y, zoom, sys, c, a );
@@ -1847,20 +2032,15 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
             double minPrice = HUGE_VAL;
             double maxPrice = 0;
             for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /*commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  maxPrice = MAX( thisPrice, maxPrice );
-                  minPrice = MIN( thisPrice, minPrice );
-                  break;
-               }
+               Spob  *p = sys->spobs[j];
+               int    k = spob_getCommodityIndex( p, c );
+               double thisPrice;
+               if ( ( k < 0 ) || ( p->commodityPrice[k].cnt <=
+                                   0 ) ) /*commodity is not known about */
+                  continue;
+               thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+               maxPrice  = MAX( thisPrice, maxPrice );
+               minPrice  = MIN( thisPrice, minPrice );
             }
 
             /* Calculate best and worst profits */
@@ -1930,20 +2110,15 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
             double sumPrice = 0;
             int    sumCnt   = 0;
             for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /* commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  sumPrice += thisPrice;
-                  sumCnt += 1;
-                  break;
-               }
+               Spob  *p = sys->spobs[j];
+               int    k = spob_getCommodityIndex( p, c );
+               double thisPrice;
+               if ( ( k < 0 ) || ( p->commodityPrice[k].cnt <=
+                                   0 ) ) /* commodity is not known about */
+                  continue;
+               thisPrice = p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
+               sumPrice += thisPrice;
+               sumCnt += 1;
             }
 
             if ( sumCnt > 0 ) {
@@ -22,6 +22,22 @@
 #define BUTTON_WIDTH 120 /**< Map button width. */
 #define BUTTON_HEIGHT 30 /**< Map button height. */
 
+#define MAP_TRIGRAM_BITS 12 /**< Bits of the trigram hash. */
+#define MAP_TRIGRAM_BUCKETS                                                    \
+   ( 1 << MAP_TRIGRAM_BITS ) /**< Number of trigram hash buckets. */
+
+/**
+ * @brief Trigram index over the searchable text of outfits or ships.
+ *
+ * Trigrams are hashed into buckets, so a bucket only gives candidates that
+ * still have to be checked against the real text.
+ */
+typedef struct MapTrigrams_ {
+   char *lang; /**< Language the index was built in, NULL if not built. */
+   int  *buckets[MAP_TRIGRAM_BUCKETS]; /**< Array (array.h) of item ids per
+                                          trigram hash. */
+} MapTrigrams;
+
 /* Stored checkbox values. */
 static int map_find_systems = 1; /**< Systems checkbox value. */
 static int map_find_spobs   = 0; /**< Spobs checkbox value. */
@@ -35,17 +51,26 @@ static int         map_found_ncur = 0;    /**< Number of found stuff. */
 static char      **map_foundOutfitNames =
    NULL; /**< Array (array.h): Internal names of outfits in the search results.
           */
-/* Tech hack. */
-static tech_group_t **map_known_techs =
-   NULL; /**< Array (array.h) of known techs. */
-static Spob **map_known_spobs =
-   NULL; /**< Array (array.h) of known spobs with techs. */
+/* Reverse index of where things are sold. */
+static Spob ***map_outfit_sellers =
+   NULL; /**< Known spobs with each outfit in their tech, by outfit id. */
+static Spob ***map_ship_sellers =
+   NULL; /**< Known spobs with each ship in their tech, by ship id. */
+static char *map_known_indexed =
+   NULL; /**< Whether each spob is in the reverse index, by spob id. */
+static int          map_known_nindexed = 0; /**< Number of indexed spobs. */
+static unsigned int map_known_techgen  = 0; /**< Tech generation indexed. */
+static int          map_known_nspobs   = 0; /**< Spobs when index was made. */
+/* Name search. */
+static MapTrigrams map_outfit_trigrams; /**< Trigrams of outfit text. */
+static MapTrigrams map_ship_trigrams;   /**< Trigrams of ship text. */
 
 /*
  * Prototypes.
  */
 /* Init/cleanup. */
 static int  map_knownInit( void );
+static void map_knownAdd( Spob *spob );
 static void map_knownClean( void );
 /* Toolkit-related. */
 static void map_addOutfitDetailFields( unsigned int wid_results, int x, int y,
@@ -73,23 +98,47 @@ static void map_sortFound( map_find_t *found, int n );
 static char map_getSpobColourChar( Spob *p );
 static const char *map_getSpobSymbol( Spob *p );
 /* Fuzzy outfit/ship stuff. */
-static char **map_fuzzyOutfits( Outfit **o, const char *name );
+static unsigned int map_trigramHash( const char *str );
+static void map_trigramAdd( MapTrigrams *tg, int id, const char *str );
+static int  map_trigramCandidates( const MapTrigrams *tg, const char *query,
+                                   const int **cand );
+static int  map_trigramCurrent( MapTrigrams *tg );
+static void map_trigramFree( MapTrigrams *tg );
+static int  map_fuzzyOutfit( const Outfit *o, const char *name );
 static char **map_outfitsMatch( const char *name );
-static char **map_fuzzyShips( Ship **o, const char *name );
+static int    map_fuzzyShip( const Ship *s, const char *name );
 static char **map_shipsMatch( const char *name );
 
 /**
- * @brief Initializes stuff the pilot knows.
+ * @brief Updates the reverse index of what known spobs sell.
+ *
+ * Only spobs that became known since the last call get added, unless the tech
+ * changed or spobs became unknown (such as when loading another save), in
+ * which case the index is rebuilt.
  */
 static int map_knownInit( void )
 {
-   const StarSystem *sys = system_getAll();
-
-   map_knownClean();
-   map_known_techs = array_create( tech_group_t * );
-   map_known_spobs = array_create( Spob * );
+   const StarSystem *sys    = system_getAll();
+   int               nknown = 0;
+
+   /* Tech changes can alter what any spob sells, and new spobs (such as from
+    * the system editor) don't fit in the index and may move the others. */
+   if ( ( map_known_techgen != tech_generation() ) ||
+        ( map_known_nspobs != array_size( spob_getAll() ) ) )
+      map_knownClean();
+
+   if ( map_known_indexed == NULL ) {
+      map_outfit_sellers = calloc( MAX( array_size( outfit_getAll() ), 1 ),
+                                   sizeof( Spob ** ) );
+      map_ship_sellers =
+         calloc( MAX( array_size( ship_getAll() ), 1 ), sizeof( Spob ** ) );
+      map_known_indexed =
+         calloc( MAX( array_size( spob_getAll() ), 1 ), sizeof( char ) );
+      map_known_techgen = tech_generation();
+      map_known_nspobs  = array_size( spob_getAll() );
+   }
 
-   /* Get techs. */
+   /* Add newly known spobs. */
    for ( int i = 0; i < array_size( sys ); i++ ) {
       if ( !sys_isKnown( &sys[i] ) )
          continue;
@@ -97,25 +146,81 @@ static int map_knownInit( void )
       for ( int j = 0; j < array_size( sys[i].spobs ); j++ ) {
          Spob *spob = sys[i].spobs[j];
 
-         if ( spob_isKnown( spob ) && spob->tech != NULL ) {
-            array_push_back( &map_known_spobs, spob );
-            array_push_back( &map_known_techs, spob->tech );
-         }
+         if ( !spob_isKnown( spob ) || ( spob->tech == NULL ) )
+            continue;
+
+         nknown++;
+         if ( !map_known_indexed[spob->id] )
+            map_knownAdd( spob );
       }
    }
 
+   /* Something we indexed is no longer known. */
+   if ( nknown < map_known_nindexed ) {
+      map_knownClean();
+      return map_knownInit();
+   }
+
    return 0;
 }
 
+/**
+ * @brief Adds a known spob to the reverse index.
+ */
+static void map_knownAdd( Spob *spob )
+{
+   Outfit **o = tech_getOutfit( spob->tech );
+   Ship   **s = tech_getShip( spob->tech );
+
+   for ( int i = 0; i < array_size( o ); i++ ) {
+      Spob ***sellers = &map_outfit_sellers[o[i] - outfit_getAll()];
+      if ( *sellers == NULL )
+         *sellers = array_create( Spob * );
+      array_push_back( sellers, spob );
+   }
+   for ( int i = 0; i < array_size( s ); i++ ) {
+      Spob ***sellers = &map_ship_sellers[s[i] - ship_getAll()];
+      if ( *sellers == NULL )
+         *sellers = array_create( Spob * );
+      array_push_back( sellers, spob );
+   }
+   array_free( o );
+   array_free( s );
+
+   map_known_indexed[spob->id] = 1;
+   map_known_nindexed++;
+}
+
 /**
  * @brief Cleans up stuff the pilot knows.
  */
 static void map_knownClean( void )
 {
-   array_free( map_known_techs );
-   map_known_techs = NULL;
-   array_free( map_known_spobs );
-   map_known_spobs = NULL;
+   if ( map_outfit_sellers != NULL ) {
+      for ( int i = 0; i < array_size( outfit_getAll() ); i++ )
+         array_free( map_outfit_sellers[i] );
+   }
+   free( map_outfit_sellers );
+   map_outfit_sellers = NULL;
+   if ( map_ship_sellers != NULL ) {
+      for ( int i = 0; i < array_size( ship_getAll() ); i++ )
+         array_free( map_ship_sellers[i] );
+   }
+   free( map_ship_sellers );
+   map_ship_sellers = NULL;
+   free( map_known_indexed );
+   map_known_indexed  = NULL;
+   map_known_nindexed = 0;
+}
+
+/**
+ * @brief Frees the search indices.
+ */
+void map_findExit( void )
+{
+   map_knownClean();
+   map_trigramFree( &map_outfit_trigrams );
+   map_trigramFree( &map_ship_trigrams );
 }
 
 /**
@@ -169,7 +274,6 @@ static void map_findOnClose( unsigned int wid, const char *str )
 
    free( map_found_cur );
    map_found_cur = NULL;
-   map_knownClean();
 }
 
 /**
@@ -529,30 +633,117 @@ static const char *map_getSpobSymbol( Spob *p )
 }
 
 /**
- * @brief Does fuzzy name matching for outfits in an Array. Searches translated
- * names but returns internal names.
+ * @brief Hashes the trigram at the start of a string, ignoring ASCII case.
  */
-static char **map_fuzzyOutfits( Outfit **o, const char *name )
+static unsigned int map_trigramHash( const char *str )
 {
-   char **names = array_create( char * );
+   uint32_t h = 0;
+   for ( int i = 0; i < 3; i++ ) {
+      unsigned char c = str[i];
+      if ( ( c >= 'A' ) && ( c <= 'Z' ) )
+         c += 'a' - 'A';
+      h = ( h << 8 ) | c;
+   }
+   return ( h * UINT32_C( 2654435761 ) ) >> ( 32 - MAP_TRIGRAM_BITS );
+}
 
-   /* Do fuzzy search. */
-   for ( int i = 0; i < array_size( o ); i++ ) {
-      if ( SDL_strcasestr( _( o[i]->name ), name ) != NULL )
-         array_push_back( &names, o[i]->name );
-      else if ( ( o[i]->typename != NULL ) &&
-                SDL_strcasestr( o[i]->typename, name ) != NULL )
-         array_push_back( &names, o[i]->name );
-      else if ( ( o[i]->condstr != NULL ) &&
-                SDL_strcasestr( o[i]->condstr, name ) != NULL )
-         array_push_back( &names, o[i]->name );
-      else if ( SDL_strcasestr( outfit_description( o[i] ), name ) != NULL )
-         array_push_back( &names, o[i]->name );
-      else if ( SDL_strcasestr( outfit_summary( o[i], 0 ), name ) != NULL )
-         array_push_back( &names, o[i]->name );
+/**
+ * @brief Adds the trigrams of a string to an index.
+ *
+ * All the strings of an item have to be added before moving on to the next
+ * item, with increasing item ids.
+ */
+static void map_trigramAdd( MapTrigrams *tg, int id, const char *str )
+{
+   if ( str == NULL )
+      return;
+
+   for ( int i = 0; ( str[i] != '\0' ) && ( str[i + 1] != '\0' ) &&
+                    ( str[i + 2] != '\0' );
+         i++ ) {
+      int **bucket = &tg->buckets[map_trigramHash( &str[i] )];
+      if ( *bucket == NULL )
+         *bucket = array_create( int );
+      else if ( ( *bucket )[array_size( *bucket ) - 1] == id )
+         continue;
+      array_push_back( bucket, id );
    }
+}
 
-   return names;
+/**
+ * @brief Gets the items that may contain a query.
+ *
+ *    @param tg Index to use.
+ *    @param query Query to look up.
+ *    @param[out] cand Ids of the candidate items.
+ *    @return Number of candidates, or -1 if the query is too short to use the
+ *            index and all items are candidates.
+ */
+static int map_trigramCandidates( const MapTrigrams *tg, const char *query,
+                                  const int **cand )
+{
+   int n = -1;
+
+   /* Use the rarest trigram of the query. */
+   *cand = NULL;
+   for ( int i = 0; ( query[i] != '\0' ) && ( query[i + 1] != '\0' ) &&
+                    ( query[i + 2] != '\0' );
+         i++ ) {
+      const int *bucket = tg->buckets[map_trigramHash( &query[i] )];
+      if ( ( n < 0 ) || ( array_size( bucket ) < n ) ) {
+         *cand = bucket;
+         n     = array_size( bucket );
+      }
+   }
+   return n;
+}
+
+/**
+ * @brief Frees a trigram index.
+ */
+static void map_trigramFree( MapTrigrams *tg )
+{
+   for ( int i = 0; i < MAP_TRIGRAM_BUCKETS; i++ )
+      array_free( tg->buckets[i] );
+   free( tg->lang );
+   memset( tg, 0, sizeof( MapTrigrams ) );
+}
+
+/**
+ * @brief Checks to see if an index is built in the current language.
+ *
+ * The index is over translated text, so an index built in another language is
+ * freed to be rebuilt.
+ *
+ *    @param tg Index to check.
+ *    @return 1 if the index can be used, 0 if it has to be built.
+ */
+static int map_trigramCurrent( MapTrigrams *tg )
+{
+   if ( tg->lang == NULL )
+      return 0;
+   if ( strcmp( tg->lang, gettext_getLanguage() ) == 0 )
+      return 1;
+   map_trigramFree( tg );
+   return 0;
+}
+
+/**
+ * @brief Does fuzzy name matching for an outfit. Searches translated names.
+ */
+static int map_fuzzyOutfit( const Outfit *o, const char *name )
+{
+   if ( SDL_strcasestr( _( o->name ), name ) != NULL )
+      return 1;
+   if ( ( o->typename != NULL ) && SDL_strcasestr( o->typename, name ) != NULL )
+      return 1;
+   if ( ( o->condstr != NULL ) && SDL_strcasestr( o->condstr, name ) != NULL )
+      return 1;
+   if ( SDL_strcasestr( outfit_description( o ), name ) != NULL )
+      return 1;
+   if ( SDL_strcasestr( outfit_summary( o, 0 ), name ) != NULL )
+      return 1;
+   return 0;
 }
 
 /**
@@ -560,17 +751,40 @@ static char **map_fuzzyOutfits( Outfit **o, const char *name )
  */
 static char **map_outfitsMatch( const char *name )
 {
-   Outfit **o;
-   char   **names;
+   const Outfit *outfits = outfit_getAll();
+   const int    *cand;
+   int           n;
+   char        **names = array_create( char * );
+
+   /* Index the outfit text on first use or after changing language. */
+   if ( !map_trigramCurrent( &map_outfit_trigrams ) ) {
+      for ( int i = 0; i < array_size( outfits ); i++ ) {
+         const Outfit *o = &outfits[i];
+         map_trigramAdd( &map_outfit_trigrams, i, _( o->name ) );
+         map_trigramAdd( &map_outfit_trigrams, i, o->typename );
+         map_trigramAdd( &map_outfit_trigrams, i, o->condstr );
+         map_trigramAdd( &map_outfit_trigrams, i, outfit_description( o ) );
+         map_trigramAdd( &map_outfit_trigrams, i, outfit_summary( o, 0 ) );
+      }
+      map_outfit_trigrams.lang = strdup( gettext_getLanguage() );
+   }
 
-   /* Get outfits and names. */
-   o = tech_getOutfitArray( map_known_techs, array_size( map_known_techs ) );
-   names = map_fuzzyOutfits( o, name );
+   /* Check the candidates that are sold somewhere known. */
+   n = map_trigramCandidates( &map_outfit_trigrams, name, &cand );
+   if ( n < 0 )
+      n = array_size( outfits );
+   for ( int i = 0; i < n; i++ ) {
+      int id = ( cand != NULL ) ? cand[i] : i;
+      if ( array_size( map_outfit_sellers[id] ) <= 0 )
+         continue;
+      if ( map_fuzzyOutfit( &outfits[id], name ) )
+         array_push_back( &names, outfits[id].name );
+   }
    qsort( names, array_size( names ), sizeof( char * ), strsort );
-   array_free( o );
 
    return names;
 }
+
 /**
  * @brief Add widgets to the extended area on the outfit search
  *    listpanel.
@@ -708,6 +922,7 @@ static int map_findSearchOutfits( unsigned int wid_map_find, const char *name )
    const char   *oname, *sysname;
    char        **list;
    const Outfit *o;
+   Spob        **sellers;
 
    assert( "Outfit search is not reentrant!" && map_foundOutfitNames == NULL );
 
@@ -749,23 +964,13 @@ static int map_findSearchOutfits( unsigned int wid_map_find, const char *name )
       return -1;
 
    /* Construct found table. */
-   found = NULL;
-   n     = 0;
-   len   = array_size( map_known_techs );
+   found   = NULL;
+   n       = 0;
+   sellers = map_outfit_sellers[o - outfit_getAll()];
+   len     = array_size( sellers );
    for ( int i = 0; i < len; i++ ) {
-      /* Try to find the outfit in the spob. */
-      int         j;
-      Spob       *spob;
+      Spob       *spob = sellers[i];
       StarSystem *sys;
-      Outfit    **olist = tech_getOutfit( map_known_techs[i] );
-      for ( j = array_size( olist ) - 1; j >= 0; j-- )
-         if ( olist[j] == o )
-            break;
-      array_free( olist );
-      olist = NULL;
-      if ( j < 0 )
-         continue;
-      spob = map_known_spobs[i];
 
       /* Must have an outfitter. */
       if ( !spob_hasService( spob, SPOB_SERVICE_OUTFITS ) )
@@ -796,43 +1001,60 @@ static int map_findSearchOutfits( unsigned int wid_map_find, const char *name )
 }
 
 /**
- * @brief Does fuzzy name matching for ships in an Array. Searches translated
- * names but returns internal names.
+ * @brief Does fuzzy name matching for a ship. Searches translated names.
  */
-static char **map_fuzzyShips( Ship **s, const char *name )
+static int map_fuzzyShip( const Ship *s, const char *name )
 {
-   char **names = array_create( char * );
-
-   /* Do fuzzy search. */
-   for ( int i = 0; i < array_size( s ); i++ ) {
-      if ( SDL_strcasestr( _( s[i]->name ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( ( s[i]->license != NULL ) &&
-                SDL_strcasestr( _( s[i]->license ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( ship_classDisplay( s[i] ) ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( s[i]->fabricator ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( s[i]->description ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-   }
-
-   return names;
+   if ( SDL_strcasestr( _( s->name ), name ) != NULL )
+      return 1;
+   if ( ( s->license != NULL ) &&
+        SDL_strcasestr( _( s->license ), name ) != NULL )
+      return 1;
+   if ( SDL_strcasestr( _( ship_classDisplay( s ) ), name ) != NULL )
+      return 1;
+   if ( SDL_strcasestr( _( s->fabricator ), name ) != NULL )
+      return 1;
+   if ( SDL_strcasestr( _( s->description ), name ) != NULL )
+      return 1;
+   return 0;
 }
+
 /**
  * @brief Gets the possible names the ship name matches.
  */
 static char **map_shipsMatch( const char *name )
 {
-   Ship **s;
-   char **names;
+   const Ship *ships = ship_getAll();
+   const int  *cand;
+   int         n;
+   char      **names = array_create( char * );
+
+   /* Index the ship text on first use or after changing language. */
+   if ( !map_trigramCurrent( &map_ship_trigrams ) ) {
+      for ( int i = 0; i < array_size( ships ); i++ ) {
+         const Ship *s = &ships[i];
+         map_trigramAdd( &map_ship_trigrams, i, _( s->name ) );
+         if ( s->license != NULL )
+            map_trigramAdd( &map_ship_trigrams, i, _( s->license ) );
+         map_trigramAdd( &map_ship_trigrams, i, _( ship_classDisplay( s ) ) );
+         map_trigramAdd( &map_ship_trigrams, i, _( s->fabricator ) );
+         map_trigramAdd( &map_ship_trigrams, i, _( s->description ) );
+      }
+      map_ship_trigrams.lang = strdup( gettext_getLanguage() );
+   }
 
-   /* Get ships and names. */
-   s     = tech_getShipArray( map_known_techs, array_size( map_known_techs ) );
-   names = map_fuzzyShips( s, name );
+   /* Check the candidates that are sold somewhere known. */
+   n = map_trigramCandidates( &map_ship_trigrams, name, &cand );
+   if ( n < 0 )
+      n = array_size( ships );
+   for ( int i = 0; i < n; i++ ) {
+      int id = ( cand != NULL ) ? cand[i] : i;
+      if ( array_size( map_ship_sellers[id] ) <= 0 )
+         continue;
+      if ( map_fuzzyShip( &ships[id], name ) )
+         array_push_back( &names, ships[id].name );
+   }
    qsort( names, array_size( names ), sizeof( char * ), strsort );
-   array_free( s );
 
    return names;
 }
@@ -853,7 +1075,7 @@ static int map_findSearchShips( unsigned int wid_map_find, const char *name )
    const char *sname, *sysname;
    char      **list;
    const Ship *s;
-   Ship      **slist;
+   Spob      **sellers;
 
    /* Match spob first. */
    s     = NULL;
@@ -888,22 +1110,12 @@ static int map_findSearchShips( unsigned int wid_map_find, const char *name )
       return -1;
 
    /* Construct found table. */
-   found = NULL;
-   n     = 0;
-   len   = array_size( map_known_techs );
+   found   = NULL;
+   n       = 0;
+   sellers = map_ship_sellers[s - ship_getAll()];
+   len     = array_size( sellers );
    for ( int i = 0; i < len; i++ ) {
-      int j;
-
-      /* Try to find the ship in the spob. */
-      slist = tech_getShip( map_known_techs[i] );
-      for ( j = array_size( slist ) - 1; j >= 0; j-- )
-         if ( slist[j] == s )
-            break;
-      array_free( slist );
-      slist = NULL;
-      if ( j < 0 )
-         continue;
-      spob = map_known_spobs[i];
+      spob = sellers[i];
 
       /* Must have an shipyard. */
       if ( !spob_hasService( spob, SPOB_SERVICE_SHIPYARD ) )
@@ -991,7 +1203,7 @@ void map_inputFind( unsigned int parent, const char *str )
    unsigned int wid_map_find;
    int          x, y, w, h;
 
-   /* initialize known. */
+   /* Update known sellers. */
    map_knownInit();
 
    /* Create the window. */
@@ -16,5 +16,6 @@ typedef struct map_find_s {
    double      distance;              /**< Distance to system. */
 } map_find_t;
 
+void map_findExit( void );
 void map_inputFind( unsigned int parent, const char *str );
 void map_inputFindType( unsigned int parent, const char *type );
@@ -39,6 +39,7 @@
 #include "economy.h"
 #include "env.h"
 #include "event.h"
+#include "explosion.h"
 #include "faction.h"
 #include "font.h"
 #include "gui.h"
@@ -58,6 +59,7 @@
 #include "nebula.h"
 #include "news.h"
 #include "nfile.h"
+#include "nlua.h"
 #include "nlua_colour.h"
 #include "nlua_data.h"
 #include "nlua_file.h"
@@ -114,6 +116,8 @@ static double fps_cur = 0.;       /**< FPS accumulator to trigger change. */
 static double fps_x   = 15.;      /**< FPS X position. */
 static double fps_y   = -15.;     /**< FPS Y position. */
 const double  fps_min = 1. / 10.; /**< New collisions allow larger fps_min. */
+#define UPDATE_RATE 60. /**< Fixed updates per second of real time. */
+static double update_acc = 0.; /**< Real time not simulated yet. */
 double        elapsed_time_mod = 0.; /**< Elapsed modified time. */
 
 static nlua_env load_env =
@@ -749,6 +753,7 @@ void load_all( void )
    space_loadLua();
    pilots_init();
    weapon_init();
+   expl_init();
    player_init(); /* Initialize player stuff. */
    loadscreen_update( 1., _( "Loading Completed!" ) );
 
@@ -763,6 +768,7 @@ void unload_all( void )
    player_cleanup();  /* cleans up the player stuff */
    gui_free();        /* cleans up the player's GUI */
    weapon_exit();     /* destroys all active weapons */
+   expl_exit();       /* drops the explosions still to resolve */
    pilots_free();     /* frees the pilots, they were locked up :( */
    cond_exit();       /* destroy conditional subsystem. */
    land_exit();       /* Destroys landing vbo and friends. */
@@ -798,12 +804,14 @@ void main_loop( int nested )
     * Control FPS.
     */
    fps_control(); /* everyone loves fps control */
+   log_frame();   /* reset log rate limits */
 
    /*
     * Handle update.
     */
    input_update( real_dt ); /* handle key repeats. */
    sound_update( real_dt ); /* Update sounds. */
+   ship_gfxUpdate();        /* Upload prefetched ship graphics. */
    toolkit_update(); /* to simulate key repetition and get rid of windows */
    if ( !paused ) {
       update_all( !nested ); /* update game */
@@ -832,6 +840,7 @@ void main_loop( int nested )
       /* Draw buffer. */
       SDL_GL_SwapWindow( gl_screen.window );
 
+      nlua_tracePlot();
       NTracingFrameMark;
    }
 
@@ -1020,40 +1029,45 @@ static void update_all( int dohooks )
 {
    NTracingZone( _ctx, 1 );
 
+   int    n;
+   double step, step_max;
+
+   /* Projectiles that are swept along their path can't go through ships, so
+    * physics can run in larger steps. */
+   step_max = fps_min;
+   if ( conf.collision_ccd )
+      step_max = MAX( fps_min, conf.collision_ccd_step );
+
    if ( ( real_dt > 0.25 ) &&
         ( fps_skipped == 0 ) ) { /* slow timers down and rerun calculations */
       fps_skipped = 1;
       NTracingZoneEnd( _ctx );
       return;
-   } else if ( game_dt > fps_min ) { /* We'll force a minimum FPS for physics to
-                                        work alright. */
-      int    n;
-      double nf, microdt, accumdt;
-
-      /* Number of frames. */
-      nf      = ceil( game_dt / fps_min );
-      microdt = game_dt / nf;
-      n       = (int)nf;
-
-      /* Update as much as needed, evenly. */
-      accumdt = 0.;
-      for ( int i = 0; i < n; i++ ) {
-         update_routine( microdt, dohooks );
-         /* OK, so we need a bit of hackish logic here in case we are chopping
-          * up a very large dt and it turns out time compression changes so
-          * we're now updating in "normal time compression" zone. This amounts
-          * to many updates being run when time compression has changed and thus
-          * can cause, say, the player to exceed their target position or get
-          * mauled by an enemy ship.
-          */
-         accumdt += microdt;
-         if ( accumdt > dt_mod * real_dt )
-            break;
-      }
+   }
 
+   /* The game is updated in fixed steps of real time, independently of the
+    * frame rate. Whatever is left over carries on to the next frame. Don't
+    * try to catch up with more than a skipped frame's worth of updates. */
+   update_acc += real_dt;
+   n          = MIN( (int)floor( update_acc * UPDATE_RATE ),
+                     (int)( 0.25 * UPDATE_RATE ) );
+   update_acc = MIN( update_acc - n / UPDATE_RATE, 1. / UPDATE_RATE );
+   for ( int i = 0; i < n; i++ ) {
+      /* Time compression makes steps longer, chop them up again if they get
+       * too long for physics. dt_mod can change between steps. */
+      int nsub;
+      step = dt_mod / UPDATE_RATE;
+      nsub = MAX( 1, (int)ceil( step / step_max ) );
+      for ( int j = 0; j < nsub; j++ )
+         update_routine( step / (double)nsub, dohooks );
       /* Note we don't touch game_dt so that fps_display works well */
-   } else /* Standard, just update with the last dt */
-      update_routine( game_dt, dohooks );
+   }
+
+   /* Rendering happens between the last two updates, so it lags behind by
+    * what is left of a step. */
+   step = dt_mod / UPDATE_RATE;
+   solid_setRenderLag( ( 1. - update_acc * UPDATE_RATE ) * step );
+   NTracingPlotI( "updates", n );
 
    fps_skipped = 0;
 
@@ -1093,6 +1107,7 @@ void update_routine( double dt, int dohooks )
       weapons_updateCollide( dt );
       pilots_update( dt );
       weapons_update( dt ); /* Has weapons think and update positions. */
+      expl_update();        /* Resolves the explosion damage. */
 
       /* Update camera. */
       cam_update( dt );
@@ -47,6 +47,7 @@
 #include "nlua_vec2.h"
 #include "nluadef.h"
 #include "nstring.h"
+#include "ntracing.h"
 
 lua_State *naevL         = NULL;      /**< Global Naev Lua state. */
 nlua_env   __NLUA_CURENV = LUA_NOREF; /**< Current environment. */
@@ -1057,6 +1058,28 @@ void nlua_resize( void )
    lua_pop( naevL, 1 );       /* */
 }
 
+/**
+ * @brief Plots the Lua memory use and garbage collector activity.
+ *
+ * LuaJIT doesn't expose collection events, so a drop in memory in use between
+ * two calls is counted as a collector step, and the amount freed plotted.
+ */
+void nlua_tracePlot( void )
+{
+#if HAVE_TRACY
+   static int nlua_gc_last  = 0; /* Memory in use at the last call (KiB). */
+   static int nlua_gc_steps = 0; /* Detected collector steps. */
+   int        kb            = lua_gc( naevL, LUA_GCCOUNT, 0 );
+   int        freed         = MAX( nlua_gc_last - kb, 0 );
+   if ( freed > 0 )
+      nlua_gc_steps++;
+   nlua_gc_last = kb;
+   NTracingPlotI( "Lua memory (KiB)", kb );
+   NTracingPlotI( "Lua GC freed (KiB)", freed );
+   NTracingPlotI( "Lua GC steps", nlua_gc_steps );
+#endif /* HAVE_TRACY */
+}
+
 /**
  * @brief Helper function to deal with tags.
  */
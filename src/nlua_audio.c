@@ -40,7 +40,21 @@ typedef struct LuaAudioEfx_s {
  */
 static LuaAudioEfx_t *lua_efx = NULL;
 
-static int stream_thread( void *la_data );
+/**
+ * @brief Streaming sources are all serviced by a single decode worker. All
+ * these are only accessed with soundLock() held.
+ */
+static LuaAudio_t **stream_sources = NULL; /**< Sources being streamed. */
+static LuaAudio_t  *stream_busy =
+   NULL; /**< Source being decoded with the sound lock released. */
+static int       stream_running = 0;    /**< Whether the worker is running. */
+static SDL_cond *stream_cond    = NULL; /**< Wakes the worker and waiters. */
+static unsigned int stream_underruns = 0; /**< Total stream underruns. */
+
+static int  stream_thread( void *unused );
+static void stream_service( LuaAudio_t *la );
+static void stream_add( LuaAudio_t *la );
+static void stream_remove( LuaAudio_t *la );
 static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer );
 static int audio_genSource( ALuint *source );
 
@@ -117,50 +131,168 @@ static const luaL_Reg audioL_methods[] = {
    { "soundPlay", audioL_soundPlay }, /* Old API */
    { 0, 0 } };                        /**< AudioLua methods. */
 
-static int stream_thread( void *la_data )
+/**
+ * @brief Decode worker shared by all the streaming sources.
+ *
+ * Exits once there is nothing left to stream.
+ */
+static int stream_thread( void *unused )
+{
+   (void)unused;
+
+   soundLock();
+   while ( array_size( stream_sources ) > 0 ) {
+      for ( int i = 0; i < array_size( stream_sources ); i++ ) {
+         LuaAudio_t *la = stream_sources[i];
+         stream_service( la );
+         /* The sound lock may have been released while decoding, so sources
+          * may have come and gone. Just pick up on the next pass. */
+         if ( ( i >= array_size( stream_sources ) ) ||
+              ( stream_sources[i] != la ) )
+            break;
+      }
+      al_checkErr(); /* XXX - good or bad idea to log from the thread? */
+      SDL_CondWaitTimeout( stream_cond, sound_lock, 10 );
+   }
+   array_free( stream_sources );
+   stream_sources = NULL;
+   stream_running = 0;
+   SDL_CondBroadcast( stream_cond );
+   soundUnlock();
+
+   return 0;
+}
+
+/**
+ * @brief Refills the processed buffers of a streaming source.
+ *
+ * Assumes that soundLock() is set.
+ */
+static void stream_service( LuaAudio_t *la )
 {
-   LuaAudio_t *la = (LuaAudio_t *)la_data;
+   ALint processed, alstate;
 
-   while ( 1 ) {
-      ALint  alstate;
+   alGetSourcei( la->source, AL_BUFFERS_PROCESSED, &processed );
+   alGetSourcei( la->source, AL_SOURCE_STATE, &alstate );
+   for ( int n = 0; n < processed; n++ ) {
       ALuint removed;
+      int    ret;
+
+      /* Refill the oldest buffer. */
+      alSourceUnqueueBuffers( la->source, 1, &removed );
+      stream_busy = la;
+      ret         = stream_loadBuffer( la, la->stream_buffers[la->active] );
+      stream_busy = NULL;
+      SDL_CondBroadcast( stream_cond );
+
+      /* stream_loadBuffer unlocks the sound lock internally, so the stream
+       * may have been stopped in the meantime. */
+      if ( !la->streaming )
+         return;
+      /* End of the stream, the buffers already queued still get played
+       * out and the source stops on its own. */
+      if ( ret < 0 ) {
+         stream_remove( la );
+         return;
+      }
+      alSourceQueueBuffers( la->source, 1, &la->stream_buffers[la->active] );
+      la->active = ( la->active + 1 ) % LUA_AUDIO_STREAM_BUFFERS;
+   }
 
-      soundLock();
+   /* Source ran dry before we got to it, so it has to be restarted. */
+   if ( ( processed > 0 ) && ( alstate == AL_STOPPED ) ) {
+      la->underruns++;
+      stream_underruns++;
+      alSourcePlay( la->source );
+   }
+}
 
-      /* Case finished. */
-      if ( la->active < 0 ) {
-         la->th = NULL;
-         SDL_CondBroadcast( la->cond );
-         alSourceStop( la->source );
+/**
+ * @brief Stops the decode worker and frees its state.
+ */
+void audio_exit( void )
+{
+   soundLock();
+   while ( array_size( stream_sources ) > 0 )
+      stream_remove( stream_sources[0] );
+   while ( stream_running ) {
+      SDL_CondBroadcast( stream_cond );
+      if ( SDL_CondWaitTimeout( stream_cond, sound_lock, 3000 ) ==
+           SDL_MUTEX_TIMEDOUT ) {
+         WARN( _( "Timed out while waiting for audio thread to finish!" ) );
          soundUnlock();
-         return 0;
+         return; /* The worker may still use the condition variable. */
       }
+   }
+   if ( stream_cond != NULL )
+      SDL_DestroyCond( stream_cond );
+   stream_cond = NULL;
+   soundUnlock();
+}
 
-      alGetSourcei( la->source, AL_BUFFERS_PROCESSED, &alstate );
-      if ( alstate > 0 ) {
-         int ret;
-         /* Refill active buffer */
-         alSourceUnqueueBuffers( la->source, 1, &removed );
-         ret = stream_loadBuffer( la, la->stream_buffers[la->active] );
-         if ( ( la->active < 0 ) || ( ret < 0 ) ) {
-            /* stream_loadBuffer unlocks the sound lock internally, which can
-             * lead to the thread being gc'd and having active = -1. We have to
-             * add a check here to not mess around with stuff. */
-            la->th = NULL;
-            SDL_CondBroadcast( la->cond );
-            alSourceStop( la->source );
-            soundUnlock();
-            return 0;
-         } else {
-            alSourceQueueBuffers( la->source, 1,
-                                  &la->stream_buffers[la->active] );
-            la->active = 1 - la->active;
-         }
+/**
+ * @brief Hands a source over to the decode worker, starting it if necessary.
+ *
+ * Assumes that soundLock() is set.
+ */
+static void stream_add( LuaAudio_t *la )
+{
+   if ( stream_cond == NULL )
+      stream_cond = SDL_CreateCond();
+   if ( stream_sources == NULL )
+      stream_sources = array_create( LuaAudio_t * );
+   array_push_back( &stream_sources, la );
+   la->streaming = 1;
+
+   if ( stream_running ) {
+      SDL_CondBroadcast( stream_cond );
+      return;
+   }
+   SDL_Thread *th = SDL_CreateThread( stream_thread, "stream_thread", NULL );
+   if ( th == NULL ) {
+      WARN( _( "Unable to create audio stream thread: %s" ), SDL_GetError() );
+      array_erase( &stream_sources,
+                   &stream_sources[array_size( stream_sources ) - 1],
+                   &stream_sources[array_size( stream_sources )] );
+      la->streaming = 0;
+      return;
+   }
+   SDL_DetachThread( th );
+   stream_running = 1;
+}
+
+/**
+ * @brief Takes a source away from the decode worker, waiting for it to be
+ * done with the source if it is being decoded.
+ *
+ * Assumes that soundLock() is set.
+ */
+static void stream_remove( LuaAudio_t *la )
+{
+   if ( !la->streaming )
+      return;
+   la->streaming = 0;
+
+   for ( int i = 0; i < array_size( stream_sources ); i++ ) {
+      if ( stream_sources[i] == la ) {
+         array_erase( &stream_sources, &stream_sources[i],
+                      &stream_sources[i + 1] );
+         break;
       }
-      al_checkErr(); /* XXX - good or bad idea to log from the thread? */
-      soundUnlock();
+   }
 
-      SDL_Delay( 10 );
+   while ( stream_busy == la ) {
+      if ( SDL_CondWaitTimeout( stream_cond, sound_lock, 3000 ) ==
+           SDL_MUTEX_TIMEDOUT ) {
+#if DEBUGGING
+         WARN( _( "Timed out while waiting for audio thread of '%s' to "
+                  "finish!" ),
+               la->name );
+#else  /* DEBUGGING */
+         WARN( _( "Timed out while waiting for audio thread to finish!" ) );
+#endif /* DEBUGGING */
+         break;
+      }
    }
 }
 
@@ -200,6 +332,7 @@ static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer )
       /* End of file. */
       if ( result == 0 ) {
          if ( size == 0 ) {
+            soundLock();
             return -2;
          }
          ret = 1;
@@ -208,11 +341,13 @@ static int stream_loadBuffer( LuaAudio_t *la, ALuint buffer )
       /* Hole error. */
       else if ( result == OV_HOLE ) {
          WARN( _( "OGG: Vorbis hole detected in music!" ) );
+         soundLock();
          return 0;
       }
       /* Bad link error. */
       else if ( result == OV_EBADLINK ) {
          WARN( _( "OGG: Invalid stream section or corrupt link in music!" ) );
+         soundLock();
          return -1;
       }
 
@@ -362,24 +497,16 @@ void audio_cleanup( LuaAudio_t *la )
 
    case LUA_AUDIO_STREAM:
       soundLock();
-      if ( la->th != NULL ) {
-         la->active = -1;
-         if ( SDL_CondWaitTimeout( la->cond, sound_lock, 3000 ) ==
-              SDL_MUTEX_TIMEDOUT )
+      stream_remove( la );
 #if DEBUGGING
-            WARN( _( "Timed out while waiting for audio thread of '%s' to "
-                     "finish!" ),
-                  la->name );
-#else  /* DEBUGGING */
-            WARN( _( "Timed out while waiting for audio thread to finish!" ) );
+      if ( la->underruns > 0 )
+         DEBUG( _( "Audio stream '%s' underran %u times (%u total)." ),
+                la->name, la->underruns, stream_underruns );
 #endif /* DEBUGGING */
-      }
       if ( alIsSource( la->source ) == AL_TRUE )
          alDeleteSources( 1, &la->source );
       if ( alIsBuffer( la->stream_buffers[0] ) == AL_TRUE )
-         alDeleteBuffers( 2, la->stream_buffers );
-      if ( la->cond != NULL )
-         SDL_DestroyCond( la->cond );
+         alDeleteBuffers( LUA_AUDIO_STREAM_BUFFERS, la->stream_buffers );
       if ( la->lock != NULL )
          SDL_DestroyMutex( la->lock );
       ov_clear( &la->stream );
@@ -570,8 +697,7 @@ static int audioL_new( lua_State *L )
 
       la.active = 0;
       la.lock   = SDL_CreateMutex();
-      la.cond   = SDL_CreateCond();
-      alGenBuffers( 2, la.stream_buffers );
+      alGenBuffers( LUA_AUDIO_STREAM_BUFFERS, la.stream_buffers );
       /* Buffers get queued later. */
    }
 
@@ -674,21 +800,24 @@ static int audioL_play( lua_State *L )
    if ( sound_disabled || la->ok )
       return 0;
 
-   if ( ( la->type == LUA_AUDIO_STREAM ) && ( la->th == NULL ) ) {
+   if ( la->type == LUA_AUDIO_STREAM ) {
       int   ret = 0;
       ALint alstate;
       soundLock();
-      alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
-      while ( alstate < 2 ) {
-         ret = stream_loadBuffer( la, la->stream_buffers[la->active] );
-         if ( ret < 0 )
-            break;
-         alSourceQueueBuffers( la->source, 1, &la->stream_buffers[la->active] );
-         la->active = 1 - la->active;
+      if ( !la->streaming ) {
          alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
+         while ( alstate < LUA_AUDIO_STREAM_BUFFERS ) {
+            ret = stream_loadBuffer( la, la->stream_buffers[la->active] );
+            if ( ret < 0 )
+               break;
+            alSourceQueueBuffers( la->source, 1,
+                                  &la->stream_buffers[la->active] );
+            la->active = ( la->active + 1 ) % LUA_AUDIO_STREAM_BUFFERS;
+            alGetSourcei( la->source, AL_BUFFERS_QUEUED, &alstate );
+         }
+         if ( ret == 0 )
+            stream_add( la );
       }
-      if ( ret == 0 )
-         la->th = SDL_CreateThread( stream_thread, "stream_thread", la );
    } else
       soundLock();
    alSourcePlay( la->source );
@@ -739,7 +868,7 @@ static int audioL_isPaused( lua_State *L )
 static int audioL_stop( lua_State *L )
 {
    ALint       alstate;
-   ALuint      removed[2];
+   ALuint      removed[LUA_AUDIO_STREAM_BUFFERS];
    LuaAudio_t *la = luaL_checkaudio( L, 1 );
    if ( sound_disabled || la->ok )
       return 0;
@@ -753,20 +882,8 @@ static int audioL_stop( lua_State *L )
       break;
 
    case LUA_AUDIO_STREAM:
-      /* Kill the thread first. */
-      if ( la->th != NULL ) {
-         la->active = -1;
-         if ( SDL_CondWaitTimeout( la->cond, sound_lock, 3000 ) ==
-              SDL_MUTEX_TIMEDOUT )
-#if DEBUGGING
-            WARN( _( "Timed out while waiting for audio thread of '%s' to "
-                     "finish!" ),
-                  la->name );
-#else  /* DEBUGGING */
-            WARN( _( "Timed out while waiting for audio thread to finish!" ) );
-#endif /* DEBUGGING */
-      }
-      la->th = NULL;
+      /* Take it away from the decode worker first. */
+      stream_remove( la );
 
       /* Stopping a source will make all buffers become processed. */
       alSourceStop( la->source );
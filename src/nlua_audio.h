@@ -12,6 +12,8 @@
 #include "nlua.h"
 
 #define AUDIO_METATABLE "audio" /**< Audio metatable identifier. */
+#define LUA_AUDIO_STREAM_BUFFERS                                               \
+   3 /**< Number of buffers each stream cycles through. */
 
 typedef enum LuaAudioType_e {
    LUA_AUDIO_NULL = 0,
@@ -46,10 +48,11 @@ typedef struct LuaAudio_s {
    ALfloat        rg_scale_factor; /**< Replaygain scale factor. */
    ALfloat
           rg_max_scale; /**< Replaygain maximum scale factor before clipping. */
-   ALuint stream_buffers[2]; /**< Double buffering for streaming. */
-   int    active;            /**< Active buffer. */
-   SDL_Thread *th;           /**< Buffering thread. */
-   SDL_cond   *cond;         /**< For message passing. */
+   ALuint stream_buffers[LUA_AUDIO_STREAM_BUFFERS]; /**< Ring of buffers for
+                                                       streaming. */
+   int active;    /**< Next buffer of the ring to fill. */
+   int streaming; /**< Whether the decode worker is servicing the stream. */
+   unsigned int underruns; /**< Times the stream ran out of buffered data. */
 } LuaAudio_t;
 
 /*
@@ -66,3 +69,4 @@ int         lua_isaudio( lua_State *L, int ind );
 /* Useful stuff. */
 void audio_clone( LuaAudio_t *la, const LuaAudio_t *source );
 void audio_cleanup( LuaAudio_t *la );
+void audio_exit( void );
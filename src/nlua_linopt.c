@@ -21,20 +21,64 @@
 
 #include "log.h"
 #include "nluadef.h"
+#include "threadpool.h"
 
 #define LINOPT_MAX_TM                                                          \
    1000 /**< Maximum time to optimize (in ms). Applied to linear relaxation    \
            and MIP independently. */
 
+/**
+ * @brief A single solve of a linear program, possibly on the threadpool.
+ *
+ * GLPK is built to keep its memory in a per-thread environment (see
+ * meson.build), and a problem may only be used from the thread that created
+ * it. Background jobs take a plain copy of the problem on the main thread,
+ * and rebuild, solve and delete it on the worker.
+ */
+typedef struct LinOptJob_s {
+   glp_prob    *prob;      /**< Problem to solve. */
+   glp_smcp     parm_smcp; /**< Simplex parameters. */
+   glp_iocp     parm_iocp; /**< MIP parameters. */
+   int          ismip;     /**< Whether the problem has integer variables. */
+   int          ncols;     /**< Number of structural variables. */
+   int          nrows;     /**< Number of auxiliary variables. */
+   double       z;         /**< Objective value. */
+   double      *x;         /**< Column values. */
+   double      *r;         /**< Row values. */
+   const char  *err;       /**< Error if the solve failed, NULL otherwise. */
+   ThreadQueue *tq;        /**< Queue running the job in the background. */
+   /* Copy of the problem for background jobs. */
+   int     dir;  /**< Optimization direction. */
+   double  c0;   /**< Constant term of the objective function. */
+   int    *type; /**< Bound types of the rows followed by the columns. */
+   int    *stat; /**< Basis statuses of the rows followed by the columns. */
+   double *lb;   /**< Lower bounds of the rows followed by the columns. */
+   double *ub;   /**< Upper bounds of the rows followed by the columns. */
+   double *coef; /**< Objective coefficients of the columns. */
+   int    *kind; /**< Kinds of the columns. */
+   int     ne;   /**< Number of constraint coefficients. */
+   int    *ia;   /**< Rows of the constraint coefficients, 1-based. */
+   int    *ja;   /**< Columns of the constraint coefficients, 1-based. */
+   double *ar;   /**< Constraint coefficients, 1-based. */
+} LinOptJob;
+
 /**
  * @brief Our cute little linear program wrapper.
  */
 typedef struct LuaLinOpt_s {
-   int       ncols; /**< Number of structural variables. */
-   int       nrows; /**< Number of auxiliary variables (constraints). */
-   glp_prob *prob;  /**< Problem structure itself. */
+   int        ncols; /**< Number of structural variables. */
+   int        nrows; /**< Number of auxiliary variables (constraints). */
+   glp_prob  *prob;  /**< Problem structure itself. */
+   LinOptJob *job;   /**< Solve running in the background. */
 } LuaLinOpt_t;
 
+static void linopt_getParams( lua_State *L, LinOptJob *job );
+static int  linopt_solveJob( LinOptJob *job );
+static void linopt_jobCopy( LinOptJob *job, glp_prob *prob );
+static int  linopt_jobThread( void *data );
+static void linopt_jobFree( LinOptJob *job );
+static int  linopt_pushJob( lua_State *L, const LinOptJob *job );
+
 /* Optim metatable methods. */
 static int linoptL_gc( lua_State *L );
 static int linoptL_eq( lua_State *L );
@@ -46,6 +90,8 @@ static int linoptL_setcol( lua_State *L );
 static int linoptL_setrow( lua_State *L );
 static int linoptL_loadmatrix( lua_State *L );
 static int linoptL_solve( lua_State *L );
+static int linoptL_solveStart( lua_State *L );
+static int linoptL_solveWait( lua_State *L );
 static int linoptL_readProblem( lua_State *L );
 static int linoptL_writeProblem( lua_State *L );
 
@@ -60,6 +106,8 @@ static const luaL_Reg linoptL_methods[] = {
    { "set_row", linoptL_setrow },
    { "load_matrix", linoptL_loadmatrix },
    { "solve", linoptL_solve },
+   { "solve_start", linoptL_solveStart },
+   { "solve_wait", linoptL_solveWait },
    { "read_problem", linoptL_readProblem },
    { "write_problem", linoptL_writeProblem },
    { 0, 0 } }; /**< Optim metatable methods. */
@@ -156,6 +204,10 @@ int lua_islinopt( lua_State *L, int ind )
 static int linoptL_gc( lua_State *L )
 {
    LuaLinOpt_t *lp = luaL_checklinopt( L, 1 );
+   if ( lp->job != NULL ) {
+      vpool_wait( lp->job->tq );
+      linopt_jobFree( lp->job );
+   }
    glp_delete_prob( lp->prob );
    return 0;
 }
@@ -208,6 +260,7 @@ static int linoptL_new( lua_State *L )
 
    /* Initialize and create. */
    lp.prob = glp_create_prob();
+   lp.job  = NULL;
    glp_set_prob_name( lp.prob, name );
    glp_add_cols( lp.prob, lp.ncols );
    glp_add_rows( lp.prob, lp.nrows );
@@ -620,43 +673,32 @@ static int opt_onoff( const char *str, int def )
 #define GETOPT_IOCP( name, func, def )                                         \
    do {                                                                        \
       lua_getfield( L, 2, #name );                                             \
-      parm_iocp.name = func( luaL_optstring( L, -1, NULL ), def );             \
+      job->parm_iocp.name = func( luaL_optstring( L, -1, NULL ), def );        \
       lua_pop( L, 1 );                                                         \
    } while ( 0 )
 #define GETOPT_SMCP( name, func, def )                                         \
    do {                                                                        \
       lua_getfield( L, 2, #name );                                             \
-      parm_smcp.name = func( luaL_optstring( L, -1, NULL ), def );             \
+      job->parm_smcp.name = func( luaL_optstring( L, -1, NULL ), def );        \
       lua_pop( L, 1 );                                                         \
    } while ( 0 )
 /**
- * @brief Solves the linear optimization problem.
+ * @brief Sets up the solver parameters of a job.
  *
- *    @luatparam LinOpt lp Linear program to modify.
- *    @luatreturn number The value of the primal funcation.
- *    @luatreturn table Table of column values.
- * @luafunc solve
+ *    @param L Lua state with the parameter table at index 2.
+ *    @param job Job to set up, its problem must already be set.
  */
-static int linoptL_solve( lua_State *L )
+static void linopt_getParams( lua_State *L, LinOptJob *job )
 {
-   LuaLinOpt_t *lp = luaL_checklinopt( L, 1 );
-   double       z;
-   int          ret, ismip;
-   glp_iocp     parm_iocp;
-   glp_smcp     parm_smcp;
-#if DEBUGGING
-   Uint64 starttime = SDL_GetTicks64();
-#endif /* DEBUGGING */
-
    /* Parameters. */
-   ismip = ( glp_get_num_int( lp->prob ) > 0 );
-   glp_init_smcp( &parm_smcp );
-   parm_smcp.msg_lev = GLP_MSG_ERR;
-   parm_smcp.tm_lim  = LINOPT_MAX_TM;
-   if ( ismip ) {
-      glp_init_iocp( &parm_iocp );
-      parm_iocp.msg_lev = GLP_MSG_ERR;
-      parm_iocp.tm_lim  = LINOPT_MAX_TM;
+   job->ismip = ( glp_get_num_int( job->prob ) > 0 );
+   glp_init_smcp( &job->parm_smcp );
+   job->parm_smcp.msg_lev = GLP_MSG_ERR;
+   job->parm_smcp.tm_lim  = LINOPT_MAX_TM;
+   if ( job->ismip ) {
+      glp_init_iocp( &job->parm_iocp );
+      job->parm_iocp.msg_lev = GLP_MSG_ERR;
+      job->parm_iocp.tm_lim  = LINOPT_MAX_TM;
    }
 
    /* Load parameters. */
@@ -665,7 +707,7 @@ static int linoptL_solve( lua_State *L )
       GETOPT_SMCP( pricing, opt_pricing, PRICING_DEF );
       GETOPT_SMCP( r_test, opt_r_test, R_TEST_DEF );
       GETOPT_SMCP( presolve, opt_onoff, PRESOLVE_DEF );
-      if ( ismip ) {
+      if ( job->ismip ) {
          GETOPT_IOCP( br_tech, opt_br_tech, BR_TECH_DEF );
          GETOPT_IOCP( bt_tech, opt_bt_tech, BT_TECH_DEF );
          GETOPT_IOCP( pp_tech, opt_pp_tech, PP_TECH_DEF );
@@ -680,82 +722,85 @@ static int linoptL_solve( lua_State *L )
    }
 #if 0
    else {
-      parm_smcp.meth    = METH_DEF;
-      parm_smcp.pricing = PRICING_DEF;
-      parm_smcp.r_test  = R_TEST_DEF;
-      parm_smcp.presolve= PRESOLVE_DEF;
-      if (ismip) {
-         parm_iocp.br_tech  = BR_TECH_DEF;
-         parm_iocp.bt_tech  = BT_TECH_DEF;
-         parm_iocp.pp_tech  = PP_TECH_DEF;
-         parm_iocp.sr_heur  = SR_HEUR_DEF;
-         parm_iocp.fp_heur  = FP_HEUR_DEF;
-         parm_iocp.ps_heur  = PS_HEUR_DEF;
-         parm_iocp.gmi_cuts = GMI_CUTS_DEF;
-         parm_iocp.mir_cuts = MIR_CUTS_DEF;
-         parm_iocp.cov_cuts = COV_CUTS_DEF;
-         parm_iocp.clq_cuts = CLQ_CUTS_DEF;
+      job->parm_smcp.meth    = METH_DEF;
+      job->parm_smcp.pricing = PRICING_DEF;
+      job->parm_smcp.r_test  = R_TEST_DEF;
+      job->parm_smcp.presolve= PRESOLVE_DEF;
+      if (job->ismip) {
+         job->parm_iocp.br_tech  = BR_TECH_DEF;
+         job->parm_iocp.bt_tech  = BT_TECH_DEF;
+         job->parm_iocp.pp_tech  = PP_TECH_DEF;
+         job->parm_iocp.sr_heur  = SR_HEUR_DEF;
+         job->parm_iocp.fp_heur  = FP_HEUR_DEF;
+         job->parm_iocp.ps_heur  = PS_HEUR_DEF;
+         job->parm_iocp.gmi_cuts = GMI_CUTS_DEF;
+         job->parm_iocp.mir_cuts = MIR_CUTS_DEF;
+         job->parm_iocp.cov_cuts = COV_CUTS_DEF;
+         job->parm_iocp.clq_cuts = CLQ_CUTS_DEF;
       }
    }
 #endif
+}
+#undef GETOPT_SMCP
+#undef GETOPT_IOCP
+
+/**
+ * @brief Solves the problem of a job, storing the results in the job.
+ *
+ * Does not touch Lua, so it is safe to run on any thread.
+ *
+ *    @param job Job to solve.
+ *    @return 0 on success.
+ */
+static int linopt_solveJob( LinOptJob *job )
+{
+   int ret;
+#if DEBUGGING
+   Uint64 starttime = SDL_GetTicks64();
+#endif /* DEBUGGING */
+
+   job->err = NULL;
 
    /* Optimization. */
-   if ( !ismip || !parm_iocp.presolve ) {
-      ret = glp_simplex( lp->prob, &parm_smcp );
+   if ( !job->ismip || !job->parm_iocp.presolve ) {
+      ret = glp_simplex( job->prob, &job->parm_smcp );
       if ( ( ret != 0 ) && ( ret != GLP_ETMLIM ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_error( ret ) );
-         return 2;
+         job->err = linopt_error( ret );
+         return -1;
       }
       /* Check for optimality of continuous problem. */
-      ret = glp_get_status( lp->prob );
+      ret = glp_get_status( job->prob );
       if ( ( ret != GLP_OPT ) && ( ret != GLP_FEAS ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_status( ret ) );
-         return 2;
+         job->err = linopt_status( ret );
+         return -1;
       }
    }
-   if ( ismip ) {
-      ret = glp_intopt( lp->prob, &parm_iocp );
+   if ( job->ismip ) {
+      ret = glp_intopt( job->prob, &job->parm_iocp );
       if ( ( ret != 0 ) && ( ret != GLP_ETMLIM ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_error( ret ) );
-         return 2;
+         job->err = linopt_error( ret );
+         return -1;
       }
       /* Check for optimality of discrete problem. */
-      ret = glp_mip_status( lp->prob );
+      ret = glp_mip_status( job->prob );
       if ( ( ret != GLP_OPT ) && ( ret != GLP_FEAS ) ) {
-         lua_pushnil( L );
-         lua_pushstring( L, linopt_status( ret ) );
-         return 2;
+         job->err = linopt_status( ret );
+         return -1;
       }
    }
-   z = glp_get_obj_val( lp->prob );
-
-   /* Output function value. */
-   lua_pushnumber( L, z );
+   job->z = glp_get_obj_val( job->prob );
 
    /* Go over variables and store them. */
-   lua_newtable( L ); /* t */
-   for ( int i = 1; i <= lp->ncols; i++ ) {
-      if ( ismip )
-         z = glp_mip_col_val( lp->prob, i );
-      else
-         z = glp_get_col_prim( lp->prob, i );
-      lua_pushnumber( L, z );  /* t, z */
-      lua_rawseti( L, -2, i ); /* t */
-   }
+   job->x = malloc( sizeof( double ) * job->ncols );
+   for ( int i = 1; i <= job->ncols; i++ )
+      job->x[i - 1] = job->ismip ? glp_mip_col_val( job->prob, i )
+                                 : glp_get_col_prim( job->prob, i );
 
    /* Go over constraints and store them. */
-   lua_newtable( L ); /* t */
-   for ( int i = 1; i <= lp->nrows; i++ ) {
-      if ( ismip )
-         z = glp_mip_row_val( lp->prob, i );
-      else
-         z = glp_get_row_prim( lp->prob, i );
-      lua_pushnumber( L, z );  /* t, z */
-      lua_rawseti( L, -2, i ); /* t */
-   }
+   job->r = malloc( sizeof( double ) * job->nrows );
+   for ( int i = 1; i <= job->nrows; i++ )
+      job->r[i - 1] = job->ismip ? glp_mip_row_val( job->prob, i )
+                                 : glp_get_row_prim( job->prob, i );
 
    /* Complain about time. */
 #if DEBUGGING
@@ -763,9 +808,229 @@ static int linoptL_solve( lua_State *L )
       WARN( _( "glpk: too over 1 second to optimize!" ) );
 #endif /* DEBUGGING */
 
+   return 0;
+}
+
+/**
+ * @brief Copies a problem into a job, so it can be rebuilt on another thread.
+ */
+static void linopt_jobCopy( LinOptJob *job, glp_prob *prob )
+{
+   int n = job->nrows + job->ncols;
+
+   job->dir  = glp_get_obj_dir( prob );
+   job->c0   = glp_get_obj_coef( prob, 0 );
+   job->type = malloc( sizeof( int ) * n );
+   job->stat = malloc( sizeof( int ) * n );
+   job->lb   = malloc( sizeof( double ) * n );
+   job->ub   = malloc( sizeof( double ) * n );
+   job->coef = malloc( sizeof( double ) * job->ncols );
+   job->kind = malloc( sizeof( int ) * job->ncols );
+   for ( int i = 1; i <= job->nrows; i++ ) {
+      job->type[i - 1] = glp_get_row_type( prob, i );
+      job->stat[i - 1] = glp_get_row_stat( prob, i );
+      job->lb[i - 1]   = glp_get_row_lb( prob, i );
+      job->ub[i - 1]   = glp_get_row_ub( prob, i );
+   }
+   for ( int j = 1; j <= job->ncols; j++ ) {
+      int k            = job->nrows + j - 1;
+      job->type[k]     = glp_get_col_type( prob, j );
+      job->stat[k]     = glp_get_col_stat( prob, j );
+      job->lb[k]       = glp_get_col_lb( prob, j );
+      job->ub[k]       = glp_get_col_ub( prob, j );
+      job->coef[j - 1] = glp_get_obj_coef( prob, j );
+      job->kind[j - 1] = glp_get_col_kind( prob, j );
+   }
+
+   /* Constraint matrix, GLPK arrays start at 1. */
+   n       = glp_get_num_nz( prob ) + 1;
+   job->ne = 0;
+   job->ia = malloc( sizeof( int ) * n );
+   job->ja = malloc( sizeof( int ) * n );
+   job->ar = malloc( sizeof( double ) * n );
+   for ( int i = 1; i <= job->nrows; i++ ) {
+      int len =
+         glp_get_mat_row( prob, i, &job->ja[job->ne], &job->ar[job->ne] );
+      for ( int k = 1; k <= len; k++ )
+         job->ia[job->ne + k] = i;
+      job->ne += len;
+   }
+}
+
+/**
+ * @brief Runs a job on the threadpool.
+ *
+ * The environment GLPK creates for the worker thread is kept for later solves
+ * on the same thread.
+ */
+static int linopt_jobThread( void *data )
+{
+   LinOptJob *job = data;
+
+   /* Rebuild the problem so GLPK only allocates on this thread. */
+   job->prob = glp_create_prob();
+   glp_set_obj_dir( job->prob, job->dir );
+   glp_set_obj_coef( job->prob, 0, job->c0 );
+   if ( job->nrows > 0 )
+      glp_add_rows( job->prob, job->nrows );
+   glp_add_cols( job->prob, job->ncols );
+   for ( int i = 1; i <= job->nrows; i++ ) {
+      glp_set_row_bnds( job->prob, i, job->type[i - 1], job->lb[i - 1],
+                        job->ub[i - 1] );
+      glp_set_row_stat( job->prob, i, job->stat[i - 1] );
+   }
+   for ( int j = 1; j <= job->ncols; j++ ) {
+      int k = job->nrows + j - 1;
+      glp_set_col_kind( job->prob, j, job->kind[j - 1] );
+      glp_set_col_bnds( job->prob, j, job->type[k], job->lb[k], job->ub[k] );
+      glp_set_col_stat( job->prob, j, job->stat[k] );
+      glp_set_obj_coef( job->prob, j, job->coef[j - 1] );
+   }
+   glp_load_matrix( job->prob, job->ne, job->ia, job->ja, job->ar );
+
+   linopt_solveJob( job );
+
+   glp_delete_prob( job->prob );
+   job->prob = NULL;
+   return 0;
+}
+
+/**
+ * @brief Frees a job and its results.
+ */
+static void linopt_jobFree( LinOptJob *job )
+{
+   if ( job->tq != NULL )
+      vpool_cleanup( job->tq );
+   free( job->type );
+   free( job->stat );
+   free( job->lb );
+   free( job->ub );
+   free( job->coef );
+   free( job->kind );
+   free( job->ia );
+   free( job->ja );
+   free( job->ar );
+   free( job->x );
+   free( job->r );
+   free( job );
+}
+
+/**
+ * @brief Pushes the results of a job like linoptL_solve.
+ */
+static int linopt_pushJob( lua_State *L, const LinOptJob *job )
+{
+   if ( job->err != NULL ) {
+      lua_pushnil( L );
+      lua_pushstring( L, job->err );
+      return 2;
+   }
+
+   /* Output function value. */
+   lua_pushnumber( L, job->z );
+
+   /* Variables. */
+   lua_newtable( L ); /* t */
+   for ( int i = 0; i < job->ncols; i++ ) {
+      lua_pushnumber( L, job->x[i] ); /* t, z */
+      lua_rawseti( L, -2, i + 1 );    /* t */
+   }
+
+   /* Constraints. */
+   lua_newtable( L ); /* t */
+   for ( int i = 0; i < job->nrows; i++ ) {
+      lua_pushnumber( L, job->r[i] ); /* t, z */
+      lua_rawseti( L, -2, i + 1 );    /* t */
+   }
+
    return 3;
 }
-#undef GETOPT_IOCP
+
+/**
+ * @brief Solves the linear optimization problem.
+ *
+ *    @luatparam LinOpt lp Linear program to modify.
+ *    @luatparam[opt=nil] table params Solver parameters.
+ *    @luatreturn number The value of the primal funcation.
+ *    @luatreturn table Table of column values.
+ *    @luatreturn table Table of constraint values.
+ * @luafunc solve
+ */
+static int linoptL_solve( lua_State *L )
+{
+   LuaLinOpt_t *lp  = luaL_checklinopt( L, 1 );
+   LinOptJob    job = {
+         .prob  = lp->prob,
+         .ncols = lp->ncols,
+         .nrows = lp->nrows,
+   };
+   int ret;
+
+   linopt_getParams( L, &job );
+   linopt_solveJob( &job );
+   ret = linopt_pushJob( L, &job );
+   free( job.x );
+   free( job.r );
+   return ret;
+}
+
+/**
+ * @brief Starts solving the linear optimization problem in the background.
+ *
+ * The linear program can be modified freely while being solved, as the
+ * threadpool solves its own copy. Get the results with solve_wait.
+ *
+ *    @luatparam LinOpt lp Linear program to solve.
+ *    @luatparam[opt=nil] table params Solver parameters.
+ * @luafunc solve_start
+ */
+static int linoptL_solveStart( lua_State *L )
+{
+   LuaLinOpt_t *lp = luaL_checklinopt( L, 1 );
+   LinOptJob   *job;
+
+   if ( lp->job != NULL )
+      return NLUA_ERROR( L, _( "Linear program is already being solved!" ) );
+
+   job        = calloc( 1, sizeof( LinOptJob ) );
+   job->prob  = lp->prob;
+   job->ncols = lp->ncols;
+   job->nrows = lp->nrows;
+   linopt_getParams( L, job );
+   linopt_jobCopy( job, lp->prob );
+   job->prob = NULL;
+
+   job->tq = vpool_create();
+   vpool_enqueue( job->tq, linopt_jobThread, job );
+   vpool_start( job->tq );
+   lp->job = job;
+   return 0;
+}
+
+/**
+ * @brief Waits for the problem started with solve_start to be solved.
+ *
+ *    @luatparam LinOpt lp Linear program being solved.
+ *    @luatreturn number The value of the primal funcation.
+ *    @luatreturn table Table of column values.
+ *    @luatreturn table Table of constraint values.
+ * @luafunc solve_wait
+ */
+static int linoptL_solveWait( lua_State *L )
+{
+   LuaLinOpt_t *lp = luaL_checklinopt( L, 1 );
+   int          ret;
+
+   if ( lp->job == NULL )
+      return NLUA_ERROR( L, _( "Linear program is not being solved!" ) );
+
+   vpool_wait( lp->job->tq );
+   ret = linopt_pushJob( L, lp->job );
+   linopt_jobFree( lp->job );
+   lp->job = NULL;
+   return ret;
+}
 
 /**
  * @brief Reads an optimization problem from a file for debugging purposes.
@@ -791,6 +1056,7 @@ static int linoptL_readProblem( lua_State *L )
       return NLUA_ERROR( L, _( "Failed to read LP problem \"%s\"!" ), fname );
    SDL_asprintf( &fpath, "%s/%s", dirname, fname );
    lp.prob = glp_create_prob();
+   lp.job  = NULL;
    ret     = glpk_format ? glp_read_prob( lp.prob, 0, fpath )
                          : glp_read_mps( lp.prob, GLP_MPS_FILE, NULL, fpath );
    free( fpath );
@@ -539,6 +539,23 @@ LuaPilot luaL_checkpilot( lua_State *L, int ind )
    luaL_typerror( L, ind, PILOT_METATABLE );
    return 0;
 }
+/**
+ * @brief Gets the actual pilot at index.
+ *
+ * Raises an error if there is no pilot at index.
+ *
+ *    @param L Lua state to get pilot from.
+ *    @param ind Index position to find pilot.
+ *    @return The pilot or NULL if it no longer exists.
+ */
+Pilot *luaL_getpilot( lua_State *L, int ind )
+{
+   if ( !lua_ispilot( L, ind ) ) {
+      luaL_typerror( L, ind, PILOT_METATABLE );
+      return NULL;
+   }
+   return pilot_get( lua_topilot( L, ind ) );
+}
 /**
  * @brief Makes sure the pilot is valid or raises a Lua error.
  *
@@ -548,7 +565,7 @@ LuaPilot luaL_checkpilot( lua_State *L, int ind )
  */
 Pilot *luaL_validpilot( lua_State *L, int ind )
 {
-   Pilot *p = pilot_get( luaL_checkpilot( L, ind ) );
+   Pilot *p = luaL_getpilot( L, ind );
    if ( p == NULL ) {
       NLUA_ERROR( L, _( "Pilot is invalid." ) );
       return NULL;
@@ -836,7 +853,7 @@ static int pilotL_clone( lua_State *L )
  */
 static int pilotL_remove( lua_State *L )
 {
-   Pilot *p = pilot_get( luaL_checkpilot( L, 1 ) );
+   Pilot *p = luaL_getpilot( L, 1 );
    if ( p == NULL )
       return 0;
 
@@ -1401,8 +1418,7 @@ static int pilotL_eq( lua_State *L )
  */
 static int pilotL_tostring( lua_State *L )
 {
-   LuaPilot     lp = luaL_checkpilot( L, 1 );
-   const Pilot *p  = pilot_get( lp );
+   const Pilot *p = luaL_getpilot( L, 1 );
    if ( p != NULL )
       lua_pushstring( L, p->name );
    else
@@ -1457,7 +1473,7 @@ static int pilotL_id( lua_State *L )
 static int pilotL_exists( lua_State *L )
 {
    int          exists;
-   const Pilot *p = pilot_get( luaL_checkpilot( L, 1 ) );
+   const Pilot *p = luaL_getpilot( L, 1 );
 
    /* Must still be kicking and alive. */
    if ( p == NULL )
@@ -4288,7 +4304,7 @@ static int pilotL_effectClear( lua_State *L )
    else
       effect_clearSpecific( &p->effects, !keepdebuffs, !keepbuffs,
                             !keepothers );
-   pilot_calcStats( p );
+   pilot_calcStatsSource( p, PILOT_STATS_EFFECTS );
    return 0;
 }
 
@@ -4312,7 +4328,7 @@ static int pilotL_effectAdd( lua_State *L )
    const EffectData *efx        = effect_get( effectname );
    if ( efx != NULL ) {
       if ( !effect_add( &p->effects, efx, duration, scale, p->id ) )
-         pilot_calcStats( p );
+         pilot_calcStatsSource( p, PILOT_STATS_EFFECTS );
       lua_pushboolean( L, 1 );
    } else
       lua_pushboolean( L, 0 );
@@ -4335,14 +4351,14 @@ static int pilotL_effectRm( lua_State *L )
    if ( lua_isnumber( L, 2 ) ) {
       int idx = lua_tointeger( L, 2 );
       if ( effect_rm( &p->effects, idx ) )
-         pilot_calcStats( p );
+         pilot_calcStatsSource( p, PILOT_STATS_EFFECTS );
    } else {
       const char       *effectname = luaL_checkstring( L, 2 );
       int               all        = lua_toboolean( L, 3 );
       const EffectData *efx        = effect_get( effectname );
       if ( efx != NULL ) {
          if ( effect_rmType( &p->effects, efx, all ) )
-            pilot_calcStats( p );
+            pilot_calcStatsSource( p, PILOT_STATS_EFFECTS );
       }
    }
    return 0;
@@ -6556,8 +6572,6 @@ static int pilotL_collisionTest( lua_State *L )
       poly_rotate( &rpoly, &a->polygon->views[0], (float)a->ang );
       int ret = CollidePolygon( getCollPoly( p ), &p->solid.pos, &rpoly,
                                 &a->sol.pos, &crash );
-      free( rpoly.x );
-      free( rpoly.y );
       if ( !ret )
          return 0;
       lua_pushvector( L, crash );
@@ -18,8 +18,8 @@
 /**
  * @brief Lua Pilot wrapper.
  *
- * TODO probably wrap pilots with id + index, so we can try the index look-up
- * first and fall back to bsearch otherwise.
+ * Pilot ids index the pilot slot map directly, so look-ups are O(1) and
+ * there is nothing else worth caching in the userdata.
  */
 typedef unsigned int LuaPilot; /**< Wrapper for a Pilot. */
 
@@ -35,4 +35,5 @@ LuaPilot  lua_topilot( lua_State *L, int ind );
 LuaPilot  luaL_checkpilot( lua_State *L, int ind );
 LuaPilot *lua_pushpilot( lua_State *L, LuaPilot pilot );
 Pilot    *luaL_validpilot( lua_State *L, int ind );
+Pilot    *luaL_getpilot( lua_State *L, int ind );
 int       lua_ispilot( lua_State *L, int ind );
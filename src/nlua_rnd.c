@@ -5,6 +5,9 @@
  * @file nlua_rnd.c
  *
  * @brief Lua bindings for the Naev random number generator.
+ *
+ * Every environment gets its own counter-based stream so scripts do not
+ * perturb each other nor the main thread generator.
  */
 /** @cond */
 #include <lauxlib.h>
@@ -16,6 +19,14 @@
 #include "nluadef.h"
 #include "rng.h"
 
+#define RND_STREAM "__rng" /**< Environment field holding the stream. */
+
+static uint32_t rnd_nstreams =
+   0; /**< Streams handed out, environment refs get reused so they can't be
+         used as the stream id. */
+
+static RngStream *rnd_stream( lua_State *L );
+
 /* Random methods. */
 static int rndL_int( lua_State *L );
 static int rndL_sigma( lua_State *L );
@@ -42,10 +53,34 @@ static const luaL_Reg rnd_methods[] = { { "rnd", rndL_int },
  */
 int nlua_loadRnd( nlua_env env )
 {
+   RngStream *s = lua_newuserdata( naevL, sizeof( RngStream ) );
+   rng_streamInit( s, RNG_SUBSYS_LUA, rnd_nstreams++ );
+   nlua_setenv( naevL, env, RND_STREAM );
+
    nlua_register( env, "rnd", rnd_methods, 0 );
    return 0;
 }
 
+/**
+ * @brief Gets the random stream of the current environment.
+ *
+ * Falls back to the stream of the calling thread when not running inside an
+ * environment.
+ *
+ *    @param L Lua state.
+ *    @return The stream to draw from.
+ */
+static RngStream *rnd_stream( lua_State *L )
+{
+   RngStream *s;
+   if ( __NLUA_CURENV == LUA_NOREF )
+      return rng_threadStream();
+   nlua_getenv( L, __NLUA_CURENV, RND_STREAM );
+   s = lua_touserdata( L, -1 );
+   lua_pop( L, 1 );
+   return ( s != NULL ) ? s : rng_threadStream();
+}
+
 /**
  * @brief Bindings for interacting with the random number generator.
  *
@@ -83,18 +118,19 @@ int nlua_loadRnd( nlua_env env )
  */
 static int rndL_int( lua_State *L )
 {
-   int l, h;
-   int o = lua_gettop( L );
+   int        l, h;
+   int        o = lua_gettop( L );
+   RngStream *s = rnd_stream( L );
 
    if ( o == 0 )
-      lua_pushnumber( L, RNGF() ); /* random double 0 <= x <= 1 */
-   else if ( o == 1 ) {            /* random int 0 <= x <= parameter */
+      lua_pushnumber( L, RNGSF( s ) ); /* random double 0 <= x <= 1 */
+   else if ( o == 1 ) {                /* random int 0 <= x <= parameter */
       l = luaL_checkint( L, 1 );
-      lua_pushnumber( L, RNG( 0, l ) );
+      lua_pushnumber( L, RNGS( s, 0, l ) );
    } else if ( o >= 2 ) { /* random int parameter 1 <= x <= parameter 2 */
       l = luaL_checkint( L, 1 );
       h = luaL_checkint( L, 2 );
-      lua_pushnumber( L, RNG( l, h ) );
+      lua_pushnumber( L, RNGS( s, l, h ) );
    } else
       NLUA_INVALID_PARAMETER( L, 1 );
 
@@ -116,7 +152,7 @@ static int rndL_int( lua_State *L )
  */
 static int rndL_sigma( lua_State *L )
 {
-   lua_pushnumber( L, RNG_1SIGMA() );
+   lua_pushnumber( L, RNGS_1SIGMA( rnd_stream( L ) ) );
    return 1;
 }
 /**
@@ -135,7 +171,7 @@ static int rndL_sigma( lua_State *L )
  */
 static int rndL_twosigma( lua_State *L )
 {
-   lua_pushnumber( L, RNG_2SIGMA() );
+   lua_pushnumber( L, RNGS_2SIGMA( rnd_stream( L ) ) );
    return 1;
 }
 /**
@@ -155,7 +191,7 @@ static int rndL_twosigma( lua_State *L )
  */
 static int rndL_threesigma( lua_State *L )
 {
-   lua_pushnumber( L, RNG_3SIGMA() );
+   lua_pushnumber( L, RNGS_3SIGMA( rnd_stream( L ) ) );
    return 1;
 }
 
@@ -174,17 +210,18 @@ static int rndL_threesigma( lua_State *L )
  */
 static int rndL_uniform( lua_State *L )
 {
-   int o = lua_gettop( L );
+   int        o = lua_gettop( L );
+   RngStream *s = rnd_stream( L );
 
    if ( o == 0 )
-      lua_pushnumber( L, RNGF() ); /* random double 0 <= x <= 1 */
-   else if ( o == 1 ) {            /* random int 0 <= x <= parameter */
+      lua_pushnumber( L, RNGSF( s ) ); /* random double 0 <= x <= 1 */
+   else if ( o == 1 ) {                /* random int 0 <= x <= parameter */
       int l = luaL_checknumber( L, 1 );
-      lua_pushnumber( L, RNGF() * l );
+      lua_pushnumber( L, RNGSF( s ) * l );
    } else if ( o >= 2 ) { /* random int parameter 1 <= x <= parameter 2 */
       int l = luaL_checknumber( L, 1 );
       int h = luaL_checknumber( L, 2 );
-      lua_pushnumber( L, l + ( h - l ) * RNGF() );
+      lua_pushnumber( L, l + ( h - l ) * RNGSF( s ) );
    } else
       NLUA_INVALID_PARAMETER( L, 1 );
 
@@ -201,7 +238,7 @@ static int rndL_uniform( lua_State *L )
  */
 static int rndL_angle( lua_State *L )
 {
-   lua_pushnumber( L, RNGF() * 2. * M_PI );
+   lua_pushnumber( L, RNGSF( rnd_stream( L ) ) * 2. * M_PI );
    return 1;
 }
 
@@ -221,9 +258,10 @@ static int rndL_angle( lua_State *L )
  */
 static int rndL_permutation( lua_State *L )
 {
-   int *values;
-   int  max;
-   int  new_table;
+   int       *values;
+   int        max;
+   int        new_table;
+   RngStream *s = rnd_stream( L );
 
    if ( lua_isnumber( L, 1 ) ) {
       max       = lua_tointeger( L, 1 );
@@ -242,7 +280,7 @@ static int rndL_permutation( lua_State *L )
    /* Fisher-Yates shuffling algorithm */
    for ( int i = max - 1; i >= 0; --i ) {
       /* Generate a random number in the range [0, max-1] */
-      int j = randint() % ( i + 1 );
+      int j = rng_streamInt( s ) % ( i + 1 );
 
       /* Swap the last element with an element at a random index. */
       int temp  = values[i];
@@ -43,6 +43,7 @@ static int shipL_CPU( lua_State *L );
 static int shipL_gfxComm( lua_State *L );
 static int shipL_gfxStore( lua_State *L );
 static int shipL_gfx( lua_State *L );
+static int shipL_gfxPrefetch( lua_State *L );
 static int shipL_dims( lua_State *L );
 static int shipL_screenSize( lua_State *L );
 static int shipL_price( lua_State *L );
@@ -74,6 +75,7 @@ static const luaL_Reg shipL_methods[] = {
    { "gfxComm", shipL_gfxComm },
    { "gfxStore", shipL_gfxStore },
    { "gfx", shipL_gfx },
+   { "gfxPrefetch", shipL_gfxPrefetch },
    { "dims", shipL_dims },
    { "screenSize", shipL_screenSize },
    { "description", shipL_description },
@@ -640,6 +642,24 @@ static int shipL_gfx( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Starts loading the graphics of a ship in the background.
+ *
+ * Useful for ships that are likely to be used soon, to avoid stalling when
+ * they are first needed.
+ *
+ * @usage s:gfxPrefetch()
+ *
+ *    @luatparam Ship s Ship to load graphics of.
+ * @luafunc gfxPrefetch
+ */
+static int shipL_gfxPrefetch( lua_State *L )
+{
+   const Ship *s = luaL_validship( L, 1 );
+   ship_gfxPrefetch( (Ship *)s );
+   return 0;
+}
+
 /**
  * @brief Gets the onscreen dimensions of the ship.
  *
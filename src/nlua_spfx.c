@@ -21,6 +21,7 @@
 #include "nopenal.h"
 #include "ntracing.h"
 #include "opengl.h"
+#include "physics.h"
 #include "player.h"
 #include "sound.h"
 
@@ -724,8 +725,9 @@ static void spfxL_renderLayer( int func, const char *funcname, double dt )
       if ( ( funcref == LUA_NOREF ) || ( ls->flags & SPFX_CLEANUP ) )
          continue;
 
-      /* Convert coordinates. */
-      gl_gameToScreenCoords( &pos.x, &pos.y, ls->pos.x, ls->pos.y );
+      /* Convert coordinates, lagging behind the simulation like the rest. */
+      solid_renderPosVec( &pos, &ls->pos, &ls->vel );
+      gl_gameToScreenCoords( &pos.x, &pos.y, pos.x, pos.y );
 
       /* If radius is defined see if in screen. */
       if ( ( r > 0. ) &&
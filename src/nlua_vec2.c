@@ -33,6 +33,11 @@ static int vectorL_mul( lua_State *L );
 static int vectorL_div__( lua_State *L );
 static int vectorL_div( lua_State *L );
 static int vectorL_unm( lua_State *L );
+static int vectorL_addi( lua_State *L );
+static int vectorL_subi( lua_State *L );
+static int vectorL_muli( lua_State *L );
+static int vectorL_divi( lua_State *L );
+static int vectorL_normalizei( lua_State *L );
 static int vectorL_dot( lua_State *L );
 static int vectorL_cross( lua_State *L );
 static int vectorL_get( lua_State *L );
@@ -47,6 +52,10 @@ static int vectorL_normalize( lua_State *L );
 static int vectorL_collideLineLine( lua_State *L );
 static int vectorL_collideCircleLine( lua_State *L );
 
+static void vectorL_checkoperand( lua_State *L, int ind, double *x,
+                                  double *y );
+static vec2 *vectorL_normalizeArg( lua_State *L );
+
 static const luaL_Reg vector_methods[] = {
    { "new", vectorL_new },
    { "newP", vectorL_newP },
@@ -61,6 +70,11 @@ static const luaL_Reg vector_methods[] = {
    { "__div", vectorL_div },
    { "div", vectorL_div__ },
    { "__unm", vectorL_unm },
+   { "addi", vectorL_addi },
+   { "subi", vectorL_subi },
+   { "muli", vectorL_muli },
+   { "divi", vectorL_divi },
+   { "normalizei", vectorL_normalizei },
    { "dot", vectorL_dot },
    { "cross", vectorL_cross },
    { "get", vectorL_get },
@@ -513,6 +527,124 @@ static int vectorL_unm( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Gets the operand of an in-place operation.
+ *
+ * The operand can be either a vector, a number used for both coordinates or a
+ * pair of numbers.
+ *
+ *    @param L Lua state to get operand from.
+ *    @param ind Index of the operand.
+ *    @param[out] x X value of the operand.
+ *    @param[out] y Y value of the operand.
+ */
+static void vectorL_checkoperand( lua_State *L, int ind, double *x,
+                                  double *y )
+{
+   if ( lua_isvector( L, ind ) ) {
+      const vec2 *v = lua_tovector( L, ind );
+      *x            = v->x;
+      *y            = v->y;
+   } else {
+      *x = luaL_checknumber( L, ind );
+      if ( !lua_isnoneornil( L, ind + 1 ) )
+         *y = luaL_checknumber( L, ind + 1 );
+      else
+         *y = *x;
+   }
+}
+
+/**
+ * @brief Adds to a vector in place without creating a new vector.
+ *
+ * Unlike vec2.add, this returns the same vector instead of a copy, so it does
+ * not allocate any memory and is preferable in hot code.
+ *
+ * @usage my_vec:addi( your_vec ) -- my_vec is modified and returned
+ * @usage my_vec:addi( 5, 3 )
+ *
+ *    @luatparam Vec2 v Vector to modify.
+ *    @luatparam number|Vec2 x X coordinate or vector to add.
+ *    @luatparam number|nil y Y coordinate or nil to add.
+ *    @luatreturn Vec2 The same vector v.
+ * @luafunc addi
+ */
+static int vectorL_addi( lua_State *L )
+{
+   double x, y;
+   vec2  *v = luaL_checkvector( L, 1 );
+   vectorL_checkoperand( L, 2, &x, &y );
+   vec2_cset( v, v->x + x, v->y + y );
+   lua_settop( L, 1 );
+   return 1;
+}
+
+/**
+ * @brief Subtracts from a vector in place without creating a new vector.
+ *
+ * @usage my_vec:subi( your_vec ) -- my_vec is modified and returned
+ * @usage my_vec:subi( 5, 3 )
+ *
+ *    @luatparam Vec2 v Vector to modify.
+ *    @luatparam number|Vec2 x X coordinate or vector to subtract.
+ *    @luatparam number|nil y Y coordinate or nil to subtract.
+ *    @luatreturn Vec2 The same vector v.
+ * @luafunc subi
+ */
+static int vectorL_subi( lua_State *L )
+{
+   double x, y;
+   vec2  *v = luaL_checkvector( L, 1 );
+   vectorL_checkoperand( L, 2, &x, &y );
+   vec2_cset( v, v->x - x, v->y - y );
+   lua_settop( L, 1 );
+   return 1;
+}
+
+/**
+ * @brief Multiplies a vector in place without creating a new vector.
+ *
+ * @usage my_vec:muli( 3 ) -- my_vec is modified and returned
+ * @usage my_vec:muli( your_vec ) -- Component-wise multiplication.
+ *
+ *    @luatparam Vec2 v Vector to modify.
+ *    @luatparam number|Vec2 x Amount or vector to multiply by.
+ *    @luatparam number|nil y Y amount to multiply by or nil.
+ *    @luatreturn Vec2 The same vector v.
+ * @luafunc muli
+ */
+static int vectorL_muli( lua_State *L )
+{
+   double x, y;
+   vec2  *v = luaL_checkvector( L, 1 );
+   vectorL_checkoperand( L, 2, &x, &y );
+   vec2_cset( v, v->x * x, v->y * y );
+   lua_settop( L, 1 );
+   return 1;
+}
+
+/**
+ * @brief Divides a vector in place without creating a new vector.
+ *
+ * @usage my_vec:divi( 3 ) -- my_vec is modified and returned
+ * @usage my_vec:divi( your_vec ) -- Component-wise division.
+ *
+ *    @luatparam Vec2 v Vector to modify.
+ *    @luatparam number|Vec2 x Amount or vector to divide by.
+ *    @luatparam number|nil y Y amount to divide by or nil.
+ *    @luatreturn Vec2 The same vector v.
+ * @luafunc divi
+ */
+static int vectorL_divi( lua_State *L )
+{
+   double x, y;
+   vec2  *v = luaL_checkvector( L, 1 );
+   vectorL_checkoperand( L, 2, &x, &y );
+   vec2_cset( v, v->x / x, v->y / y );
+   lua_settop( L, 1 );
+   return 1;
+}
+
 /**
  * @brief Dot product of two vectors.
  *
@@ -719,6 +851,21 @@ static int vectorL_angle( lua_State *L )
    return 1;
 }
 
+/**
+ * @brief Normalizes the vector argument of normalize and normalizei in place.
+ *
+ *    @param L Lua state with the vector and optional length.
+ *    @return The normalized vector.
+ */
+static vec2 *vectorL_normalizeArg( lua_State *L )
+{
+   vec2  *v = luaL_checkvector( L, 1 );
+   double n = luaL_optnumber( L, 2, 1. );
+   double m = n / MAX( VMOD( *v ), DOUBLE_TOL );
+   vec2_cset( v, v->x * m, v->y * m );
+   return v;
+}
+
 /**
  * @brief Normalizes a vector.
  *    @luatparam Vec2 v Vector to normalize.
@@ -728,12 +875,21 @@ static int vectorL_angle( lua_State *L )
  */
 static int vectorL_normalize( lua_State *L )
 {
-   vec2  *v = luaL_checkvector( L, 1 );
-   double n = luaL_optnumber( L, 2, 1. );
-   double m = n / MAX( VMOD( *v ), DOUBLE_TOL );
-   v->x *= m;
-   v->y *= m;
-   lua_pushvector( L, *v );
+   lua_pushvector( L, *vectorL_normalizeArg( L ) );
+   return 1;
+}
+
+/**
+ * @brief Normalizes a vector in place without creating a new vector.
+ *    @luatparam Vec2 v Vector to normalize.
+ *    @luatparam[opt=1] number n Length to normalize the vector to.
+ *    @luatreturn Vec2 The same vector v.
+ * @luafunc normalizei
+ */
+static int vectorL_normalizei( lua_State *L )
+{
+   vectorL_normalizeArg( L );
+   lua_settop( L, 1 );
    return 1;
 }
 
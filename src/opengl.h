@@ -16,11 +16,11 @@
 #include "opengl_tex.h"    // IWYU pragma: export
 #include "opengl_vbo.h"    // IWYU pragma: export
 
-#define OPENGL_NUM_FBOS 4 /**< Number of FBOs to allocate and deal with. */
+#define OPENGL_NUM_FBOS 3 /**< Number of FBOs to allocate and deal with. */
 /** Currently used FBO IDs:
  * 0/1: front/back buffer for rendering
  * 2: temporary scratch buffer to use as necessary
- * 3: Used by toolkit */
+ * The toolkit keeps its own framebuffer per window. */
 
 /*
  * Contains info about the opengl screen
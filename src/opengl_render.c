@@ -541,7 +541,7 @@ void gl_gameToScreenCoords( double *nx, double *ny, double bx, double by )
    double cx, cy, gx, gy, z;
 
    /* Get parameters. */
-   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &cx, &cy );
    z = cam_getZoom();
    gui_getOffset( &gx, &gy );
 
@@ -562,7 +562,7 @@ mat4 gl_gameToScreenMatrix( mat4 lhs )
    mat4   projection = lhs;
 
    /* Get parameters. */
-   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &cx, &cy );
    z = cam_getZoom();
    gui_getOffset( &gx, &gy );
 
@@ -585,7 +585,7 @@ void gl_screenToGameCoords( double *nx, double *ny, int bx, int by )
    double cx, cy, gx, gy, z;
 
    /* Get parameters. */
-   cam_getPos( &cx, &cy );
+   cam_getRenderPos( &cx, &cy );
    z = cam_getZoom();
    gui_getOffset( &gx, &gy );
 
@@ -51,8 +51,9 @@ static SDL_mutex   *tex_lock = NULL; /**< Lock for texture list manipulation. */
 /* misc */
 static uint8_t             SDL_GetAlpha( SDL_Surface *s, int x, int y );
 static int                 SDL_IsTrans( SDL_Surface *s, int x, int y );
-static USE_RESULT uint8_t *SDL_MapAlpha( SDL_Surface *s, int tight );
-static size_t              gl_transSize( const int w, const int h );
+static USE_RESULT uint8_t  *SDL_MapAlpha( SDL_Surface *s );
+static USE_RESULT uint64_t *SDL_MapTrans( SDL_Surface *s );
+static size_t               gl_transSize( const int w, const int h );
 /* glTexture */
 static USE_RESULT GLuint gl_texParameters( unsigned int flags );
 static USE_RESULT GLuint gl_loadSurface( SDL_Surface *surface,
@@ -63,6 +64,8 @@ static int gl_loadNewImage( glTexture *tex, const char *path, int sx, int sy,
 static int gl_loadNewImageRWops( glTexture *tex, const char *path,
                                  SDL_RWops *rw, int sx, int sy,
                                  unsigned int flags );
+static void gl_loadNewImageSurface( glTexture *tex, SDL_Surface *surface,
+                                    int sx, int sy, unsigned int flags );
 /* List. */
 static glTexture *gl_texExistsOrCreate( const char *path, unsigned int flags,
                                         int sx, int sy, int *created );
@@ -158,46 +161,52 @@ static int SDL_IsTrans( SDL_Surface *s, int x, int y )
    return a > 127;
 }
 
+/**
+ * @brief Maps the surface alpha.
+ *
+ *    @param s Surface to map its alpha.
+ *    @return Byte per pixel alpha map.
+ */
+static uint8_t *SDL_MapAlpha( SDL_Surface *s )
+{
+   int      w = s->w;
+   int      h = s->h;
+   uint8_t *t = malloc( w * h );
+   /* Check each pixel individually. */
+   for ( int i = 0; i < h; i++ )
+      for ( int j = 0; j < w; j++ )
+         t[i * w + j] = SDL_GetAlpha( s, j, i );
+   return t;
+}
+
 /**
  * @brief Maps the surface transparency.
  *
  * Basically generates a map of what pixels are transparent.  Good for pixel
- *  perfect collision routines.
+ *  perfect collision routines. Each row is stored as a bit per pixel in 64
+ *  bit words, set if the pixel is not transparent, so collision routines can
+ *  test 64 pixels at a time.
  *
  *    @param s Surface to map its transparency.
- *    @param tight Whether or not to store transparency per bit or
- *    @return 0 on success.
+ *    @return The transparency map or NULL on error.
  */
-static uint8_t *SDL_MapAlpha( SDL_Surface *s, int tight )
+static uint64_t *SDL_MapTrans( SDL_Surface *s )
 {
-   uint8_t *t;
-   int      w = s->w;
-   int      h = s->h;
+   int       w      = s->w;
+   int       h      = s->h;
+   int       stride = GL_TRANS_STRIDE( w );
+   uint64_t *t      = calloc( 1, gl_transSize( w, h ) );
+   if ( t == NULL ) {
+      WARN( _( "Out of Memory" ) );
+      return NULL;
+   }
 
-   if ( tight ) {
-      /* alloc memory for just enough bits to hold all the data we need */
-      size_t size = gl_transSize( w, h );
-      t           = malloc( size );
-      if ( t == NULL ) {
-         WARN( _( "Out of Memory" ) );
-         return NULL;
-      }
-      memset( t, 0, size ); /* important, must be set to zero */
-
-      /* Check each pixel individually. */
-      for ( int i = 0; i < h; i++ )
-         for ( int j = 0; j < w;
-               j++ ) /* sets each bit to be 1 if not transparent or 0 if is */
-            t[( i * w + j ) / 8] |=
-               ( SDL_IsTrans( s, j, i ) ) ? 0 : ( 1 << ( ( i * w + j ) % 8 ) );
-   } else {
-      t = malloc( w * h );
-      /* Check each pixel individually. */
-      for ( int i = 0; i < h; i++ )
-         for ( int j = 0; j < w;
-               j++ ) /* sets each bit to be 1 if not transparent or 0 if is */
-            t[i * w + j] = SDL_GetAlpha(
-               s, j, i ); /* Flipped with tight version, this is not good :/ */
+   /* Check each pixel individually, padding bits stay zero. */
+   for ( int i = 0; i < h; i++ ) {
+      uint64_t *row = &t[i * stride];
+      for ( int j = 0; j < w; j++ )
+         if ( !SDL_IsTrans( s, j, i ) )
+            row[j / 64] |= UINT64_C( 1 ) << ( j % 64 );
    }
 
    return t;
@@ -212,8 +221,8 @@ static uint8_t *SDL_MapAlpha( SDL_Surface *s, int tight )
  */
 static size_t gl_transSize( const int w, const int h )
 {
-   /* One bit per pixel, plus remainder. */
-   return w * h / 8 + ( ( w * h % 8 ) ? 1 : 0 );
+   /* One bit per pixel, rows padded to whole words. */
+   return (size_t)h * GL_TRANS_STRIDE( w ) * sizeof( uint64_t );
 }
 
 /**
@@ -420,7 +429,7 @@ static GLuint gl_loadSurface( SDL_Surface *surface, unsigned int flags,
    SDL_LockSurface( rgba );
    if ( flags & OPENGL_TEX_SDF ) {
       const float border[] = { 0., 0., 0., 0. };
-      uint8_t    *trans    = SDL_MapAlpha( rgba, 0 );
+      uint8_t    *trans    = SDL_MapAlpha( rgba );
       GLfloat    *dataf = make_distance_mapbf( trans, rgba->w, rgba->h, vmax );
       free( trans );
       glTexParameterfv( GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border );
@@ -682,7 +691,7 @@ static int gl_loadNewImageRWops( glTexture *tex, const char *path,
       md5_state_t md5;
       char       *data;
       char       *cachefile = NULL;
-      uint8_t    *trans     = NULL;
+      uint64_t   *trans     = NULL;
       md5_byte_t *md5val    = malloc( 16 );
       md5_init( &md5 );
       char digest[33];
@@ -708,11 +717,12 @@ static int gl_loadNewImageRWops( glTexture *tex, const char *path,
          snprintf( &digest[i * 2], 3, "%02x", md5val[i] );
       free( md5val );
 
-      SDL_asprintf( &cachefile, "%scollisions/%s", nfile_cachePath(), digest );
+      SDL_asprintf( &cachefile, "%scollisions64/%s", nfile_cachePath(),
+                    digest );
 
       /* Attempt to find a cached transparency map. */
       if ( nfile_fileExists( cachefile ) ) {
-         trans = (uint8_t *)nfile_readFile( &filesize, cachefile );
+         trans = (uint64_t *)nfile_readFile( &filesize, cachefile );
 
          /* Consider cached data invalid if the length doesn't match. */
          if ( trans != NULL && cachesize != (unsigned int)filesize ) {
@@ -728,23 +738,43 @@ static int gl_loadNewImageRWops( glTexture *tex, const char *path,
 
       if ( trans == NULL ) {
          SDL_LockSurface( surface );
-         trans = SDL_MapAlpha( surface, 1 );
+         trans = SDL_MapTrans( surface );
          SDL_UnlockSurface( surface );
 
          if ( cachefile != NULL ) {
             /* Cache newly-generated transparency map. */
             char dirpath[PATH_MAX];
             snprintf( dirpath, sizeof( dirpath ), "%s/%s", nfile_cachePath(),
-                      "collisions/" );
+                      "collisions64/" );
             nfile_dirMakeExist( dirpath );
             nfile_writeFile( (char *)trans, cachesize, cachefile );
             free( cachefile );
          }
       }
 
-      tex->trans = trans;
+      tex->trans        = trans;
+      tex->trans_stride = GL_TRANS_STRIDE( surface->w );
    }
 
+   gl_loadNewImageSurface( tex, surface, sx, sy, flags );
+
+   /* Clean up. */
+   SDL_FreeSurface( surface );
+   return 0;
+}
+
+/**
+ * @brief Uploads a decoded image to a texture.
+ *
+ *    @param tex Texture to load to.
+ *    @param surface Decoded image, not freed.
+ *    @param sx X sprites to load.
+ *    @param sy Y sprites to load.
+ *    @param flags Flags to control image parameters.
+ */
+static void gl_loadNewImageSurface( glTexture *tex, SDL_Surface *surface,
+                                    int sx, int sy, unsigned int flags )
+{
    /* Load image if necessary. */
    tex->w  = (double)surface->w;
    tex->h  = (double)surface->h;
@@ -758,10 +788,6 @@ static int gl_loadNewImageRWops( glTexture *tex, const char *path,
    tex->srw   = tex->sw / tex->w;
    tex->srh   = tex->sh / tex->h;
    tex->flags = flags;
-
-   /* Clean up. */
-   SDL_FreeSurface( surface );
-   return 0;
 }
 
 /**
@@ -786,6 +812,34 @@ glTexture *gl_newSprite( const char *path, const int sx, const int sy,
    return t;
 }
 
+/**
+ * @brief Loads a sprite from an image that was already decoded.
+ *
+ * Allows decoding the image on another thread and only uploading it on the
+ * main one. Transparency mapping is not supported, as it needs the file.
+ *
+ *    @param path Path of the image for deduplication.
+ *    @param surface Decoded image, not freed.
+ *    @param sx Number of X sprites in image.
+ *    @param sy Number of Y sprites in image.
+ *    @param flags Flags to control image parameters.
+ *    @return Texture loaded.
+ */
+glTexture *gl_newSpriteSurface( const char *path, SDL_Surface *surface,
+                                const int sx, const int sy,
+                                const unsigned int flags )
+{
+   int        created;
+   glTexture *t = gl_texExistsOrCreate( path, flags, sx, sy, &created );
+   if ( !created )
+      return t;
+
+   /* Create new image. */
+   gl_loadNewImageSurface(
+      t, surface, sx, sy, ( flags & ~OPENGL_TEX_MAPTRANS ) | OPENGL_TEX_VFLIP );
+   return t;
+}
+
 /**
  * @brief Loads the texture immediately, but also sets it as a sprite.
  *
@@ -937,22 +991,6 @@ USE_RESULT glTexture *gl_rawTexture( const char *name, GLuint texid, double w,
    return texture;
 }
 
-/**
- * @brief Checks to see if a pixel is transparent in a texture.
- *
- *    @param t Texture to check for transparency.
- *    @param x X position of the pixel.
- *    @param y Y position of the pixel.
- *    @return 1 if the pixel is transparent or 0 if it isn't.
- */
-int gl_isTrans( const glTexture *t, const int x, const int y )
-{
-   /* Get the position in the sheet. */
-   int i = y * (int)( t->w ) + x;
-   /* Now we have to pull out the individual bit. */
-   return !( t->trans[i / 8] & ( 1 << ( i % 8 ) ) );
-}
-
 /**
  * @brief Sets x and y to be the appropriate sprite for glTexture using dir.
  *
@@ -6,6 +6,7 @@
 /** @cond */
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
+#include "SDL_surface.h"
 #include <stdint.h>
 /** @endcond */
 
@@ -34,6 +35,9 @@
 #define OPENGL_TEX_CLAMP_ALPHA                                                 \
    ( 1 << 5 ) /**< Clamp image border to transparency. */
 
+#define GL_TRANS_STRIDE( w )                                                   \
+   ( ( ( w ) + 63 ) / 64 ) /**< Words per row of a transparency map. */
+
 /**
  * @brief Abstraction for rendering sprite sheets.
  *
@@ -55,9 +59,10 @@ typedef struct glTexture_ {
    double srh; /**< Sprite render height - equivalent to sh/h. */
 
    /* data */
-   GLuint   texture; /**< the opengl texture itself */
-   uint8_t *trans;   /**< maps the transparency */
-   double   vmax;    /**< Maximum value for SDF textures. */
+   GLuint    texture;      /**< the opengl texture itself */
+   uint64_t *trans;        /**< Maps the transparency, see SDL_MapTrans. */
+   int       trans_stride; /**< 64 bit words per row of the trans map. */
+   double    vmax;         /**< Maximum value for SDF textures. */
 
    /* properties */
    uint8_t flags; /**< flags used for texture properties */
@@ -83,6 +88,10 @@ USE_RESULT glTexture *gl_newSprite( const char *path, const int sx,
 USE_RESULT glTexture *gl_newSpriteRWops( const char *path, SDL_RWops *rw,
                                          const int sx, const int sy,
                                          const unsigned int flags );
+USE_RESULT glTexture *gl_newSpriteSurface( const char *path,
+                                           SDL_Surface *surface, const int sx,
+                                           const int sy,
+                                           const unsigned int flags );
 USE_RESULT glTexture *gl_dupTexture( const glTexture *texture );
 USE_RESULT glTexture *gl_rawTexture( const char *name, GLuint tex, double w,
                                      double h );
@@ -103,7 +112,39 @@ int gl_fboAddDepth( GLuint fbo, GLuint *tex, GLsizei width, GLsizei height );
  */
 void        gl_contextSet( void );
 void        gl_contextUnset( void );
-int         gl_isTrans( const glTexture *t, const int x, const int y );
 void        gl_getSpriteFromDir( int *x, int *y, int sx, int sy, double dir );
 glTexture **gl_copyTexArray( glTexture **tex );
 glTexture **gl_addTexArray( glTexture **tex, glTexture *t );
+
+/**
+ * @brief Checks to see if a pixel is transparent in a texture.
+ *
+ *    @param t Texture to check for transparency.
+ *    @param x X position of the pixel.
+ *    @param y Y position of the pixel.
+ *    @return 1 if the pixel is transparent or 0 if it isn't.
+ */
+static inline int gl_isTrans( const glTexture *t, int x, int y )
+{
+   return !( ( t->trans[y * t->trans_stride + x / 64] >> ( x % 64 ) ) & 1 );
+}
+
+/**
+ * @brief Gets the transparency of 64 consecutive pixels of a texture row.
+ *
+ *    @param t Texture to check for transparency.
+ *    @param x X position of the first pixel.
+ *    @param y Y position of the row.
+ *    @return Bit i is set if pixel x+i isn't transparent. Pixels past the end
+ *            of the row are transparent.
+ */
+static inline uint64_t gl_transBits( const glTexture *t, int x, int y )
+{
+   const uint64_t *row  = &t->trans[y * t->trans_stride];
+   int             i    = x / 64;
+   int             s    = x % 64;
+   uint64_t        bits = row[i] >> s;
+   if ( ( s > 0 ) && ( i + 1 < t->trans_stride ) )
+      bits |= row[i + 1] << ( 64 - s );
+   return bits;
+}
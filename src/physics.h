@@ -60,6 +60,10 @@ typedef struct Solid_ {
 double solid_maxspeed( const Solid *s, double speed, double accel );
 void   solid_init( Solid *dest, double mass, double dir, const vec2 *pos,
                    const vec2 *vel, int update );
+void   solid_setRenderLag( double lag );
+double solid_getRenderLag( void );
+void   solid_renderPos( vec2 *pos, const Solid *s, const vec2 *vel );
+void   solid_renderPosVec( vec2 *rpos, const vec2 *pos, const vec2 *vel );
 
 /*
  * misc
@@ -33,18 +33,48 @@
 #include "nlua_vec2.h"
 #include "ntime.h"
 #include "ntracing.h"
+#include "pilot_pool.h"
 #include "pilot_ship.h"
 #include "player.h"
 #include "player_autonav.h"
 #include "quadtree.h"
 #include "rng.h"
 #include "sound.h"
+#include "threadpool.h"
 
 #define PILOT_SIZE_MIN 128 /**< Minimum chunks to increment pilot_stack by */
+#define PILOT_QT_LOOSE                                                         \
+   0.25 /**< Seconds of flight covered by the loose quadtree bounds. */
+#define PILOT_UPDATE_CHUNK                                                     \
+   32 /**< Pilots per job of the local phase of the update. */
 
-/* ID Generators. */
-static unsigned int pilot_id =
-   PLAYER_ID; /**< Stack of pilot ids to assure uniqueness */
+/**
+ * @brief Types of events recorded by the local phase of the pilot update.
+ */
+typedef enum PilotEventType_ {
+   PILOT_EVENT_COOLDOWN, /**< Active cooldown is over. */
+   PILOT_EVENT_AMMO,     /**< Outfit reloaded ammo. */
+   PILOT_EVENT_OUTFIT,   /**< Outfit state timer ran out. */
+} PilotEventType;
+
+/**
+ * @brief Event recorded by the local phase of the pilot update.
+ */
+typedef struct PilotEvent_ {
+   PilotEventType type; /**< Type of the event. */
+   int            slot; /**< Outfit slot of the event or -1. */
+   int            n;    /**< Amount of ammo reloaded. */
+} PilotEvent;
+
+/**
+ * @brief Job of the local phase of the pilot update.
+ */
+typedef struct PilotUpdateJob_ {
+   Pilot     **pilots; /**< Pilots to update. */
+   int         n;      /**< Number of pilots to update. */
+   double      dt;     /**< Delta tick of the update. */
+   PilotEvent *events; /**< Events recorded by the job (array.h). */
+} PilotUpdateJob;
 
 /* stack of pilots */
 static Pilot **pilot_stack =
@@ -58,6 +88,18 @@ static int      qt_init = 0;
 static int qt_max_elem = 2;
 static int qt_depth    = 5;
 
+/* Update. */
+static ThreadQueue *pilot_updQueue =
+   NULL; /**< Queue running the local phase of the update. */
+static PilotUpdateJob *pilot_updJobs = NULL; /**< Update jobs (array.h). */
+static Pilot **pilot_updList =
+   NULL; /**< Pilots of the local phase of the update (array.h). */
+static PilotEvent *pilot_updEvents =
+   NULL; /**< Events of all the jobs in stack order (array.h). */
+static PilotEvent *pilot_updScratch =
+   NULL; /**< Events of a single pilot_update (array.h). */
+static unsigned int pilot_updStamp = 0; /**< Current update. */
+
 /* misc */
 static const double pilot_commTimeout =
    15.; /**< Time for text above pilot to time out. */
@@ -76,15 +118,23 @@ static void pilot_init( Pilot *dest, const Ship *ship, const char *name,
 static void pilot_hyperspace( Pilot *pilot, double dt );
 static void pilot_refuel( Pilot *p, double dt );
 static void pilot_updateSolid( Pilot *p, double dt );
+static void pilot_updateEvent( PilotEvent **events, PilotEventType type,
+                               int slot, int n );
+static void pilot_updateLocal( Pilot *pilot, double dt, PilotEvent **events );
+static void pilot_updateShared( Pilot *pilot, const PilotEvent *events,
+                                int nevents );
+static int  pilot_updateJob( void *data );
+static void pilots_updateLocal( double dt );
 /* Clean up. */
 static void pilot_erase( Pilot *p );
 /* Misc. */
 static void pilot_renderFramebufferBase( Pilot *p, GLuint fbo, double fw,
                                          double fh, const Lighting *L );
-static int  pilot_getStackPos( unsigned int id );
+static int  pilot_getStackPos( const Pilot *p );
 static void pilot_init_trails( Pilot *p );
 static int  pilot_trail_generated( Pilot *p, int generator );
-static void pilot_addQuadtree( const Pilot *p, int i );
+static void pilot_addQuadtree( Pilot *p, int i );
+static void pilots_qtPlot( void );
 
 /**
  * @brief Gets the pilot stack.
@@ -95,33 +145,35 @@ Pilot *const *pilot_getAll( void )
 }
 
 /**
- * @brief Compare id (for use with bsearch)
+ * @brief Gets the pilot's position in the stack.
+ *
+ * Only used when the stack is going to be walked or modified anyway, look-ups
+ * by id go through the slot map instead.
+ *
+ *    @param p Pilot to get position of (may be NULL).
+ *    @return Position of pilot in stack or -1 if not found.
  */
-static int pilot_cmp( const void *ptr1, const void *ptr2 )
+static int pilot_getStackPos( const Pilot *p )
 {
-   const Pilot *p1, *p2;
-   p1 = *( (const Pilot **)ptr1 );
-   p2 = *( (const Pilot **)ptr2 );
-   return p1->id - p2->id;
+   if ( p == NULL )
+      return -1;
+   for ( int i = array_size( pilot_stack ) - 1; i >= 0; i-- )
+      if ( pilot_stack[i] == p )
+         return i;
+   return -1;
 }
 
 /**
- * @brief Gets the pilot's position in the stack.
+ * @brief Moves the pilot at a position of the stack to the front, keeping the
+ * order of the rest.
  *
- *    @param id ID of the pilot to get.
- *    @return Position of pilot in stack or -1 if not found.
+ *    @param i Position of the pilot to move.
  */
-static int pilot_getStackPos( unsigned int id )
+static void pilot_stackToFront( int i )
 {
-   const Pilot  pid    = { .id = id };
-   const Pilot *pidptr = &pid;
-   /* binary search */
-   Pilot **pp = bsearch( &pidptr, pilot_stack, array_size( pilot_stack ),
-                         sizeof( Pilot * ), pilot_cmp );
-   if ( pp == NULL )
-      return -1;
-   else
-      return pp - pilot_stack;
+   Pilot *p = pilot_stack[i];
+   memmove( &pilot_stack[1], &pilot_stack[0], i * sizeof( Pilot * ) );
+   pilot_stack[0] = p;
 }
 
 /**
@@ -140,7 +192,7 @@ unsigned int pilot_getNextID( unsigned int id, int mode )
       return PLAYER_ID;
 
    /* Get the pilot. */
-   m = pilot_getStackPos( id );
+   m = pilot_getStackPos( pilot_slotGet( id ) );
 
    /* Unselect. */
    if ( ( m == ( array_size( pilot_stack ) - 1 ) ) || ( m == -1 ) )
@@ -188,7 +240,7 @@ unsigned int pilot_getPrevID( unsigned int id, int mode )
       return PLAYER_ID;
 
    /* Get the pilot. */
-   m = pilot_getStackPos( id );
+   m = pilot_getStackPos( pilot_slotGet( id ) );
 
    /* Check to see what position to try. */
    if ( m == -1 )
@@ -629,23 +681,18 @@ double pilot_getNearestAng( const Pilot *p, unsigned int *tp, double ang,
 /**
  * @brief Pulls a pilot out of the pilot_stack based on ID.
  *
- * It's a binary search ( O(logn) ) therefore it's pretty fast and can be
- *  abused all the time. Maximum iterations is 32 on a platform with 32 bit
- *  unsigned ints.
+ * The ID holds the pilot's index in the slot map, so this is O(1) and can be
+ *  abused all the time.
  *
  *    @param id ID of the pilot to get.
  *    @return The actual pilot who has matching ID or NULL if not found.
  */
 Pilot *pilot_get( unsigned int id )
 {
-   const Pilot  pid    = { .id = id };
-   const Pilot *pidptr = &pid;
-   /* binary search */
-   Pilot **pp = bsearch( &pidptr, pilot_stack, array_size( pilot_stack ),
-                         sizeof( Pilot * ), pilot_cmp );
-   if ( ( pp == NULL ) || ( pilot_isFlag( *pp, PILOT_DELETE ) ) )
+   Pilot *p = pilot_slotGet( id );
+   if ( ( p == NULL ) || ( pilot_isFlag( p, PILOT_DELETE ) ) )
       return NULL;
-   return *pp;
+   return p;
 }
 
 /**
@@ -935,7 +982,7 @@ void pilot_cooldown( Pilot *p, int dochecks )
 
    /* Disable active outfits. */
    if ( pilot_outfitOffAll( p ) > 0 )
-      pilot_calcStats( p );
+      pilot_calcStatsSource( p, PILOT_STATS_OUTFITS );
 
    /* Calculate the ship's overall heat. */
    heat_capacity = p->heat_C;
@@ -1634,7 +1681,7 @@ void pilot_updateDisable( Pilot *p, unsigned int shooter )
 
       /* Disable active outfits. */
       if ( pilot_outfitOffAll( p ) > 0 )
-         pilot_calcStats( p );
+         pilot_calcStatsSource( p, PILOT_STATS_OUTFITS );
 
       pilot_setFlag( p, PILOT_DISABLED ); /* set as disabled */
       if ( pilot_isPlayer( p ) )
@@ -1726,63 +1773,6 @@ void pilot_dead( Pilot *p, unsigned int killer )
    }
 }
 
-/**
- * @brief Makes the pilot explosion.
- *    @param x X position of the pilot.
- *    @param y Y position of the pilot.
- *    @param radius Radius of the explosion.
- *    @param dmg Damage of the explosion.
- *    @param parent The exploding pilot.
- */
-void pilot_explode( double x, double y, double radius, const Damage *dmg,
-                    const Pilot *parent )
-{
-   double         rad2;
-   Solid          s; /* Only need to manipulate mass and vel. */
-   Damage         ddmg;
-   const IntList *qt;
-   int            qx, qy, qr;
-
-   rad2 = radius * radius;
-   ddmg = *dmg;
-
-   qx = round( x );
-   qy = round( y );
-   qr = ceil( radius );
-   qt = pilot_collideQuery( qx - qr, qy - qr, qx + qr, qy + qr );
-   for ( int i = 0; i < il_size( qt ); i++ ) {
-      Pilot *p = pilot_stack[il_get( qt, i, 0 )];
-      double rx, ry, dist;
-
-      /* Calculate a bit. */
-      rx   = p->solid.pos.x - x;
-      ry   = p->solid.pos.y - y;
-      dist = pow2( rx ) + pow2( ry );
-      /* Take into account ship size. */
-      dist -= pow2( p->ship->size );
-      dist = MAX( 0, dist );
-
-      /* Pilot is not hit. */
-      if ( dist > rad2 )
-         continue;
-
-      /* Adjust damage based on distance. */
-      ddmg.damage = dmg->damage * ( 1. - sqrt( dist / rad2 ) );
-
-      /* Impact settings. */
-      s.mass  = pow2( dmg->damage ) / 30.;
-      s.vel.x = rx;
-      s.vel.y = ry;
-
-      /* Actual damage calculations. */
-      pilot_hit( p, &s, parent, &ddmg, NULL, LUA_NOREF, 1 );
-
-      /* Shock wave from the explosion. */
-      if ( p->id == PILOT_PLAYER )
-         spfx_shake( pow2( ddmg.damage ) / pow2( 100. ) );
-   }
-}
-
 /**
  * @brief Renders a pilot to a framebuffer without effects.
  *
@@ -1821,13 +1811,14 @@ void pilot_renderFramebuffer( Pilot *p, GLuint fbo, double fw, double fh,
 {
    double        x, y, w, h;
    double        timeleft, elapsed;
+   vec2          pos;
    const Effect *e = NULL;
 
-   /* Transform coordinates. */
+   /* Transform coordinates, at the same position as pilot_render. */
+   solid_renderPos( &pos, &p->solid, &p->solid.vel );
    w = p->ship->size;
    h = p->ship->size;
-   gl_gameToScreenCoords( &x, &y, p->solid.pos.x - w / 2.,
-                          p->solid.pos.y - h / 2. );
+   gl_gameToScreenCoords( &x, &y, pos.x - w / 2., pos.y - h / 2. );
 
    /* Render effects - already sorted by priority and then timer. */
    for ( int i = 0; i < array_size( p->effects ); i++ ) {
@@ -1929,6 +1920,7 @@ void pilot_render( Pilot *p )
 {
    double   scale, x, y, w, h, z;
    double   timeleft, elapsed;
+   vec2     pos;
    int      inbounds = 1;
    Effect  *e        = NULL;
    glColour c        = { .r = 1., .g = 1., .b = 1., .a = 1. };
@@ -1937,12 +1929,15 @@ void pilot_render( Pilot *p )
    if ( pilot_isFlag( p, PILOT_NORENDER ) )
       return;
 
+   /* Where the pilot is drawn, which lags behind the simulation. */
+   solid_renderPos( &pos, &p->solid, &p->solid.vel );
+
    /* Transform coordinates. */
    z = cam_getZoom();
    w = p->ship->size;
    h = p->ship->size;
-   gl_gameToScreenCoords( &x, &y, p->solid.pos.x - w / 2.,
-                          p->solid.pos.y - h / 2. );
+   gl_gameToScreenCoords( &x, &y, pos.x - w / 2.,
+                          pos.y - h / 2. );
 
    /* Check if inbounds */
    if ( ( x < -w ) || ( x > SCREEN_W + w ) || ( y < -h ) ||
@@ -1996,7 +1991,7 @@ void pilot_render( Pilot *p )
          } else {
             gl_renderSpriteInterpolateScale(
                p->ship->gfx_space, p->ship->gfx_engine, 1. - p->engine_glow,
-               p->solid.pos.x, p->solid.pos.y, scale, scale, p->tsx, p->tsy,
+               pos.x, pos.y, scale, scale, p->tsx, p->tsy,
                &c );
          }
       }
@@ -2091,10 +2086,8 @@ void pilot_render( Pilot *p )
       mat4   projection = gl_view_matrix;
 
       /* Set up the vector data. */
-      for ( size_t i = 0; i < n; i++ ) {
-         data[i * 2 + 0] = poly->x[i];
-         data[i * 2 + 1] = poly->y[i];
-      }
+      for ( size_t i = 0; i < n; i++ )
+         poly_point( poly, i, &data[i * 2 + 0], &data[i * 2 + 1] );
 
       /* Upload to VBO, creating as necessary. */
       if ( poly_vbo == NULL )
@@ -2109,7 +2102,7 @@ void pilot_render( Pilot *p )
                                   GL_FLOAT, 0 );
 
       /* Do projection. */
-      gl_gameToScreenCoords( &x, &y, p->solid.pos.x, p->solid.pos.y );
+      gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
       mat4_translate_scale_xy( &projection, x, y, z, z );
       gl_uniformMat4( shaders.lines.projection, &projection );
 
@@ -2163,8 +2156,8 @@ void pilot_render( Pilot *p )
          v.y *= scale;
 
          /* Draw. */
-         gl_gameToScreenCoords( &x, &y, p->solid.pos.x + v.x,
-                                p->solid.pos.y + v.y );
+         gl_gameToScreenCoords( &x, &y, pos.x + v.x,
+                                pos.y + v.y );
          if ( trail->trail_spec->nebula )
             gl_renderCross( x, y, 2, &cFontBlue );
          else
@@ -2183,11 +2176,14 @@ void pilot_renderOverlay( Pilot *p )
 {
    int    playerdead;
    double sw, sh;
+   vec2   pos;
 
    /* Don't render the pilot. */
    if ( pilot_isFlag( p, PILOT_NORENDER ) )
       return;
 
+   solid_renderPos( &pos, &p->solid, &p->solid.vel );
+
    sw = p->ship->size;
    sh = p->ship->size;
 
@@ -2202,8 +2198,8 @@ void pilot_renderOverlay( Pilot *p )
          /* Render. */
          gl_renderSprite(
             ico_hail,
-            p->solid.pos.x + PILOT_SIZE_APPROX * sw / 2. + ico_hail->sw / 4.,
-            p->solid.pos.y + PILOT_SIZE_APPROX * sh / 2. + ico_hail->sh / 4.,
+            pos.x + PILOT_SIZE_APPROX * sw / 2. + ico_hail->sw / 4.,
+            pos.y + PILOT_SIZE_APPROX * sh / 2. + ico_hail->sh / 4.,
             p->hail_pos % sx, p->hail_pos / sx, NULL );
       }
    }
@@ -2213,7 +2209,7 @@ void pilot_renderOverlay( Pilot *p )
       double x, y, dx, dy;
 
       /* Coordinate translation. */
-      gl_gameToScreenCoords( &x, &y, p->solid.pos.x, p->solid.pos.y );
+      gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
 
       /* Display the text. */
       glColour c = { 1., 1., 1., 1. };
@@ -2241,7 +2237,7 @@ void pilot_renderOverlay( Pilot *p )
       double x, y, w, h;
 
       /* Coordinate translation. */
-      gl_gameToScreenCoords( &x, &y, p->solid.pos.x, p->solid.pos.y );
+      gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
 
       w = sw + 4.;
       h = sh + 4.;
@@ -2267,24 +2263,43 @@ void pilot_renderOverlay( Pilot *p )
 }
 
 /**
- * @brief Updates the pilot.
+ * @brief Records an event of the local phase of the pilot update.
+ *
+ *    @param events Queue to record the event to (array.h).
+ *    @param type Type of the event.
+ *    @param slot Outfit slot the event refers to or -1.
+ *    @param n Amount of the event.
+ */
+static void pilot_updateEvent( PilotEvent **events, PilotEventType type,
+                               int slot, int n )
+{
+   PilotEvent *ev = &array_grow( events );
+   ev->type       = type;
+   ev->slot       = slot;
+   ev->n          = n;
+}
+
+/**
+ * @brief Runs the local phase of the pilot update.
+ *
+ * Only the pilot itself is modified, so this can be run for different pilots
+ * at the same time. Anything that runs hooks, Lua or touches other pilots is
+ * recorded as an event for pilot_updateShared to run afterwards.
  *
  *    @param pilot Pilot to update.
  *    @param dt Current delta tick.
+ *    @param events Queue to record the events of the pilot to (array.h).
  */
-void pilot_update( Pilot *pilot, double dt )
+static void pilot_updateLocal( Pilot *pilot, double dt, PilotEvent **events )
 {
-   int    cooling, nchg;
-   Pilot *target;
-   double a, px, py, vx, vy, Q;
-   Target wt;
+   int    cooling;
+   double Q;
 
    /* Modify the dt with speedup. */
    dt *= pilot->stats.time_speedup;
-
-   /* Check target validity. */
-   target  = pilot_weaponTarget( pilot, &wt );
-   cooling = pilot_isFlag( pilot, PILOT_COOLDOWN );
+   pilot->upd_dt = dt;
+   pilot->upd_ev = array_size( *events );
+   cooling       = pilot_isFlag( pilot, PILOT_COOLDOWN );
 
    /*
     * Update timers.
@@ -2294,7 +2309,7 @@ void pilot_update( Pilot *pilot, double dt )
    if ( cooling ) {
       pilot->ctimer -= dt;
       if ( pilot->ctimer < 0. ) {
-         pilot_cooldownEnd( pilot, NULL );
+         pilot_updateEvent( events, PILOT_EVENT_COOLDOWN, -1, 0 );
          cooling = 0;
       }
    }
@@ -2326,9 +2341,7 @@ void pilot_update( Pilot *pilot, double dt )
       }
    }
    /* Update heat. */
-   a    = -1.;
-   Q    = 0.;
-   nchg = 0; /* Number of outfits that change state, processed at the end. */
+   Q = 0.;
    for ( int i = 0; i < array_size( pilot->outfits ); i++ ) {
       PilotOutfitSlot *o = pilot->outfits[i];
 
@@ -2349,6 +2362,7 @@ void pilot_update( Pilot *pilot, double dt )
       if ( outfit_isLauncher( o->outfit ) ||
            outfit_isFighterBay( o->outfit ) ) {
          double ammo_threshold, reload_time;
+         int    n;
 
          /* Initial (raw) ammo threshold */
          if ( outfit_isLauncher( o->outfit ) ) {
@@ -2377,11 +2391,16 @@ void pilot_update( Pilot *pilot, double dt )
          if ( o->u.ammo.quantity >= ammo_threshold )
             o->rtimer = 0;
 
+         /* The ammo itself is added in the shared phase as it changes the
+          * mass of the pilot. */
+         n = 0;
          while ( ( o->rtimer >= reload_time ) &&
-                 ( o->u.ammo.quantity < ammo_threshold ) ) {
+                 ( o->u.ammo.quantity + n < ammo_threshold ) ) {
             o->rtimer -= reload_time;
-            pilot_addAmmo( pilot, o, 1 );
+            n++;
          }
+         if ( n > 0 )
+            pilot_updateEvent( events, PILOT_EVENT_AMMO, i, n );
 
          o->rtimer = MIN( o->rtimer, reload_time );
       }
@@ -2389,33 +2408,120 @@ void pilot_update( Pilot *pilot, double dt )
       /* Handle state timer. */
       if ( o->stimer >= 0. ) {
          o->stimer -= dt;
-         if ( o->stimer < 0. ) {
-            if ( o->state == PILOT_OUTFIT_ON ) {
-               pilot_outfitOff( pilot, o );
-               nchg++;
-            } else if ( o->state == PILOT_OUTFIT_COOLDOWN ) {
-               o->state = PILOT_OUTFIT_OFF;
-               nchg++;
-            }
-         }
+         if ( ( o->stimer < 0. ) && ( ( o->state == PILOT_OUTFIT_ON ) ||
+                                      ( o->state == PILOT_OUTFIT_COOLDOWN ) ) )
+            pilot_updateEvent( events, PILOT_EVENT_OUTFIT, i, 0 );
       }
 
       /* Handle heat. */
       if ( !cooling )
          Q += pilot_heatUpdateSlot( pilot, o, dt );
-
-      /* Handle lockons. */
-      pilot_lockUpdateSlot( pilot, o, target, &wt, &a, dt );
    }
 
-   /* Global heat. */
+   /* Global heat, active cooldown is handled in the shared phase as it
+    * refills ammo. */
    if ( !cooling )
       pilot_heatUpdateShip( pilot, Q, dt );
-   else
-      pilot_heatUpdateCooldown( pilot );
 
    /* Update electronic warfare. */
-   pilot_ewUpdateDynamic( pilot, dt );
+   pilot_ewUpdateModifiers( pilot );
+
+   pilot->upd_nev = array_size( *events ) - pilot->upd_ev;
+}
+
+/**
+ * @brief Updates the pilot.
+ *
+ *    @param pilot Pilot to update.
+ *    @param dt Current delta tick.
+ */
+void pilot_update( Pilot *pilot, double dt )
+{
+   array_resize( &pilot_updScratch, 0 );
+   pilot_updateLocal( pilot, dt, &pilot_updScratch );
+   pilot_updateShared( pilot, pilot_updScratch, pilot->upd_nev );
+}
+
+/**
+ * @brief Runs the shared phase of the pilot update.
+ *
+ * Has to be run right after pilot_updateLocal for a pilot, and always from
+ * the main thread as it runs hooks and Lua.
+ *
+ *    @param pilot Pilot to update.
+ *    @param events Events recorded by the local phase of the pilot.
+ *    @param nevents Number of events.
+ */
+static void pilot_updateShared( Pilot *pilot, const PilotEvent *events,
+                                int nevents )
+{
+   int    cooling, nchg, nefx;
+   Pilot *target;
+   double a, px, py, vx, vy, dt;
+   Target wt;
+
+   /* Already has the speedup. */
+   dt = pilot->upd_dt;
+
+   /* Check target validity. */
+   target  = pilot_weaponTarget( pilot, &wt );
+   cooling = pilot_isFlag( pilot, PILOT_COOLDOWN );
+
+   /* Run the events of the local phase in the order they were recorded. */
+   nchg = 0; /* Number of outfits that change state, processed at the end. */
+   for ( int i = 0; i < nevents; i++ ) {
+      const PilotEvent *ev = &events[i];
+      PilotOutfitSlot  *o;
+
+      /* The shared phases of the pilots before this one may have run Lua
+       * that changed this pilot since the event was recorded, so the
+       * conditions of the events are checked again. */
+      if ( ev->type == PILOT_EVENT_COOLDOWN ) {
+         if ( pilot_isFlag( pilot, PILOT_COOLDOWN ) &&
+              ( pilot->ctimer < 0. ) ) {
+            pilot_cooldownEnd( pilot, NULL );
+            cooling = 0;
+         }
+         continue;
+      }
+
+      /* Lua may have changed the outfits of the pilot in the meantime. */
+      if ( ev->slot >= array_size( pilot->outfits ) )
+         continue;
+      o = pilot->outfits[ev->slot];
+      if ( o->outfit == NULL )
+         continue;
+
+      if ( ev->type == PILOT_EVENT_AMMO )
+         pilot_addAmmo( pilot, o, ev->n );
+      else if ( o->stimer >= 0. )
+         continue;
+      else if ( o->state == PILOT_OUTFIT_ON ) {
+         pilot_outfitOff( pilot, o );
+         nchg++;
+      } else if ( o->state == PILOT_OUTFIT_COOLDOWN ) {
+         o->state = PILOT_OUTFIT_OFF;
+         nchg++;
+      }
+   }
+
+   /* Handle lockons. */
+   a = -1.;
+   for ( int i = 0; i < array_size( pilot->outfits ); i++ ) {
+      PilotOutfitSlot *o = pilot->outfits[i];
+      if ( o->outfit == NULL )
+         continue;
+      if ( !( o->flags & PILOTOUTFIT_ACTIVE ) )
+         continue;
+      pilot_lockUpdateSlot( pilot, o, target, &wt, &a, dt );
+   }
+
+   /* Active cooldown overrides the heat model. */
+   if ( cooling )
+      pilot_heatUpdateCooldown( pilot );
+
+   /* Scanning runs hooks. */
+   pilot_ewUpdateScan( pilot, dt );
 
    /* Update stress. */
    if ( !pilot_isFlag( pilot,
@@ -2496,7 +2602,7 @@ void pilot_update( Pilot *pilot, double dt )
 
             /* Damage from explosion. */
             a        = sqrt( pilot->solid.mass );
-            dmg.type = dtype_get( "explosion_splash" );
+            dmg.type = expl_dtype();
             dmg.damage =
                MAX( 0., 2. * ( a * ( 1. + sqrt( pilot->fuel + 1. ) / 28. ) ) );
             dmg.penetration = 1.; /* Full penetration. */
@@ -2539,9 +2645,9 @@ void pilot_update( Pilot *pilot, double dt )
             l = ( pilot->id == PLAYER_ID ) ? SPFX_LAYER_FRONT
                                            : SPFX_LAYER_MIDDLE;
             if ( RNGF() > 0.8 )
-               spfx_add( spfx_get( "ExpM" ), px, py, vx, vy, l );
+               spfx_add( expl_spfx( 30. ), px, py, vx, vy, l ); /* Medium. */
             else
-               spfx_add( spfx_get( "ExpS" ), px, py, vx, vy, l );
+               spfx_add( expl_spfx( 10. ), px, py, vx, vy, l ); /* Small. */
          }
 
          /* completely destroyed with final explosion */
@@ -2646,14 +2752,16 @@ void pilot_update( Pilot *pilot, double dt )
    }
 
    /* Update effects. */
-   nchg += effect_update( &pilot->effects, dt );
+   nefx = effect_update( &pilot->effects, dt );
    if ( pilot_isFlag( pilot, PILOT_DELETE ) )
       return; /* It's possible for effects to remove the pilot causing future
                  Lua to be unhappy. */
 
    /* Must recalculate stats because something changed state. */
-   if ( nchg > 0 )
-      pilot_calcStats( pilot );
+   if ( ( nchg > 0 ) || ( nefx > 0 ) )
+      pilot_calcStatsSource(
+         pilot, ( ( nchg > 0 ) ? PILOT_STATS_OUTFITS : 0 ) |
+                   ( ( nefx > 0 ) ? PILOT_STATS_EFFECTS : 0 ) );
 
    /* purpose fallthrough to get the movement like disabled */
    if ( pilot_isDisabled( pilot ) || cooling ) {
@@ -2901,7 +3009,8 @@ void pilot_sample_trails( Pilot *p, int none )
 
       /* Sample. */
       spfx_trail_sample( p->trail[i++], p->solid.pos.x + dx,
-                         p->solid.pos.y + dy, dz, mode, mode == MODE_NONE );
+                         p->solid.pos.y + dy, dz, &p->solid.vel, mode,
+                         mode == MODE_NONE );
    }
 }
 
@@ -3314,6 +3423,7 @@ static void pilot_init( Pilot *pilot, const Ship *ship, const char *name,
    pilot->lua_mem      = LUA_NOREF;
    pilot->lua_ship_mem = LUA_NOREF;
    pilot->autoweap     = 1;
+   pilot->ew_row       = -1;
    pilot->aimLines     = 0;
    pilot->dockpilot    = dockpilot;
    pilot->parent = dockpilot; /* leader will default to mothership if exists. */
@@ -3337,12 +3447,17 @@ static void pilot_init( Pilot *pilot, const Ship *ship, const char *name,
    pilot_calcStats( pilot );
    pilot->stress = 0.; /* No stress. */
 
-   /* Allocate outfit memory. */
-   pilot->outfits = array_create( PilotOutfitSlot * );
+   /* Allocate outfit memory, reusing the arrays the pool kept if possible.
+    * They must not be reallocated while filling as pilot->outfits points into
+    * them. */
+   pilot_poolArray( &pilot->outfits, PilotOutfitSlot *,
+                    array_size( ship->outfit_structure ) +
+                       array_size( ship->outfit_utility ) +
+                       array_size( ship->outfit_weapon ) );
    /* First pass copy data. */
    for ( int i = 0; i < 3; i++ ) {
-      *pilot_list_ptr[i] =
-         array_create_size( PilotOutfitSlot, array_size( ship_list[i] ) );
+      pilot_poolArray( pilot_list_ptr[i], PilotOutfitSlot,
+                       array_size( ship_list[i] ) );
       for ( int j = 0; j < array_size( ship_list[i] ); j++ ) {
          PilotOutfitSlot *slot = &array_grow( pilot_list_ptr[i] );
          memset( slot, 0, sizeof( PilotOutfitSlot ) );
@@ -3358,7 +3473,6 @@ static void pilot_init( Pilot *pilot, const Ship *ship, const char *name,
             pilot_addOutfitRaw( pilot, slot->sslot->data, slot );
       }
    }
-   array_shrink( &pilot->outfits );
 
    /* Add intrinsics if applicable. */
    if ( !pilot_isFlagRaw( flags, PILOT_NO_OUTFITS ) ) {
@@ -3518,17 +3632,12 @@ Pilot *pilot_create( const Ship *ship, const char *name, int faction,
                      unsigned int dockpilot, int dockslot )
 {
    /* Allocate pilot memory. */
-   Pilot *p = nmalloc( sizeof( Pilot ) );
-   if ( p == NULL ) {
-      WARN( _( "Unable to allocate memory" ) );
-      return 0;
-   }
+   Pilot *p = pilot_poolAlloc();
 
    NTracingZone( _ctx, 1 );
 
    /* Set the pilot in the stack -- must be there before initializing */
    array_push_back( &pilot_stack, p );
-   memset( p, 0, sizeof( Pilot ) );
 
    /* Load ship graphics. */
    ship_gfxLoad( (Ship *)ship ); /* TODO no casting. */
@@ -3539,11 +3648,10 @@ Pilot *pilot_create( const Ship *ship, const char *name, int faction,
            flags, PILOT_PLAYER ) ) { /* Set player ID. TODO should probably be
                                         fixed to something better someday. */
       p->id = PLAYER_ID;
-      qsort( pilot_stack, array_size( pilot_stack ), sizeof( Pilot * ),
-             pilot_cmp );
+      pilot_slotSetPlayer( p );
+      pilot_stackToFront( array_size( pilot_stack ) - 1 );
    } else
-      p->id =
-         ++pilot_id; /* new unique pilot id based on pilot_id, can't be 0 */
+      p->id = pilot_slotAcquire( p ); /* new unique pilot id, can't be 0 */
 
    /* Initialize the pilot. */
    pilot_init( p, ship, name, faction, dir, pos, vel, flags, dockpilot,
@@ -3566,7 +3674,7 @@ Pilot *pilot_create( const Ship *ship, const char *name, int faction,
    pilot_runHook( p, PILOT_HOOK_CREATION );
 
    /* Add to quadtree. */
-   pilot_addQuadtree( p, array_size( pilot_stack ) - 1 );
+   pilot_addQuadtree( p, pilot_getStackPos( p ) );
 
    NTracingZoneEnd( _ctx );
 
@@ -3585,12 +3693,7 @@ Pilot *pilot_create( const Ship *ship, const char *name, int faction,
 Pilot *pilot_createEmpty( const Ship *ship, const char *name, int faction,
                           PilotFlags flags )
 {
-   Pilot *dyn = nmalloc( sizeof( Pilot ) );
-   if ( dyn == NULL ) {
-      WARN( _( "Unable to allocate memory" ) );
-      return 0;
-   }
-   memset( dyn, 0, sizeof( Pilot ) );
+   Pilot *dyn = pilot_poolAlloc();
    pilot_init( dyn, ship, name, faction, 0., NULL, NULL, flags, 0, 0 );
    return dyn;
 }
@@ -3610,17 +3713,12 @@ unsigned int pilot_clone( const Pilot *ref )
    pilot_setFlagRaw( pf, PILOT_NO_OUTFITS );
 
    /* Allocate pilot memory. */
-   dyn = nmalloc( sizeof( Pilot ) );
-   if ( dyn == NULL ) {
-      WARN( _( "Unable to allocate memory" ) );
-      return 0;
-   }
+   dyn = pilot_poolAlloc();
 
    /* Set the pilot in the stack -- must be there before initializing */
-   p  = &array_grow( &pilot_stack );
-   *p = dyn;
-   memset( dyn, 0, sizeof( Pilot ) );
-   dyn->id = ++pilot_id; /* new unique pilot id. */
+   p       = &array_grow( &pilot_stack );
+   *p      = dyn;
+   dyn->id = pilot_slotAcquire( dyn ); /* new unique pilot id. */
 
    /* Initialize the pilot. */
    pilot_init( dyn, ref->ship, ref->name, ref->faction, ref->solid.dir,
@@ -3647,7 +3745,7 @@ unsigned int pilot_clone( const Pilot *ref )
  */
 unsigned int pilot_addStack( Pilot *p )
 {
-   p->id = ++pilot_id; /* new unique pilot id based on pilot_id, can't be 0 */
+   p->id = pilot_slotAcquire( p ); /* new unique pilot id, can't be 0 */
    pilot_setFlag( p, PILOT_NOFREE );
 
    array_push_back( &pilot_stack, p );
@@ -3692,8 +3790,8 @@ void pilot_clearTrails( Pilot *p )
  */
 Pilot *pilot_setPlayer( Pilot *after )
 {
-   int i = pilot_getStackPos( PLAYER_ID );
-   int l = pilot_getStackPos( after->id );
+   int i = pilot_getStackPos( pilot_slotGet( PLAYER_ID ) );
+   int l = pilot_getStackPos( after );
 
    if ( i < 0 ) {  /* No existing player ID. */
       if ( l < 0 ) /* No existing pilot, have to create. */
@@ -3705,9 +3803,10 @@ Pilot *pilot_setPlayer( Pilot *after )
       else
          pilot_stack[i] = after; /* after overwrites player. */
    }
+   pilot_slotRelease( after );
    after->id = PLAYER_ID;
-   qsort( pilot_stack, array_size( pilot_stack ), sizeof( Pilot * ),
-          pilot_cmp );
+   pilot_slotSetPlayer( after );
+   pilot_stackToFront( pilot_getStackPos( after ) );
 
    /* Load graphics if necessary. */
    ship_gfxLoad( (Ship *)after->ship );
@@ -3862,24 +3961,27 @@ void pilot_free( Pilot *p )
 {
    NTracingZone( _ctx, 1 );
 
+   /* Give back the ID. */
+   pilot_slotRelease( p );
+
    /* Clear some useful things. */
    pilot_clearHooks( p );
-   effect_cleanup( p->effects );
-   p->effects = NULL;
-   escort_freeList( p );
 
    /* If hostile, must remove counter. */
    pilot_rmHostile( p );
 
-   /* Free animated trail. */
+   /* Stop animated trail. */
    for ( int i = 0; i < array_size( p->trail ); i++ )
       spfx_trail_remove( p->trail[i] );
-   array_free( p->trail );
-   p->trail = NULL;
 
    /* We don't actually free internals of the pilot once we cleaned up stuff. */
    if ( pilot_isFlag( p, PILOT_NOFREE ) ) {
-      p->id = 0; /* Invalidate ID. */
+      effect_cleanup( p->effects );
+      p->effects = NULL;
+      escort_freeList( p );
+      array_free( p->trail );
+      p->trail = NULL;
+      p->id    = 0; /* Invalidate ID. */
       NTracingZoneEnd( _ctx );
       return;
    }
@@ -3895,14 +3997,11 @@ void pilot_free( Pilot *p )
 
    pilot_weapSetFree( p );
 
-   /* Clean up outfit slots. */
+   /* Clean up outfit slots, the slot arrays themselves go back to the pool
+    * along with the effect, escort and trail arrays. */
    for ( int i = 0; i < array_size( p->outfits ); i++ ) {
       ss_free( p->outfits[i]->lua_stats );
    }
-   array_free( p->outfits );
-   array_free( p->outfit_structure );
-   array_free( p->outfit_utility );
-   array_free( p->outfit_weapon );
    array_free( p->outfit_intrinsic );
 
    /* Clean up data. */
@@ -3917,18 +4016,12 @@ void pilot_free( Pilot *p )
    // solid_free(p->solid);
    free( p->mounted );
 
-   escort_freeList( p );
-
    free( p->comm_msg );
 
    /* Free messages. */
    luaL_unref( naevL, p->messages, LUA_REGISTRYINDEX );
 
-#ifdef DEBUGGING
-   memset( p, 0, sizeof( Pilot ) );
-#endif /* DEBUGGING */
-
-   nfree( p );
+   pilot_poolRelease( p );
 
    NTracingZoneEnd( _ctx );
 }
@@ -3940,7 +4033,7 @@ void pilot_free( Pilot *p )
  */
 static void pilot_erase( Pilot *p )
 {
-   int i = pilot_getStackPos( p->id );
+   int i = pilot_getStackPos( p );
    pilot_free( p );
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i + 1] );
 }
@@ -3950,12 +4043,13 @@ static void pilot_erase( Pilot *p )
  */
 void pilot_stackRemove( Pilot *p )
 {
-   int i = pilot_getStackPos( p->id );
+   int i = pilot_getStackPos( p );
 #ifdef DEBUGGING
    if ( i < 0 )
       WARN( _( "Trying to remove non-existent pilot '%s' from stack!" ),
             p->name );
 #endif /* DEBUGGING */
+   pilot_slotRelease( p );
    p->id = 0;
    array_erase( &pilot_stack, &pilot_stack[i], &pilot_stack[i + 1] );
 }
@@ -3967,6 +4061,13 @@ void pilots_init( void )
 {
    pilot_stack = array_create_size( Pilot *, PILOT_SIZE_MIN );
    il_create( &pilot_qtquery, 1 );
+   pilots_ewInit();
+
+   pilot_updQueue   = vpool_createFrame();
+   pilot_updJobs    = array_create( PilotUpdateJob );
+   pilot_updList    = array_create( Pilot * );
+   pilot_updEvents  = array_create( PilotEvent );
+   pilot_updScratch = array_create( PilotEvent );
 }
 
 /**
@@ -3998,6 +4099,24 @@ void pilots_free( void )
    /* Clean up quadtree. */
    qt_destroy( &pilot_quadtree );
    il_destroy( &pilot_qtquery );
+   pilots_ewFree();
+
+   /* Clean up the update. */
+   vpool_cleanup( pilot_updQueue );
+   pilot_updQueue = NULL;
+   for ( int i = 0; i < array_size( pilot_updJobs ); i++ )
+      array_free( pilot_updJobs[i].events );
+   array_free( pilot_updJobs );
+   pilot_updJobs = NULL;
+   array_free( pilot_updList );
+   pilot_updList = NULL;
+   array_free( pilot_updEvents );
+   pilot_updEvents = NULL;
+   array_free( pilot_updScratch );
+   pilot_updScratch = NULL;
+
+   /* Clean up the memory pool. */
+   pilots_poolFree();
 }
 
 /**
@@ -4113,17 +4232,45 @@ void pilots_cleanAll( void )
                 array_end( pilot_stack ) );
 }
 
-static void pilot_addQuadtree( const Pilot *p, int i )
+/**
+ * @brief Adds a pilot to the quadtree or updates its bounds if already there.
+ *
+ * Pilots are placed in the quadtree with loose bounds, so they only get moved
+ * within it once they fly out of them.
+ *
+ *    @param p Pilot to add.
+ *    @param i Position of the pilot in the stack.
+ */
+static void pilot_addQuadtree( Pilot *p, int i )
 {
-   int x, y, w2, h2, px, py;
+   int x, y, w2, h2, px, py, m;
    x  = round( p->solid.pos.x );
    y  = round( p->solid.pos.y );
    px = round( p->solid.pre.x );
    py = round( p->solid.pre.y );
    w2 = ceil( p->ship->size * 0.5 );
    h2 = ceil( p->ship->size * 0.5 );
-   qt_insert( &pilot_quadtree, i, MIN( x, px ) - w2, MIN( y, py ) - h2,
-              MAX( x, px ) + w2, MAX( y, py ) + h2 );
+   m  = w2 + ceil( VMOD( p->solid.vel ) * PILOT_QT_LOOSE );
+   p->qt_elem = qt_update( &pilot_quadtree, p->qt_elem, (int)p->id, i,
+                           MIN( x, px ) - w2, MIN( y, py ) - h2,
+                           MAX( x, px ) + w2, MAX( y, py ) + h2, m );
+}
+
+/**
+ * @brief Plots the statistics of the pilot quadtree for the profiler.
+ */
+static void pilots_qtPlot( void )
+{
+#if HAVE_TRACY
+   QtStats st;
+   qt_stats( &pilot_quadtree, &st );
+   NTracingPlotI( "pilot qt nodes", st.nodes );
+   NTracingPlotI( "pilot qt depth", st.max_depth );
+   NTracingPlotI( "pilot qt reinserts", st.reinserts );
+   NTracingPlotF( "pilot qt candidates",
+                  ( st.queries > 0 ) ? (double)st.candidates / st.queries
+                                     : 0. );
+#endif /* HAVE_TRACY */
 }
 
 /**
@@ -4145,10 +4292,11 @@ void pilots_updatePurge( void )
          pilot_erase( p );
    }
 
-   /* Second loop sets up quadtrees. */
-   qt_clear( &pilot_quadtree ); /* Empty it. */
+   /* Second loop updates the quadtree, as pilots keep their elements from
+    * one frame to the next their positions in the stack have to be updated
+    * too. Pilots that were not updated get swept out afterwards. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
-      const Pilot *p = pilot_stack[i];
+      Pilot *p = pilot_stack[i];
 
       /* Ignore pilots being deleted. */
       if ( pilot_isFlag( p, PILOT_DELETE ) )
@@ -4160,10 +4308,100 @@ void pilots_updatePurge( void )
 
       pilot_addQuadtree( p, i );
    }
+   qt_sweep( &pilot_quadtree );
+   pilots_qtPlot();
+
+   /* Electronic warfare depends on the quadtree. */
+   pilots_ewUpdate();
 
    NTracingZoneEnd( _ctx );
 }
 
+/**
+ * @brief Runs a job of the local phase of the pilot update.
+ *
+ *    @param data Job to run.
+ *    @return 0 always.
+ */
+static int pilot_updateJob( void *data )
+{
+   PilotUpdateJob *job = data;
+   array_resize( &job->events, 0 );
+   for ( int i = 0; i < job->n; i++ )
+      pilot_updateLocal( job->pilots[i], job->dt, &job->events );
+   return 0;
+}
+
+/**
+ * @brief Runs the local phase of the update of all the pilots.
+ *
+ * The pilots are split into jobs that run on the frame threadpool, each
+ * recording the events of its pilots into its own queue. The queues are then
+ * merged in stack order so the events run in the same order no matter how the
+ * jobs were scheduled. The frame threadpool keeps the update from waiting
+ * behind long jobs of the global threadpool, like ship graphics or linear
+ * programs.
+ *
+ * This runs the local phase of every pilot before the shared phase of any of
+ * them, whereas pilot_update runs both phases of a pilot before moving on to
+ * the next. The local phase only ages timers and heat, so the hooks and Lua
+ * run by the shared phases see every pilot already aged by this frame, as if
+ * it came earlier in the stack. A timer that Lua resets is thus aged from the
+ * next frame on, which is at most a frame of difference. Events that no
+ * longer apply after Lua changed a pilot are dropped by the shared phase.
+ *
+ *    @param dt Delta tick for the update.
+ */
+static void pilots_updateLocal( double dt )
+{
+   int n, njobs;
+
+   /* Zero is never a valid stamp, new pilots start with it. */
+   pilot_updStamp++;
+   if ( pilot_updStamp == 0 )
+      pilot_updStamp = 1;
+
+   /* The player is updated serially by player_update. */
+   array_resize( &pilot_updList, 0 );
+   for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
+      Pilot *p = pilot_stack[i];
+      if ( pilot_isFlag( p, PILOT_DELETE ) || pilot_isFlag( p, PILOT_HIDE ) ||
+           pilot_isFlag( p, PILOT_PLAYER ) )
+         continue;
+      p->upd_stamp = pilot_updStamp;
+      array_push_back( &pilot_updList, p );
+   }
+
+   /* Set up the jobs. */
+   n     = array_size( pilot_updList );
+   njobs = ( n + PILOT_UPDATE_CHUNK - 1 ) / PILOT_UPDATE_CHUNK;
+   while ( array_size( pilot_updJobs ) < njobs )
+      array_grow( &pilot_updJobs ).events = array_create( PilotEvent );
+   for ( int i = 0; i < njobs; i++ ) {
+      PilotUpdateJob *job = &pilot_updJobs[i];
+      job->pilots         = &pilot_updList[i * PILOT_UPDATE_CHUNK];
+      job->n = MIN( PILOT_UPDATE_CHUNK, n - i * PILOT_UPDATE_CHUNK );
+      job->dt             = dt;
+      if ( njobs > 1 )
+         vpool_enqueue( pilot_updQueue, pilot_updateJob, job );
+      else
+         pilot_updateJob( job );
+   }
+   if ( njobs > 1 )
+      vpool_wait( pilot_updQueue );
+
+   /* Merge the event queues. */
+   array_resize( &pilot_updEvents, 0 );
+   for ( int i = 0; i < njobs; i++ ) {
+      PilotUpdateJob *job  = &pilot_updJobs[i];
+      int             base = array_size( pilot_updEvents );
+      for ( int j = 0; j < job->n; j++ )
+         job->pilots[j]->upd_ev += base;
+      for ( int j = 0; j < array_size( job->events ); j++ )
+         array_push_back( &pilot_updEvents, job->events[j] );
+   }
+}
+
 /**
  * @brief Updates all the pilots.
  *
@@ -4173,6 +4411,7 @@ void pilots_update( double dt )
 {
    NTracingZone( _ctx, 1 );
    NTracingPlotI( "pilots", array_size( pilot_stack ) );
+   pilots_poolPlot();
 
    /* Have all the pilots think. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
@@ -4221,6 +4460,9 @@ void pilots_update( double dt )
       }
    }
 
+   /* Run the part of the update that only touches each pilot. */
+   pilots_updateLocal( dt );
+
    /* Now update all the pilots. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
       Pilot *p = pilot_stack[i];
@@ -4236,6 +4478,11 @@ void pilots_update( double dt )
       /* Just update the pilot. */
       if ( pilot_isFlag( p, PILOT_PLAYER ) )
          player_update( p, dt );
+      else if ( p->upd_stamp == pilot_updStamp ) {
+         p->upd_stamp = 0;
+         pilot_updateShared( p, &pilot_updEvents[p->upd_ev], p->upd_nev );
+      }
+      /* Pilots added or shown by hooks in this loop missed the local phase. */
       else
          pilot_update( p, dt );
    }
@@ -4317,7 +4564,7 @@ void pilot_clearTimers( Pilot *pilot )
 
    /* Must recalculate stats. */
    if ( n > 0 )
-      pilot_calcStats( pilot );
+      pilot_calcStatsSource( pilot, PILOT_STATS_OUTFITS );
 }
 
 /**
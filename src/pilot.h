@@ -55,6 +55,14 @@
    5. /**< Time the player is safe (from being targetted) after takeoff. */
 #define PILOT_PLAYER_NONTARGETABLE_JUMPIN_DELAY                                \
    5. /**< Time the player is safe (from being targetted) after jumping in. */
+/* Stat sources cached by pilot_calcStats(), see pilot_calcStatsSource(). */
+#define PILOT_STATS_OUTFITS ( 1 << 0 ) /**< Outfit slots and their Lua stats. */
+#define PILOT_STATS_SHIP ( 1 << 1 )    /**< Ship and intrinsic stat lists. */
+#define PILOT_STATS_EFFECTS ( 1 << 2 ) /**< Active effects. */
+#define PILOT_STATS_SYSTEM ( 1 << 3 )  /**< Current system stats. */
+#define PILOT_STATS_NSOURCES 4         /**< Number of cached stat sources. */
+#define PILOT_STATS_ALL                                                        \
+   ( ( 1 << PILOT_STATS_NSOURCES ) - 1 ) /**< Every stat source. */
 
 /* Pilot-related hooks. */
 typedef enum PilotHookType_ {
@@ -271,6 +279,7 @@ typedef struct Pilot_ {
    /* Object characteristics */
    const Ship  *ship;        /**< ship pilot is flying */
    Solid        solid;       /**< Associated solid (physics) */
+   int          qt_elem;     /**< Element of the pilot in the quadtree. */
    double       base_mass;   /**< Ship mass plus core outfit mass. */
    double       mass_cargo;  /**< Amount of cargo mass added. */
    double       mass_outfit; /**< Amount of outfit mass added. */
@@ -327,6 +336,7 @@ typedef struct Pilot_ {
    double ew_jumppoint; /**< Jump point factor, affects stealth. */
    /* misc. */
    double ew_stealth_timer; /**< Stealth timer. */
+   int    ew_row;           /**< Row in the visibility matrix, or -1. */
 
    /* Heat. */
    double heat_T; /**< Ship temperature. [K] */
@@ -346,6 +356,10 @@ typedef struct Pilot_ {
                                      on the fly. */
    ShipStats
       stats; /**< Pilot's copy of ship statistics, used for comparisons.. */
+   ShipStatsDelta
+      stats_src[PILOT_STATS_NSOURCES]; /**< Cached contribution of each stat
+                                          source, indexed by flag bit. */
+   unsigned int stats_valid; /**< PILOT_STATS_* sources with a valid cache. */
 
    /* Ship effects. */
    Effect *effects; /**< Pilot's current activated effects. */
@@ -443,6 +457,12 @@ typedef struct Pilot_ {
    double tilt;          /**< Amount of ship tilting in a direction. */
    int    messages;      /**< Queued messages (Lua ref). */
    lvar  *shipvar;       /**< Per-ship version of lua mission variables. */
+
+   /* Update. */
+   unsigned int upd_stamp; /**< Update the local phase of the pilot ran in. */
+   double       upd_dt;    /**< Delta tick of the update with the speedup. */
+   int          upd_ev;    /**< First event of the pilot in the event queue. */
+   int          upd_nev;   /**< Number of events of the pilot. */
 } Pilot;
 
 /* These depend on Pilot being defined first. */
@@ -493,8 +513,6 @@ double pilot_hit( Pilot *p, const Solid *w, const Pilot *pshooter,
                   const Damage *dmg, const Outfit *outfit, int lua_mem,
                   int reset );
 void   pilot_updateDisable( Pilot *p, unsigned int shooter );
-void   pilot_explode( double x, double y, double radius, const Damage *dmg,
-                      const Pilot *parent );
 double pilot_face( Pilot *p, double dir, double dt );
 int    pilot_brakeCheckReverseThrusters( const Pilot *p );
 double pilot_minbrakedist( const Pilot *p, double dt, double *flytime );
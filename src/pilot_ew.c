@@ -14,12 +14,27 @@
 
 #include "array.h"
 #include "hook.h"
+#include "intlist.h"
 #include "pilot.h"
 #include "player.h"
 #include "player_autonav.h"
 #include "space.h"
 
-static double ew_interference = 1.; /**< Interference factor. */
+static double  ew_interference = 1.; /**< Interference factor. */
+static double  ew_detect_max   = 0.; /**< Largest ew_detect of any pilot. */
+static IntList ew_qtquery;           /**< Quadtree query for stealth checks. */
+
+/*
+ * Visibility matrix, computed once per frame for every pair of pilots. Each
+ * pair takes 2 bits, storing the result of pilot_inRangePilot before any of
+ * the flag-based special cases.
+ */
+#define EW_VIS_PAIRS ( 32 / 2 ) /**< Pairs per word of the matrix. */
+#define EW_VIS_RANGE 1          /**< Target is in range. */
+#define EW_VIS_FUZZY 2          /**< Target is fuzzily detected. */
+static int           ew_vis_n  = 0;    /**< Pilots in the matrix. */
+static unsigned int *ew_vis_id = NULL; /**< Pilot of each row, 0 if none. */
+static uint32_t     *ew_vis    = NULL; /**< Visibility matrix. */
 
 /*
  * Prototypes.
@@ -30,6 +45,145 @@ static double pilot_ewAsteroid( const Pilot *p );
 static double pilot_ewJumpPoint( const Pilot *p );
 static int    pilot_ewStealthGetNearby( const Pilot *p, double *mod, int *close,
                                         int *isplayer );
+static int    pilot_ewDetect( const Pilot *p, const Pilot *target, double d );
+static int    pilot_ewVisibility( const Pilot *p, const Pilot *target,
+                                  int *vis );
+
+/**
+ * @brief Initializes the electronic warfare state.
+ */
+void pilots_ewInit( void )
+{
+   il_create( &ew_qtquery, 1 );
+   ew_vis_id = array_create( unsigned int );
+   ew_vis    = array_create( uint32_t );
+   ew_vis_n  = 0;
+}
+
+/**
+ * @brief Frees the electronic warfare state.
+ */
+void pilots_ewFree( void )
+{
+   il_destroy( &ew_qtquery );
+   array_free( ew_vis_id );
+   array_free( ew_vis );
+   ew_vis_id = NULL;
+   ew_vis    = NULL;
+   ew_vis_n  = 0;
+}
+
+/**
+ * @brief Updates the per-frame electronic warfare state of all the pilots.
+ *
+ * Does a single detection pass over all the pilot pairs and stores the result
+ * in the visibility matrix, so that pilot_inRangePilot does not have to
+ * recompute it for every caller. Should be run once the pilot quadtree has
+ * been rebuilt.
+ */
+void pilots_ewUpdate( void )
+{
+   Pilot *const *ps = pilot_getAll();
+   int           n  = array_size( ps );
+   double        sig_max, det_max;
+   size_t        nw;
+
+   /* Pilots not in the quadtree are left out and get computed directly. */
+   array_resize( &ew_vis_id, n );
+   ew_detect_max = 0.;
+   sig_max       = 0.;
+   det_max       = 0.;
+   for ( int i = 0; i < n; i++ ) {
+      Pilot *p      = ps[i];
+      p->ew_row     = i;
+      ew_detect_max = MAX( ew_detect_max, p->stats.ew_detect );
+      if ( pilot_isFlag( p, PILOT_DELETE ) || pilot_isFlag( p, PILOT_HIDE ) ) {
+         ew_vis_id[i] = 0;
+         continue;
+      }
+      ew_vis_id[i] = p->id;
+      sig_max      = MAX( sig_max, p->ew_signature );
+      det_max      = MAX( det_max, p->ew_detection );
+   }
+
+   /* Clear the matrix. */
+   ew_vis_n = n;
+   nw       = ( (size_t)n * n + EW_VIS_PAIRS - 1 ) / EW_VIS_PAIRS;
+   array_resize( &ew_vis, nw );
+   if ( nw > 0 )
+      memset( ew_vis, 0, nw * sizeof( uint32_t ) );
+
+   /* Only pilots within the largest range of each pilot can be detected, so
+    * look them up in the quadtree. Everything else stays undetected. */
+   for ( int i = 0; i < n; i++ ) {
+      const Pilot *p = ps[i];
+      int          x, y, r;
+
+      if ( ew_vis_id[i] == 0 )
+         continue;
+
+      r = ceil( MAX( 0., p->stats.ew_detect *
+                            MAX( p->stats.ew_track * sig_max, det_max ) ) );
+      if ( r <= 0 )
+         continue;
+      x = round( p->solid.pos.x );
+      y = round( p->solid.pos.y );
+      pilot_collideQueryIL( &ew_qtquery, x - r, y - r, x + r, y + r );
+      for ( int j = 0; j < il_size( &ew_qtquery ); j++ ) {
+         const Pilot *t;
+         size_t       k;
+         int          idx = il_get( &ew_qtquery, j, 0 );
+         int          vis;
+
+         /* Quadtree may be from before the stack got cleaned. */
+         if ( ( idx >= n ) || ( idx == i ) || ( ew_vis_id[idx] == 0 ) )
+            continue;
+         t   = ps[idx];
+         vis = pilot_ewDetect( p, t,
+                               vec2_dist2( &p->solid.pos, &t->solid.pos ) );
+         if ( vis == 0 )
+            continue;
+
+         k = (size_t)i * n + idx;
+         ew_vis[k / EW_VIS_PAIRS] |= (uint32_t)( ( vis > 0 ) ? EW_VIS_RANGE
+                                                             : EW_VIS_FUZZY )
+                                     << ( 2 * ( k % EW_VIS_PAIRS ) );
+      }
+   }
+}
+
+/**
+ * @brief Looks up a pair of pilots in the visibility matrix.
+ *
+ *    @param p Pilot doing the detecting.
+ *    @param target Pilot being detected.
+ *    @param[out] vis Detection result as in pilot_inRangePilot.
+ *    @return 1 if the pair was in the matrix, 0 if it has to be computed.
+ */
+static int pilot_ewVisibility( const Pilot *p, const Pilot *target, int *vis )
+{
+   int      r = p->ew_row;
+   int      c = target->ew_row;
+   size_t   k;
+   uint32_t v;
+
+   /* Pilots may have been added or removed since the last pass. */
+   if ( ( r < 0 ) || ( c < 0 ) || ( r >= ew_vis_n ) || ( c >= ew_vis_n ) )
+      return 0;
+   if ( ( ew_vis_id[r] != p->id ) || ( ew_vis_id[c] != target->id ) ||
+        ( p->id == 0 ) )
+      return 0;
+
+   k = (size_t)r * ew_vis_n + c;
+   v = ( ew_vis[k / EW_VIS_PAIRS] >> ( 2 * ( k % EW_VIS_PAIRS ) ) ) & 3;
+   if ( v == EW_VIS_RANGE )
+      *vis = 1;
+   else if ( v == EW_VIS_FUZZY )
+      *vis = -1;
+   else
+      *vis = 0;
+   return 1;
+}
 
 /**
  * @brief Gets the time it takes to scan a pilot.
@@ -112,12 +266,36 @@ void pilot_ewUpdateStatic( Pilot *p )
  */
 void pilot_ewUpdateDynamic( Pilot *p, double dt )
 {
-   Pilot *t;
+   pilot_ewUpdateModifiers( p );
+   pilot_ewUpdateScan( p, dt );
+}
 
-   /* Electronic warfare values. */
+/**
+ * @brief Updates the electronic warfare modifiers that depend on where the
+ * pilot is.
+ *
+ * Only modifies the pilot itself, so it can be run for several pilots at
+ * once.
+ *
+ *    @param p Pilot to update.
+ */
+void pilot_ewUpdateModifiers( Pilot *p )
+{
    p->ew_asteroid  = pilot_ewAsteroid( p );
    p->ew_jumppoint = pilot_ewJumpPoint( p );
    pilot_ewUpdate( p );
+}
+
+/**
+ * @brief Updates the pilot scanning its target, running the scan hooks when
+ * done.
+ *
+ *    @param p Pilot to update.
+ *    @param dt Delta time increment (seconds).
+ */
+void pilot_ewUpdateScan( Pilot *p, double dt )
+{
+   Pilot *t;
 
    /* Already scanned so skipping. */
    if ( p->scantimer < 0. )
@@ -256,6 +434,7 @@ int pilot_inRange( const Pilot *p, double x, double y )
 int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist2 )
 {
    double d;
+   int    vis;
 
    /* Get distance if needed. */
    if ( dist2 != NULL )
@@ -270,9 +449,24 @@ int pilot_inRangePilot( const Pilot *p, const Pilot *target, double *dist2 )
    if ( pilot_isFlag( target, PILOT_STEALTH ) && !pilot_areAllies( p, target ) )
       return 0;
 
-   /* No stealth so normal detection. */
+   /* No stealth so normal detection, done once per frame when possible. */
+   if ( pilot_ewVisibility( p, target, &vis ) )
+      return vis;
    d = ( dist2 != NULL ? *dist2
                        : vec2_dist2( &p->solid.pos, &target->solid.pos ) );
+   return pilot_ewDetect( p, target, d );
+}
+
+/**
+ * @brief Normal detection of a pilot, ignoring stealth and special cases.
+ *
+ *    @param p Pilot doing the detecting.
+ *    @param target Pilot being detected.
+ *    @param d Distance squared between the pilots.
+ *    @return 1 if in range, 0 if not and -1 if detected fuzzily.
+ */
+static int pilot_ewDetect( const Pilot *p, const Pilot *target, double d )
+{
    if ( d < pow2( MAX( 0., p->stats.ew_detect * p->stats.ew_track *
                               target->ew_signature ) ) )
       return 1;
@@ -432,7 +626,7 @@ static int pilot_ewStealthGetNearby( const Pilot *p, double *mod, int *close,
                                      int *isplayer )
 {
    Pilot *const *ps;
-   int           n;
+   int           n, x, y, r;
 
    /* Check nearby non-allies. */
    if ( mod != NULL )
@@ -441,11 +635,27 @@ static int pilot_ewStealthGetNearby( const Pilot *p, double *mod, int *close,
       *close = 0;
    if ( isplayer != NULL )
       *isplayer = 0;
-   n  = 0;
+   n = 0;
+
+   /* Only pilots within the largest detection range can break stealth, so
+    * look them up in the quadtree instead of going over all the pilots. */
+   r = ceil( MAX( 0., p->ew_stealth * ew_detect_max ) *
+             ( ( close != NULL ) ? 1.5 : 1. ) );
+   if ( r <= 0 )
+      return 0;
+   x  = round( p->solid.pos.x );
+   y  = round( p->solid.pos.y );
    ps = pilot_getAll();
-   for ( int i = 0; i < array_size( ps ); i++ ) {
+   pilot_collideQueryIL( &ew_qtquery, x - r, y - r, x + r, y + r );
+   for ( int i = 0; i < il_size( &ew_qtquery ); i++ ) {
       double dist;
-      Pilot *t = ps[i];
+      Pilot *t;
+      int    idx = il_get( &ew_qtquery, i, 0 );
+
+      /* Quadtree may be from before the stack got cleaned. */
+      if ( idx >= array_size( ps ) )
+         continue;
+      t = ps[idx];
 
       /* Quick checks first. */
       if ( pilot_isDisabled( t ) )
@@ -568,7 +778,7 @@ int pilot_stealth( Pilot *p )
 
    /* Got into stealth. */
    if ( !pilot_outfitLOnstealth( p ) || ret )
-      pilot_calcStats( p );
+      pilot_calcStatsSource( p, PILOT_STATS_OUTFITS );
    p->ew_stealth_timer = 0.;
 
    /* Run hook. */
@@ -587,7 +797,7 @@ void pilot_destealth( Pilot *p )
    pilot_rmFlag( p, PILOT_STEALTH );
    p->ew_stealth_timer = 0.;
    if ( !pilot_outfitLOnstealth( p ) )
-      pilot_calcStats( p );
+      pilot_calcStatsSource( p, PILOT_STATS_OUTFITS );
 
    /* Run hook. */
    const HookParam hparam = { .type = HOOK_PARAM_BOOL, .u.b = 0 };
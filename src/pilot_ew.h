@@ -11,6 +11,13 @@
 #define EW_JUMPDETECT_DIST 7.5e3
 #define EW_SPOBDETECT_DIST 20e3 /* TODO something better than this. */
 
+/*
+ * Global state.
+ */
+void pilots_ewInit( void );
+void pilots_ewFree( void );
+void pilots_ewUpdate( void );
+
 /*
  * Sensors and range.
  */
@@ -36,6 +43,8 @@ double pilot_ewScanTime( const Pilot *p );
 void   pilot_ewScanStart( Pilot *p );
 void   pilot_ewUpdateStatic( Pilot *p );
 void   pilot_ewUpdateDynamic( Pilot *p, double dt );
+void   pilot_ewUpdateModifiers( Pilot *p );
+void   pilot_ewUpdateScan( Pilot *p, double dt );
 
 /*
  * Stealth.
@@ -32,7 +32,8 @@ static int stealth_break = 0; /**< Whether or not to break stealth. */
 /*
  * Prototypes.
  */
-static void        pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot );
+static void        pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
+                                        ShipStatsDelta *delta );
 static const char *outfitkeytostr( OutfitKey key );
 
 /**
@@ -923,11 +924,16 @@ double pilot_outfitRange( const Pilot *p, const Outfit *o )
 
 /**
  * @brief Computes the stats for a pilot's slot.
+ *
+ *    @param pilot Pilot owning the slot.
+ *    @param slot Slot to compute.
+ *    @param delta Delta to accumulate the slot's stats into, or NULL if the
+ *           cached outfit stats are still valid.
  */
-static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
+static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
+                                 ShipStatsDelta *delta )
 {
    const Outfit *o = slot->outfit;
-   ShipStats    *s = &pilot->stats;
 
    /* Outfit must exist. */
    if ( o == NULL )
@@ -953,8 +959,8 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
       pilot->afterburner = slot;    /* Set afterburner */
 
    /* Lua mods apply their stats. */
-   if ( slot->lua_mem != LUA_NOREF )
-      ss_statsMergeFromList( &pilot->stats, slot->lua_stats );
+   if ( ( delta != NULL ) && ( slot->lua_mem != LUA_NOREF ) )
+      ss_deltaMergeFromListScale( delta, slot->lua_stats, 1. );
 
    /* Has update function. */
    if ( o->lua_update != LUA_NOREF )
@@ -967,7 +973,8 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
            !( slot->state == PILOT_OUTFIT_ON ) )
          return;
       /* Add stats. */
-      ss_statsMergeFromList( s, o->stats );
+      if ( delta != NULL )
+         ss_deltaMergeFromListScale( delta, o->stats, 1. );
 
    } else if ( outfit_isAfterburner( o ) ) { /* Afterburner */
       /* Active outfits must be on to affect stuff. */
@@ -975,7 +982,8 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
            !( slot->state == PILOT_OUTFIT_ON ) )
          return;
       /* Add stats. */
-      ss_statsMergeFromList( s, o->stats );
+      if ( delta != NULL )
+         ss_deltaMergeFromListScale( delta, o->stats, 1. );
       pilot_setFlag(
          pilot,
          PILOT_AFTERBURNER ); /* We use old school flags for this still... */
@@ -983,7 +991,8 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
          pilot->afterburner->outfit->u.afb.energy; /* energy loss */
    } else {
       /* Always add stats for non mod/afterburners. */
-      ss_statsMergeFromList( s, o->stats );
+      if ( delta != NULL )
+         ss_deltaMergeFromListScale( delta, o->stats, 1. );
    }
 }
 
@@ -994,8 +1003,28 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot )
  */
 void pilot_calcStats( Pilot *pilot )
 {
-   double     ac, sc, ec, tm; /* temporary health coefficients to set */
-   ShipStats *s;
+   pilot_calcStatsSource( pilot, PILOT_STATS_ALL );
+}
+
+/**
+ * @brief Recalculates the pilot's stats when only some stat sources changed.
+ *
+ * The contribution of each source is cached, so only the ones in sources are
+ * rebuilt from their stat lists and the rest are just merged back in. Callers
+ * must pass every source they may have touched, pilot_calcStats() is the safe
+ * default.
+ *
+ *    @param pilot Pilot to recalculate his stats.
+ *    @param sources PILOT_STATS_* flags of the sources that changed.
+ */
+void pilot_calcStatsSource( Pilot *pilot, unsigned int sources )
+{
+   double          ac, sc, ec, tm; /* temporary health coefficients to set */
+   ShipStats      *s;
+   ShipStatsDelta  total;
+   ShipStatsDelta *delta;
+
+   NTracingZone( _ctx, 1 );
 
    /*
     * Set up the basic stuff
@@ -1041,22 +1070,50 @@ void pilot_calcStats( Pilot *pilot )
    if ( pilot_isPlayer( pilot ) )
       difficulty_apply( s );
 
-   /* Now add outfit changes */
+   /* Invalidate the sources that changed. */
+   pilot->stats_valid &= ~sources;
+
+   /* Now add outfit changes, the slots always have to be visited for mass,
+    * CPU and such, but stats only get gathered if the cache is stale. */
    pilot->mass_outfit = 0.;
+   delta              = NULL;
+   if ( !( pilot->stats_valid & PILOT_STATS_OUTFITS ) ) {
+      delta = &pilot->stats_src[0];
+      ss_deltaInit( delta );
+   }
    for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
-      pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i] );
+      pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i], delta );
    for ( int i = 0; i < array_size( pilot->outfits ); i++ )
-      pilot_calcStatsSlot( pilot, pilot->outfits[i] );
+      pilot_calcStatsSlot( pilot, pilot->outfits[i], delta );
 
    /* Merge stats. */
-   ss_statsMergeFromList( &pilot->stats, pilot->ship_stats );
-   ss_statsMergeFromList( &pilot->stats, pilot->intrinsic_stats );
+   if ( !( pilot->stats_valid & PILOT_STATS_SHIP ) ) {
+      delta = &pilot->stats_src[1];
+      ss_deltaInit( delta );
+      ss_deltaMergeFromListScale( delta, pilot->ship_stats, 1. );
+      ss_deltaMergeFromListScale( delta, pilot->intrinsic_stats, 1. );
+   }
 
    /* Compute effects. */
-   effect_compute( &pilot->stats, pilot->effects );
+   if ( !( pilot->stats_valid & PILOT_STATS_EFFECTS ) ) {
+      delta = &pilot->stats_src[2];
+      ss_deltaInit( delta );
+      effect_compute( delta, pilot->effects );
+   }
 
    /* Apply system effects. */
-   ss_statsMergeFromList( &pilot->stats, cur_system->stats );
+   if ( !( pilot->stats_valid & PILOT_STATS_SYSTEM ) ) {
+      delta = &pilot->stats_src[3];
+      ss_deltaInit( delta );
+      ss_deltaMergeFromListScale( delta, cur_system->stats, 1. );
+   }
+   pilot->stats_valid = PILOT_STATS_ALL;
+
+   /* Combine all the sources and apply them on top of the base stats. */
+   total = pilot->stats_src[0];
+   for ( int i = 1; i < PILOT_STATS_NSOURCES; i++ )
+      ss_deltaMerge( &total, &pilot->stats_src[i] );
+   ss_statsMergeDelta( s, &total );
 
    /* Apply stealth malus. */
    if ( pilot_isFlag( pilot, PILOT_STEALTH ) ) {
@@ -1146,6 +1203,8 @@ void pilot_calcStats( Pilot *pilot )
    /* In case the time_mod has changed. */
    if ( pilot_isPlayer( pilot ) && ( tm != s->time_mod ) )
       player_resetSpeed();
+
+   NTracingZoneEnd( _ctx );
 }
 
 /**
@@ -1275,7 +1334,7 @@ static void pilot_outfitLRun( Pilot *p,
    }
    /* Recalculate if anything changed. */
    if ( pilotoutfit_modified )
-      pilot_calcStats( p );
+      pilot_calcStatsSource( p, PILOT_STATS_OUTFITS );
 }
 static void outfitLRunWarning( const Pilot *p, const Outfit *o,
                                const char *name, const char *error )
@@ -1410,7 +1469,7 @@ void pilot_outfitLInitAll( Pilot *pilot )
       pilot_outfitLInit( pilot, &pilot->outfit_intrinsic[i] );
    /* Recalculate if anything changed. */
    if ( pilotoutfit_modified )
-      pilot_calcStats( pilot );
+      pilot_calcStatsSource( pilot, PILOT_STATS_OUTFITS );
 }
 
 /**
@@ -64,6 +64,7 @@ void pilot_lockClear( Pilot *p );
 
 /* Other. */
 void             pilot_calcStats( Pilot *pilot );
+void             pilot_calcStatsSource( Pilot *pilot, unsigned int sources );
 double           pilot_massFactor( const Pilot *pilot );
 void             pilot_updateMass( Pilot *pilot );
 void             pilot_healLanded( Pilot *pilot );
@@ -0,0 +1,338 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file pilot_pool.c
+ *
+ * @brief Pilot memory pool and id slot map.
+ *
+ * Pilots are carved out of fixed size chunks and recycled through a free list
+ * instead of going through the allocator for every spawn. A recycled pilot
+ * also keeps the per-pilot arrays (outfits, effects, escorts and trails) of
+ * its previous owner so they only have to be emptied.
+ *
+ * Pilot ids encode the index of the pilot in the slot map in the lower bits
+ * and a generation counter in the upper bits, so looking up a pilot is a
+ * single array access and stale ids never match a reused slot.
+ */
+/** @cond */
+#include "SDL_timer.h"
+#include <limits.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "pilot_pool.h"
+
+#include "log.h"
+#include "ntracing.h"
+
+#define PILOT_POOL_CHUNK 32 /**< Pilots allocated at once by the pool. */
+
+#define PILOT_SLOT_BITS 16 /**< Bits of the id used for the slot index. */
+#define PILOT_SLOT_MASK                                                        \
+   ( ( 1U << PILOT_SLOT_BITS ) - 1 ) /**< Mask of the slot index. */
+#define PILOT_SLOT_MAX ( 1 << PILOT_SLOT_BITS ) /**< Maximum slots. */
+#define PILOT_SLOT_RESERVED                                                    \
+   2 /**< Slot 0 is the invalid id and slot 1 is PLAYER_ID. */
+#define PILOT_SLOT_MINFREE                                                     \
+   256 /**< Free slots to keep before reusing any, slows generation wrap. */
+
+/**
+ * @brief A pilot in the pool along with the arrays kept for its next use.
+ */
+typedef struct PilotBlock_ {
+   Pilot               p;    /**< The pilot itself, must be first. */
+   struct PilotBlock_ *next; /**< Next free block. */
+   PilotOutfitSlot   **outfits;          /**< Kept outfit pointer array. */
+   PilotOutfitSlot    *outfit_structure; /**< Kept structure slots. */
+   PilotOutfitSlot    *outfit_utility;   /**< Kept utility slots. */
+   PilotOutfitSlot    *outfit_weapon;    /**< Kept weapon slots. */
+   Effect             *effects;          /**< Kept effect array. */
+   Escort_t           *escorts;          /**< Kept escort array. */
+   Trail_spfx        **trail;            /**< Kept trail array. */
+} PilotBlock;
+
+/**
+ * @brief An entry of the pilot slot map.
+ */
+typedef struct PilotSlot_ {
+   Pilot       *p;    /**< Pilot in the slot or NULL if free. */
+   unsigned int id;   /**< Full id of the pilot in the slot (0 if free). */
+   unsigned int gen;  /**< Generation of the slot. */
+   int          next; /**< Next free slot or -1. */
+} PilotSlot;
+
+/* Pool. */
+static PilotBlock **pool_chunks = NULL; /**< Chunks allocated (array.h). */
+static PilotBlock  *pool_free   = NULL; /**< Free blocks. */
+static int          pool_used   = 0;    /**< Blocks in use. */
+static Uint64       pool_ticks  = 0;    /**< Ticks spent in the pool. */
+
+/* Slot map. */
+static PilotSlot *pilot_slots = NULL; /**< Slot map (array.h). */
+static int        slot_head   = -1;   /**< First free slot. */
+static int        slot_tail   = -1;   /**< Last free slot. */
+static int        slot_nfree  = 0;    /**< Number of free slots. */
+
+/**
+ * @brief Empties an array if it exists.
+ */
+#define pilot_poolEmpty( ptr_array )                                           \
+   do {                                                                        \
+      if ( *( ptr_array ) != NULL )                                            \
+         array_resize( ptr_array, 0 );                                         \
+   } while ( 0 )
+
+/*
+ * Prototypes.
+ */
+static void pilot_slotInit( void );
+
+/**
+ * @brief Gets a zeroed pilot from the pool.
+ *
+ * The pilot has the emptied arrays from the previous user of its memory set
+ * so they can be reused, and the rest is zero.
+ *
+ *    @return The new pilot.
+ */
+Pilot *pilot_poolAlloc( void )
+{
+   PilotBlock *b;
+   Pilot      *p;
+   Uint64      t = SDL_GetPerformanceCounter();
+
+   if ( pool_free == NULL ) {
+      PilotBlock *chunk = ncalloc( PILOT_POOL_CHUNK, sizeof( PilotBlock ) );
+      if ( pool_chunks == NULL )
+         pool_chunks = array_create( PilotBlock * );
+      array_push_back( &pool_chunks, chunk );
+      for ( int i = PILOT_POOL_CHUNK - 1; i >= 0; i-- ) {
+         chunk[i].next = pool_free;
+         pool_free     = &chunk[i];
+      }
+   }
+   b         = pool_free;
+   pool_free = b->next;
+   pool_used++;
+
+   p = &b->p;
+   memset( p, 0, sizeof( Pilot ) );
+   p->outfits          = b->outfits;
+   p->outfit_structure = b->outfit_structure;
+   p->outfit_utility   = b->outfit_utility;
+   p->outfit_weapon    = b->outfit_weapon;
+   p->effects          = b->effects;
+   p->escorts          = b->escorts;
+   p->trail            = b->trail;
+
+   pool_ticks += SDL_GetPerformanceCounter() - t;
+   return p;
+}
+
+/**
+ * @brief Returns a pilot to the pool.
+ *
+ * The pilot must have been cleaned up already, only its outfit, effect,
+ * escort and trail arrays are kept around.
+ *
+ *    @param p Pilot to return.
+ */
+void pilot_poolRelease( Pilot *p )
+{
+   PilotBlock *b = (PilotBlock *)p;
+   Uint64      t = SDL_GetPerformanceCounter();
+
+   pilot_poolEmpty( &p->outfits );
+   pilot_poolEmpty( &p->outfit_structure );
+   pilot_poolEmpty( &p->outfit_utility );
+   pilot_poolEmpty( &p->outfit_weapon );
+   pilot_poolEmpty( &p->effects );
+   pilot_poolEmpty( &p->escorts );
+   pilot_poolEmpty( &p->trail );
+   b->outfits          = p->outfits;
+   b->outfit_structure = p->outfit_structure;
+   b->outfit_utility   = p->outfit_utility;
+   b->outfit_weapon    = p->outfit_weapon;
+   b->effects          = p->effects;
+   b->escorts          = p->escorts;
+   b->trail            = p->trail;
+
+#ifdef DEBUGGING
+   memset( p, 0, sizeof( Pilot ) );
+#endif /* DEBUGGING */
+
+   b->next   = pool_free;
+   pool_free = b;
+   pool_used--;
+
+   pool_ticks += SDL_GetPerformanceCounter() - t;
+}
+
+/**
+ * @brief Frees the pool and the slot map.
+ *
+ * Chunks are only freed if no pilot is left using them.
+ */
+void pilots_poolFree( void )
+{
+   array_free( pilot_slots );
+   pilot_slots = NULL;
+   slot_head   = -1;
+   slot_tail   = -1;
+   slot_nfree  = 0;
+
+   if ( pool_used > 0 )
+      return;
+   for ( int i = 0; i < array_size( pool_chunks ); i++ ) {
+      for ( int j = 0; j < PILOT_POOL_CHUNK; j++ ) {
+         PilotBlock *b = &pool_chunks[i][j];
+         array_free( b->outfits );
+         array_free( b->outfit_structure );
+         array_free( b->outfit_utility );
+         array_free( b->outfit_weapon );
+         array_free( b->effects );
+         array_free( b->escorts );
+         array_free( b->trail );
+      }
+      nfree( pool_chunks[i] );
+   }
+   array_free( pool_chunks );
+   pool_chunks = NULL;
+   pool_free   = NULL;
+}
+
+/**
+ * @brief Plots the pool statistics for the profiler, once a frame.
+ */
+void pilots_poolPlot( void )
+{
+#if HAVE_TRACY
+   int total = array_size( pool_chunks ) * PILOT_POOL_CHUNK;
+   NTracingPlotI( "pilot pool used", pool_used );
+   NTracingPlotI( "pilot pool unused (%)",
+                  ( total > 0 ) ? 100 * ( total - pool_used ) / total : 0 );
+   NTracingPlotI( "pilot slots free", slot_nfree );
+   NTracingPlotF( "pilot alloc (us)",
+                  1e6 * (double)pool_ticks /
+                     (double)SDL_GetPerformanceFrequency() );
+#endif /* HAVE_TRACY */
+   pool_ticks = 0;
+}
+
+/**
+ * @brief Creates the slot map with the reserved slots if needed.
+ */
+static void pilot_slotInit( void )
+{
+   if ( pilot_slots != NULL )
+      return;
+   pilot_slots = array_create_size( PilotSlot, PILOT_SLOT_RESERVED );
+   for ( int i = 0; i < PILOT_SLOT_RESERVED; i++ )
+      memset( &array_grow( &pilot_slots ), 0, sizeof( PilotSlot ) );
+}
+
+/**
+ * @brief Gives a pilot a new id from the slot map.
+ *
+ * Freed slots are only reused once enough of them have piled up, so the
+ * generation of any given slot advances slowly.
+ *
+ *    @param p Pilot to give an id to.
+ *    @return The new id or 0 on failure.
+ */
+unsigned int pilot_slotAcquire( Pilot *p )
+{
+   PilotSlot *s;
+   int        idx, full;
+
+   pilot_slotInit();
+   full = ( array_size( pilot_slots ) >= PILOT_SLOT_MAX );
+
+   if ( ( slot_nfree > PILOT_SLOT_MINFREE ) ||
+        ( full && ( slot_nfree > 0 ) ) ) {
+      idx       = slot_head;
+      slot_head = pilot_slots[idx].next;
+      if ( slot_head < 0 )
+         slot_tail = -1;
+      slot_nfree--;
+   } else if ( !full ) {
+      idx = array_size( pilot_slots );
+      memset( &array_grow( &pilot_slots ), 0, sizeof( PilotSlot ) );
+   } else {
+      WARN( _( "Ran out of pilot ids!" ) );
+      return 0;
+   }
+
+   s      = &pilot_slots[idx];
+   s->gen = ( s->gen + 1 ) & ( UINT_MAX >> PILOT_SLOT_BITS );
+   if ( s->gen == 0 )
+      s->gen = 1;
+   s->p    = p;
+   s->id   = ( s->gen << PILOT_SLOT_BITS ) | (unsigned int)idx;
+   s->next = -1;
+   return s->id;
+}
+
+/**
+ * @brief Makes a pilot the one PLAYER_ID refers to.
+ *
+ *    @param p Pilot to set as the player.
+ */
+void pilot_slotSetPlayer( Pilot *p )
+{
+   pilot_slotInit();
+   pilot_slots[PLAYER_ID].p  = p;
+   pilot_slots[PLAYER_ID].id = PLAYER_ID;
+}
+
+/**
+ * @brief Frees the id of a pilot.
+ *
+ * Does nothing if the slot of the id no longer refers to the pilot, as is the
+ * case with the old player pilot when the player swaps ships.
+ *
+ *    @param p Pilot to free the id of.
+ */
+void pilot_slotRelease( const Pilot *p )
+{
+   PilotSlot   *s;
+   unsigned int idx = p->id & PILOT_SLOT_MASK;
+
+   if ( ( p->id == 0 ) || ( (int)idx >= array_size( pilot_slots ) ) )
+      return;
+   s = &pilot_slots[idx];
+   if ( ( s->id != p->id ) || ( s->p != p ) )
+      return;
+
+   s->p  = NULL;
+   s->id = 0;
+   if ( idx < PILOT_SLOT_RESERVED )
+      return;
+
+   /* Free slots are reused in FIFO order. */
+   s->next = -1;
+   if ( slot_tail >= 0 )
+      pilot_slots[slot_tail].next = idx;
+   else
+      slot_head = idx;
+   slot_tail = idx;
+   slot_nfree++;
+}
+
+/**
+ * @brief Gets the pilot with an id in O(1).
+ *
+ *    @param id ID of the pilot to get.
+ *    @return The pilot or NULL if the id is no longer valid.
+ */
+Pilot *pilot_slotGet( unsigned int id )
+{
+   unsigned int idx = id & PILOT_SLOT_MASK;
+   if ( (int)idx >= array_size( pilot_slots ) )
+      return NULL;
+   if ( pilot_slots[idx].id != id )
+      return NULL;
+   return pilot_slots[idx].p;
+}
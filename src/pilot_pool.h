@@ -0,0 +1,41 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "array.h"
+#include "pilot.h"
+
+/**
+ * @brief Empties an array recycled from the pilot pool, recreating it only if
+ * it can not hold n elements without being reallocated.
+ *
+ *    @param ptr_array Array being manipulated (may point to NULL).
+ *    @param basic_type Type of the array elements.
+ *    @param n Number of elements the array has to hold.
+ */
+#define pilot_poolArray( ptr_array, basic_type, n )                            \
+   do {                                                                        \
+      if ( ( *( ptr_array ) == NULL ) ||                                       \
+           ( array_reserved( *( ptr_array ) ) < ( n ) ) ) {                    \
+         array_free( *( ptr_array ) );                                         \
+         *( ptr_array ) = array_create_size( basic_type, n );                  \
+      } else                                                                   \
+         array_resize( ptr_array, 0 );                                         \
+   } while ( 0 )
+
+/*
+ * Pilot memory.
+ */
+Pilot *pilot_poolAlloc( void );
+void   pilot_poolRelease( Pilot *p );
+void   pilots_poolFree( void );
+void   pilots_poolPlot( void );
+
+/*
+ * Pilot ids.
+ */
+unsigned int pilot_slotAcquire( Pilot *p );
+void         pilot_slotSetPlayer( Pilot *p );
+void         pilot_slotRelease( const Pilot *p );
+Pilot       *pilot_slotGet( unsigned int id );
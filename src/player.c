@@ -1123,6 +1123,7 @@ static void player_renderStealthUnderlay( double dt )
    ps      = pilot_getAll();
    for ( int i = 0; i < array_size( ps ); i++ ) {
       double x, y, r;
+      vec2   pos;
       Pilot *t = ps[i];
       if ( areAllies( player.p->faction, t->faction ) || pilot_isFriendly( t ) )
          continue;
@@ -1132,7 +1133,8 @@ static void player_renderStealthUnderlay( double dt )
       if ( !pilot_validTarget( player.p, t ) )
          continue;
 
-      gl_gameToScreenCoords( &x, &y, t->solid.pos.x, t->solid.pos.y );
+      solid_renderPos( &pos, &t->solid, &t->solid.vel );
+      gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
       r = detectz * t->stats.ew_detect;
       if ( r > 0. ) {
          glUseProgram( shaders.stealthaura.program );
@@ -1148,11 +1150,12 @@ static void player_renderStealthOverlay( double dt )
 {
    (void)dt;
    double   x, y, r, st, z;
+   vec2     pos;
    glColour col;
 
    z = cam_getZoom();
-   gl_gameToScreenCoords( &x, &y, player.p->solid.pos.x,
-                          player.p->solid.pos.y );
+   solid_renderPos( &pos, &player.p->solid, &player.p->solid.vel );
+   gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
 
    /* Determine the arcs. */
    st = player.p->ew_stealth_timer;
@@ -1177,6 +1180,7 @@ static void player_renderAimHelper( double dt )
 {
    (void)dt;
    double   a, b, d, x1, y1, x2, y2, r, theta;
+   vec2     pos;
    glColour c, c2;
    Pilot   *target;
 
@@ -1186,8 +1190,8 @@ static void player_renderAimHelper( double dt )
 
    a = player.p->solid.dir;
    r = 200.;
-   gl_gameToScreenCoords( &x1, &y1, player.p->solid.pos.x,
-                          player.p->solid.pos.y );
+   solid_renderPos( &pos, &player.p->solid, &player.p->solid.vel );
+   gl_gameToScreenCoords( &x1, &y1, pos.x, pos.y );
 
    b = pilot_aimAngle( player.p, &target->solid.pos, &target->solid.vel );
 
@@ -1199,13 +1203,11 @@ static void player_renderAimHelper( double dt )
 
    c   = cInert;
    c.a = 0.3;
-   gl_gameToScreenCoords( &x2, &y2,
-                          player.p->solid.pos.x + r * cos( a + theta ),
-                          player.p->solid.pos.y + r * sin( a + theta ) );
+   gl_gameToScreenCoords( &x2, &y2, pos.x + r * cos( a + theta ),
+                          pos.y + r * sin( a + theta ) );
    gl_renderLine( x1, y1, x2, y2, &c );
-   gl_gameToScreenCoords( &x2, &y2,
-                          player.p->solid.pos.x + r * cos( a - theta ),
-                          player.p->solid.pos.y + r * sin( a - theta ) );
+   gl_gameToScreenCoords( &x2, &y2, pos.x + r * cos( a - theta ),
+                          pos.y + r * sin( a - theta ) );
    gl_renderLine( x1, y1, x2, y2, &c );
 
    c.r = d * 0.9;
@@ -1213,8 +1215,8 @@ static void player_renderAimHelper( double dt )
    c.b = ( 1 - d ) * 0.2;
    c.a = 0.7;
    col_gammaToLinear( &c );
-   gl_gameToScreenCoords( &x2, &y2, player.p->solid.pos.x + r * cos( a ),
-                          player.p->solid.pos.y + r * sin( a ) );
+   gl_gameToScreenCoords( &x2, &y2, pos.x + r * cos( a ),
+                          pos.y + r * sin( a ) );
 
    gl_renderLine( x1, y1, x2, y2, &c );
 
@@ -1224,8 +1226,8 @@ static void player_renderAimHelper( double dt )
    glUniform1f( shaders.crosshairs.paramf, 1. );
    gl_renderShader( x2, y2, 7, 7, 0., &shaders.crosshairs, &c2, 1 );
 
-   gl_gameToScreenCoords( &x2, &y2, player.p->solid.pos.x + r * cos( b ),
-                          player.p->solid.pos.y + r * sin( b ) );
+   gl_gameToScreenCoords( &x2, &y2, pos.x + r * cos( b ),
+                          pos.y + r * sin( b ) );
 
    c.a = 0.4;
    gl_renderLine( x1, y1, x2, y2, &c );
@@ -13,9 +13,13 @@
  * BY-SA 4.0: https://creativecommons.org/licenses/by-sa/4.0/
  */
 #include "quadtree.h"
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Sweeps between cleanups of the tree when elements have been removed.
+#define QT_CLEANUP_PERIOD 16
+
 enum {
    // ----------------------------------------------------------------------------------------
    // Element node fields:
@@ -32,9 +36,9 @@ enum {
    // ----------------------------------------------------------------------------------------
    // Element fields:
    // ----------------------------------------------------------------------------------------
-   elt_num = 5,
+   elt_num = 11,
 
-   // Stores the rectangle encompassing the element.
+   // Stores the loose rectangle used to place the element in the tree.
    elt_idx_lft = 0,
    elt_idx_top = 1,
    elt_idx_rgt = 2,
@@ -43,6 +47,18 @@ enum {
    // Stores the ID of the element.
    elt_idx_id = 4,
 
+   // Stores the rectangle encompassing the element, tested by queries.
+   elt_idx_x1 = 5,
+   elt_idx_y1 = 6,
+   elt_idx_x2 = 7,
+   elt_idx_y2 = 8,
+
+   // Stores the key of the object owning the element.
+   elt_idx_key = 9,
+
+   // Stores the stamp of the last update or -1 if the element was removed.
+   elt_idx_stamp = 10,
+
    // ----------------------------------------------------------------------------------------
    // Node fields:
    // ----------------------------------------------------------------------------------------
@@ -229,6 +245,14 @@ void qt_create( Quadtree *qt, int x1, int y1, int x2, int y2, int max_elements,
    qt->max_depth    = max_depth;
    qt->temp         = NULL;
    qt->temp_size    = 0;
+   qt->stamp        = 0;
+   qt->dirty        = 0;
+   qt->num_elts     = 0;
+
+   qt->stat_queries    = 0;
+   qt->stat_candidates = 0;
+   qt->stat_reinserts  = 0;
+
    il_create( &qt->nodes, node_num );
    il_create( &qt->elts, elt_num );
    il_create( &qt->enodes, enode_num );
@@ -253,6 +277,8 @@ void qt_clear( Quadtree *qt )
    il_clear( &qt->nodes );
    il_clear( &qt->elts );
    il_clear( &qt->enodes );
+   qt->dirty    = 0;
+   qt->num_elts = 0;
 
    // Insert the root node to the qt.
    il_insert( &qt->nodes );
@@ -268,17 +294,24 @@ void qt_destroy( Quadtree *qt )
    free( qt->temp );
 }
 
-int qt_insert( Quadtree *qt, int id, int x1, int y1, int x2, int y2 )
+static int elt_insert( Quadtree *qt, int key, int id, int x1, int y1, int x2,
+                       int y2, int margin )
 {
    // Insert a new element.
    const int new_element = il_insert( &qt->elts );
 
    // Set the fields of the new element.
-   il_set( &qt->elts, new_element, elt_idx_lft, x1 );
-   il_set( &qt->elts, new_element, elt_idx_top, y1 );
-   il_set( &qt->elts, new_element, elt_idx_rgt, x2 );
-   il_set( &qt->elts, new_element, elt_idx_btm, y2 );
+   il_set( &qt->elts, new_element, elt_idx_lft, x1 - margin );
+   il_set( &qt->elts, new_element, elt_idx_top, y1 - margin );
+   il_set( &qt->elts, new_element, elt_idx_rgt, x2 + margin );
+   il_set( &qt->elts, new_element, elt_idx_btm, y2 + margin );
    il_set( &qt->elts, new_element, elt_idx_id, id );
+   il_set( &qt->elts, new_element, elt_idx_x1, x1 );
+   il_set( &qt->elts, new_element, elt_idx_y1, y1 );
+   il_set( &qt->elts, new_element, elt_idx_x2, x2 );
+   il_set( &qt->elts, new_element, elt_idx_y2, y2 );
+   il_set( &qt->elts, new_element, elt_idx_key, key );
+   il_set( &qt->elts, new_element, elt_idx_stamp, qt->stamp );
 
    // Insert the element to the appropriate leaf node(s).
    node_insert( qt, 0, 0, qt->root_mx, qt->root_my, qt->root_sx, qt->root_sy,
@@ -286,6 +319,39 @@ int qt_insert( Quadtree *qt, int id, int x1, int y1, int x2, int y2 )
    return new_element;
 }
 
+int qt_insert( Quadtree *qt, int id, int x1, int y1, int x2, int y2 )
+{
+   return elt_insert( qt, id, id, x1, y1, x2, y2, 0 );
+}
+
+int qt_update( Quadtree *qt, int element, int key, int id, int x1, int y1,
+               int x2, int y2, int margin )
+{
+   // Only reuse the element if it is alive and still belongs to the object.
+   if ( element >= 0 && element < il_size( &qt->elts ) &&
+        il_get( &qt->elts, element, elt_idx_stamp ) != -1 &&
+        il_get( &qt->elts, element, elt_idx_key ) == key ) {
+      il_set( &qt->elts, element, elt_idx_id, id );
+      il_set( &qt->elts, element, elt_idx_x1, x1 );
+      il_set( &qt->elts, element, elt_idx_y1, y1 );
+      il_set( &qt->elts, element, elt_idx_x2, x2 );
+      il_set( &qt->elts, element, elt_idx_y2, y2 );
+      il_set( &qt->elts, element, elt_idx_stamp, qt->stamp );
+
+      // Nothing to do in the tree while it stays within the loose rectangle.
+      if ( x1 >= il_get( &qt->elts, element, elt_idx_lft ) &&
+           y1 >= il_get( &qt->elts, element, elt_idx_top ) &&
+           x2 <= il_get( &qt->elts, element, elt_idx_rgt ) &&
+           y2 <= il_get( &qt->elts, element, elt_idx_btm ) )
+         return element;
+
+      qt_remove( qt, element );
+      ++qt->dirty;
+      ++qt->stat_reinserts;
+   }
+   return elt_insert( qt, key, id, x1, y1, x2, y2, margin );
+}
+
 void qt_remove( Quadtree *qt, int element )
 {
    // Find the leaves.
@@ -331,9 +397,35 @@ void qt_remove( Quadtree *qt, int element )
    il_destroy( &leaves );
 
    // Remove the element.
+   il_set( &qt->elts, element, elt_idx_stamp, -1 );
    il_erase( &qt->elts, element );
 }
 
+void qt_sweep( Quadtree *qt )
+{
+   int num = 0;
+   for ( int i = 0; i < il_size( &qt->elts ); ++i ) {
+      const int stamp = il_get( &qt->elts, i, elt_idx_stamp );
+      if ( stamp == -1 )
+         continue;
+      if ( stamp != qt->stamp ) {
+         qt_remove( qt, i );
+         ++qt->dirty;
+      } else
+         ++num;
+   }
+   qt->num_elts = num;
+   qt->stamp    = ( qt->stamp + 1 ) & INT_MAX;
+
+   // Empty leaves are only merged back every so often, or when a lot of
+   // elements went away at once.
+   if ( qt->dirty > 0 &&
+        ( qt->dirty * 4 > num || qt->stamp % QT_CLEANUP_PERIOD == 0 ) ) {
+      qt_cleanup( qt );
+      qt->dirty = 0;
+   }
+}
+
 void qt_query( Quadtree *qt, IntList *out, int qlft, int qtop, int qrgt,
                int qbtm )
 {
@@ -361,10 +453,10 @@ void qt_query( Quadtree *qt, IntList *out, int qlft, int qtop, int qrgt,
       while ( elt_node_index != -1 ) {
          const int element =
             il_get( &qt->enodes, elt_node_index, enode_idx_elt );
-         const int lft = il_get( &qt->elts, element, elt_idx_lft );
-         const int top = il_get( &qt->elts, element, elt_idx_top );
-         const int rgt = il_get( &qt->elts, element, elt_idx_rgt );
-         const int btm = il_get( &qt->elts, element, elt_idx_btm );
+         const int lft = il_get( &qt->elts, element, elt_idx_x1 );
+         const int top = il_get( &qt->elts, element, elt_idx_y1 );
+         const int rgt = il_get( &qt->elts, element, elt_idx_x2 );
+         const int btm = il_get( &qt->elts, element, elt_idx_y2 );
          if ( !qt->temp[element] &&
               intersect( qlft, qtop, qrgt, qbtm, lft, top, rgt, btm ) ) {
             il_set( out, il_push_back( out ), 0, element );
@@ -382,6 +474,8 @@ void qt_query( Quadtree *qt, IntList *out, int qlft, int qtop, int qrgt,
       qt->temp[element] = 0;
       il_set( out, j, 0, id );
    }
+   ++qt->stat_queries;
+   qt->stat_candidates += il_size( out );
 }
 
 void qt_cleanup( Quadtree *qt )
@@ -472,3 +566,47 @@ void qt_traverse( Quadtree *qt, void *user_data, QtNodeFunc *branch,
    }
    il_destroy( &to_process );
 }
+
+static void stats_branch( Quadtree *qt, void *user_data, int node, int depth,
+                          int mx, int my, int sx, int sy )
+{
+   QtStats *stats = user_data;
+   (void)qt;
+   (void)node;
+   (void)depth;
+   (void)mx;
+   (void)my;
+   (void)sx;
+   (void)sy;
+   ++stats->nodes;
+}
+
+static void stats_leaf( Quadtree *qt, void *user_data, int node, int depth,
+                        int mx, int my, int sx, int sy )
+{
+   QtStats *stats = user_data;
+   (void)qt;
+   (void)node;
+   (void)mx;
+   (void)my;
+   (void)sx;
+   (void)sy;
+   ++stats->nodes;
+   ++stats->leaves;
+   if ( depth > stats->max_depth )
+      stats->max_depth = depth;
+}
+
+void qt_stats( Quadtree *qt, QtStats *stats )
+{
+   memset( stats, 0, sizeof( QtStats ) );
+   qt_traverse( qt, stats, stats_branch, stats_leaf );
+   stats->elements   = qt->num_elts;
+   stats->queries    = qt->stat_queries;
+   stats->candidates = qt->stat_candidates;
+   stats->reinserts  = qt->stat_reinserts;
+
+   qt->stat_queries    = 0;
+   qt->stat_candidates = 0;
+   qt->stat_reinserts  = 0;
+}
@@ -17,6 +17,7 @@
 #include "intlist.h"
 
 typedef struct Quadtree Quadtree;
+typedef struct QtStats  QtStats;
 
 struct Quadtree {
    // Stores all the nodes in the quadtree. The first node in this
@@ -45,6 +46,32 @@ struct Quadtree {
 
    // Stores the size of the temporary buffer.
    int temp_size;
+
+   // Stamp given to the elements updated since the last sweep.
+   int stamp;
+
+   // Number of elements removed since the last cleanup.
+   int dirty;
+
+   // Number of elements alive as of the last sweep.
+   int num_elts;
+
+   // Counters accumulated until the statistics are read.
+   unsigned int stat_queries;
+   unsigned int stat_candidates;
+   unsigned int stat_reinserts;
+};
+
+// Statistics of a quadtree, the counters cover the period since they were last
+// read.
+struct QtStats {
+   int          nodes;      // Number of nodes in use.
+   int          leaves;     // Number of leaves in use.
+   int          max_depth;  // Depth of the deepest leaf.
+   int          elements;   // Number of elements alive as of the last sweep.
+   unsigned int queries;    // Number of queries.
+   unsigned int candidates; // Number of elements returned by the queries.
+   unsigned int reinserts;  // Number of elements that left their loose bounds.
 };
 
 // Function signature used for traversing a tree node.
@@ -69,6 +96,22 @@ int qt_insert( Quadtree *qt, int id, int x1, int y1, int x2, int y2 );
 // Removes the specified element from the tree.
 void qt_remove( Quadtree *qt, int element );
 
+// Updates the rectangle of an element that is kept in the tree from one frame
+// to the next. 'element' is the index returned by the previous update, or -1,
+// and 'key' has to be unique to the object so that stale indices are detected.
+// The element is placed in the tree with its rectangle grown by 'margin' and
+// is only reinserted once the rectangle leaves those loose bounds, queries
+// still test the exact rectangle. Returns the index of the element.
+int qt_update( Quadtree *qt, int element, int key, int id, int x1, int y1,
+               int x2, int y2, int margin );
+
+// Removes the elements that were not updated or inserted since the last sweep
+// and cleans up the tree once enough of them have been removed.
+void qt_sweep( Quadtree *qt );
+
+// Gets the statistics of the tree and resets its counters.
+void qt_stats( Quadtree *qt, QtStats *stats );
+
 // Cleans up the tree, removing empty leaves.
 void qt_cleanup( Quadtree *qt );
 
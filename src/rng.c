@@ -6,7 +6,14 @@
  *
  * @brief Handles all the random number logic.
  *
- * Random numbers are currently generated using the mersenne twister.
+ * Random numbers are currently generated using the mersenne twister, which
+ * is only meant to be used from the main thread.
+ *
+ * For reproducible or multi-threaded code, there are also counter-based
+ * streams using the Philox4x32-10 generator (Salmon et al., "Parallel Random
+ * Numbers: As Easy as 1, 2, 3", SC'11). Every stream is defined by the global
+ * seed, a subsystem and an identifier, so streams can be created on the fly
+ * and never overlap.
  */
 /** @cond */
 #include <errno.h>
@@ -14,6 +21,8 @@
 #include <stdint.h>
 #include <unistd.h>
 
+#include "SDL_atomic.h"
+
 #include "naev.h"
 
 #if HAS_POSIX
@@ -29,6 +38,14 @@
 
 #include "rng.h"
 
+#include "log.h"
+
+#define PHILOX_M0 0xD2511F53U /**< Philox multiplier for the first word. */
+#define PHILOX_M1 0xCD9E8D57U /**< Philox multiplier for the third word. */
+#define PHILOX_W0 0x9E3779B9U /**< Philox key schedule (golden ratio). */
+#define PHILOX_W1 0xBB67AE85U /**< Philox key schedule (sqrt(3)-1). */
+#define PHILOX_ROUNDS 10      /**< Number of rounds to use. */
+
 /*
  * mersenne twister state
  */
@@ -36,6 +53,15 @@ static uint32_t MT[624];    /**< Mersenne twister state. */
 static uint32_t mt_y;       /**< Internal mersenne twister variable. */
 static int      mt_pos = 0; /**< Current number being used. */
 
+/*
+ * Counter-based stream state.
+ */
+static uint64_t     rng_seed     = 0; /**< Global seed for all streams. */
+static int          rng_seed_set = 0; /**< Seed was explicitly set. */
+static SDL_atomic_t rng_thread_count; /**< Thread streams handed out. */
+static _Thread_local RngStream rng_thread_stream; /**< Stream of this thread. */
+static _Thread_local int rng_thread_init = 0; /**< Thread stream is set up. */
+
 /*
  * prototypes
  */
@@ -44,6 +70,8 @@ static uint32_t rng_timeEntropy( void );
 static void     mt_initArray( uint32_t seed );
 static void     mt_genArray( void );
 static uint32_t mt_getInt( void );
+/* philox */
+static void philox_block( RngStream *s );
 
 /**
  * @fn void rng_init (void)
@@ -55,6 +83,17 @@ void rng_init( void )
    uint32_t i;
    int      need_init;
 
+   /* Explicit seed makes everything reproducible. */
+   if ( rng_seed_set ) {
+      mt_initArray( (uint32_t)( rng_seed ^ ( rng_seed >> 32 ) ) );
+      for ( int j = 0; j < 10; j++ )
+         mt_genArray();
+      LOG( _( "Using random seed %llu" ), (unsigned long long)rng_seed );
+      rng_streamInit( &rng_thread_stream, RNG_SUBSYS_MAIN, 0 );
+      rng_thread_init = 1;
+      return;
+   }
+
    need_init = 1; /* initialize by default */
 #if __LINUX__
    int fd;
@@ -78,6 +117,35 @@ void rng_init( void )
    for ( int j = 0; j < 10;
          j++ ) /* generate numbers to get away from poor initial values */
       mt_genArray();
+
+   /* Streams get their seed from the freshly initialized twister. */
+   rng_seed = ( (uint64_t)mt_getInt() << 32 ) | (uint64_t)mt_getInt();
+   rng_streamInit( &rng_thread_stream, RNG_SUBSYS_MAIN, 0 );
+   rng_thread_init = 1;
+}
+
+/**
+ * @brief Sets the global seed.
+ *
+ * Must be called before rng_init() to make the whole run reproducible. Streams
+ * created afterwards will derive from the new seed.
+ *
+ *    @param seed Seed to use.
+ */
+void rng_setSeed( uint64_t seed )
+{
+   rng_seed     = seed;
+   rng_seed_set = 1;
+}
+
+/**
+ * @brief Gets the global seed.
+ *
+ *    @return The seed all the streams are derived from.
+ */
+uint64_t rng_getSeed( void )
+{
+   return rng_seed;
 }
 
 /**
@@ -181,6 +249,103 @@ double        randfp( void )
    return m / m_div;
 }
 
+/**
+ * @brief Runs the Philox4x32-10 bijection on the current counter.
+ *
+ *    @param s Stream to generate the next output block for.
+ */
+static void philox_block( RngStream *s )
+{
+   uint32_t c0 = s->ctr[0], c1 = s->ctr[1], c2 = s->ctr[2], c3 = s->ctr[3];
+   uint32_t k0 = s->key[0], k1 = s->key[1];
+
+   for ( int r = 0; r < PHILOX_ROUNDS; r++ ) {
+      uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+      uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+      c0          = (uint32_t)( p1 >> 32 ) ^ c1 ^ k0;
+      c1          = (uint32_t)p1;
+      c2          = (uint32_t)( p0 >> 32 ) ^ c3 ^ k1;
+      c3          = (uint32_t)p0;
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+   }
+   s->out[0] = c0;
+   s->out[1] = c1;
+   s->out[2] = c2;
+   s->out[3] = c3;
+   s->pos    = 0;
+
+   /* The first two words form a 64-bit block index. */
+   if ( ++s->ctr[0] == 0 )
+      s->ctr[1]++;
+}
+
+/**
+ * @brief Initializes a counter-based random stream.
+ *
+ * The same seed, subsystem and identifier always produce the same sequence,
+ * independently of how many other streams exist or which thread uses them.
+ *
+ *    @param s Stream to initialize.
+ *    @param subsys Subsystem the stream belongs to.
+ *    @param id Identifier of the stream within the subsystem (thread, job,
+ *              environment, etc.).
+ */
+void rng_streamInit( RngStream *s, RngSubsystem subsys, uint32_t id )
+{
+   s->key[0] = (uint32_t)rng_seed;
+   s->key[1] = (uint32_t)( rng_seed >> 32 );
+   s->ctr[0] = 0;
+   s->ctr[1] = 0;
+   s->ctr[2] = (uint32_t)subsys;
+   s->ctr[3] = id;
+   s->pos    = 4; /* Force generating a block on first use. */
+}
+
+/**
+ * @brief Gets a random integer from a stream.
+ *
+ *    @param s Stream to draw from.
+ *    @return A random 4 byte number.
+ */
+uint32_t rng_streamInt( RngStream *s )
+{
+   if ( s->pos >= 4 )
+      philox_block( s );
+   return s->out[s->pos++];
+}
+
+/**
+ * @brief Gets a random float between 0 and 1 (inclusive) from a stream.
+ *
+ *    @param s Stream to draw from.
+ *    @return A random float between 0 and 1 (inclusive).
+ */
+double rng_streamFloat( RngStream *s )
+{
+   return (double)rng_streamInt( s ) / m_div;
+}
+
+/**
+ * @brief Gets the random stream of the calling thread.
+ *
+ * The main thread gets the main stream, while other threads get a new thread
+ * stream the first time they call this. Since the order threads call this is
+ * not deterministic, code that has to be reproducible across threads should
+ * instead create streams with rng_streamInit() using a job or object index.
+ *
+ *    @return The stream of the calling thread.
+ */
+RngStream *rng_threadStream( void )
+{
+   if ( !rng_thread_init ) {
+      uint32_t id = (uint32_t)SDL_AtomicAdd( &rng_thread_count, 1 );
+      rng_streamInit( &rng_thread_stream, RNG_SUBSYS_THREAD, id );
+      rng_thread_init = 1;
+   }
+   return &rng_thread_stream;
+}
+
 /**
  * @fn double Normal( double x )
  *
@@ -3,6 +3,10 @@
  */
 #pragma once
 
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
 /**
  * @brief Gets a random number between L and H (L <= RNG <= H).
  *
@@ -44,8 +48,77 @@
 #define RNG_3SIGMA()                                                           \
    NormalInverse( 0.0013498985 + RNGF() * ( 1. - 0.0013498985 * 2. ) )
 
+/**
+ * @brief Gets a random number between L and H (L <= RNGS <= H) from stream S.
+ *
+ * Same semantics as RNG() but draws from a counter-based stream.
+ */
+#define RNGS( S, L, H )                                                        \
+   ( ( ( L ) > ( H ) ) ? RNGS_BASE( S, ( H ), ( L ) )                          \
+                       : RNGS_BASE( S, ( L ), ( H ) ) ) /* L <= RNGS <= H */
+/**
+ * @brief Gets a number between L and H (L <= RNGS <= H) from stream S.
+ */
+#define RNGS_BASE( S, L, H )                                                   \
+   ( (int)L + (int)( (double)( H - L + 1 ) * rng_streamFloat( S ) ) )
+/**
+ * @brief Gets a random float between 0 and 1 from stream S (0. <= RNGSF <= 1.).
+ */
+#define RNGSF( S ) ( rng_streamFloat( S ) ) /* 0. <= RNGSF <= 1. */
+/**
+ * @brief Gets a random mu within one-sigma (-1 to 1) from stream S.
+ */
+#define RNGS_1SIGMA( S )                                                       \
+   NormalInverse( 0.158655255 + RNGSF( S ) * ( 1. - 0.158655255 * 2. ) )
+/**
+ * @brief Gets a random mu within two-sigma (-2 to 2) from stream S.
+ */
+#define RNGS_2SIGMA( S )                                                       \
+   NormalInverse( 0.022750132 + RNGSF( S ) * ( 1. - 0.022750132 * 2. ) )
+/**
+ * @brief Gets a random mu within three-sigma (-3 to 3) from stream S.
+ */
+#define RNGS_3SIGMA( S )                                                       \
+   NormalInverse( 0.0013498985 + RNGSF( S ) * ( 1. - 0.0013498985 * 2. ) )
+
+/**
+ * @brief Subsystems that get their own independent random streams.
+ *
+ * Streams with different subsystems or identifiers never overlap, so each
+ * subsystem can be advanced independently (and on any thread) while staying
+ * reproducible for a given global seed.
+ */
+typedef enum RngSubsystem_ {
+   RNG_SUBSYS_MAIN,    /**< Main thread default stream. */
+   RNG_SUBSYS_THREAD,  /**< Per-thread streams. */
+   RNG_SUBSYS_LUA,     /**< Per Lua environment streams. */
+   RNG_SUBSYS_ECONOMY, /**< Economy production changes. */
+} RngSubsystem;
+
+/**
+ * @brief Counter-based random number stream (Philox4x32-10).
+ *
+ * The stream is fully determined by the global seed, the subsystem and the
+ * stream identifier, so it does not share any state with other streams and
+ * can be used from any thread as long as a single thread owns it.
+ */
+typedef struct RngStream_ {
+   uint32_t key[2]; /**< Key derived from the global seed. */
+   uint32_t ctr[4]; /**< Counter: block index, subsystem and stream id. */
+   uint32_t out[4]; /**< Current output block. */
+   int      pos;    /**< Next unused word in the output block. */
+} RngStream;
+
 /* Init */
-void rng_init( void );
+void     rng_init( void );
+void     rng_setSeed( uint64_t seed );
+uint64_t rng_getSeed( void );
+
+/* Counter-based streams. */
+void       rng_streamInit( RngStream *s, RngSubsystem subsys, uint32_t id );
+uint32_t   rng_streamInt( RngStream *s );
+double     rng_streamFloat( RngStream *s );
+RngStream *rng_threadStream( void );
 
 /* Random functions */
 unsigned int randint( void );
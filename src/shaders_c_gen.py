@@ -194,8 +194,8 @@ SHADERS = [
       name = "font",
       vs_path = "font.vert",
       fs_path = "font.frag",
-      attributes = ["vertex", "tex_coord"],
-      uniforms = ["projection", "m", "colour", "outline_colour"],
+      attributes = ["vertex", "tex_coord", "glyph_m", "glyph_colour"],
+      uniforms = ["projection", "outline_colour"],
       subroutines = {},
    ),
    Shader(
@@ -280,6 +280,22 @@ SHADERS = [
       uniforms = ["ClipSpaceFromLocal", "MainTex", "gamma"],
       subroutines = {},
    ),
+   Shader(
+      name = "jumplanes",
+      vs_path = "jumplanes.vert",
+      fs_path = "jumplanes.frag",
+      attributes = ["lane", "vertex", "height", "lane_colour", "lane_colour_end"],
+      uniforms = ["projection", "offset", "zoom", "radius"],
+      subroutines = {},
+   ),
+   Shader(
+      name = "factiondisks",
+      vs_path = "factiondisks.vert",
+      fs_path = "factiondisks.frag",
+      attributes = ["centre", "vertex", "size", "disk_colour"],
+      uniforms = ["projection", "offset", "zoom", "radius", "alpha"],
+      subroutines = {},
+   ),
    SimpleShader(
       name = "status",
       fs_path = "status.frag",
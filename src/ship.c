@@ -7,8 +7,10 @@
  * @brief Handles the ship details.
  */
 /** @cond */
+#include "SDL_image.h"
 #include "SDL_timer.h"
 #include "physfs.h"
+#include "physfsrwops.h"
 
 #include "naev.h"
 /** @endcond */
@@ -70,6 +72,8 @@ static double       ship_aa_scale       = -1.;
  * Prototypes
  */
 static int  ship_loadPLG( Ship *temp, const char *buf );
+static char *ship_gfxPath( const Ship *s, char *str, size_t len,
+                           const char **ext );
 static int  ship_parse( Ship *temp, const char *filename );
 static int  ship_parseThread( void *ptr );
 static void ship_freeSlot( ShipOutfitSlot *s );
@@ -600,6 +604,277 @@ int ship_gfxLoadNeeded( void )
    return 0;
 }
 
+/**
+ * @brief Graphics of a ship being decoded ahead of time.
+ */
+typedef struct ShipGfxJob_s {
+   Ship        *s;      /**< Ship being loaded. */
+   int          state;  /**< State of the job. */
+   int          plg;    /**< Whether the polygon has been loaded. */
+   SDL_Surface *space;  /**< Decoded space sprite. */
+   SDL_Surface *engine; /**< Decoded engine sprite. */
+} ShipGfxJob;
+
+/**
+ * @brief States of a ShipGfxJob.
+ */
+enum {
+   SHIP_GFXJOB_QUEUED,   /**< Waiting to be decoded. */
+   SHIP_GFXJOB_DECODING, /**< Being decoded. */
+   SHIP_GFXJOB_DONE,     /**< Waiting to be uploaded. */
+};
+
+static ShipGfxJob **gfx_jobs   = NULL; /**< Prefetch jobs, use gfx_lock. */
+static SDL_mutex   *gfx_lock   = NULL; /**< Protects gfx_jobs. */
+static SDL_cond    *gfx_cond   = NULL; /**< Signals changes to gfx_jobs. */
+static SDL_Thread  *gfx_thread = NULL; /**< Decoding thread. */
+static int          gfx_quit   = 0;    /**< Tells the thread to stop. */
+
+/**
+ * @brief Decodes an image without uploading it.
+ */
+static SDL_Surface *ship_gfxDecodeImage( const char *path )
+{
+   SDL_RWops *rw = PHYSFSRWOPS_openRead( path );
+   if ( rw == NULL )
+      return NULL;
+   return IMG_Load_RW( rw, 1 );
+}
+
+/**
+ * @brief Does all the work of loading the graphics of a ship that doesn't
+ * need OpenGL.
+ */
+static void ship_gfxDecode( ShipGfxJob *job )
+{
+   char        str[PATH_MAX], *base;
+   const char *ext;
+   Ship       *s = job->s;
+   const char *base_path =
+      ( s->base_path != NULL ) ? s->base_path : s->base_type;
+
+   /* 3D models upload as they load, so they are left to ship_gfxLoad. */
+   snprintf( str, sizeof( str ), SHIP_3DGFX_PATH "%s/%s.gltf", base_path,
+             s->gfx_path );
+   if ( PHYSFS_exists( str ) )
+      return;
+
+   ship_loadPLG( s,
+                 ( s->polygon_path != NULL ) ? s->polygon_path : s->gfx_path );
+   job->plg = 1;
+
+   /* Without a polygon we need a transparency map, which has to be built
+    * from the file. */
+   if ( array_size( s->polygon.views ) <= 0 )
+      return;
+
+   base       = ship_gfxPath( s, str, sizeof( str ), &ext );
+   job->space = ship_gfxDecodeImage( str );
+   if ( !s->noengine ) {
+      snprintf( str, sizeof( str ), SHIP_GFX_PATH "%s/%s" SHIP_ENGINE "%s",
+                base, s->gfx_path, ext );
+      job->engine = ship_gfxDecodeImage( str );
+   }
+   free( base );
+}
+
+/**
+ * @brief Thread that decodes the graphics of prefetched ships.
+ */
+static int ship_gfxThread( void *unused )
+{
+   (void)unused;
+
+   SDL_mutexP( gfx_lock );
+   while ( !gfx_quit ) {
+      ShipGfxJob *job = NULL;
+      for ( int i = 0; i < array_size( gfx_jobs ); i++ ) {
+         if ( gfx_jobs[i]->state == SHIP_GFXJOB_QUEUED ) {
+            job = gfx_jobs[i];
+            break;
+         }
+      }
+      if ( job == NULL ) {
+         SDL_CondWait( gfx_cond, gfx_lock );
+         continue;
+      }
+
+      job->state = SHIP_GFXJOB_DECODING;
+      SDL_mutexV( gfx_lock );
+      ship_gfxDecode( job );
+      SDL_mutexP( gfx_lock );
+      job->state = SHIP_GFXJOB_DONE;
+      SDL_CondBroadcast( gfx_cond );
+   }
+   SDL_mutexV( gfx_lock );
+
+   return 0;
+}
+
+/**
+ * @brief Frees a prefetch job.
+ */
+static void ship_gfxJobFree( ShipGfxJob *job )
+{
+   if ( job == NULL )
+      return;
+   SDL_FreeSurface( job->space );
+   SDL_FreeSurface( job->engine );
+   free( job );
+}
+
+/**
+ * @brief Takes the prefetch job of a ship, waiting for it to be decoded if it
+ * is in progress.
+ *
+ *    @param s Ship to get job of.
+ *    @return The job if it was decoded, NULL otherwise.
+ */
+static ShipGfxJob *ship_gfxJobTake( Ship *s )
+{
+   ShipGfxJob *job = NULL;
+
+   if ( !ship_isFlag( s, SHIP_GFXQUEUED ) )
+      return NULL;
+
+   SDL_mutexP( gfx_lock );
+   for ( int i = 0; i < array_size( gfx_jobs ); i++ ) {
+      if ( gfx_jobs[i]->s == s ) {
+         job = gfx_jobs[i];
+         array_erase( &gfx_jobs, &gfx_jobs[i], &gfx_jobs[i + 1] );
+         break;
+      }
+   }
+   while ( ( job != NULL ) && ( job->state == SHIP_GFXJOB_DECODING ) )
+      SDL_CondWait( gfx_cond, gfx_lock );
+   SDL_mutexV( gfx_lock );
+   ship_rmFlag( s, SHIP_GFXQUEUED );
+
+   /* Never got started, so nothing to reuse. */
+   if ( ( job != NULL ) && ( job->state == SHIP_GFXJOB_QUEUED ) ) {
+      ship_gfxJobFree( job );
+      return NULL;
+   }
+   return job;
+}
+
+/**
+ * @brief Starts decoding the graphics of a ship in the background.
+ *
+ * The graphics get uploaded by ship_gfxUpdate() over the following frames, or
+ * as soon as they are needed by ship_gfxLoad().
+ *
+ *    @param s Ship to prefetch graphics of.
+ */
+void ship_gfxPrefetch( Ship *s )
+{
+   ShipGfxJob *job;
+
+   if ( ship_gfxLoaded( s ) || ship_isFlag( s, SHIP_GFXQUEUED ) )
+      return;
+
+   if ( gfx_lock == NULL ) {
+      gfx_lock   = SDL_CreateMutex();
+      gfx_cond   = SDL_CreateCond();
+      gfx_jobs   = array_create( ShipGfxJob * );
+      gfx_quit   = 0;
+      gfx_thread = SDL_CreateThread( ship_gfxThread, "ship_gfx", NULL );
+   }
+   if ( gfx_thread == NULL )
+      return;
+
+   job    = calloc( 1, sizeof( ShipGfxJob ) );
+   job->s = s;
+   SDL_mutexP( gfx_lock );
+   array_push_back( &gfx_jobs, job );
+   SDL_CondBroadcast( gfx_cond );
+   SDL_mutexV( gfx_lock );
+   ship_setFlag( s, SHIP_GFXQUEUED );
+}
+
+/**
+ * @brief Uploads the graphics of prefetched ships that finished decoding.
+ *
+ * Only does a ship per call to spread the uploads over frames.
+ */
+void ship_gfxUpdate( void )
+{
+   Ship *s = NULL;
+
+   if ( gfx_lock == NULL )
+      return;
+
+   SDL_mutexP( gfx_lock );
+   for ( int i = 0; i < array_size( gfx_jobs ); i++ ) {
+      if ( gfx_jobs[i]->state == SHIP_GFXJOB_DONE ) {
+         s = gfx_jobs[i]->s;
+         break;
+      }
+   }
+   SDL_mutexV( gfx_lock );
+
+   if ( s != NULL )
+      ship_gfxLoad( s );
+}
+
+/**
+ * @brief Stops the prefetching thread and frees pending jobs.
+ */
+static void ship_gfxPrefetchExit( void )
+{
+   if ( gfx_lock == NULL )
+      return;
+
+   SDL_mutexP( gfx_lock );
+   gfx_quit = 1;
+   SDL_CondBroadcast( gfx_cond );
+   SDL_mutexV( gfx_lock );
+   if ( gfx_thread != NULL )
+      SDL_WaitThread( gfx_thread, NULL );
+   gfx_thread = NULL;
+
+   for ( int i = 0; i < array_size( gfx_jobs ); i++ ) {
+      ship_rmFlag( gfx_jobs[i]->s, SHIP_GFXQUEUED );
+      ship_gfxJobFree( gfx_jobs[i] );
+   }
+   array_free( gfx_jobs );
+   gfx_jobs = NULL;
+   SDL_DestroyCond( gfx_cond );
+   gfx_cond = NULL;
+   SDL_DestroyMutex( gfx_lock );
+   gfx_lock = NULL;
+}
+
+/**
+ * @brief Gets the path of the space sprite of a ship.
+ *
+ *    @param s Ship to get path of.
+ *    @param[out] str Path of the space sprite.
+ *    @param len Size of \p str.
+ *    @param[out] ext Extension of the sprite files.
+ *    @return Base directory of the graphics, must be freed.
+ */
+static char *ship_gfxPath( const Ship *s, char *str, size_t len,
+                           const char **ext )
+{
+   const char *buf   = s->gfx_path;
+   const char *delim = strchr( buf, '_' );
+   char *base = ( delim == NULL ) ? strdup( buf ) : strndup( buf, delim - buf );
+
+   /* Determine extension path. */
+   *ext = ".webp";
+   if ( buf[0] == '/' ) /* absolute path. */
+      snprintf( str, len, "%s", buf );
+   else {
+      snprintf( str, len, SHIP_GFX_PATH "%s/%s%s", base, buf, *ext );
+      if ( !PHYSFS_exists( str ) ) {
+         *ext = ".png";
+         snprintf( str, len, SHIP_GFX_PATH "%s/%s%s", base, buf, *ext );
+      }
+   }
+   return base;
+}
+
 /**
  * @brief Loads the graphics for a ship if necessary.
  *
@@ -607,25 +882,27 @@ int ship_gfxLoadNeeded( void )
  */
 int ship_gfxLoad( Ship *s )
 {
-   char        str[PATH_MAX], *base, *delim, *base_path;
-   const char *ext    = ".webp";
+   char        str[PATH_MAX], *base, *base_path;
+   const char *ext;
    const char *buf    = s->gfx_path;
    int         sx     = s->sx;
    int         sy     = s->sy;
    int         engine = !s->noengine;
+   ShipGfxJob *job;
 
    /* If already loaded, just ignore. */
    if ( ship_gfxLoaded( s ) )
       return 0;
 
+   /* See if it was already decoded in the background. */
+   job = ship_gfxJobTake( s );
+
    /* Get base path. */
-   delim     = strchr( buf, '_' );
-   base      = delim == NULL ? strdup( buf ) : strndup( buf, delim - buf );
    base_path = ( s->base_path != NULL ) ? s->base_path : s->base_type;
 
-   /* Load the 3d model */
+   /* Load the 3d model, prefetching already checked there is none. */
    snprintf( str, sizeof( str ), SHIP_3DGFX_PATH "%s/%s.gltf", base_path, buf );
-   if ( PHYSFS_exists( str ) ) {
+   if ( ( ( job == NULL ) || !job->plg ) && PHYSFS_exists( str ) ) {
       // DEBUG( "Found 3D graphics for '%s' at '%s'!", s->name, str );
       s->gfx_3d = gltf_loadFromFile( str );
 
@@ -671,23 +948,16 @@ int ship_gfxLoad( Ship *s )
    }
 
    /* Determine extension path. */
-   if ( buf[0] == '/' ) /* absolute path. */
-      snprintf( str, sizeof( str ), "%s", buf );
-   else {
-      snprintf( str, sizeof( str ), SHIP_GFX_PATH "%s/%s%s", base, buf, ext );
-      if ( !PHYSFS_exists( str ) ) {
-         ext = ".png";
-         snprintf( str, sizeof( str ), SHIP_GFX_PATH "%s/%s%s", base, buf,
-                   ext );
-      }
-   }
+   base = ship_gfxPath( s, str, sizeof( str ), &ext );
 
    /* Load the polygon. */
-   ship_loadPLG( s,
-                 ( s->polygon_path != NULL ) ? s->polygon_path : s->gfx_path );
+   if ( ( job == NULL ) || !job->plg )
+      ship_loadPLG( s, ( s->polygon_path != NULL ) ? s->polygon_path
+                                                   : s->gfx_path );
 
    /* If we have 3D and polygons, we'll ignore the 2D stuff. */
    if ( ( s->gfx_3d != NULL ) && ( array_size( s->polygon.views ) > 0 ) ) {
+      ship_gfxJobFree( job );
       free( base );
       return 0;
    }
@@ -698,17 +968,26 @@ int ship_gfxLoad( Ship *s )
                     buf, ext );
 
    /* Load the space sprite. */
-   ship_loadSpaceImage( s, str, sx, sy );
+   if ( ( job != NULL ) && ( job->space != NULL ) )
+      s->gfx_space = gl_newSpriteSurface(
+         str, job->space, sx, sy, OPENGL_TEX_MIPMAPS | OPENGL_TEX_VFLIP );
+   else
+      ship_loadSpaceImage( s, str, sx, sy );
 
    /* Load the engine sprite .*/
    if ( engine ) {
       snprintf( str, sizeof( str ), SHIP_GFX_PATH "%s/%s" SHIP_ENGINE "%s",
                 base, buf, ext );
-      ship_loadEngineImage( s, str, sx, sy );
+      if ( ( job != NULL ) && ( job->engine != NULL ) )
+         s->gfx_engine = gl_newSpriteSurface( str, job->engine, sx, sy,
+                                              OPENGL_TEX_MIPMAPS );
+      else
+         ship_loadEngineImage( s, str, sx, sy );
       if ( s->gfx_engine == NULL )
          WARN( _( "Ship '%s' does not have an engine sprite (%s)." ), s->name,
                str );
    }
+   ship_gfxJobFree( job );
    free( base );
 
 #if 0
@@ -1589,6 +1868,8 @@ void ships_resize( void )
  */
 void ships_free( void )
 {
+   ship_gfxPrefetchExit();
+
    /* Clean up opengl. */
    for ( int i = 0; i < SHIP_FBO; i++ ) {
       glDeleteFramebuffers( 1, &ship_fbo[i] );
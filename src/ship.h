@@ -22,6 +22,8 @@
 #define SHIP_NEEDSGFX ( 1 << 3 ) /**< Ship needs to load graphics. */
 #define SHIP_3DTRAILS ( 1 << 4 ) /**< Ship is using 3D trails. */
 #define SHIP_3DMOUNTS ( 1 << 5 ) /**< Ship is using 3D mounts. */
+#define SHIP_GFXQUEUED                                                         \
+   ( 1 << 6 ) /**< Ship graphics are being decoded in the background. */
 #define ship_isFlag( s, f ) ( ( s )->flags & ( f ) )   /**< Checks ship flag. */
 #define ship_setFlag( s, f ) ( ( s )->flags |= ( f ) ) /**< Sets ship flag. */
 #define ship_rmFlag( s, f )                                                    \
@@ -237,5 +239,7 @@ void   ships_resize( void );
 int    ship_gfxLoaded( const Ship *s );
 int    ship_gfxLoadNeeded( void );
 int    ship_gfxLoad( Ship *temp );
+void   ship_gfxPrefetch( Ship *s );
+void   ship_gfxUpdate( void );
 int    ship_compareTech( const void *arg1, const void *arg2 );
 double ship_maxSize( void );
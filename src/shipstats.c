@@ -673,6 +673,119 @@ int ss_statsMergeFromListScale( ShipStats *stats, const ShipStatList *list,
    return ret;
 }
 
+/**
+ * @brief Applies an accumulated delta to a stat structure.
+ *
+ * Equivalent to merging every list that went into the delta with
+ * ss_statsMergeFromListScale(), up to floating point reordering.
+ *
+ *    @param stats Stats to update.
+ *    @param delta Delta to apply.
+ *    @return 0 on success.
+ */
+int ss_statsMergeDelta( ShipStats *stats, const ShipStatsDelta *delta )
+{
+   char   *ptr = (char *)stats;
+   double *dbl;
+   int    *i;
+
+   for ( int t = 0; t < SS_TYPE_SENTINEL; t++ ) {
+      const ShipStatsLookup *sl = &ss_lookup[t];
+
+      /* Only want valid names. */
+      if ( sl->name == NULL )
+         continue;
+
+      switch ( sl->data ) {
+      /* mul is 1 for everything not inverted, and add 0 for inverted. */
+      case SS_DATA_TYPE_DOUBLE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+         dbl  = (double *)(void *)&ptr[sl->offset];
+         *dbl = ( *dbl + delta->add[t] ) * delta->mul[t];
+         break;
+
+      case SS_DATA_TYPE_INTEGER:
+         i  = (int *)&ptr[sl->offset];
+         *i = *i + delta->add[t];
+         break;
+
+      case SS_DATA_TYPE_BOOLEAN:
+         i = (int *)&ptr[sl->offset];
+         if ( delta->add[t] > 0. )
+            *i = 1;
+         break;
+      }
+   }
+
+   return 0;
+}
+
+/**
+ * @brief Initializes an empty delta.
+ *
+ *    @param delta Delta to initialize.
+ */
+void ss_deltaInit( ShipStatsDelta *delta )
+{
+   memset( delta->add, 0, sizeof( delta->add ) );
+   for ( int t = 0; t < SS_TYPE_SENTINEL; t++ )
+      delta->mul[t] = 1.;
+}
+
+/**
+ * @brief Merges two deltas.
+ *
+ *    @param dest Destination delta.
+ *    @param src Source to be merged with destination, must not alias it.
+ */
+void ss_deltaMerge( ShipStatsDelta *restrict dest,
+                    const ShipStatsDelta *restrict src )
+{
+   /* Kept as two branchless loops so they get vectorised. */
+   for ( int t = 0; t < SS_TYPE_SENTINEL; t++ )
+      dest->add[t] += src->add[t];
+   for ( int t = 0; t < SS_TYPE_SENTINEL; t++ )
+      dest->mul[t] *= src->mul[t];
+}
+
+/**
+ * @brief Accumulates a stat list into a delta.
+ *
+ *    @param delta Delta to update.
+ *    @param list List to update from.
+ *    @param scale Scaling factor.
+ */
+void ss_deltaMergeFromListScale( ShipStatsDelta *delta,
+                                 const ShipStatList *list, double scale )
+{
+   for ( const ShipStatList *ll = list; ll != NULL; ll = ll->next ) {
+      const ShipStatsLookup *sl = &ss_lookup[ll->type];
+      switch ( sl->data ) {
+      case SS_DATA_TYPE_DOUBLE:
+         /* Same rules as ss_adjustDoubleStat(). */
+         if ( sl->inverted )
+            delta->mul[ll->type] *= 1. + ll->d.d * scale;
+         else
+            delta->add[ll->type] += ll->d.d * scale;
+         break;
+
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+         delta->add[ll->type] += ll->d.d * scale;
+         break;
+
+      case SS_DATA_TYPE_INTEGER:
+         delta->add[ll->type] += ll->d.i * scale;
+         break;
+
+      case SS_DATA_TYPE_BOOLEAN:
+         delta->add[ll->type] = 1.; /* Can only set to true. */
+         break;
+      }
+   }
+}
+
 /**
  * @brief Gets the name from type.
  *
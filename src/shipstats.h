@@ -338,6 +338,19 @@ typedef struct ShipStats_ {
    double jump_warmup;   /**< Modifies the time that is necessary to jump. */
 } ShipStats;
 
+/**
+ * @brief Accumulated contribution of stat lists, stored flat per type.
+ *
+ * Summed values (non-inverted relative doubles, absolute values, integers and
+ * booleans) go in add, inverted relative doubles are multiplied into mul. Being
+ * plain double arrays, two deltas combine with loops the compiler vectorises,
+ * which ShipStats with its interleaved integers does not allow.
+ */
+typedef struct ShipStatsDelta_ {
+   double add[SS_TYPE_SENTINEL]; /**< Additive part, 0 when unset. */
+   double mul[SS_TYPE_SENTINEL]; /**< Multiplicative part, 1 when unset. */
+} ShipStatsDelta;
+
 /*
  * Safety.
  */
@@ -362,6 +375,12 @@ int ss_statsMergeSingleScale( ShipStats *stats, const ShipStatList *list,
 int ss_statsMergeFromList( ShipStats *stats, const ShipStatList *list );
 int ss_statsMergeFromListScale( ShipStats *stats, const ShipStatList *list,
                                 double scale );
+int ss_statsMergeDelta( ShipStats *stats, const ShipStatsDelta *delta );
+void ss_deltaInit( ShipStatsDelta *delta );
+void ss_deltaMerge( ShipStatsDelta *restrict dest,
+                    const ShipStatsDelta *restrict src );
+void ss_deltaMergeFromListScale( ShipStatsDelta *delta,
+                                 const ShipStatList *list, double scale );
 
 /*
  * Lookup.
@@ -48,6 +48,7 @@
 #include "log.h"
 #include "music.h"
 #include "ndata.h"
+#include "nlua_audio.h"
 #include "nlua_spfx.h"
 #include "nopenal.h"
 #include "pilot.h"
@@ -693,6 +694,9 @@ void sound_exit( void )
       voice_mutex = NULL;
    }
 
+   /* Stop the stream decode worker. */
+   audio_exit();
+
    soundLock();
 
    /* Free groups. */
@@ -1968,30 +1972,35 @@ void rg_filter( float **pcm, long channels, long samples, void *filter_param )
    float                    scale_factor = param->rg_scale_factor;
    float                    max_scale    = param->rg_max_scale;
 
-   /* Apply the gain, and any limiting necessary */
-   if ( scale_factor > max_scale ) {
-      for ( int i = 0; i < channels; i++ )
-         for ( int j = 0; j < samples; j++ ) {
-            float cur_sample = pcm[i][j] * scale_factor;
-            /*
-             * This is essentially the scaled hard-limiting algorithm
-             * It looks like the soft-knee to me
-             * I haven't found a better limiting algorithm yet...
-             */
-            if ( cur_sample < -0.5 )
-               cur_sample =
-                  tanh( ( cur_sample + 0.5 ) / ( 1 - 0.5 ) ) * ( 1 - 0.5 ) -
-                  0.5;
-            else if ( cur_sample > 0.5 )
-               cur_sample =
-                  tanh( ( cur_sample - 0.5 ) / ( 1 - 0.5 ) ) * ( 1 - 0.5 ) +
-                  0.5;
-            pcm[i][j] = cur_sample;
-         }
-   } else if ( scale_factor > 0.0 )
-      for ( int i = 0; i < channels; i++ )
-         for ( int j = 0; j < samples; j++ )
-            pcm[i][j] *= scale_factor;
+   /* Unity gain and nothing to limit. */
+   if ( ( scale_factor == 1.f ) && ( scale_factor <= max_scale ) )
+      return;
+   if ( scale_factor <= 0.f )
+      return;
+
+   for ( long i = 0; i < channels; i++ ) {
+      float *ch = pcm[i];
+
+      /* Apply the gain. Kept branchless so it gets vectorised. */
+      for ( long j = 0; j < samples; j++ )
+         ch[j] *= scale_factor;
+
+      /* Apply any limiting necessary. */
+      if ( scale_factor <= max_scale )
+         continue;
+      for ( long j = 0; j < samples; j++ ) {
+         float cur_sample = ch[j];
+         /*
+          * This is essentially the scaled hard-limiting algorithm
+          * It looks like the soft-knee to me
+          * I haven't found a better limiting algorithm yet...
+          */
+         if ( cur_sample < -0.5f )
+            ch[j] = tanhf( ( cur_sample + 0.5f ) * 2.f ) * 0.5f - 0.5f;
+         else if ( cur_sample > 0.5f )
+            ch[j] = tanhf( ( cur_sample - 0.5f ) * 2.f ) * 0.5f + 0.5f;
+      }
+   }
 }
 
 /**
@@ -23,6 +23,7 @@
 #include "damagetype.h"
 #include "dev_uniedit.h"
 #include "economy.h"
+#include "explosion.h"
 #include "gatherable.h"
 #include "gui.h"
 #include "hook.h"
@@ -119,6 +120,8 @@ static Spob *space_landQueueSpob      = NULL;
  * Fleet spawning.
  */
 int space_spawn = 1; /**< Spawn enabled by default. */
+unsigned int space_mapGeneration =
+   0; /**< Bumped on system/jump flag, jump or presence changes. */
 
 /*
  * Internal Prototypes.
@@ -289,9 +292,8 @@ const char *spob_getClassName( const char *class )
  */
 credits_t spob_commodityPrice( const Spob *p, const Commodity *c )
 {
-   const char       *sysname = spob_getSystem( p->name );
-   const StarSystem *sys     = system_get( sysname );
-   return economy_getPrice( c, sys, p );
+   /* Prices only depend on the spob, so skip looking up the system. */
+   return economy_getPrice( c, NULL, p );
 }
 
 /**
@@ -304,9 +306,7 @@ credits_t spob_commodityPrice( const Spob *p, const Commodity *c )
 credits_t spob_commodityPriceAtTime( const Spob *p, const Commodity *c,
                                      ntime_t t )
 {
-   const char       *sysname = spob_getSystem( p->name );
-   const StarSystem *sys     = system_get( sysname );
-   return economy_getPriceAtTime( c, sys, p, t );
+   return economy_getPriceAtTime( c, NULL, p, t );
 }
 
 /**
@@ -381,11 +381,37 @@ int spob_setFaction( Spob *p, int faction )
  */
 int spob_addCommodity( Spob *p, Commodity *c )
 {
+   /* Keep the reverse index up to date. */
+   if ( p->commodityIndex == NULL ) {
+      int n             = array_size( commodity_getAll() );
+      p->commodityIndex = malloc( MAX( n, 1 ) * sizeof( int ) );
+      for ( int i = 0; i < n; i++ )
+         p->commodityIndex[i] = -1;
+   }
+   if ( !c->istemp )
+      p->commodityIndex[c - commodity_getAll()] =
+         array_size( p->commodities );
+
    array_grow( &p->commodities )          = c;
    array_grow( &p->commodityPrice ).price = c->price;
    return 0;
 }
 
+/**
+ * @brief Gets the position of a commodity in a spob's commodity list.
+ *
+ *    @param p Spob to look up.
+ *    @param c Commodity to look for.
+ *    @return Index into the spob commodities and commodity prices or -1 if
+ *            not sold at the spob.
+ */
+int spob_getCommodityIndex( const Spob *p, const Commodity *c )
+{
+   if ( ( p->commodityIndex == NULL ) || c->istemp )
+      return -1;
+   return p->commodityIndex[c - commodity_getAll()];
+}
+
 /**
  * @brief Removes a service from a spob.
  *
@@ -1619,6 +1645,7 @@ void space_init( const char *sysname, int do_simulate )
    pilots_clean( 1 );       /* Destroy non-persistent pilots */
    weapon_clear();          /* get rid of all the weapons */
    spfx_clear();            /* get rid of the explosions */
+   expl_clear();            /* get rid of the explosion damage */
    gatherable_free();       /* get rid of gatherable stuff. */
    background_clear();      /* Get rid of the background. */
    factions_clearDynamic(); /* get rid of dynamic factions. */
@@ -1670,7 +1697,7 @@ void space_init( const char *sysname, int do_simulate )
       Pilot *const *pilot_stack = pilot_getAll();
       for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
          Pilot *p = pilot_stack[i];
-         pilot_calcStats( p );
+         pilot_calcStatsSource( p, PILOT_STATS_SYSTEM );
          if ( pilot_isWithPlayer( p ) )
             pilot_setFlag( p, PILOT_HIDE );
       }
@@ -2940,6 +2967,10 @@ void systems_reconstructJumps( void )
          sys->jumps[j].targetid = sys->jumps[j].target->id;
    }
 
+   /* Economy depends on the jump topology. */
+   economy_jumpsChanged();
+   space_mapGeneration++;
+
    NTracingZoneEnd( _ctx );
 }
 
@@ -3816,6 +3847,7 @@ void space_exit( void )
       /* commodities */
       array_free( spb->commodities );
       array_free( spb->commodityPrice );
+      free( spb->commodityIndex );
 
       /* Lua. */
       nlua_freeEnv( spb->lua_env );
@@ -4497,6 +4529,7 @@ void space_reconstructPresences( void )
       systems_stack[i].ownerpresence =
          system_getPresence( &systems_stack[i], systems_stack[i].faction );
    }
+   space_mapGeneration++;
 
    /* Have to redo the scheduler because everything changed. */
    /* TODO this actually ignores existing presence and will temporarily increase
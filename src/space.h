@@ -131,6 +131,8 @@ typedef struct Spob_ {
    Commodity  **commodities;     /**< array: what commodities they sell */
    CommodityPrice
       *commodityPrice; /**< array: the base cost of a commodity on this spob */
+   int *commodityIndex; /**< Position in commodities by commodity stack index,
+                           or -1 if not sold. */
    tech_group_t *tech; /**< Spob tech. */
 
    /* Graphics. */
@@ -207,9 +209,13 @@ typedef struct Spob_ {
    ( ( s )->flags & ( f ) ) /**< Checks system flag.                           \
                              */
 #define sys_setFlag( s, f )                                                    \
-   ( ( s )->flags |= ( f ) ) /**< Sets a system flag. */
+   ( ( ( ( s )->flags & ( f ) ) != ( f ) )                                     \
+        ? (void)( ( s )->flags |= ( f ), space_mapGeneration++ )               \
+        : (void)0 ) /**< Sets a system flag. */
 #define sys_rmFlag( s, f )                                                     \
-   ( ( s )->flags &= ~( f ) ) /**< Removes a system flag. */
+   ( ( ( s )->flags & ( f ) )                                                  \
+        ? (void)( ( s )->flags &= ~( f ), space_mapGeneration++ )              \
+        : (void)0 ) /**< Removes a system flag. */
 #define sys_isKnown( s )                                                       \
    ( sys_isFlag( ( s ), SYSTEM_KNOWN ) ) /**< Checks if system is known. */
 #define sys_isMarked( s )                                                      \
@@ -239,9 +245,14 @@ typedef struct SystemPresence_ {
 #define JP_EXITONLY ( 1 << 3 ) /**< Jump point is exit only */
 #define JP_NOLANES ( 1 << 4 )  /**< Jump point doesn't create lanes. */
 #define jp_isFlag( j, f ) ( ( j )->flags & ( f ) )   /**< Checks jump flag. */
-#define jp_setFlag( j, f ) ( ( j )->flags |= ( f ) ) /**< Sets a jump flag. */
+#define jp_setFlag( j, f )                                                     \
+   ( ( ( ( j )->flags & ( f ) ) != ( f ) )                                     \
+        ? (void)( ( j )->flags |= ( f ), space_mapGeneration++ )               \
+        : (void)0 ) /**< Sets a jump flag. */
 #define jp_rmFlag( j, f )                                                      \
-   ( ( j )->flags &= ~( f ) ) /**< Removes a jump flag. */
+   ( ( ( j )->flags & ( f ) )                                                  \
+        ? (void)( ( j )->flags &= ~( f ), space_mapGeneration++ )              \
+        : (void)0 ) /**< Removes a jump flag. */
 #define jp_isKnown( j )                                                        \
    jp_isFlag( j, JP_KNOWN ) /**< Checks if jump is known. */
 #define jp_isUsable( j ) ( jp_isKnown( j ) && !jp_isFlag( j, JP_EXITONLY ) )
@@ -359,6 +370,8 @@ struct StarSystem_ {
 /* Some useful externs. */
 extern StarSystem *cur_system;  /**< current star system */
 extern int         space_spawn; /**< 1 if spawning is enabled. */
+extern unsigned int
+   space_mapGeneration; /**< Bumped whenever map-visible state changes. */
 
 /*
  * loading/exiting
@@ -397,6 +410,7 @@ void spob_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate );
 /* Misc modification. */
 int spob_setFaction( Spob *p, int faction );
 int spob_addCommodity( Spob *p, Commodity *c );
+int spob_getCommodityIndex( const Spob *p, const Commodity *c );
 int spob_addService( Spob *p, int service );
 int spob_rmService( Spob *p, int service );
 int spob_rename( Spob *p, char *newname );
@@ -27,6 +27,7 @@
 #include "opengl.h"
 #include "pause.h"
 #include "perlin.h"
+#include "physics.h"
 #include "render.h"
 #include "rng.h"
 #include "vec2.h"
@@ -798,14 +799,16 @@ static void spfx_trail_update( Trail_spfx *trail, double dt )
  *    @param x X position of the new control point.
  *    @param y Y position of the new control point.
  *    @param z Z position of the new control point.
+ *    @param vel Velocity of the emitter.
  *    @param mode Type of trail emission at this point.
  *    @param force Whether or not to force the addition of the sample.
  */
 void spfx_trail_sample( Trail_spfx *trail, double x, double y, double z,
-                        TrailMode mode, int force )
+                        const vec2 *vel, TrailMode mode, int force )
 {
    TrailPoint p;
 
+   trail->vel = *vel;
    if ( !force && trail->spec->style[mode].col.a <= 0. )
       return;
 
@@ -847,8 +850,12 @@ void spfx_trail_sample( Trail_spfx *trail, double x, double y, double z,
  */
 void spfx_trail_remove( Trail_spfx *trail )
 {
-   if ( trail != NULL )
-      trail->refcount--;
+   if ( trail == NULL )
+      return;
+   trail->refcount--;
+   /* Nothing moves the newest point anymore. */
+   if ( trail->refcount <= 0 )
+      vec2_cset( &trail->vel, 0., 0. );
 }
 
 /**
@@ -892,6 +899,7 @@ void spfx_trail_draw( const Trail_spfx *trail )
       mat4              projection;
       const TrailStyle *sp, *spp;
       double            x1, y1, x2, y2, s;
+      vec2              pos;
       TrailPoint       *tp  = &trail_at( trail, i );
       TrailPoint       *tpp = &trail_at( trail, i - 1 );
 
@@ -899,7 +907,12 @@ void spfx_trail_draw( const Trail_spfx *trail )
       if ( tp->mode == MODE_NONE || tpp->mode == MODE_NONE )
          continue;
 
-      gl_gameToScreenCoords( &x1, &y1, tp->x, tp->y );
+      /* The newest point is drawn where the emitter is drawn, the rest stay
+       * where they were left. */
+      vec2_cset( &pos, tp->x, tp->y );
+      if ( i == trail->iwrite - 1 )
+         solid_renderPosVec( &pos, &pos, &trail->vel );
+      gl_gameToScreenCoords( &x1, &y1, pos.x, pos.y );
       gl_gameToScreenCoords( &x2, &y2, tpp->x, tpp->y );
 
       s = hypot( x2 - x1, y2 - y1 );
@@ -1090,6 +1103,10 @@ static void spfx_renderStack( SPFX *spfx_stack )
    for ( int i = array_size( spfx_stack ) - 1; i >= 0; i-- ) {
       SPFX      *spfx   = &spfx_stack[i];
       SPFX_Base *effect = &spfx_effects[spfx->effect];
+      vec2       pos;
+
+      /* Drawn lagging behind the simulation like the rest. */
+      solid_renderPosVec( &pos, &spfx->pos, &spfx->vel );
 
       /* Render shader. */
       if ( effect->shader >= 0 ) {
@@ -1100,7 +1117,7 @@ static void spfx_renderStack( SPFX *spfx_stack )
          /* Translate coords. */
          s2 = effect->size / 2.;
          z  = cam_getZoom();
-         gl_gameToScreenCoords( &x, &y, spfx->pos.x - s2, spfx->pos.y - s2 );
+         gl_gameToScreenCoords( &x, &y, pos.x - s2, pos.y - s2 );
          w = h = effect->size * z;
 
          /* Check if inbounds. */
@@ -1151,8 +1168,8 @@ static void spfx_renderStack( SPFX *spfx_stack )
          }
 
          /* Renders */
-         gl_renderSprite( effect->gfx, VX( spfx_stack[i].pos ),
-                          VY( spfx_stack[i].pos ), spfx_stack[i].lastframe % sx,
+         gl_renderSprite( effect->gfx, pos.x, pos.y,
+                          spfx_stack[i].lastframe % sx,
                           spfx_stack[i].lastframe / sx, NULL );
       }
    }
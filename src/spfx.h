@@ -4,6 +4,7 @@
 #pragma once
 
 #include "opengl.h"
+#include "vec2.h"
 
 #define SPFX_LAYER_FRONT 0  /**< Front spfx layer. */
 #define SPFX_LAYER_MIDDLE 1 /**< Middle spfx layer. */
@@ -100,6 +101,8 @@ typedef struct Trail_spfx_ {
    GLfloat r; /**< Random variable between 0 and 1 to make each trail unique. */
    unsigned int ontop; /**< Boolean to decide if the trail is drawn before or
                           after the ship. */
+   vec2 vel; /**< Velocity of the emitter, moves the newest point back when
+                rendering. */
 } Trail_spfx;
 
 /** @brief Indexes into a trail's circular buffer.  */
@@ -128,7 +131,7 @@ void        spfx_render( int layer, double dt );
 void        spfx_clear( void );
 Trail_spfx *spfx_trail_create( const TrailSpec *spec );
 void        spfx_trail_sample( Trail_spfx *trail, double x, double y, double z,
-                               TrailMode mode, int force );
+                               const vec2 *vel, TrailMode mode, int force );
 void        spfx_trail_remove( Trail_spfx *trail );
 void        spfx_trail_draw( const Trail_spfx *trail );
 
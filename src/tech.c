@@ -9,6 +9,7 @@
  */
 /** @cond */
 #include "SDL_timer.h"
+#include <stdint.h>
 /** @endcond */
 
 #include "tech.h"
@@ -25,6 +26,9 @@
 #define XML_TECH_ID "Techs" /**< Tech xml document tag. */
 #define XML_TECH_TAG "tech" /**< Individual tech xml tag. */
 
+#define TECH_CLOSURE_NTYPES 3 /**< Item types that get a closure bitset. */
+#define TECH_CLOSURE_BITS 64  /**< Bits per closure bitset word. */
+
 /**
  * @brief Different tech types.
  */
@@ -58,12 +62,20 @@ struct tech_group_s {
    char        *name;     /**< Name of the tech group. */
    char        *filename; /**< Name of the file. */
    tech_item_t *items;    /**< Items in the tech group. */
+   unsigned int closure_gen; /**< Generation the closure was built at. */
+   uint64_t    *closure[TECH_CLOSURE_NTYPES]; /**< Flattened closure of the
+                                                 group as bitsets indexed by
+                                                 item id, built lazily. */
+   const Commodity **closure_temp; /**< Temporary commodities in the closure,
+                                      which have no id (array.h). */
 };
 
 /*
  * Group list.
  */
 static tech_group_t *tech_groups = NULL;
+static unsigned int  tech_gen =
+   1; /**< Bumped whenever any group changes, invalidating closures. */
 
 /*
  * Prototypes.
@@ -84,9 +96,17 @@ static int tech_getID( const char *name );
 static int tech_addItemGroupPointer( tech_group_t       *grp,
                                      const tech_group_t *ptr );
 static int tech_addItemGroup( tech_group_t *grp, const char *name );
-/* Getting by tech. */
-static void **tech_addGroupItem( void **items, tech_item_type_t type,
-                                 const tech_group_t *tech );
+/* Closures. */
+static int             tech_closureSize( tech_item_type_t type );
+static int             tech_closureID( const tech_item_t *item );
+static const uint64_t *tech_closure( const tech_group_t *tech,
+                                     tech_item_type_t    type );
+static int tech_closureHas( const tech_group_t *tech, tech_item_type_t type,
+                            int id );
+static void **tech_closureList( const tech_group_t *tech,
+                                tech_item_type_t    type );
+static void   tech_closureFree( tech_group_t *grp );
+static void   tech_closureAddTemp( tech_group_t *grp, const Commodity *c );
 
 static int tech_cmp( const void *p1, const void *p2 )
 {
@@ -108,6 +128,7 @@ int tech_load( void )
 
    /* Create the array. */
    tech_groups = array_create( tech_group_t );
+   tech_gen++;
 
    /* First pass create the groups - needed to reference them later. */
    for ( int i = 0; i < array_size( tech_files ); i++ ) {
@@ -172,6 +193,7 @@ static void tech_freeGroup( tech_group_t *grp )
    free( grp->name );
    free( grp->filename );
    array_free( grp->items );
+   tech_closureFree( grp );
 }
 
 /**
@@ -204,6 +226,7 @@ void tech_groupDestroy( tech_group_t *grp )
 
    tech_freeGroup( grp );
    free( grp );
+   tech_gen++;
 }
 
 /**
@@ -474,6 +497,7 @@ int tech_addItem( const char *name, const char *value )
       return -1;
    }
 
+   tech_gen++;
    return 0;
 }
 
@@ -494,6 +518,7 @@ int tech_addItemTech( tech_group_t *tech, const char *value )
       WARN( _( "Generic item '%s' not found in tech group" ), value );
       return -1;
    }
+   tech_gen++;
    return 0;
 }
 
@@ -508,6 +533,7 @@ int tech_rmItemTech( tech_group_t *tech, const char *value )
       const char *buf = tech_getItemName( &tech->items[i] );
       if ( strcmp( buf, value ) == 0 ) {
          array_erase( &tech->items, &tech->items[i], &tech->items[i + 1] );
+         tech_gen++;
          return 0;
       }
    }
@@ -541,6 +567,7 @@ int tech_rmItem( const char *name, const char *value )
       const char *buf = tech_getItemName( &tech->items[i] );
       if ( strcmp( buf, value ) == 0 ) {
          array_erase( &tech->items, &tech->items[i], &tech->items[i + 1] );
+         tech_gen++;
          return 0;
       }
    }
@@ -615,56 +642,6 @@ static void tech_createMetaGroup( tech_group_t *grp, tech_group_t **tech,
       tech_addItemGroupPointer( grp, tech[i] );
 }
 
-/**
- * @brief Recursive function for creating an array of commodities from a tech
- * group.
- */
-static void **tech_addGroupItem( void **items, tech_item_type_t type,
-                                 const tech_group_t *tech )
-{
-   /* Set up. */
-   int size = array_size( tech->items );
-
-   /* Load commodities first, then we handle groups. */
-   for ( int i = 0; i < size; i++ ) {
-      int          f;
-      tech_item_t *item = &tech->items[i];
-
-      /* Only handle commodities for now. */
-      if ( item->type != type )
-         continue;
-
-      /* Skip if already in list. */
-      f = 0;
-      for ( int j = 0; j < array_size( items ); j++ ) {
-         if ( items[j] == item->u.ptr ) {
-            f = 1;
-            break;
-         }
-      }
-      if ( f == 1 )
-         continue;
-
-      /* Add. */
-      if ( items == NULL )
-         items = array_create( void * );
-      array_push_back( &items, item->u.ptr );
-   }
-
-   /* Now handle other groups. */
-   for ( int i = 0; i < size; i++ ) {
-      tech_item_t *item = &tech->items[i];
-
-      /* Only handle commodities for now. */
-      if ( item->type == TECH_TYPE_GROUP )
-         items = tech_addGroupItem( items, type, &tech_groups[item->u.grp] );
-      else if ( item->type == TECH_TYPE_GROUP_POINTER )
-         items = tech_addGroupItem( items, type, item->u.grpptr );
-   }
-
-   return items;
-}
-
 /**
  * @brief Checks whether a given tech group has the specified item.
  *
@@ -749,7 +726,7 @@ Outfit **tech_getOutfit( const tech_group_t *tech )
    if ( tech == NULL )
       return NULL;
 
-   o = (Outfit **)tech_addGroupItem( NULL, TECH_TYPE_OUTFIT, tech );
+   o = (Outfit **)tech_closureList( tech, TECH_TYPE_OUTFIT );
 
    /* Sort. */
    if ( o != NULL )
@@ -798,7 +775,7 @@ Ship **tech_getShip( const tech_group_t *tech )
       return NULL;
 
    /* Get the outfits. */
-   s = (Ship **)tech_addGroupItem( NULL, TECH_TYPE_SHIP, tech );
+   s = (Ship **)tech_closureList( tech, TECH_TYPE_SHIP );
 
    /* Sort. */
    if ( s != NULL )
@@ -870,8 +847,13 @@ Commodity **tech_getCommodity( const tech_group_t *tech )
    if ( tech == NULL )
       return NULL;
 
-   /* Get the commodities. */
-   c = (Commodity **)tech_addGroupItem( NULL, TECH_TYPE_COMMODITY, tech );
+   /* Get the commodities, temporary ones are not in the bitset. */
+   c = (Commodity **)tech_closureList( tech, TECH_TYPE_COMMODITY );
+   for ( int i = 0; i < array_size( tech->closure_temp ); i++ ) {
+      if ( c == NULL )
+         c = array_create( Commodity * );
+      array_push_back( &c, (Commodity *)tech->closure_temp[i] );
+   }
 
    /* Sort. */
    if ( c != NULL )
@@ -880,18 +862,230 @@ Commodity **tech_getCommodity( const tech_group_t *tech )
    return c;
 }
 
+/**
+ * @brief Gets the tech generation, which changes whenever any tech group is
+ * modified.
+ */
+unsigned int tech_generation( void )
+{
+   return tech_gen;
+}
+
 /**
  * @brief Checks to see if there is an outfit in the tech group.
  */
 int tech_checkOutfit( const tech_group_t *tech, const Outfit *o )
 {
-   Outfit **to = tech_getOutfit( tech );
-   for ( int i = 0; i < array_size( to ); i++ ) {
-      if ( to[i] == o ) {
-         array_free( to );
-         return 1;
+   if ( tech == NULL )
+      return 0;
+   return tech_closureHas( tech, TECH_TYPE_OUTFIT, o - outfit_getAll() );
+}
+
+/**
+ * @brief Checks to see if there is a ship in the tech group.
+ */
+int tech_checkShip( const tech_group_t *tech, const Ship *s )
+{
+   if ( tech == NULL )
+      return 0;
+   return tech_closureHas( tech, TECH_TYPE_SHIP, s - ship_getAll() );
+}
+
+/**
+ * @brief Checks to see if there is a commodity in the tech group.
+ */
+int tech_checkCommodity( const tech_group_t *tech, const Commodity *c )
+{
+   if ( tech == NULL )
+      return 0;
+   if ( c->istemp ) {
+      tech_closure( tech, TECH_TYPE_COMMODITY );
+      for ( int i = 0; i < array_size( tech->closure_temp ); i++ )
+         if ( tech->closure_temp[i] == c )
+            return 1;
+      return 0;
+   }
+   return tech_closureHas( tech, TECH_TYPE_COMMODITY, c - commodity_getAll() );
+}
+
+/**
+ * @brief Gets the number of items of a type that can be in a closure.
+ */
+static int tech_closureSize( tech_item_type_t type )
+{
+   switch ( type ) {
+   case TECH_TYPE_OUTFIT:
+      return array_size( outfit_getAll() );
+   case TECH_TYPE_SHIP:
+      return array_size( ship_getAll() );
+   case TECH_TYPE_COMMODITY:
+      return array_size( commodity_getAll() );
+   default:
+      return 0;
+   }
+}
+
+/**
+ * @brief Gets the closure id of an item, which is its index in its stack.
+ *
+ * Temporary commodities are not in the commodity stack and have no id.
+ */
+static int tech_closureID( const tech_item_t *item )
+{
+   switch ( item->type ) {
+   case TECH_TYPE_OUTFIT:
+      return item->u.outfit - outfit_getAll();
+   case TECH_TYPE_SHIP:
+      return item->u.ship - ship_getAll();
+   case TECH_TYPE_COMMODITY:
+      if ( item->u.comm->istemp )
+         return -1;
+      return item->u.comm - commodity_getAll();
+   default:
+      return -1;
+   }
+}
+
+/**
+ * @brief Gets the flattened closure bitset of a group for an item type.
+ *
+ * The closure is built on first use and cached in the group until any tech
+ * group is modified. Nested groups are resolved through their own cached
+ * closures, so shared subgroups are only flattened once.
+ *
+ *    @param tech Tech group to get closure of.
+ *    @param type Type of item to get closure for.
+ *    @return Bitset indexed by the closure id of the items.
+ */
+static const uint64_t *tech_closure( const tech_group_t *tech,
+                                     tech_item_type_t    type )
+{
+   /* The closure is a cache and not part of the logical state. */
+   tech_group_t *grp = (tech_group_t *)tech;
+   uint64_t     *bits;
+   int           nwords;
+
+   /* Throw away stale closures. */
+   if ( grp->closure_gen != tech_gen ) {
+      tech_closureFree( grp );
+      grp->closure_gen = tech_gen;
+   }
+   if ( grp->closure[type] != NULL )
+      return grp->closure[type];
+
+   /* Set before recursing so cyclic groups terminate. */
+   nwords = ( tech_closureSize( type ) + TECH_CLOSURE_BITS - 1 ) /
+            TECH_CLOSURE_BITS;
+   bits   = calloc( MAX( nwords, 1 ), sizeof( uint64_t ) );
+   grp->closure[type] = bits;
+
+   for ( int i = 0; i < array_size( grp->items ); i++ ) {
+      const tech_item_t  *item = &grp->items[i];
+      const tech_group_t *sub;
+      const uint64_t     *subbits;
+
+      if ( item->type == type ) {
+         int id = tech_closureID( item );
+         if ( id < 0 )
+            tech_closureAddTemp( grp, item->u.comm );
+         else
+            bits[id / TECH_CLOSURE_BITS] |= UINT64_C( 1 )
+                                            << ( id % TECH_CLOSURE_BITS );
+         continue;
       }
+
+      if ( item->type == TECH_TYPE_GROUP )
+         sub = &tech_groups[item->u.grp];
+      else if ( item->type == TECH_TYPE_GROUP_POINTER )
+         sub = item->u.grpptr;
+      else
+         continue;
+
+      subbits = tech_closure( sub, type );
+      for ( int j = 0; j < nwords; j++ )
+         bits[j] |= subbits[j];
+      if ( type == TECH_TYPE_COMMODITY )
+         for ( int j = 0; j < array_size( sub->closure_temp ); j++ )
+            tech_closureAddTemp( grp, sub->closure_temp[j] );
    }
-   array_free( to );
-   return 0;
+
+   return bits;
+}
+
+/**
+ * @brief Checks to see if an item id is in the closure of a group.
+ */
+static int tech_closureHas( const tech_group_t *tech, tech_item_type_t type,
+                            int id )
+{
+   const uint64_t *bits;
+   if ( ( id < 0 ) || ( id >= tech_closureSize( type ) ) )
+      return 0;
+   bits = tech_closure( tech, type );
+   return !!( bits[id / TECH_CLOSURE_BITS] &
+              ( UINT64_C( 1 ) << ( id % TECH_CLOSURE_BITS ) ) );
+}
+
+/**
+ * @brief Gets all the items of a type in the closure of a group.
+ *
+ *    @return Array (array.h): Items found or NULL if none.
+ */
+static void **tech_closureList( const tech_group_t *tech,
+                                tech_item_type_t    type )
+{
+   void          **items = NULL;
+   const uint64_t *bits  = tech_closure( tech, type );
+   int             n     = tech_closureSize( type );
+
+   for ( int i = 0; i < n; i += TECH_CLOSURE_BITS ) {
+      uint64_t w = bits[i / TECH_CLOSURE_BITS];
+      for ( int j = 0; w != 0; j++, w >>= 1 ) {
+         void *ptr;
+         if ( !( w & 1 ) )
+            continue;
+         switch ( type ) {
+         case TECH_TYPE_OUTFIT:
+            ptr = (void *)&outfit_getAll()[i + j];
+            break;
+         case TECH_TYPE_SHIP:
+            ptr = (void *)&ship_getAll()[i + j];
+            break;
+         default:
+            ptr = &commodity_getAll()[i + j];
+            break;
+         }
+         if ( items == NULL )
+            items = array_create( void * );
+         array_push_back( &items, ptr );
+      }
+   }
+
+   return items;
+}
+
+/**
+ * @brief Frees the cached closures of a group.
+ */
+static void tech_closureFree( tech_group_t *grp )
+{
+   for ( int i = 0; i < TECH_CLOSURE_NTYPES; i++ ) {
+      free( grp->closure[i] );
+      grp->closure[i] = NULL;
+   }
+   array_free( grp->closure_temp );
+   grp->closure_temp = NULL;
+}
+
+/**
+ * @brief Adds a temporary commodity to the closure of a group if missing.
+ */
+static void tech_closureAddTemp( tech_group_t *grp, const Commodity *c )
+{
+   for ( int i = 0; i < array_size( grp->closure_temp ); i++ )
+      if ( grp->closure_temp[i] == c )
+         return;
+   if ( grp->closure_temp == NULL )
+      grp->closure_temp = array_create( const Commodity * );
+   array_push_back( &grp->closure_temp, c );
 }
@@ -53,4 +53,8 @@ Commodity **tech_getCommodityArray( tech_group_t **tech, int num );
 /*
  * Check.
  */
-int tech_checkOutfit( const tech_group_t *tech, const Outfit *o );
+unsigned int tech_generation( void );
+int          tech_checkOutfit( const tech_group_t *tech, const Outfit *o );
+int          tech_checkShip( const tech_group_t *tech, const Ship *s );
+int          tech_checkCommodity( const tech_group_t *tech,
+                                  const Commodity    *c );
@@ -74,6 +74,8 @@ struct ThreadQueue_ {
    SDL_mutex               *mutex;
    struct vpoolThreadData_ *arg;
    int                      cnt;
+   int                      started; /**< Jobs were started by vpool_start. */
+   int                      frame;   /**< Jobs run on the frame threadpool. */
 };
 
 /**
@@ -112,6 +114,9 @@ typedef struct vpoolThreadData_ vpoolThreadData;
 
 /* The global threadpool queue */
 static ThreadQueue *global_queue = NULL;
+/* The queue of the threadpool for the jobs of a frame, which must not wait
+ * behind the long jobs of the global threadpool. */
+static ThreadQueue *frame_queue = NULL;
 
 /*
  * Prototypes.
@@ -286,8 +291,8 @@ static void tq_destroy( ThreadQueue *q )
  * @brief The worker function for the threadpool.
  *
  * It waits for a signal from the handler. If it receives THREADSIG_STOP it
- *  means the worker thread should stop. Else it dequeues a job from the
- *  global_queue and executes it.
+ *  means the worker thread should stop. Else it runs the job from the queue of
+ *  its threadpool that the handler gave it.
  *
  *    @param data A pointer to the ThreadData struct used for a lot of stuff.
  */
@@ -322,6 +327,8 @@ static int threadpool_worker( void *data )
 /**
  * @brief Handles assigning jobs to the workers and killing them if necessary.
  *
+ * Each threadpool has its own handler and workers.
+ *
  * @note Stopping the threeadpool_handler is not yet implemented.
  *
  * Process is:
@@ -335,14 +342,13 @@ static int threadpool_worker( void *data )
  *      else wait for running thread
  * 4) Go to 1)
  *
- *    @param data Not used. SDL threading requires functions to take a void
- *                pointer as argument.
+ *    @param data Queue of the threadpool to handle jobs of.
  *    @return Not really implemented yet.
  */
 static int threadpool_handler( void *data )
 {
-   (void)data;
-   int         nrunning, newthread;
+   ThreadQueue *queue = data;
+   int          nrunning, newthread;
    ThreadData *threadargs, *threadarg;
    /* Queues for idle workers and stopped workers */
    ThreadQueue     *idle, *stopped;
@@ -385,8 +391,8 @@ static int threadpool_handler( void *data )
           * Here we'll wait until thread gets work to do. If it doesn't it will
           * just stop a worker thread and wait until it gets something to do.
           */
-         if ( SDL_SemWaitTimeout( global_queue->semaphore,
-                                  THREADPOOL_TIMEOUT ) != 0 ) {
+         if ( SDL_SemWaitTimeout( queue->semaphore, THREADPOOL_TIMEOUT ) !=
+              0 ) {
             /* There weren't any new jobs so we'll start killing threads ;) */
             if ( SDL_SemTryWait( idle->semaphore ) == 0 ) {
                threadarg = tq_dequeue( idle );
@@ -407,7 +413,7 @@ static int threadpool_handler( void *data )
           * Here we wait for a new job. No threads are alive at this point and
           * the threadpool is just patiently waiting for work to arrive.
           */
-         if ( SDL_SemWait( global_queue->semaphore ) == -1 ) {
+         if ( SDL_SemWait( queue->semaphore ) == -1 ) {
             WARN( _( "SDL_SemWait failed! Error: %s" ), SDL_GetError() );
             continue;
          }
@@ -417,9 +423,9 @@ static int threadpool_handler( void *data )
 
       /*
        * Get a new job from the queue. This should be safe as we have received
-       * a permission from the global_queue->semaphore.
+       * a permission from the queue->semaphore.
        */
-      node      = tq_dequeue( global_queue );
+      node      = tq_dequeue( queue );
       newthread = 0;
 
       /*
@@ -483,10 +489,13 @@ int threadpool_init( void )
 
    /* Create the global queue queue */
    global_queue = tq_create();
+   frame_queue  = tq_create();
 
-   /* Initialize the threadpool handler. */
-   if ( SDL_CreateThread( threadpool_handler, "threadpool_handler", NULL ) ==
-        NULL ) {
+   /* Initialize the threadpool handlers. */
+   if ( ( SDL_CreateThread( threadpool_handler, "threadpool_handler",
+                            global_queue ) == NULL ) ||
+        ( SDL_CreateThread( threadpool_handler, "threadpool_frame",
+                            frame_queue ) == NULL ) ) {
       ERR( _( "Threadpool init failed: %s" ), SDL_GetError() );
       return -1;
    }
@@ -518,6 +527,22 @@ ThreadQueue *vpool_create( void )
    return tq;
 }
 
+/**
+ * @brief Creates a new vpool queue for jobs that are waited on every frame.
+ *
+ * The jobs run on a threadpool of their own, so they never wait for the jobs
+ *  of the global threadpool, such as loading or background computations, to
+ *  free a worker thread. The jobs should be short.
+ *
+ *    @return Returns a ThreadQueue to be used.
+ */
+ThreadQueue *vpool_createFrame( void )
+{
+   ThreadQueue *tq = vpool_create();
+   tq->frame       = 1;
+   return tq;
+}
+
 /**
  * @brief Enqueue a job in the vpool queue.
  *
@@ -565,17 +590,16 @@ static int vpool_worker( void *data )
    return 0;
 }
 
-/* @brief Run every job in the vpool queue and block until every job in the
- *        queue is done.
+/**
+ * @brief Starts every job in the vpool queue without waiting for them.
  *
- * @note It destroys the queue when it's done.
+ * The jobs have to be finished with vpool_wait before the queue can be used
+ *  again.
  */
-void vpool_wait( ThreadQueue *queue )
+void vpool_start( ThreadQueue *queue )
 {
    /* Number of tasks we have. */
-   int cnt;
-   queue->cnt = array_size( queue->arg );
-   cnt        = queue->cnt;
+   int cnt = array_size( queue->arg );
 
    if ( global_queue == NULL ) {
       WARN( _( "Threadpool has not been initialized yet!" ) );
@@ -583,11 +607,13 @@ void vpool_wait( ThreadQueue *queue )
    }
 
    /* Nothing to do. */
-   if ( cnt <= 0 )
+   if ( queue->started || ( cnt <= 0 ) )
       return;
 
    /* Allocate all vpoolThreadData objects */
    SDL_mutexP( queue->mutex );
+   queue->cnt     = cnt;
+   queue->started = 1;
    /* Initialize the vpoolThreadData */
    for ( int i = 0; i < cnt; i++ ) {
       vpoolThreadData *arg;
@@ -599,11 +625,29 @@ void vpool_wait( ThreadQueue *queue )
       /* Launch new job. */
       arg               = &queue->arg[i];
       arg->wrapper.data = arg;
-      tq_enqueue( global_queue, &queue->arg[i].wrapper );
+      tq_enqueue( queue->frame ? frame_queue : global_queue,
+                  &queue->arg[i].wrapper );
    }
+   SDL_mutexV( queue->mutex );
+}
 
-   /* Wait for the threads to finish */
-   SDL_CondWait( queue->cond, queue->mutex );
+/* @brief Run every job in the vpool queue and block until every job in the
+ *        queue is done.
+ *
+ * @note It destroys the queue when it's done.
+ */
+void vpool_wait( ThreadQueue *queue )
+{
+   /* Launch the jobs if vpool_start didn't already. */
+   vpool_start( queue );
+   if ( !queue->started )
+      return;
+
+   /* Wait for the threads to finish, they may be done already. */
+   SDL_mutexP( queue->mutex );
+   while ( queue->cnt > 0 )
+      SDL_CondWait( queue->cond, queue->mutex );
+   queue->started = 0;
    SDL_mutexV( queue->mutex );
 
    /* Can toss away all the queue stuff. */
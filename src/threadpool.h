@@ -23,12 +23,20 @@ int threadpool_init( void );
 /* Creates a new vpool queue. Destroy with vpool_wait. */
 ThreadQueue *vpool_create( void );
 
+/* Creates a new vpool queue running on the threadpool for the short jobs that
+ * are waited on every frame. */
+ThreadQueue *vpool_createFrame( void );
+
 /* Enqueue a job in the vpool queue. Do NOT enqueue a job that has to wait for
  * another job to be done as this could lead to a deadlock. Also do not enqueue
  * jobs from enqueued threads. */
 void vpool_enqueue( ThreadQueue *queue, int ( *function )( void * ),
                     void        *data );
 
+/* Start every job in the vpool queue without blocking. They still have to be
+ * finished with vpool_wait. */
+void vpool_start( ThreadQueue *queue );
+
 /* Run every job in the vpool queue and block until every job in the queue is
  * done. */
 void vpool_wait( ThreadQueue *queue );
@@ -221,6 +221,17 @@ typedef struct Window_ {
    int     focus;   /**< Current focused widget. */
    Widget *widgets; /**< Widget storage. */
    void   *udata;   /**< Custom data of the window. */
+
+   /* Render cache. */
+   GLuint fbo;       /**< Framebuffer the window is cached in, 0 if none. */
+   GLuint fbo_tex;   /**< Colour texture of the cache framebuffer. */
+   GLuint fbo_depth; /**< Depth texture of the cache framebuffer. */
+   int    fbo_w;     /**< Width of the cache framebuffer in real pixels. */
+   int    fbo_h;     /**< Height of the cache framebuffer in real pixels. */
+   int    fbo_x;     /**< Screen X of the cache in real pixels. */
+   int    fbo_y;     /**< Screen Y of the cache in real pixels. */
+   int    fbo_top;   /**< Whether the cache was rendered as the top window. */
+   int    dirty;     /**< Whether the cache needs to be rerendered. */
 } Window;
 
 /* Window stuff. */
@@ -233,12 +244,14 @@ int     toolkit_inputWindow( Window *wdw, SDL_Event *event, int purge );
 void    window_render( Window *w, int top );
 void    window_renderDynamic( Window *w );
 void    window_renderOverlay( Window *w );
+void    window_rerender( Window *w );
 void    window_kill( Window *wdw );
 
 /* Widget stuff. */
 Widget *window_newWidget( Window *w, const char *name );
 void    widget_cleanup( Widget *widget );
 void    widget_setStatus( Widget *widget, WidgetStatus sts );
+void    widget_rerender( const Widget *widget );
 Widget *window_getwgt( const unsigned int wid, const char *name );
 void    toolkit_setPos( const Window *wdw, Widget *wgt, int x, int y );
 void    toolkit_focusSanitize( Window *wdw );
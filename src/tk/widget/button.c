@@ -139,6 +139,7 @@ void window_disableButton( unsigned int wid, const char *name )
 
    /* Disable button. */
    wgt->dat.btn.disabled = 1;
+   widget_rerender( wgt );
 
    /* Sanitize focus. */
    wdw = window_wget( wid );
@@ -176,6 +177,7 @@ void window_enableButton( unsigned int wid, const char *name )
    /* Enable button. */
    wgt->dat.btn.disabled = 0;
    wgt_setFlag( wgt, WGT_FLAG_CANFOCUS );
+   widget_rerender( wgt );
 }
 
 /**
@@ -194,6 +196,7 @@ void window_buttonCaption( unsigned int wid, const char *name,
 
    free( wgt->dat.btn.display );
    wgt->dat.btn.display = ( display != NULL ) ? strdup( display ) : NULL;
+   widget_rerender( wgt );
 
    if ( wgt->dat.btn.key != 0 )
       btn_updateHotkey( wgt );
@@ -361,6 +364,7 @@ void window_buttonCustomRender( unsigned int wid, const char *name,
       return;
 
    wgt->dat.btn.cst_render = func;
+   widget_rerender( wgt );
 }
 
 void window_buttonCustomRenderGear( double x, double y, double w, double h,
@@ -103,6 +103,7 @@ void window_checkboxCaption( unsigned int wid, const char *name, char *display )
 
    free( wgt->dat.chk.display );
    wgt->dat.chk.display = strdup( display );
+   widget_rerender( wgt );
 }
 
 /**
@@ -132,6 +133,7 @@ int window_checkboxSet( unsigned int wid, const char *name, int state )
       return -1;
 
    wgt->dat.chk.state = state;
+   widget_rerender( wgt );
    return wgt->dat.chk.state;
 }
 
@@ -243,6 +245,7 @@ int window_enableCheckbox( unsigned int wid, const char *name )
    if ( wgt == NULL )
       return -1;
    wgt->dat.chk.disabled = 0;
+   widget_rerender( wgt );
    return 0;
 }
 
@@ -258,5 +261,6 @@ int window_disableCheckbox( unsigned int wid, const char *name )
    if ( wgt == NULL )
       return -1;
    wgt->dat.chk.disabled = 1;
+   widget_rerender( wgt );
    return 0;
 }
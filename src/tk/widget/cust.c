@@ -194,6 +194,7 @@ void window_custSetClipping( unsigned int wid, const char *name, int clip )
 
    /* Set the clipping. */
    wgt->dat.cst.clip = clip;
+   widget_rerender( wgt );
 }
 
 /**
@@ -213,6 +214,7 @@ void window_custSetOverlay( unsigned int wid, const char *name,
       return;
 
    wgt->dat.cst.renderOverlay = renderOverlay;
+   widget_rerender( wgt );
 }
 
 /**
@@ -281,6 +281,7 @@ void window_faderValue( unsigned int wid, const char *name, double value )
 
    /* Set fader value. */
    fad_setValue( wgt, value );
+   widget_rerender( wgt );
 }
 
 /**
@@ -322,6 +323,7 @@ void window_faderSetBoundedValue( unsigned int wid, const char *name,
 
    /* Set fader value. */
    fad_setValue( wgt, value );
+   widget_rerender( wgt );
 }
 
 /**
@@ -352,6 +354,7 @@ void window_faderBounds( unsigned int wid, const char *name, double min,
 
    /* Set the value. */
    fad_setValue( wgt, wgt->dat.fad.value );
+   widget_rerender( wgt );
 }
 
 /**
@@ -144,6 +144,7 @@ void window_modifyImage( unsigned int wid, char *name, const glTexture *image,
       WARN( "Not modifying image on non-image widget '%s'.", name );
       return;
    }
+   widget_rerender( wgt );
 
    /* Image must not be NULL. */
    if ( image == NULL ) {
@@ -188,6 +189,7 @@ void window_imgColour( unsigned int wid, char *name, const glColour *colour )
 
    /* Set the colour. */
    wgt->dat.img.colour = *colour;
+   widget_rerender( wgt );
 }
 
 /**
@@ -213,6 +215,7 @@ void window_modifyImageLayers( unsigned int wid, char *name, glTexture **layers,
    img_freeLayers( wgt );
    wgt->dat.img.layers  = layers;
    wgt->dat.img.nlayers = n;
+   widget_rerender( wgt );
 }
 
 /**
@@ -307,8 +307,8 @@ static void iar_render( Widget *iar, double bx, double by )
  */
 static void iar_renderOverlay( Widget *iar, double bx, double by )
 {
-   double      x, y;
-   const char *alt;
+   double          x, y;
+   ImageArrayCell *cell;
 
    /*
     * Draw Alt text if applicable.
@@ -320,10 +320,13 @@ static void iar_renderOverlay( Widget *iar, double bx, double by )
       x = bx + iar->x + iar->dat.iar.altx;
       y = by + iar->y + iar->dat.iar.alty;
 
-      /* Draw alt text. */
-      alt = iar->dat.iar.images[iar->dat.iar.alt].alt;
-      if ( alt != NULL )
-         toolkit_drawAltText( x, y, alt );
+      /* Draw alt text, generating it first if it was left for later. */
+      cell = &iar->dat.iar.images[iar->dat.iar.alt];
+      if ( ( cell->alt == NULL ) && ( iar->dat.iar.altfptr != NULL ) )
+         cell->alt =
+            iar->dat.iar.altfptr( iar->wdw, iar->name, iar->dat.iar.alt );
+      if ( cell->alt != NULL )
+         toolkit_drawAltText( x, y, cell->alt );
    }
 }
 
@@ -783,6 +786,7 @@ int toolkit_setImageArray( unsigned int wid, const char *name,
    Widget *wgt = iar_getWidget( wid, name );
    if ( wgt == NULL )
       return -1;
+   widget_rerender( wgt );
 
    /* Case NULL. */
    if ( elem == NULL ) {
@@ -835,6 +839,7 @@ int toolkit_setImageArrayZoom( unsigned int wid, const char *name, double zoom )
 
    wgt->dat.iar.zoom = zoom;
    iar_updateSpacing( wgt );
+   widget_rerender( wgt );
    return 0;
 }
 
@@ -880,6 +885,7 @@ int toolkit_setImageArrayOffset( unsigned int wid, const char *name,
 
    /* Get dimensions. */
    hmax = iar_maxPos( wgt );
+   widget_rerender( wgt );
 
    /* Ignore fancy stuff if smaller than height. */
    if ( hmax == 0. ) {
@@ -909,6 +915,7 @@ int toolkit_setImageArrayPos( unsigned int wid, const char *name, int pos )
 
    /* Set position. */
    wgt->dat.iar.selected = CLAMP( 0, wgt->dat.iar.nelements - 1, pos );
+   widget_rerender( wgt );
 
    /* Call callback - dangerous if called from within callback. */
    if ( wgt->dat.iar.fptr != NULL )
@@ -960,6 +967,7 @@ int toolkit_loadImageArrayData( unsigned int wid, const char *name,
    wgt->dat.iar.pos      = iar_data->offset;
    wgt->dat.iar.zoom     = iar_data->zoom;
    iar_updateSpacing( wgt ); /* Potentially can be necessary if zoom changes. */
+   widget_rerender( wgt );
 
    return 0;
 }
@@ -987,6 +995,7 @@ int toolkit_unsetSelection( unsigned int wid, const char *name )
 
    /* unset the selection */
    wgt->dat.iar.selected = -1;
+   widget_rerender( wgt );
 
    return 0;
 }
@@ -1007,6 +1016,27 @@ void toolkit_setImageArrayAccept( unsigned int wid, const char *name,
    wgt->dat.iar.accept = fptr;
 }
 
+/**
+ * @brief Sets the function used to generate alt text of cells without any.
+ *
+ * Alt text is only ever shown for the hovered cell, so generating it on
+ * demand avoids building it for every element when the array is created.
+ *
+ *    @param wid Window where image array is.
+ *    @param name Name of the image array.
+ *    @param fptr Function returning newly allocated alt text of an element, or
+ * NULL.
+ */
+void toolkit_setImageArrayAltFunc( unsigned int wid, const char *name,
+                                   char *( *fptr )( unsigned int, const char *,
+                                                    int ) )
+{
+   Widget *wgt = iar_getWidget( wid, name );
+   if ( wgt == NULL )
+      return;
+   wgt->dat.iar.altfptr = fptr;
+}
+
 /**
  * @brief Gets the number of visible elements in an image array.
  *
@@ -49,6 +49,8 @@ typedef struct WidgetImageArrayData_ {
    void ( *accept )(
       unsigned int,
       const char * ); /**< Accept function pointer (when hitting enter). */
+   char *( *altfptr )( unsigned int, const char *,
+                       int ); /**< Generates missing alt text on demand. */
 } WidgetImageArrayData;
 
 /**
@@ -92,5 +94,8 @@ int    toolkit_unsetSelection( unsigned int wid, const char *name );
 void   toolkit_setImageArrayAccept( unsigned int wid, const char *name,
                                     void ( *fptr )( unsigned int,
                                                   const char   *) );
+void   toolkit_setImageArrayAltFunc( unsigned int wid, const char *name,
+                                     char *( *fptr )( unsigned int,
+                                                      const char *, int ) );
 int toolkit_getImageArrayVisibleElements( unsigned int wid, const char *name );
 int toolkit_simImageArrayVisibleElements( int w, int h, int iw, int ih );
@@ -620,6 +620,7 @@ const char *window_setInput( unsigned int wid, const char *name,
       wgt->dat.inp.input[wgt->dat.inp.byte_max - 1] = '\0';
       wgt->dat.inp.pos = strlen( wgt->dat.inp.input );
    }
+   widget_rerender( wgt );
 
    /* Get the value. */
    if ( wgt->dat.inp.fptr != NULL )
@@ -519,6 +519,7 @@ const char *toolkit_setList( unsigned int wid, const char *name,
          continue;
       wgt->dat.lst.selected = i;
       lst_scroll( wgt, 0 ); /* checks boundaries and triggers callback */
+      widget_rerender( wgt );
       return value;
    }
 
@@ -537,6 +538,7 @@ const char *toolkit_setListPos( unsigned int wid, const char *name, int pos )
    /* Set by pos. */
    wgt->dat.lst.selected = CLAMP( 0, wgt->dat.lst.noptions - 1, pos );
    lst_scroll( wgt, 0 ); /* checks boundaries and triggers callback */
+   widget_rerender( wgt );
    return wgt->dat.lst.options[wgt->dat.lst.selected];
 }
 
@@ -578,6 +580,7 @@ int toolkit_setListOffset( unsigned int wid, const char *name, int off )
       return -1;
 
    wgt->dat.lst.pos = off;
+   widget_rerender( wgt );
    return 0;
 }
 
@@ -599,5 +602,6 @@ int toolkit_setListAltText( unsigned int wid, const char *name, char **alttext )
 
    /* Set. */
    wgt->dat.lst.alttext = alttext;
+   widget_rerender( wgt );
    return 0;
 }
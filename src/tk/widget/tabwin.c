@@ -576,6 +576,7 @@ int window_tabSetFont( unsigned int wid, const char *tab, const glFont *font )
    for ( int i = 0; i < wgt->dat.tab.ntabs; i++ )
       wgt->dat.tab.namelen[i] =
          gl_printWidthRaw( wgt->dat.tab.font, wgt->dat.tab.tabnames[i] );
+   widget_rerender( wgt );
 
    return 0;
 }
@@ -635,5 +636,6 @@ int window_tabWinSetTabName( unsigned int wid, const char *tab, int id,
    const Widget *wgt = tab_getWgt( wid, tab );
    free( wgt->dat.tab.tabnames[id] );
    wgt->dat.tab.tabnames[id] = strdup( name );
+   widget_rerender( wgt );
    return 0;
 }
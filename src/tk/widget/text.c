@@ -121,6 +121,7 @@ void window_modifyText( const unsigned int wid, const char *name,
    if ( wgt->dat.txt.text )
       free( wgt->dat.txt.text );
    wgt->dat.txt.text = ( newstring ) ? strdup( newstring ) : NULL;
+   widget_rerender( wgt );
 }
 
 /**
@@ -25,8 +25,6 @@
 
 static unsigned int genwid = 0; /**< Generates unique window ids, > 0 */
 
-static int toolkit_needsRender =
-   1; /**< Whether or not toolkit needs a render. */
 static int toolkit_delayCounter =
    0; /**< Horrible hack around secondary loop. */
 
@@ -34,6 +32,8 @@ static int toolkit_delayCounter =
  * window stuff
  */
 #define MIN_WINDOWS 4 /**< Minimum windows to prealloc. */
+#define WINDOW_CACHE_MARGIN                                                    \
+   2 /**< Margin around a window cache, the border is drawn outside. */
 static Window *windows =
    NULL; /**< Window linked list, not to be confused with MS windows. */
 
@@ -79,6 +79,10 @@ static int  toolkit_isFocusable( const Widget *wgt );
 static void toolkit_expose( Window *wdw, int expose );
 /* render */
 static void window_renderBorder( const Window *w );
+static void window_renderCache( Window *w, int top );
+static int  window_isDirty( const Window *w );
+static void window_clearDirty( Window *w );
+static void window_freeCache( Window *w );
 /* Death. */
 static void widget_kill( Widget *wgt );
 static void window_cleanup( Window *wdw );
@@ -164,6 +168,8 @@ void toolkit_setWindowPos( Window *wdw, int x, int y )
       wdw->y = gl_screen.nh - wdw->h + (double)y;
    else
       wdw->y = (double)y;
+
+   window_rerender( wdw );
 }
 
 /**
@@ -211,6 +217,7 @@ void window_resize( unsigned int wid, int w, int h )
            window_isFlag( wdw, WINDOW_CENTERY ) )
          toolkit_setWindowPos( wdw, -1, -1 );
    }
+   window_rerender( wdw );
 }
 
 /**
@@ -285,7 +292,7 @@ Widget *window_newWidget( Window *w, const char *name )
    else
       wlast->next = wgt;
 
-   toolkit_rerender();
+   window_rerender( w );
    return wgt;
 }
 
@@ -723,6 +730,7 @@ unsigned int window_createFlags( const char *name, const char *displayname,
    wdw->yrel    = -1.;
    wdw->flags   = flags;
    wdw->exposed = !window_isFlag( wdw, WINDOW_NOFOCUS );
+   wdw->dirty   = 1;
 
    /* Dimensions. */
    wdw->w = ( w == -1 ) ? gl_screen.nw : (double)w;
@@ -1006,7 +1014,7 @@ void widget_cleanup( Widget *widget )
 void widget_setStatus( Widget *wgt, WidgetStatus sts )
 {
    if ( wgt->status != sts )
-      toolkit_rerender();
+      widget_rerender( wgt );
    wgt->status = sts;
 }
 
@@ -1128,6 +1136,7 @@ static void window_remove( Window *wdw )
       wgt             = wgtkill->next;
       widget_kill( wgtkill );
    }
+   window_freeCache( wdw );
    nfree( wdw );
 
    /* Clear key repeat, since toolkit could miss the keyup event. */
@@ -1190,6 +1199,7 @@ void window_destroyWidget( unsigned int wid, const char *wgtname )
    /* There's dead stuff now. */
    wgt_rmFlag( wgt, WGT_FLAG_FOCUSED );
    wgt_setFlag( wgt, WGT_FLAG_KILL );
+   window_rerender( wdw );
 }
 
 /**
@@ -1599,6 +1609,141 @@ void toolkit_drawScrollbar( int x, int y, int w, int h, double pos )
    toolkit_drawOutline( x + 1, sy, w - 2, 30., 0., toolkit_colDark, NULL );
 }
 
+/**
+ * @brief Frees the render cache of a window.
+ *
+ *    @param w Window to free render cache of.
+ */
+static void window_freeCache( Window *w )
+{
+   if ( w->fbo == 0 )
+      return;
+   glDeleteFramebuffers( 1, &w->fbo );
+   glDeleteTextures( 1, &w->fbo_tex );
+   glDeleteTextures( 1, &w->fbo_depth );
+   w->fbo       = 0;
+   w->fbo_tex   = 0;
+   w->fbo_depth = 0;
+   gl_checkErr();
+}
+
+/**
+ * @brief Checks to see if a window or any of its tab children changed.
+ *
+ * Tab children are rendered as part of their parent, so they share its cache.
+ *
+ *    @param w Window to check.
+ *    @return 1 if the window needs to be rerendered.
+ */
+static int window_isDirty( const Window *w )
+{
+   if ( w->dirty )
+      return 1;
+   for ( const Widget *wgt = w->widgets; wgt != NULL; wgt = wgt->next ) {
+      if ( wgt->type != WIDGET_TABBEDWINDOW )
+         continue;
+      for ( int i = 0; i < wgt->dat.tab.ntabs; i++ ) {
+         const Window *wtab = window_wgetW( wgt->dat.tab.windows[i] );
+         if ( ( wtab != NULL ) && window_isDirty( wtab ) )
+            return 1;
+      }
+   }
+   return 0;
+}
+
+/**
+ * @brief Marks a window and its tab children as rerendered.
+ *
+ *    @param w Window to clear.
+ */
+static void window_clearDirty( Window *w )
+{
+   w->dirty = 0;
+   for ( Widget *wgt = w->widgets; wgt != NULL; wgt = wgt->next ) {
+      if ( wgt->type != WIDGET_TABBEDWINDOW )
+         continue;
+      for ( int i = 0; i < wgt->dat.tab.ntabs; i++ ) {
+         Window *wtab = window_wgetW( wgt->dat.tab.windows[i] );
+         if ( wtab != NULL )
+            window_clearDirty( wtab );
+      }
+   }
+}
+
+/**
+ * @brief Updates the render cache of a window if it is stale.
+ *
+ * The cache only covers the window and its border, aligned to real pixels.
+ * Widgets keep rendering in screen coordinates through a projection offset to
+ * the cache, and the screen offset is shifted too so gl_clipRect() still
+ * scissors the right area.
+ *
+ *    @param w Window to update render cache of.
+ *    @param top Whether or not the window is at the top.
+ */
+static void window_renderCache( Window *w, int top )
+{
+   GLuint current_fbo;
+   mat4   view_matrix;
+   double sx, sy;
+   int    rx, ry, rw, rh;
+
+   /* Bounds of the window and its border in real pixels. */
+   rx = floor( ( w->x - WINDOW_CACHE_MARGIN ) / gl_screen.mxscale );
+   ry = floor( ( w->y - WINDOW_CACHE_MARGIN ) / gl_screen.myscale );
+   rw = ceil( ( w->x + w->w + WINDOW_CACHE_MARGIN ) / gl_screen.mxscale ) - rx;
+   rh = ceil( ( w->y + w->h + WINDOW_CACHE_MARGIN ) / gl_screen.myscale ) - ry;
+
+   /* (Re)create the framebuffer if the window size changed. */
+   if ( ( w->fbo == 0 ) || ( w->fbo_w != rw ) || ( w->fbo_h != rh ) ) {
+      window_freeCache( w );
+      gl_fboCreate( &w->fbo, &w->fbo_tex, rw, rh );
+      gl_fboAddDepth( w->fbo, &w->fbo_depth, rw, rh );
+      w->fbo_w = rw;
+      w->fbo_h = rh;
+      w->dirty = 1;
+   }
+   if ( ( w->fbo_x != rx ) || ( w->fbo_y != ry ) ) {
+      w->fbo_x = rx;
+      w->fbo_y = ry;
+      w->dirty = 1;
+   }
+
+   /* Dynamic widgets are only skipped when on top, so it matters too. */
+   if ( !window_isDirty( w ) && ( w->fbo_top == top ) )
+      return;
+   window_clearDirty( w );
+   w->fbo_top = top;
+
+   current_fbo           = gl_screen.current_fbo;
+   gl_screen.current_fbo = w->fbo;
+   glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+   glViewport( 0, 0, rw, rh );
+   glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+   glBlendFuncSeparate( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                        GL_ONE_MINUS_SRC_ALPHA );
+
+   /* Offset the projection to the cache. */
+   view_matrix    = gl_view_matrix;
+   sx             = gl_screen.x;
+   sy             = gl_screen.y;
+   gl_screen.x    = sx - rx * gl_screen.mxscale;
+   gl_screen.y    = sy - ry * gl_screen.myscale;
+   gl_view_matrix = mat4_ortho( 0., rw * gl_screen.mxscale, 0.,
+                                rh * gl_screen.myscale, -1., 1. );
+   mat4_translate_xy( &gl_view_matrix, gl_screen.x, gl_screen.y );
+
+   window_render( w, top );
+
+   gl_view_matrix = view_matrix;
+   gl_screen.x    = sx;
+   gl_screen.y    = sy;
+   glViewport( 0, 0, gl_screen.rw, gl_screen.rh );
+   glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+   gl_screen.current_fbo = current_fbo;
+   glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+}
+
 /**
  * @brief Renders the windows.
  */
@@ -1609,37 +1754,26 @@ void toolkit_render( double dt )
 
    NTracingZone( _ctx, 1 );
 
-   if ( toolkit_needsRender ) {
-      GLuint current_fbo    = gl_screen.current_fbo;
-      gl_screen.current_fbo = gl_screen.fbo[3];
-      toolkit_needsRender   = 0;
-
-      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
-      glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
-      glBlendFuncSeparate( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
-                           GL_ONE_MINUS_SRC_ALPHA );
-
-      /* Render base. */
-      for ( Window *w = windows; w != NULL; w = w->next ) {
-         if ( window_isFlag( w, WINDOW_NORENDER | WINDOW_KILL ) )
-            continue;
-         if ( ( w == top ) && window_isFlag( w, WINDOW_DYNAMIC ) )
-            continue;
-
-         /* The actual rendering. */
-         window_render( w, w == top );
-      }
+   for ( Window *w = windows; w != NULL; w = w->next ) {
+      mat4 projection, tex_mat;
+      if ( window_isFlag( w, WINDOW_NORENDER | WINDOW_KILL ) )
+         continue;
+      if ( ( w == top ) && window_isFlag( w, WINDOW_DYNAMIC ) )
+         continue;
 
-      glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
-      gl_screen.current_fbo = current_fbo;
-      glBindFramebuffer( GL_FRAMEBUFFER, gl_screen.current_fbo );
+      /* Only windows that changed get rendered again. */
+      window_renderCache( w, w == top );
+
+      /* We can just render the whole cache onto the screen. */
+      projection = mat4_ortho( 0., 1., 0., 1., 1., -1. );
+      mat4_translate_scale_xy(
+         &projection, (double)w->fbo_x / gl_screen.rw,
+         (double)w->fbo_y / gl_screen.rh, (double)w->fbo_w / gl_screen.rw,
+         (double)w->fbo_h / gl_screen.rh );
+      tex_mat = mat4_identity();
+      gl_renderTextureRawH( w->fbo_tex, &projection, &tex_mat, &cWhite );
    }
 
-   /* We can just rendered stored FBO onto the screen. */
-   const mat4 ortho = mat4_ortho( 0., 1., 0., 1., 1., -1. );
-   const mat4 I     = mat4_identity();
-   gl_renderTextureRawH( gl_screen.fbo_tex[3], &ortho, &I, &cWhite );
-
    /* We render only the active window dynamically, otherwise we wouldn't be
     * able to respect the order. However, since the dynamic stuff is also
     * rendered to the framebuffer below, it shouldn't be too bad. */
@@ -1657,7 +1791,30 @@ void toolkit_render( double dt )
  */
 void toolkit_rerender( void )
 {
-   toolkit_needsRender = 1;
+   for ( Window *w = windows; w != NULL; w = w->next )
+      w->dirty = 1;
+}
+
+/**
+ * @brief Marks a single window as needing to be rerendered.
+ *
+ *    @param w Window to rerender.
+ */
+void window_rerender( Window *w )
+{
+   w->dirty = 1;
+}
+
+/**
+ * @brief Marks the window a widget belongs to as needing to be rerendered.
+ *
+ *    @param wgt Widget that changed.
+ */
+void widget_rerender( const Widget *wgt )
+{
+   Window *w = window_wgetW( wgt->wdw );
+   if ( w != NULL )
+      w->dirty = 1;
 }
 
 /**
@@ -1692,7 +1849,7 @@ int toolkit_inputWindow( Window *wdw, SDL_Event *event, int purge )
          continue;
       ret = wgt->rawevent( wgt, event );
       if ( ret != 0 ) {
-         toolkit_rerender();
+         window_rerender( wdw );
          return ret;
       }
    }
@@ -1701,7 +1858,7 @@ int toolkit_inputWindow( Window *wdw, SDL_Event *event, int purge )
    if ( wdw->eventevent != NULL ) {
       ret = wdw->eventevent( wdw->id, event );
       if ( ret != 0 ) {
-         toolkit_rerender();
+         window_rerender( wdw );
          return ret;
       }
    }
@@ -1731,7 +1888,7 @@ int toolkit_inputWindow( Window *wdw, SDL_Event *event, int purge )
       }
    }
    if ( ret )
-      toolkit_rerender();
+      window_rerender( wdw );
 
    /* Clean up the dead if needed. */
    if ( purge &&
@@ -1896,7 +2053,7 @@ static int toolkit_mouseEventWidget( Window *w, Widget *wgt, SDL_Event *event,
       if ( wgt->mwheelevent != NULL )
          ret |= ( *wgt->mwheelevent )( wgt, event->wheel );
       if ( ret )
-         toolkit_rerender();
+         window_rerender( w );
 
       break;
 
@@ -1921,7 +2078,7 @@ static int toolkit_mouseEventWidget( Window *w, Widget *wgt, SDL_Event *event,
          ret |= ( *wgt->mclickevent )( wgt, button, x, y );
       if ( ret ) {
          input_clicked( (void *)wgt );
-         toolkit_rerender();
+         window_rerender( w );
       }
       break;
 
@@ -1943,7 +2100,7 @@ static int toolkit_mouseEventWidget( Window *w, Widget *wgt, SDL_Event *event,
             else {
                ( *wgt->dat.btn.fptr )( w->id, wgt->name );
                ret = 1;
-               toolkit_rerender();
+               window_rerender( w );
             }
          }
       }
@@ -2335,7 +2492,7 @@ void toolkit_nextFocus( Window *wdw )
 
    /* Focus nothing. */
    wdw->focus = -1;
-   toolkit_rerender();
+   window_rerender( wdw );
    return;
 }
 
@@ -2388,7 +2545,7 @@ void toolkit_focusWidget( Window *wdw, Widget *wgt )
    if ( wgt->focusGain != NULL )
       wgt->focusGain( wgt );
 
-   toolkit_rerender();
+   window_rerender( wdw );
 }
 
 /**
@@ -2405,7 +2562,7 @@ void toolkit_defocusWidget( Window *wdw, Widget *wgt )
    if ( wgt->focusLose != NULL )
       wgt->focusLose( wgt );
 
-   toolkit_rerender();
+   window_rerender( wdw );
 }
 
 /**
@@ -22,7 +22,9 @@
 #include "array.h"
 #include "camera.h"
 #include "collision.h"
+#include "conf.h"
 #include "damagetype.h"
+#include "explosion.h"
 #include "gui.h"
 #include "input.h"
 #include "intlist.h"
@@ -68,6 +70,9 @@ typedef struct WeaponHit_ {
       *pos; /* Location of the hit, can be 2d array in the case of beams. */
 } WeaponHit;
 
+#define WEAPON_QT_LOOSE                                                        \
+   0.25 /**< Seconds of flight covered by the loose quadtree bounds. */
+
 /* Weapon layers. */
 static Weapon *weapon_stack =
    NULL; /**< All the weapon munitions are piled up here. */
@@ -82,7 +87,6 @@ static unsigned int weapon_idgen = 0; /**< Weapon identifier generator. */
 static int      qt_init = 0; /**< Whether or not the quadtree was created. */
 static Quadtree weapon_quadtree; /**< Quadtree for weapons. */
 static IntList  weapon_qtquery;  /**< For querying collisions. */
-static IntList  weapon_qtexp; /**< For querying collisions from explosions. */
 
 /*
  * Prototypes
@@ -120,7 +124,6 @@ static void weapon_destroy( Weapon *w );
 static void weapon_free( Weapon *w );
 /* Hitting. */
 static int  weapon_checkCanHit( const Weapon *w, const Pilot *p );
-static void weapon_damage( Weapon *w, const Damage *dmg );
 static void weapon_hit( Weapon *w, const WeaponHit *hit );
 static void weapon_hitBeam( Weapon *w, const WeaponHit *hit, double dt );
 static void weapon_miss( Weapon *w );
@@ -128,6 +131,10 @@ static int  weapon_testCollision( const WeaponCollision *wc,
                                   const glTexture *ctex, int csx, int csy,
                                   const Solid *csol, const CollPolyView *cpol,
                                   double cradius, vec2 crash[2] );
+static int  weapon_sweepCollision( const WeaponCollision *wc,
+                                   const glTexture *ctex, int csx, int csy,
+                                   const Solid *csol, const CollPolyView *cpol,
+                                   double cradius, vec2 crash[2] );
 /* think */
 static void think_seeker( Weapon *w, double dt );
 static void think_beam( Weapon *w, double dt );
@@ -145,7 +152,6 @@ void weapon_init( void )
 {
    weapon_stack = array_create( Weapon );
    il_create( &weapon_qtquery, 1 );
-   il_create( &weapon_qtexp, 1 );
 }
 
 /**
@@ -613,6 +619,23 @@ static void think_beam( Weapon *w, double dt )
    }
 }
 
+/**
+ * @brief Plots the statistics of the weapon quadtree for the profiler.
+ */
+static void weapons_qtPlot( void )
+{
+#if HAVE_TRACY
+   QtStats st;
+   qt_stats( &weapon_quadtree, &st );
+   NTracingPlotI( "weapon qt nodes", st.nodes );
+   NTracingPlotI( "weapon qt depth", st.max_depth );
+   NTracingPlotI( "weapon qt reinserts", st.reinserts );
+   NTracingPlotF( "weapon qt candidates",
+                  ( st.queries > 0 ) ? (double)st.candidates / st.queries
+                                     : 0. );
+#endif /* HAVE_TRACY */
+}
+
 /**
  * @brief Purges unnecessary weapons.
  */
@@ -620,9 +643,6 @@ void weapons_updatePurge( void )
 {
    NTracingZone( _ctx, 1 );
 
-   /* Clear quadtree. */
-   qt_clear( &weapon_quadtree );
-
    /* Actually purge and remove weapons. */
    for ( int i = array_size( weapon_stack ) - 1; i >= 0; i-- ) {
       Weapon *w = &weapon_stack[i];
@@ -632,10 +652,12 @@ void weapons_updatePurge( void )
       array_erase( &weapon_stack, &weapon_stack[i], &weapon_stack[i + 1] );
    }
 
-   /* Do a second pass to add the quadtree elements. */
+   /* Do a second pass to update the quadtree elements. Weapons keep their
+    * elements, which only move within the tree when they leave their loose
+    * bounds, and the ones left behind are swept afterwards. */
    for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
-      const Weapon    *w = &weapon_stack[i];
-      int              x, y, px, py, w2, h2;
+      Weapon          *w = &weapon_stack[i];
+      int              x, y, px, py, w2, h2, m;
       const OutfitGFX *gfx;
       double           range;
 
@@ -655,9 +677,13 @@ void weapons_updatePurge( void )
       py = round( w->solid.pre.y );
       w2 = ceil( range * 0.5 );
       h2 = ceil( range * 0.5 );
-      qt_insert( &weapon_quadtree, i, MIN( x, px ) - w2, MIN( y, py ) - h2,
-                 MAX( x, px ) + w2, MAX( y, py ) + h2 );
+      m  = w2 + ceil( VMOD( w->solid.vel ) * WEAPON_QT_LOOSE );
+      w->qt_elem = qt_update( &weapon_quadtree, w->qt_elem, (int)w->id, i,
+                              MIN( x, px ) - w2, MIN( y, py ) - h2,
+                              MAX( x, px ) + w2, MAX( y, py ) + h2, m );
    }
+   qt_sweep( &weapon_quadtree );
+   weapons_qtPlot();
 
    NTracingZoneEnd( _ctx );
 }
@@ -770,7 +796,7 @@ void weapons_render( const WeaponLayer layer, double dt )
    NTracingZoneEnd( _ctx );
 }
 
-static void weapon_renderBeam( Weapon *w, double dt )
+static void weapon_renderBeam( Weapon *w, const vec2 *pos, double dt )
 {
    double x, y, z;
    mat4   projection;
@@ -785,7 +811,7 @@ static void weapon_renderBeam( Weapon *w, double dt )
    z = cam_getZoom();
 
    /* Position. */
-   gl_gameToScreenCoords( &x, &y, w->solid.pos.x, w->solid.pos.y );
+   gl_gameToScreenCoords( &x, &y, pos->x, pos->y );
 
    projection = gl_view_matrix;
    mat4_translate_xy( &projection, x, y );
@@ -833,12 +859,20 @@ static void weapon_render( Weapon *w, double dt )
 {
    const OutfitGFX *gfx;
    double           x, y;
+   vec2             pos;
    glColour         col, c = { .r = 1., .g = 1., .b = 1. };
 
    /* Don't render destroyed weapons. */
    if ( weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) )
       return;
 
+   /* Beams are attached to their parent, so they move with it. */
+   if ( outfit_isBeam( w->outfit ) ) {
+      const Pilot *p = pilot_get( w->parent );
+      solid_renderPos( &pos, &w->solid, ( p != NULL ) ? &p->solid.vel : NULL );
+   } else
+      solid_renderPos( &pos, &w->solid, &w->solid.vel );
+
    switch ( w->outfit->type ) {
    /* Weapons that use sprites. */
    case OUTFIT_TYPE_LAUNCHER:
@@ -846,7 +880,7 @@ static void weapon_render( Weapon *w, double dt )
       if ( w->status == WEAPON_STATUS_LOCKING ) {
          double st, r, z;
          z = cam_getZoom();
-         gl_gameToScreenCoords( &x, &y, w->solid.pos.x, w->solid.pos.y );
+         gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
          r = w->outfit->u.lau.gfx.size * z * 0.75; /* Assume square. */
 
          st = 1. - w->timer2 / w->paramf;
@@ -885,11 +919,11 @@ static void weapon_render( Weapon *w, double dt )
 
             if ( gfx->tex_end != NULL )
                gl_renderSpriteInterpolate(
-                  tex, gfx->tex_end, w->timer / w->life, w->solid.pos.x,
-                  w->solid.pos.y, w->sprite % (int)tex->sx,
+                  tex, gfx->tex_end, w->timer / w->life, pos.x,
+                  pos.y, w->sprite % (int)tex->sx,
                   w->sprite / (int)tex->sx, &c );
             else
-               gl_renderSprite( tex, w->solid.pos.x, w->solid.pos.y,
+               gl_renderSprite( tex, pos.x, pos.y,
                                 w->sprite % (int)tex->sx,
                                 w->sprite / (int)tex->sx, &c );
          }
@@ -901,17 +935,17 @@ static void weapon_render( Weapon *w, double dt )
             const glTexture *tex = gfx->tex;
             if ( gfx->tex_end != NULL )
                gl_renderSpriteInterpolate( tex, gfx->tex_end,
-                                           w->timer / w->life, w->solid.pos.x,
-                                           w->solid.pos.y, w->sx, w->sy, &c );
+                                           w->timer / w->life, pos.x,
+                                           pos.y, w->sx, w->sy, &c );
             else
-               gl_renderSprite( tex, w->solid.pos.x, w->solid.pos.y, w->sx,
+               gl_renderSprite( tex, pos.x, pos.y, w->sx,
                                 w->sy, &c );
          } else {
             double r, z;
 
             /* Translate coords. */
             z = cam_getZoom();
-            gl_gameToScreenCoords( &x, &y, w->solid.pos.x, w->solid.pos.y );
+            gl_gameToScreenCoords( &x, &y, pos.x, pos.y );
 
             /* Scaled sprite dimensions. */
             r = gfx->size * z;
@@ -949,7 +983,7 @@ static void weapon_render( Weapon *w, double dt )
    /* Beam weapons. */
    case OUTFIT_TYPE_BEAM:
    case OUTFIT_TYPE_TURRET_BEAM:
-      weapon_renderBeam( w, dt );
+      weapon_renderBeam( w, &pos, dt );
       break;
 
    default:
@@ -1205,10 +1239,81 @@ static int weapon_testCollision( const WeaponCollision *wc,
          ret = CollideCircleCircle( wpos, wc->range, cpos, cradius, crash );
    }
 
+   /* Fast projectiles may have gone through the target between updates. */
+   if ( !ret && conf.collision_ccd && !wc->explosion && !wc->beam )
+      ret = weapon_sweepCollision( wc, ctex, csx, csy, csol, cpol, cradius,
+                                   crash );
+
    NTracingZoneEnd( _ctx );
    return ret;
 }
 
+/**
+ * @brief Tests the path a projectile travelled in the last update against a
+ * target.
+ *
+ * The path is taken relative to the target, so it goes from where the
+ * projectile started with respect to the target to where it is now, and is
+ * tested against the target at its current position. This catches
+ * projectiles that went through the target without overlapping it at either
+ * end of the update.
+ *
+ *    @param wc Weapon collision data.
+ *    @param ctex Collision target texture.
+ *    @param csx Collision target texture x sprite.
+ *    @param csy Collision target texture y sprite.
+ *    @param csol Collision target solid.
+ *    @param cpol Collision target collision polygon (NULL if none).
+ *    @param cradius Collision radius fallback (if no texture and polygon are
+ * provided).
+ *    @param[out] crash Crash location, with the earliest hit along the path
+ * first.
+ *    @return Number of collisions detected (0 to 2)
+ */
+static int weapon_sweepCollision( const WeaponCollision *wc,
+                                  const glTexture *ctex, int csx, int csy,
+                                  const Solid *csol, const CollPolyView *cpol,
+                                  double cradius, vec2 crash[2] )
+{
+   const Weapon *w = wc->w;
+   vec2          start;
+   double        dx, dy, len;
+   int           ret;
+
+   vec2_cset( &start, w->solid.pre.x - csol->pre.x + csol->pos.x,
+              w->solid.pre.y - csol->pre.y + csol->pos.y );
+   dx  = w->solid.pos.x - start.x;
+   dy  = w->solid.pos.y - start.y;
+   len = hypot( dx, dy );
+
+   /* Didn't move far enough to skip over anything. */
+   if ( len < wc->range )
+      return 0;
+
+   if ( cpol != NULL )
+      ret = CollideLinePolygon( &start, atan2( dy, dx ), len, cpol, &csol->pos,
+                                crash );
+   else if ( ctex != NULL )
+      ret = CollideLineSprite( &start, atan2( dy, dx ), len, ctex, csx, csy,
+                               &csol->pos, crash );
+   else {
+      ret = CollideLineCircle( &start, &w->solid.pos, &csol->pos,
+                               cradius + wc->range, crash );
+      if ( ret == 1 )
+         crash[1] = crash[0];
+   }
+   if ( !ret )
+      return 0;
+
+   /* Hits aren't sorted, keep the one the projectile reached first. */
+   if ( vec2_dist2( &start, &crash[1] ) < vec2_dist2( &start, &crash[0] ) ) {
+      vec2 tmp = crash[0];
+      crash[0] = crash[1];
+      crash[1] = tmp;
+   }
+   return ret;
+}
+
 /**
  * @brief Updates an individual weapon.
  *
@@ -1249,8 +1354,8 @@ static void weapon_updateCollide( Weapon *w, double dt )
       /* Determine quadtree location. */
       x  = round( w->solid.pos.x );
       y  = round( w->solid.pos.y );
-      px = x + round( w->solid.pre.x );
-      py = y + round( w->solid.pre.y );
+      px = round( w->solid.pre.x );
+      py = round( w->solid.pre.y );
       w2 = ceil( wc.range * 0.5 );
       h2 = ceil( wc.range * 0.5 );
       x1 = MIN( x, px ) - w2;
@@ -1377,8 +1482,6 @@ static void weapon_updateCollide( Weapon *w, double dt )
                poly_rotate( &rpoly, &a->polygon->views[0], (float)a->ang );
                coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, &rpoly,
                                             0., crash );
-               free( rpoly.x );
-               free( rpoly.y );
             } else
                coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, NULL,
                                             0., crash );
@@ -1498,7 +1601,8 @@ static void weapon_sample_trail( Weapon *w )
       mode = MODE_IDLE;
 
    spfx_trail_sample( w->trail, w->solid.pos.x + dx,
-                      w->solid.pos.y + dy * M_SQRT1_2, 0., mode, 0 );
+                      w->solid.pos.y + dy * M_SQRT1_2, 0., &w->solid.vel, mode,
+                      0 );
 }
 
 /**
@@ -1545,26 +1649,52 @@ void weapon_hitAI( Pilot *p, const Pilot *shooter, double dmg )
       ai_attacked( p, shooter->id, dmg );
 }
 
+/**
+ * @brief Sets up the collision of the explosion of a weapon.
+ */
+static void weapon_explodeCollision( WeaponCollision *wc, const Weapon *w,
+                                     double radius )
+{
+   /* Circle explosion. */
+   wc->w         = w;
+   wc->gfx       = NULL;
+   wc->beam      = 0;
+   wc->range     = radius;
+   wc->polygon   = NULL;
+   wc->explosion = 1;
+}
+
 /**
  * @brief A weapon hit something and decided to explode.
  *
+ * The damage to pilots and missiles gets done with the rest of the
+ * explosions in expl_update(), only asteroids are hit right away.
+ *
  *    @param w Weapon exploding.
  *    @param dmg Damage it does.
  *    @param radius Radius of the explosion.
  */
 static void weapon_hitExplode( Weapon *w, const Damage *dmg, double radius )
 {
-   int             x, y, r, x1, y1, x2, y2;
+   int             x, y, r, x1, y1, x2, y2, mining_rarity;
+   int             mode   = 0;
    Pilot          *parent = pilot_get( w->parent );
+   double          mining_bonus;
    WeaponCollision wc;
 
-   /* Circle explosion. */
-   wc.w         = w;
-   wc.gfx       = NULL;
-   wc.beam      = 0;
-   wc.range     = radius;
-   wc.polygon   = NULL;
-   wc.explosion = 1;
+   /* Pilots and, for point defense like flak, missiles. */
+   if ( !outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_MISS_SHIPS ) )
+      mode |= EXPL_MODE_SHIP;
+   if ( outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_POINTDEFENSE ) )
+      mode |= EXPL_MODE_MISSILE;
+   if ( mode != 0 )
+      expl_explodeWeapon( w, radius, dmg, mode );
+
+   /* Test asteroids. */
+   if ( outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_MISS_ASTEROIDS ) )
+      return;
+
+   weapon_explodeCollision( &wc, w, radius );
 
    /* Set up coordinates. */
    x  = round( w->solid.pos.x );
@@ -1575,123 +1705,189 @@ static void weapon_hitExplode( Weapon *w, const Damage *dmg, double radius )
    x2 = x + r;
    y2 = y + r;
 
-   /* Test pilots. */
-   if ( !outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_MISS_SHIPS ) ) {
-      Pilot *const *pilot_stack = pilot_getAll();
-      pilot_collideQueryIL( &weapon_qtexp, x1, y1, x2, y2 );
-      for ( int i = 0; i < il_size( &weapon_qtexp ); i++ ) {
-         vec2   crash[2];
-         double damage;
-         Pilot *p = pilot_stack[il_get( &weapon_qtexp, i, 0 )];
+   mining_bonus  = ( parent != NULL ) ? parent->stats.mining_bonus : 1.;
+   mining_rarity = outfit_miningRarity( w->outfit );
+   for ( int i = 0; i < array_size( cur_system->asteroids ); i++ ) {
+      AsteroidAnchor *ast = &cur_system->asteroids[i];
 
-         /* Ignore pilots being deleted. */
-         if ( pilot_isFlag( p, PILOT_DELETE ) )
-            continue;
+      /* Early in-range check with the asteroid field. */
+      if ( vec2_dist2( &w->solid.pos, &ast->pos ) >
+           pow2( ast->radius + ast->margin + wc.range ) )
+         continue;
 
-         if ( !outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_FRIENDLYFIRE ) ) {
-            /* Ignore if parent is self. */
-            if ( w->parent == p->id )
-               continue; /* pilot is self */
+      /* Quadtree collisions. */
+      asteroid_collideQueryIL( ast, &weapon_qtquery, x1, y1, x2, y2 );
+      for ( int j = 0; j < il_size( &weapon_qtquery ); j++ ) {
+         Asteroid *a = &ast->asteroids[il_get( &weapon_qtquery, j, 0 )];
+         vec2      crash[2];
+         int       coll;
+         if ( a->state != ASTEROID_FG )
+            continue;
 
-            /* Check to see if it can hit. */
-            if ( !weapon_checkCanHit( w, p ) )
-               continue;
-         }
+         if ( a->polygon != NULL ) {
+            CollPolyView rpoly;
+            poly_rotate( &rpoly, &a->polygon->views[0], (float)a->ang );
+            coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, &rpoly,
+                                         0., crash );
+         } else
+            coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, NULL, 0.,
+                                         crash );
 
-         /* Test if hit. */
-         if ( !weapon_testCollision(
-                 &wc, p->ship->gfx_space, p->tsx, p->tsy, &p->solid,
-                 poly_view( &p->ship->polygon, p->solid.dir ), 0., crash ) )
+         /* Missed. */
+         if ( !coll )
             continue;
 
-         /* Have pilot take damage and get real damage done. */
-         damage =
-            pilot_hit( p, &w->solid, parent, dmg, w->outfit, w->lua_mem, 1 );
-         /* Inform AI that it's been hit. */
-         weapon_hitAI( p, parent, damage );
+         asteroid_hit( a, dmg, mining_rarity, mining_bonus );
       }
    }
+}
 
-   /* Test asteroids. */
-   if ( !outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_MISS_ASTEROIDS ) ) {
-      double mining_bonus =
-         ( parent != NULL ) ? parent->stats.mining_bonus : 1.;
-      int mining_rarity = outfit_miningRarity( w->outfit );
-      for ( int i = 0; i < array_size( cur_system->asteroids ); i++ ) {
-         AsteroidAnchor *ast = &cur_system->asteroids[i];
+/**
+ * @brief Keeps what the explosion of a weapon needs once it is destroyed.
+ *
+ *    @param[out] we Explosion to set up.
+ *    @param w Weapon exploding.
+ */
+void weapon_explosionInit( WeaponExplosion *we, const Weapon *w )
+{
+   we->solid   = w->solid;
+   we->faction = w->faction;
+   we->parent  = w->parent;
+   we->target  = w->target;
+   we->outfit  = w->outfit;
+   /* The weapon frees its reference when it gets destroyed. */
+   we->lua_mem = LUA_NOREF;
+   if ( w->lua_mem != LUA_NOREF ) {
+      lua_rawgeti( naevL, LUA_REGISTRYINDEX, w->lua_mem ); /* mem */
+      we->lua_mem = luaL_ref( naevL, LUA_REGISTRYINDEX );
+   }
+}
 
-         /* Early in-range check with the asteroid field. */
-         if ( vec2_dist2( &w->solid.pos, &ast->pos ) >
-              pow2( ast->radius + ast->margin + wc.range ) )
-            continue;
+/**
+ * @brief Frees the explosion of a weapon.
+ *
+ *    @param we Explosion to free.
+ */
+void weapon_explosionFree( WeaponExplosion *we )
+{
+   luaL_unref( naevL, LUA_REGISTRYINDEX, we->lua_mem );
+   we->lua_mem = LUA_NOREF;
+}
 
-         /* Quadtree collisions. */
-         asteroid_collideQueryIL( ast, &weapon_qtquery, x1, y1, x2, y2 );
-         for ( int j = 0; j < il_size( &weapon_qtquery ); j++ ) {
-            Asteroid *a = &ast->asteroids[il_get( &weapon_qtquery, j, 0 )];
-            vec2      crash[2];
-            int       coll;
-            if ( a->state != ASTEROID_FG )
-               continue;
+/**
+ * @brief Sets up a stand-in weapon for the collision tests of an explosion.
+ *
+ *    @param[out] w Stand-in weapon.
+ *    @param we Explosion of the weapon.
+ */
+static void weapon_explosionWeapon( Weapon *w, const WeaponExplosion *we )
+{
+   memset( w, 0, sizeof( Weapon ) );
+   w->solid   = we->solid;
+   w->faction = we->faction;
+   w->parent  = we->parent;
+   w->target  = we->target;
+   w->outfit  = we->outfit;
+   w->lua_mem = we->lua_mem;
+}
 
-            if ( a->polygon != NULL ) {
-               CollPolyView rpoly;
-               poly_rotate( &rpoly, &a->polygon->views[0], (float)a->ang );
-               coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, &rpoly,
-                                            0., crash );
-               free( rpoly.x );
-               free( rpoly.y );
-            } else
-               coll = weapon_testCollision( &wc, a->gfx, 0, 0, &a->sol, NULL,
-                                            0., crash );
+/**
+ * @brief Hits a pilot caught in the explosion of a weapon.
+ *
+ * Called when the explosions get resolved, see expl_update().
+ *
+ *    @param we Explosion of the weapon.
+ *    @param radius Radius of the explosion.
+ *    @param dmg Damage it does.
+ *    @param p Pilot to try to hit.
+ */
+void weapon_explodePilot( const WeaponExplosion *we, double radius,
+                          const Damage *dmg, Pilot *p )
+{
+   WeaponCollision wc;
+   vec2            crash[2];
+   double          damage;
+   Pilot          *parent;
+   Weapon          wstand;
+   const Weapon   *w = &wstand;
 
-            /* Missed. */
-            if ( !coll )
-               continue;
+   weapon_explosionWeapon( &wstand, we );
 
-            asteroid_hit( a, dmg, mining_rarity, mining_bonus );
-         }
-      }
+   /* Ignore pilots being deleted. */
+   if ( pilot_isFlag( p, PILOT_DELETE ) )
+      return;
+
+   if ( !outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_FRIENDLYFIRE ) ) {
+      /* Ignore if parent is self. */
+      if ( w->parent == p->id )
+         return; /* pilot is self */
+
+      /* Check to see if it can hit. */
+      if ( !weapon_checkCanHit( w, p ) )
+         return;
    }
 
-   /* Finally do a point defense test. */
-   if ( outfit_isProp( w->outfit, OUTFIT_PROP_WEAP_POINTDEFENSE ) ) {
-      qt_query( &weapon_quadtree, &weapon_qtquery, x1, y1, x2, y2 );
-      for ( int i = 0; i < il_size( &weapon_qtquery ); i++ ) {
-         Weapon         *whit = &weapon_stack[il_get( &weapon_qtquery, i, 0 )];
-         WeaponCollision wchit;
-         vec2            crash[2];
-         int             coll;
+   /* Test if hit. */
+   weapon_explodeCollision( &wc, w, radius );
+   if ( !weapon_testCollision(
+           &wc, p->ship->gfx_space, p->tsx, p->tsy, &p->solid,
+           poly_view( &p->ship->polygon, p->solid.dir ), 0., crash ) )
+      return;
 
-         wchit.gfx = outfit_gfx( w->outfit );
-         if ( wchit.gfx->tex != NULL ) {
-            const CollPoly *plg = outfit_plg( w->outfit );
-            if ( plg != NULL ) {
-               wchit.polygon  = plg;
-               wchit.polyview = poly_view( plg, w->solid.dir );
-            } else {
-               wchit.polygon  = NULL;
-               wchit.polyview = NULL;
-            }
-            wchit.range =
-               wchit.gfx->size; /* Range is set to size in this case. */
-         } else {
-            wchit.polygon  = NULL;
-            wchit.polyview = NULL;
-            wchit.range    = wchit.gfx->col_size;
-         }
+   /* Have pilot take damage and get real damage done. */
+   parent = pilot_get( w->parent );
+   damage = pilot_hit( p, &w->solid, parent, dmg, w->outfit, w->lua_mem, 1 );
+   /* Inform AI that it's been hit. */
+   weapon_hitAI( p, parent, damage );
+}
 
-         /* Actually test the collision. */
-         coll = weapon_testCollision( &wc, wchit.gfx->tex, whit->sx, whit->sy,
-                                      &whit->solid, wchit.polyview, wchit.range,
-                                      crash );
-         if ( !coll )
-            continue;
+/**
+ * @brief Point defense test of a missile caught in the explosion of a weapon.
+ *
+ * Called when the explosions get resolved, see expl_update().
+ *
+ *    @param we Explosion of the weapon.
+ *    @param radius Radius of the explosion.
+ *    @param dmg Damage it does.
+ *    @param whit Weapon to try to hit.
+ */
+void weapon_explodeWeapon( const WeaponExplosion *we, double radius,
+                           const Damage *dmg, Weapon *whit )
+{
+   WeaponCollision wc, wchit;
+   vec2            crash[2];
+   Weapon          wstand;
+   const Weapon   *w = &wstand;
 
-         /* Handle the hit. */
-         weapon_damage( whit, dmg );
+   weapon_explosionWeapon( &wstand, we );
+
+   weapon_explodeCollision( &wc, w, radius );
+
+   wchit.gfx = outfit_gfx( w->outfit );
+   if ( wchit.gfx->tex != NULL ) {
+      const CollPoly *plg = outfit_plg( w->outfit );
+      if ( plg != NULL ) {
+         wchit.polygon  = plg;
+         wchit.polyview = poly_view( plg, w->solid.dir );
+      } else {
+         wchit.polygon  = NULL;
+         wchit.polyview = NULL;
       }
+      wchit.range = wchit.gfx->size; /* Range is set to size in this case. */
+   } else {
+      wchit.polygon  = NULL;
+      wchit.polyview = NULL;
+      wchit.range    = wchit.gfx->col_size;
    }
+
+   /* Actually test the collision. */
+   if ( !weapon_testCollision( &wc, wchit.gfx->tex, whit->sx, whit->sy,
+                               &whit->solid, wchit.polyview, wchit.range,
+                               crash ) )
+      return;
+
+   /* Handle the hit. */
+   weapon_damage( whit, dmg );
 }
 
 /**
@@ -1852,7 +2048,7 @@ static void weapon_miss( Weapon *w )
  *    @param w Weapon being damaged.
  *    @param dmg Damage being applied.
  */
-static void weapon_damage( Weapon *w, const Damage *dmg )
+void weapon_damage( Weapon *w, const Damage *dmg )
 {
    assert( outfit_isLauncher( w->outfit ) );
 
@@ -2479,6 +2675,7 @@ static int weapon_create( Weapon *w, PilotOutfitSlot *po, const Outfit *ref,
    /* Create basic features */
    memset( w, 0, sizeof( Weapon ) );
    w->id      = ++weapon_idgen;
+   w->qt_elem = -1;
    w->layer   = ( parent->id == PLAYER_ID ) ? WEAPON_LAYER_FG : WEAPON_LAYER_BG;
    w->mount   = po;
    w->dam_mod = 1.;                     /* Default of 100% damage. */
@@ -2805,7 +3002,6 @@ void weapon_exit( void )
    /* Clean up the queries. */
    qt_destroy( &weapon_quadtree );
    il_destroy( &weapon_qtquery );
-   il_destroy( &weapon_qtexp );
 }
 
 const IntList *weapon_collideQuery( int x1, int y1, int x2, int y2 )
@@ -82,8 +82,25 @@ typedef struct Weapon_ {
    void ( *think )( struct Weapon_ *, double ); /**< for the smart missiles */
 
    WeaponStatus status; /**< Weapon status - to check for jamming */
+
+   int qt_elem; /**< Element of the weapon in the quadtree. */
 } Weapon;
 
+/**
+ * @brief What is kept of an exploding weapon until its explosion is resolved.
+ *
+ * The weapon itself gets destroyed right away. Set up with
+ * weapon_explosionInit() and freed with weapon_explosionFree().
+ */
+typedef struct WeaponExplosion_ {
+   Solid         solid;   /**< Solid of the weapon when it exploded. */
+   int           faction; /**< Faction of the pilot that shot it. */
+   unsigned int  parent;  /**< Pilot that shot it. */
+   Target        target;  /**< Target of the weapon. */
+   const Outfit *outfit;  /**< Outfit that fired it. */
+   int           lua_mem; /**< Own reference to the mem table, if any. */
+} WeaponExplosion;
+
 Weapon *weapon_getStack( void );
 Weapon *weapon_getID( unsigned int id );
 
@@ -105,6 +122,13 @@ void         beam_end( unsigned int beam );
 
 /* Misc stuff. */
 void           weapon_hitAI( Pilot *p, const Pilot *shooter, double dmg );
+void           weapon_damage( Weapon *w, const Damage *dmg );
+void weapon_explosionInit( WeaponExplosion *we, const Weapon *w );
+void weapon_explosionFree( WeaponExplosion *we );
+void weapon_explodePilot( const WeaponExplosion *we, double radius,
+                          const Damage *dmg, Pilot *p );
+void weapon_explodeWeapon( const WeaponExplosion *we, double radius,
+                           const Damage *dmg, Weapon *whit );
 const IntList *weapon_collideQuery( int x1, int y1, int x2, int y2 );
 void weapon_collideQueryIL( IntList *il, int x1, int y1, int x2, int y2 );
 